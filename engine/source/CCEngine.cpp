@@ -12,8 +12,12 @@
 #include "CCObjects.h"
 #include "CCFileManager.h"
 
+#ifdef HEADLESS
+#include "CCHeadlessRenderer.h"
+#else
 #include "CCDeviceControls.h"
 #include "CCDeviceRenderer.h"
+#endif
 #include "CCAppManager.h"
 
 #ifdef IOS
@@ -91,6 +95,12 @@ double CCEngine::GetSystemTime()
 
 	const double currentTime = static_cast<double>(m_currentTime.QuadPart) / static_cast<double>(m_frequency.QuadPart);
 
+#else
+
+    struct timespec res;
+	clock_gettime( CLOCK_MONOTONIC, &res );
+	const double currentTime = res.tv_sec + ( res.tv_nsec * 1e-9 );
+
 #endif
 
     return currentTime;
@@ -107,6 +117,8 @@ CCEngine::CCEngine() :
 
     renderer = NULL;
     textureManager = NULL;
+    transformStore = NULL;
+    renderQueue = NULL;
 
 	fpsLimit = 1/60.0f;
 
@@ -119,6 +131,9 @@ CCEngine::CCEngine() :
 
 CCEngine::~CCEngine()
 {
+    // Finish with our workers before the managers their jobs use are deleted
+    jobScheduler.stop();
+
     onWebViewLoaded.deleteObjects();
     onWebJSLoaded.deleteObjects();
     onWebJSEvalResult.deleteObjects();
@@ -127,20 +142,17 @@ CCEngine::~CCEngine()
     onResume.deleteObjects();
 
     // Run remaining callbacks
-    while( nativeThreadCallbacks.length > 0 || engineThreadCallbacks.length > 0 )
+    while( nativeThreadCallbacks.isEmpty() == false || engineThreadCallbacks.isEmpty() == false )
     {
-        while( nativeThreadCallbacks.length > 0 )
+        CCLambdaCallback *callback;
+        while( ( callback = nativeThreadCallbacks.pop() ) != NULL )
         {
-        	CCLambdaCallback *callback = nativeThreadCallbacks.list[0];
-        	nativeThreadCallbacks.remove( callback );
         	callback->safeRun();
             delete callback;
         }
 
-        while( engineThreadCallbacks.length > 0 )
+        while( ( callback = engineThreadCallbacks.pop() ) != NULL )
         {
-        	CCLambdaCallback *callback = engineThreadCallbacks.list[0];
-        	engineThreadCallbacks.remove( callback );
         	callback->safeRun();
             delete callback;
         }
@@ -152,6 +164,9 @@ CCEngine::~CCEngine()
 	delete controls;
 	delete renderer;
 
+    DELETE_POINTER( transformStore );
+    DELETE_POINTER( renderQueue );
+
 	gEngine = NULL;
 
     CCNativeThreadUnlock();
@@ -165,45 +180,72 @@ void CCEngine::setupNativeThread()
 }
 
 
-static int ZCompare(const void *a, const void *b)
+void CCEngine::enableTransformStore(const bool toggle)
 {
-    const CCCollideable *objectA = CCOctreeGetVisibleCollideables( *(int*)a );
-    const CCCollideable *objectB = CCOctreeGetVisibleCollideables( *(int*)b );
-    const int drawOrderA = objectA->getDrawOrder();
-    const int drawOrderB = objectB->getDrawOrder();
+    if( toggle && transformStore == NULL )
+    {
+        transformStore = new CCTransformStore();
+    }
+    else if( toggle == false )
+    {
+        DELETE_POINTER( transformStore );
+    }
+}
+
 
-    if( drawOrderA == 200 || drawOrderB == 200 )
+void CCEngine::enableRenderQueue(const bool toggle)
+{
+    if( toggle && renderQueue == NULL )
     {
-		if( CCCameraBase::CurrentCamera != NULL )
-		{
-			if( drawOrderA == 200 && drawOrderB == 200 )
-			{
-				const CCVector3 &cameraPosition = CCCameraBase::CurrentCamera->getRotatedPosition();
-				const CCVector3 &positionA = objectA->getConstPosition();
-				const CCVector3 &positionB = objectB->getConstPosition();
-				const float distanceA = CCVector3Distance( positionA, cameraPosition, true );
-				const float distanceB = CCVector3Distance( positionB, cameraPosition, true );
-
-				// If A is smaller than B, swap
-				return (int)( distanceB - distanceA );
-			}
-        }
+        renderQueue = new CCRenderQueue();
+    }
+    else if( toggle == false )
+    {
+        DELETE_POINTER( renderQueue );
+    }
+}
+
 
-        // Largest to the back to be drawn last
-        return drawOrderA - drawOrderB;
+// Draw order first, then opaque before transparent objects, then depth
+// Draw order 200 and transparent objects are drawn back to front, everything else front to back
+static CCSortKey ZSortKey(CCCollideable *object, const CCVector3 &cameraPosition)
+{
+    // Draw orders can be negative, so they're kept to 31 bits and biased to sort below the positive ones
+    const int drawOrder = MAX( MIN( object->getDrawOrder(), 0x3fffffff ), -0x40000000 );
+    const uint biasedDrawOrder = (uint)( drawOrder + 0x40000000 );
+    const bool transparent = object->isTransparent();
+
+    const CCVector3 &position = object->getConstPosition();
+    const float x = position.x - cameraPosition.x;
+    const float y = position.y - cameraPosition.y;
+    const float z = position.z - cameraPosition.z;
+    uint depth = CCSortKeyFromFloat( x * x + y * y + z * z );
+    if( drawOrder == 200 || transparent )
+    {
+        depth = ~depth;
     }
 
-    // Largest to the back to be drawn last
-    return drawOrderA - drawOrderB;
+    return ( (CCSortKey)biasedDrawOrder << 33 ) | ( (CCSortKey)( transparent ? 1 : 0 ) << 32 ) | depth;
 }
 
 
 bool CCEngine::setupEngineThread()
 {
     urlManager = new CCURLManager();
-    CCCameraBase::SetVisibleSortFunction( &ZCompare );
+    CCCameraBase::SetVisibleSortKeyFunction( &ZSortKey );
+
+    // Platforms without worker threads keep using the jobs thread
+    if( jobScheduler.isRunning() == false )
+    {
+        jobScheduler.start( CCJobScheduler::DefaultNumberOfWorkers() );
+    }
+
     const bool rendererSetup = setupRenderer();
+#ifdef HEADLESS
+    controls = new CCControls();
+#else
     controls = new CCDeviceControls();
+#endif
     cameraRecorder = new CCCameraRecorder();
 
     if( rendererSetup )
@@ -223,7 +265,11 @@ void CCEngine::createRenderer()
         delete renderer;
     }
 
+#ifdef HEADLESS
+    renderer = new CCHeadlessRenderer();
+#else
     renderer = new CCDeviceRenderer();
+#endif
 }
 
 
@@ -279,42 +325,74 @@ void CCEngine::updateTime()
 }
 
 
-bool CCEngine::updateNativeThread()
+// Runs queued callbacks until the queue is empty or we're out of time
+// The thread locks are taken once per batch rather than once per callback
+static int RunCallbacks(CCCallbackQueue &queue, const double finishTime, const bool timeLimited, const bool nativeLock, const bool jobsLock)
 {
-    // Run callbacks
-	if( nativeThreadCallbacks.length > 0 )
+    int callbacksProcessed = 0;
+
+    bool finished = false;
+    while( finished == false )
     {
-        int jobsProcessed = 0;
-        
-        const double startTime = CCEngine::GetSystemTime();
-        const double finishTime = startTime + 0.002f;   // Spend a max of 2ms on this task
-        double currentTime = startTime;
-        while( nativeThreadCallbacks.length > 0 )
+        CCLambdaCallback *batch[CCCallbackQueue::batch_size];
+        int batchLength = 0;
+
+        if( nativeLock )
         {
             CCNativeThreadLock();
-            CCLambdaCallback *callback = nativeThreadCallbacks.pop();
-			if( callback != NULL )
-			{
-				callback->safeRun();
-            }
-            CCNativeThreadUnlock();
-            
-            if( callback != NULL )
+        }
+        if( jobsLock )
+        {
+            CCJobsThreadLock();
+        }
+
+        while( batchLength < CCCallbackQueue::batch_size )
+        {
+            CCLambdaCallback *callback = queue.pop();
+            if( callback == NULL )
             {
-				delete callback;
-			}
-            
-            jobsProcessed++;
-            if( textureManager != NULL && textureManager->isReady() )
+                finished = true;
+                break;
+            }
+
+            callback->safeRun();
+            batch[batchLength++] = callback;
+
+            if( timeLimited && CCEngine::GetSystemTime() > finishTime )
             {
-				currentTime = CCEngine::GetSystemTime();
-				if( currentTime > finishTime )
-				{
-					//DEBUGLOG( "Max nativeThreadCallbacks processed in time %i, %i\n", jobsProcessed, engineThreadCallbacks.length );
-					break;
-				}
+                finished = true;
+                break;
             }
         }
+
+        if( nativeLock )
+        {
+            CCNativeThreadUnlock();
+        }
+        if( jobsLock )
+        {
+            CCJobsThreadUnlock();
+        }
+
+        for( int i=0; i<batchLength; ++i )
+        {
+            delete batch[i];
+        }
+        callbacksProcessed += batchLength;
+    }
+
+    return callbacksProcessed;
+}
+
+
+bool CCEngine::updateNativeThread()
+{
+    // Run callbacks
+	if( nativeThreadCallbacks.isEmpty() == false )
+    {
+        const double finishTime = CCEngine::GetSystemTime() + 0.002f;   // Spend a max of 2ms on this task
+        const bool timeLimited = textureManager != NULL && textureManager->isReady();
+        RunCallbacks( nativeThreadCallbacks, finishTime, timeLimited, true, false );
     }
 
 	return false;
@@ -350,52 +428,52 @@ void CCEngine::updateEngineThread()
     	handleBackButton();
     }
 
+    const double frameStartTime = CCEngine::GetSystemTime();
+
     // Run callbacks
-    if( engineThreadCallbacks.length > 0 )
+    if( engineThreadCallbacks.isEmpty() == false )
     {
-        int jobsProcessed = 0;
-        
-        const double startTime = CCEngine::GetSystemTime();
-        const double finishTime = startTime + 0.002f;   // Spend a max of 2ms on this task
-        double currentTime = startTime;
-        while( engineThreadCallbacks.length > 0 )
+        const double finishTime = frameStartTime + 0.002f;   // Spend a max of 2ms on this task
+        const bool timeLimited = textureManager != NULL && textureManager->isReady();
+        const int callbacksProcessed = RunCallbacks( engineThreadCallbacks, finishTime, timeLimited, true, true );
+        if( timeLimited && engineThreadCallbacks.isEmpty() == false )
         {
-            CCNativeThreadLock();
-            CCJobsThreadLock();
-            CCLambdaCallback *callback = engineThreadCallbacks.pop();
-			if( callback != NULL )
-			{
-				callback->safeRun();
-            }
-            CCNativeThreadUnlock();
-            CCJobsThreadUnlock();
-            
-            if( callback != NULL )
-            {
-				delete callback;
-			}
-            
-            jobsProcessed++;
-            if( textureManager != NULL && textureManager->isReady() )
-            {
-				currentTime = CCEngine::GetSystemTime();
-				if( currentTime > finishTime )
-				{
-					DEBUGLOG( "Max engineThreadCallbacks processed in time %i, %i\n", jobsProcessed, engineThreadCallbacks.length );
-					break;
-				}
-            }
+            DEBUGLOG( "Max engineThreadCallbacks processed in time %i\n", callbacksProcessed );
         }
     }
 
+    const double callbacksFinishTime = CCEngine::GetSystemTime();
+    frameTimings.callbacks = callbacksFinishTime - frameStartTime;
+
     finishJobs();
+    const double jobsFinishTime = CCEngine::GetSystemTime();
+    frameTimings.jobs = jobsFinishTime - callbacksFinishTime;
+
+    // List this frame's candidate pairs before anything moves
+    if( collisionManager.broadphase != NULL )
+    {
+        collisionManager.broadphase->update( time.delta );
+    }
+
 	updateLoop();
 
     if( paused == false )
     {
         CCAppManager::UpdateOrientation( time.delta );
     }
+
+    // Rebuild everything moved this frame before it's rendered
+    if( transformStore != NULL )
+    {
+        transformStore->update();
+    }
+    const double updateFinishTime = CCEngine::GetSystemTime();
+    frameTimings.update = updateFinishTime - jobsFinishTime;
+
     renderLoop();
+    const double renderFinishTime = CCEngine::GetSystemTime();
+    frameTimings.render = renderFinishTime - updateFinishTime;
+    frameTimings.total = renderFinishTime - frameStartTime;
 
 #if defined DEBUGON && TARGET_IPHONE_SIMULATOR
 	// 66 frames a second in debug
@@ -415,11 +493,10 @@ bool CCEngine::updateJobsThread()
     CCJobsThreadLock();
 
 	static bool RUNNING_JOB = false;
-	if( jobsThreadCallbacks.length > 0 && !RUNNING_JOB )
+	CCLambdaCallback *callback = RUNNING_JOB ? NULL : jobsThreadCallbacks.pop();
+	if( callback != NULL )
     {
 		RUNNING_JOB = true;
-
-        CCLambdaCallback *callback = jobsThreadCallbacks.pop();
         CCJobsThreadUnlock();
 
 		auto currentThread = Concurrency::task_continuation_context::use_current();
@@ -456,42 +533,15 @@ bool CCEngine::updateJobsThread(const bool multicore)
     // If we have more than one CPU we can process more jobs
     if( multicore || textureManager == NULL || !textureManager->isReady() )
     {
-        int jobsProcessed = 0;
-        
-        const double startTime = CCEngine::GetSystemTime();
-        const double finishTime = startTime + 0.002f;   // Spend a max of 2ms on this task
-        double currentTime = startTime;
-
-        bool updated = false;
-        while( jobsThreadCallbacks.length > 0 )
-        {
-            CCJobsThreadLock();
-            CCLambdaCallback *callback = jobsThreadCallbacks.pop();
-            CCJobsThreadUnlock();
-            callback->safeRun();
-            delete callback;
-            updated = true;
-
-            jobsProcessed++;
-            if( textureManager != NULL && textureManager->isReady() )
-            {
-				currentTime = CCEngine::GetSystemTime();
-				if( currentTime > finishTime )
-				{
-					//DEBUGLOG( "Max jobsThreadCallbacks processed in time %i, %i\n", jobsProcessed, engineThreadCallbacks.length );
-					break;
-				}
-            }
-        }
-        return updated;
+        const double finishTime = CCEngine::GetSystemTime() + 0.002f;   // Spend a max of 2ms on this task
+        const bool timeLimited = textureManager != NULL && textureManager->isReady();
+        return RunCallbacks( jobsThreadCallbacks, finishTime, timeLimited, false, false ) > 0;
     }
     
     // One job per call on single cores
-	if( jobsThreadCallbacks.length > 0 )
+    CCLambdaCallback *callback = jobsThreadCallbacks.pop();
+	if( callback != NULL )
     {
-        CCJobsThreadLock();
-        CCLambdaCallback *callback = jobsThreadCallbacks.pop();
-        CCJobsThreadUnlock();
         callback->safeRun();
         delete callback;
         return true;
@@ -534,16 +584,8 @@ void CCEngine::finishJobs()
 
     urlManager->update();
 
-	// Prune the octree
-	if( collisionManager.pruneOctreeTimer > 0.0f )
-	{
-		collisionManager.pruneOctreeTimer -= time.real;
-		if( collisionManager.pruneOctreeTimer <= 0.0f )
-		{
-            //DEBUGLOG( "Octree - prune" );
-			CCOctreePruneTree( collisionManager.octree );
-		}
-	}
+	// Compact the octree a little each frame
+	CCOctreeCompactTrees( MAX_OCTREE_COMPACTS_PER_FRAME );
 }
 
 
@@ -563,48 +605,31 @@ void CCEngine::touchUpdateMovementThreasholds()
 
 void CCEngine::nextEngineUpdate(CCLambdaCallback *lambdaCallback, const int index)
 {
-    engineThreadCallbacks.add( lambdaCallback );
-
-    if( index >= 0 )
-    {
-        engineThreadCallbacks.reinsert( lambdaCallback, index );
-    }
+    engineThreadCallbacks.push( lambdaCallback, index >= 0 );
 }
 
 
 void CCEngine::engineToNativeThread(CCLambdaCallback *lambdaCallback)
 {
-    CCNativeThreadLock();
-    nativeThreadCallbacks.add( lambdaCallback );
-    CCNativeThreadUnlock();
+    nativeThreadCallbacks.push( lambdaCallback );
 }
 
 
 void CCEngine::nativeToEngineThread(CCLambdaCallback *lambdaCallback, const bool pushToFront)
 {
-    CCNativeThreadLock();
     nextEngineUpdate( lambdaCallback, pushToFront ? 0 : -1 );
-    CCNativeThreadUnlock();
 }
 
 
 void CCEngine::engineToJobsThread(CCLambdaCallback *lambdaCallback, const bool pushToFront)
 {
-    CCJobsThreadLock();
-    jobsThreadCallbacks.add( lambdaCallback );
-    if( pushToFront )
-    {
-        jobsThreadCallbacks.reinsert( lambdaCallback, 0 );
-    }
-    CCJobsThreadUnlock();
+    jobsThreadCallbacks.push( lambdaCallback, pushToFront );
 }
 
 
 void CCEngine::jobsToEngineThread(CCLambdaCallback *lambdaCallback)
 {
-    CCJobsThreadLock();
-    engineThreadCallbacks.add( lambdaCallback );
-    CCJobsThreadUnlock();
+    engineThreadCallbacks.push( lambdaCallback );
 }
 
 
@@ -33,6 +33,26 @@ struct CCTime
 };
 
 
+// Seconds spent in each phase of the last engine thread update
+struct CCFrameTimings
+{
+	CCFrameTimings()
+	{
+		callbacks = 0.0;
+		jobs = 0.0;
+		update = 0.0;
+		render = 0.0;
+		total = 0.0;
+	}
+
+	double callbacks;
+	double jobs;
+	double update;
+	double render;
+	double total;
+};
+
+
 #include "CCAudioManager.h"
 #include "CCExternalAccessoryManager.h"
 #include "CCRenderer.h"
@@ -40,6 +60,11 @@ struct CCTime
 #include "CCCameraBase.h"
 #include "CCTextureManager.h"
 #include "CCOctree.h"
+#include "CCSweepAndPrune.h"
+#include "CCTransformStore.h"
+#include "CCRenderQueue.h"
+#include "CCJobScheduler.h"
+#include "CCCallbackQueue.h"
 #include "CCURLManager.h"
 #include "CCCameraRecorder.h"
 #include "CCScenes.h"
@@ -62,16 +87,27 @@ public:
     // Our Octree collideables container
 	CCCollisionManager collisionManager;
 
+    // Optional, when enabled objects added to scenes keep their matrices here and are refreshed together each frame
+    CCTransformStore *transformStore;
+
+    // Optional, when enabled the visible objects' model draws are queued and submitted sorted by render state
+    CCRenderQueue *renderQueue;
+
+    // Background jobs which can run in any order, spread across our worker threads
+    CCJobScheduler jobScheduler;
+
     // Engine level controls used for timers and such
     CCObjectPtrList<CCTimer> timers;
 
 	CCTime time;
 	double fpsLimit;
 
+    CCFrameTimings frameTimings;
+
 protected:
-    CCPtrList<CCLambdaCallback> nativeThreadCallbacks;
-    CCPtrList<CCLambdaCallback> engineThreadCallbacks;
-    CCPtrList<CCLambdaCallback> jobsThreadCallbacks;
+    CCCallbackQueue nativeThreadCallbacks;
+    CCCallbackQueue engineThreadCallbacks;
+    CCCallbackQueue jobsThreadCallbacks;
 
     bool backButtonActionPending;
 
@@ -98,6 +134,12 @@ public:
     virtual bool setupRenderer();
 
     static double GetSystemTime();
+
+    // Objects already in scenes keep building their own matrices
+    void enableTransformStore(const bool toggle);
+
+    // Only draws made through CCModelBase are queued, anything else still draws straight away
+    void enableRenderQueue(const bool toggle);
 protected:
     void updateTime();
     virtual void start() = 0;
@@ -124,10 +166,11 @@ public:
     virtual void setAppOrientation(const char *orientation) {}
     virtual bool isOrientationSupported(const float angle) { return true; }
 
-    // Run on another thread
+    // Run on another thread, an index of 0 runs ahead of the already queued callbacks
     void nextEngineUpdate(CCLambdaCallback *lambdaCallback, const int index=-1);
     void engineToNativeThread(CCLambdaCallback *lambdaCallback);
     void nativeToEngineThread(CCLambdaCallback *lambdaCallback, const bool pushToFront=false);
+    // Jobs thread callbacks run one at a time in order, submit to jobScheduler to run in parallel instead
     void engineToJobsThread(CCLambdaCallback *lambdaCallback, const bool pushToFront=false);
     void jobsToEngineThread(CCLambdaCallback *lambdaCallback);
 
@@ -242,6 +242,78 @@ bool CCInterpolatorLinearColour::update(const float delta)
 
 
 
+// CCInterpolatorSlerp
+void CCInterpolatorSlerp::setup(CCQuaternion *inCurrent, const CCQuaternion inTarget, CCLambdaCallback *inCallback)
+{
+    CCASSERT( inCurrent != NULL );
+
+    current = inCurrent;
+    start = *inCurrent;
+    target = inTarget;
+    amount = start == target ? 1.0f : 0.0f;
+    updating = true;
+
+    onInterpolated.deleteObjects();
+    if( inCallback != NULL )
+    {
+        onInterpolated.add( inCallback );
+    }
+}
+
+
+bool CCInterpolatorSlerp::update(const float delta)
+{
+    updating = false;
+
+    if( current != NULL )
+    {
+        if( CCToTarget( amount, 1.0f, delta * speed ) )
+        {
+            interpolate( amount );
+            updating = true;
+            return true;
+        }
+        else if( *current != target )
+        {
+            *current = target;
+            current = NULL;
+            updating = true;
+            return true;
+        }
+        else
+        {
+            current = NULL;
+        }
+    }
+    else if( onInterpolated.length > 0 )
+    {
+        CCLAMBDA_SIGNAL pendingCallbacks;
+        for( int i=0; i<onInterpolated.length; ++i )
+        {
+            pendingCallbacks.add( onInterpolated.list[i] );
+        }
+        onInterpolated.length = 0;
+        CCLAMBDA_EMIT_ONCE( pendingCallbacks );
+    }
+
+    return updating;
+}
+
+
+void CCInterpolatorSlerp::interpolate(const float percentage)
+{
+    CCQuaternionSlerp( *current, start, target, percentage );
+}
+
+
+
+// CCInterpolatorNlerp
+void CCInterpolatorNlerp::interpolate(const float percentage)
+{
+    CCQuaternionNlerp( *current, start, target, percentage );
+}
+
+
 // CCTimer
 bool CCTimer::update(const float delta)
 {
@@ -401,6 +401,65 @@ public:
 
 
 
+// CCInterpolatorSlerp
+// Rotates a quaternion to its target at a constant angular speed, call quaternionUpdated on
+// the owning renderable whenever update returns true
+class CCInterpolatorSlerp : public CCInterpolator
+{
+public:
+    CCInterpolatorSlerp()
+    {
+        current = NULL;
+        amount = 1.0f;
+    }
+
+    CCInterpolatorSlerp(CCQuaternion *inCurrent, const CCQuaternion inTarget, CCLambdaCallback *inCallback=NULL)
+    {
+        setup( inCurrent, inTarget, inCallback );
+    }
+
+    void setup(CCQuaternion *inCurrent, const CCQuaternion inTarget, CCLambdaCallback *inCallback=NULL);
+
+    bool equals(CCQuaternion *inCurrent, const CCQuaternion inTarget)
+    {
+        // Ignore if we're already doing this
+        return current == inCurrent && target == inTarget;
+    }
+
+    bool update(const float delta);
+
+    inline float getAmount() const { return amount; }
+    inline const CCQuaternion& getTarget() const { return target; }
+
+protected:
+    virtual void interpolate(const float percentage);
+
+protected:
+    CCQuaternion *current;
+    CCQuaternion start;
+    CCQuaternion target;
+    float amount;
+};
+
+
+// CCInterpolatorNlerp
+// Cheaper, speeding up towards the middle of wide turns
+class CCInterpolatorNlerp : public CCInterpolatorSlerp
+{
+public:
+    CCInterpolatorNlerp() {}
+
+    CCInterpolatorNlerp(CCQuaternion *inCurrent, const CCQuaternion inTarget, CCLambdaCallback *inCallback=NULL)
+    {
+        setup( inCurrent, inTarget, inCallback );
+    }
+
+protected:
+    void interpolate(const float percentage);
+};
+
+
+
 class CCTimer : public CCUpdater
 {
 public:
@@ -0,0 +1,439 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCPathFinderHierarchy.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCPathFinderHierarchy.h"
+
+
+// Keeps the number of clusters reasonable however big the network is
+#define MAX_CLUSTERS_PER_SIDE 256
+
+
+static inline float Distance2D(const CCVector3 &from, const CCVector3 &to)
+{
+    const float x = to.x - from.x;
+    const float z = to.z - from.z;
+    return sqrtf( x * x + z * z );
+}
+
+
+CCPathFinderHierarchy::CCPathFinderHierarchy(const Snapshot &snapshot, const float clusterSize)
+{
+    const int numberOfNodes = snapshot.numberOfNodes;
+    CCASSERT( numberOfNodes > 0 );
+
+    float maxX, maxZ;
+    minX = maxX = snapshot.points[0].x;
+    minZ = maxZ = snapshot.points[0].z;
+    for( int i=1; i<numberOfNodes; ++i )
+    {
+        const CCVector3 &point = snapshot.points[i];
+        minX = MIN( minX, point.x );
+        minZ = MIN( minZ, point.z );
+        maxX = MAX( maxX, point.x );
+        maxZ = MAX( maxZ, point.z );
+    }
+
+    this->clusterSize = MAX( clusterSize, MAX( maxX - minX, maxZ - minZ ) / ( MAX_CLUSTERS_PER_SIDE - 1 ) );
+    clustersWide = (int)( ( maxX - minX ) / this->clusterSize ) + 1;
+    clustersDeep = (int)( ( maxZ - minZ ) / this->clusterSize ) + 1;
+    const int numberOfClusters = clustersWide * clustersDeep;
+
+    nodeClusters = (int*)malloc( sizeof( int ) * numberOfNodes );
+    CCASSERT( nodeClusters != NULL );
+    for( int i=0; i<numberOfNodes; ++i )
+    {
+        const CCVector3 &point = snapshot.points[i];
+        const int clusterX = MIN( (int)( ( point.x - minX ) / this->clusterSize ), clustersWide-1 );
+        const int clusterZ = MIN( (int)( ( point.z - minZ ) / this->clusterSize ), clustersDeep-1 );
+        nodeClusters[i] = clusterZ * clustersWide + clusterX;
+    }
+
+    // Flip the connections around so we can search backwards from a goal
+    const int numberOfConnections = snapshot.connectionStarts[numberOfNodes];
+    incomingStarts = (int*)malloc( sizeof( int ) * ( numberOfNodes + 1 ) );
+    incomingNodes = (int*)malloc( sizeof( int ) * MAX( numberOfConnections, 1 ) );
+    incomingLengths = (float*)malloc( sizeof( float ) * MAX( numberOfConnections, 1 ) );
+    CCASSERT( incomingStarts != NULL && incomingNodes != NULL && incomingLengths != NULL );
+    for( int i=0; i<=numberOfNodes; ++i )
+    {
+        incomingStarts[i] = 0;
+    }
+    for( int i=0; i<numberOfConnections; ++i )
+    {
+        incomingStarts[snapshot.connectionNodes[i]+1]++;
+    }
+    for( int i=0; i<numberOfNodes; ++i )
+    {
+        incomingStarts[i+1] += incomingStarts[i];
+    }
+    for( int i=0; i<numberOfNodes; ++i )
+    {
+        for( int j=snapshot.connectionStarts[i]; j<snapshot.connectionStarts[i+1]; ++j )
+        {
+            const int incoming = incomingStarts[snapshot.connectionNodes[j]]++;
+            incomingNodes[incoming] = i;
+            incomingLengths[incoming] = snapshot.connectionLengths[j];
+        }
+    }
+    for( int i=numberOfNodes; i>0; --i )
+    {
+        incomingStarts[i] = incomingStarts[i-1];
+    }
+    incomingStarts[0] = 0;
+
+    // Both ends of a connection across clusters are entrances
+    nodeEntrances = (int*)malloc( sizeof( int ) * numberOfNodes );
+    CCASSERT( nodeEntrances != NULL );
+    for( int i=0; i<numberOfNodes; ++i )
+    {
+        nodeEntrances[i] = -1;
+    }
+    for( int i=0; i<numberOfNodes; ++i )
+    {
+        for( int j=snapshot.connectionStarts[i]; j<snapshot.connectionStarts[i+1]; ++j )
+        {
+            const int target = snapshot.connectionNodes[j];
+            if( nodeClusters[target] != nodeClusters[i] )
+            {
+                nodeEntrances[i] = 0;
+                nodeEntrances[target] = 0;
+            }
+        }
+    }
+
+    numberOfEntrances = 0;
+    for( int i=0; i<numberOfNodes; ++i )
+    {
+        if( nodeEntrances[i] != -1 )
+        {
+            nodeEntrances[i] = numberOfEntrances++;
+        }
+    }
+
+    entranceNodes = (int*)malloc( sizeof( int ) * MAX( numberOfEntrances, 1 ) );
+    clusterEntranceStarts = (int*)malloc( sizeof( int ) * ( numberOfClusters + 1 ) );
+    clusterEntrances = (int*)malloc( sizeof( int ) * MAX( numberOfEntrances, 1 ) );
+    CCASSERT( entranceNodes != NULL && clusterEntranceStarts != NULL && clusterEntrances != NULL );
+    for( int i=0; i<=numberOfClusters; ++i )
+    {
+        clusterEntranceStarts[i] = 0;
+    }
+    for( int i=0; i<numberOfNodes; ++i )
+    {
+        if( nodeEntrances[i] != -1 )
+        {
+            entranceNodes[nodeEntrances[i]] = i;
+            clusterEntranceStarts[nodeClusters[i]+1]++;
+        }
+    }
+    for( int i=0; i<numberOfClusters; ++i )
+    {
+        clusterEntranceStarts[i+1] += clusterEntranceStarts[i];
+    }
+    for( int i=0; i<numberOfEntrances; ++i )
+    {
+        clusterEntrances[clusterEntranceStarts[nodeClusters[entranceNodes[i]]]++] = i;
+    }
+    for( int i=numberOfClusters; i>0; --i )
+    {
+        clusterEntranceStarts[i] = clusterEntranceStarts[i-1];
+    }
+    clusterEntranceStarts[0] = 0;
+
+    // Each entrance's edges, its connections across clusters then the cheapest legs to the other entrances of its cluster
+    edgeStarts = (int*)malloc( sizeof( int ) * ( numberOfEntrances + 1 ) );
+    CCASSERT( edgeStarts != NULL );
+    edgeTargets = NULL;
+    edgeCosts = NULL;
+    edgeDirections = NULL;
+    numberOfEdges = allocatedEdges = 0;
+
+    SearchContext context;
+    for( int entrance=0; entrance<numberOfEntrances; ++entrance )
+    {
+        edgeStarts[entrance] = numberOfEdges;
+        const int node = entranceNodes[entrance];
+        const int cluster = nodeClusters[node];
+
+        const int firstConnection = snapshot.connectionStarts[node];
+        for( int i=firstConnection; i<snapshot.connectionStarts[node+1]; ++i )
+        {
+            const int target = snapshot.connectionNodes[i];
+            if( nodeClusters[target] != cluster )
+            {
+                addEdge( nodeEntrances[target], snapshot.connectionLengths[i], i - firstConnection );
+            }
+        }
+
+        searchCluster( snapshot, context, node, false );
+        for( int i=clusterEntranceStarts[cluster]; i<clusterEntranceStarts[cluster+1]; ++i )
+        {
+            const int otherEntrance = clusterEntrances[i];
+            const CCPathFinderNetwork::SearchState &state = context.states[entranceNodes[otherEntrance]];
+            if( otherEntrance != entrance && state.searchID == context.searchID && state.closed )
+            {
+                addEdge( otherEntrance, state.cost, -1 );
+            }
+        }
+    }
+    edgeStarts[numberOfEntrances] = numberOfEdges;
+}
+
+
+CCPathFinderHierarchy::~CCPathFinderHierarchy()
+{
+    FREE_POINTER( nodeClusters );
+    FREE_POINTER( incomingStarts );
+    FREE_POINTER( incomingNodes );
+    FREE_POINTER( incomingLengths );
+    FREE_POINTER( entranceNodes );
+    FREE_POINTER( nodeEntrances );
+    FREE_POINTER( clusterEntranceStarts );
+    FREE_POINTER( clusterEntrances );
+    FREE_POINTER( edgeStarts );
+    FREE_POINTER( edgeTargets );
+    FREE_POINTER( edgeCosts );
+    FREE_POINTER( edgeDirections );
+}
+
+
+void CCPathFinderHierarchy::addEdge(const int target, const float cost, const int direction)
+{
+    if( numberOfEdges == allocatedEdges )
+    {
+        allocatedEdges = allocatedEdges > 0 ? allocatedEdges * 2 : 1024;
+        edgeTargets = (int*)realloc( edgeTargets, sizeof( int ) * allocatedEdges );
+        edgeCosts = (float*)realloc( edgeCosts, sizeof( float ) * allocatedEdges );
+        edgeDirections = (int*)realloc( edgeDirections, sizeof( int ) * allocatedEdges );
+        CCASSERT( edgeTargets != NULL && edgeCosts != NULL && edgeDirections != NULL );
+    }
+
+    edgeTargets[numberOfEdges] = target;
+    edgeCosts[numberOfEdges] = cost;
+    edgeDirections[numberOfEdges] = direction;
+    numberOfEdges++;
+}
+
+
+void CCPathFinderHierarchy::Relax(SearchContext &context, const int node, const int parent, const int parentDirection,
+                                  const float cost, const float estimate)
+{
+    CCPathFinderNetwork::SearchState &state = context.states[node];
+    const bool visited = state.searchID == context.searchID;
+    if( visited && ( state.closed || cost >= state.cost ) )
+    {
+        return;
+    }
+
+    state.cost = cost;
+    state.estimate = estimate;
+    state.parent = parent;
+    state.parentDirection = parentDirection;
+    if( visited )
+    {
+        context.openHeapSiftUp( state.heapIndex );
+    }
+    else
+    {
+        state.searchID = context.searchID;
+        state.closed = false;
+        context.openHeapPush( node );
+    }
+}
+
+
+void CCPathFinderHierarchy::searchCluster(const Snapshot &snapshot, SearchContext &context, const int fromNode, const bool reverse) const
+{
+    const int cluster = nodeClusters[fromNode];
+    const int *starts = reverse ? incomingStarts : snapshot.connectionStarts;
+    const int *targets = reverse ? incomingNodes : snapshot.connectionNodes;
+    const float *lengths = reverse ? incomingLengths : snapshot.connectionLengths;
+
+    context.begin( snapshot.numberOfNodes );
+    Relax( context, fromNode, -1, -1, 0.0f, 0.0f );
+    while( context.openHeapLength > 0 )
+    {
+        const int current = context.openHeapPop();
+        CCPathFinderNetwork::SearchState &state = context.states[current];
+        state.closed = true;
+        context.nodesSearched++;
+
+        for( int i=starts[current]; i<starts[current+1]; ++i )
+        {
+            const int target = targets[i];
+            if( nodeClusters[target] == cluster )
+            {
+                const float cost = state.cost + lengths[i];
+                Relax( context, target, current, i, cost, cost );
+            }
+        }
+    }
+}
+
+
+bool CCPathFinderHierarchy::refine(const Snapshot &snapshot, SearchContext &context, const int fromNode, const int toNode, const int cluster,
+                                   Path &path, int &nodesSearched) const
+{
+    Path leg;
+    const bool found = CCPathFinderNetwork::SearchSnapshot( snapshot, context, NULL, fromNode, toNode, 0, leg, nodeClusters, cluster );
+    nodesSearched += context.nodesSearched;
+    if( found )
+    {
+        path.reserve( path.endDirection + leg.endDirection );
+        for( int i=0; i<leg.endDirection; ++i )
+        {
+            path.directions[path.endDirection++] = leg.directions[i];
+        }
+        path.distance += leg.distance;
+    }
+    return found;
+}
+
+
+bool CCPathFinderHierarchy::findPath(const Snapshot &snapshot, SearchContext &context, const int fromNode, const int toNode, Path &path) const
+{
+    const int fromCluster = nodeClusters[fromNode];
+    const int toCluster = nodeClusters[toNode];
+    if( fromCluster == toCluster )
+    {
+        return CCPathFinderNetwork::SearchSnapshot( snapshot, context, NULL, fromNode, toNode, 0, path );
+    }
+
+    int nodesSearched = 0;
+
+    // The cost from the start out to the entrances of its cluster
+    const int numberOfStartLinks = clusterEntranceStarts[fromCluster+1] - clusterEntranceStarts[fromCluster];
+    const int numberOfGoalLinks = clusterEntranceStarts[toCluster+1] - clusterEntranceStarts[toCluster];
+    float *startCosts = (float*)malloc( sizeof( float ) * MAX( numberOfStartLinks + numberOfGoalLinks, 1 ) );
+    float *goalCosts = startCosts + numberOfStartLinks;
+    CCASSERT( startCosts != NULL );
+
+    searchCluster( snapshot, context, fromNode, false );
+    nodesSearched += context.nodesSearched;
+    for( int i=0; i<numberOfStartLinks; ++i )
+    {
+        const CCPathFinderNetwork::SearchState &state = context.states[entranceNodes[clusterEntrances[clusterEntranceStarts[fromCluster]+i]]];
+        startCosts[i] = state.searchID == context.searchID && state.closed ? state.cost : -1.0f;
+    }
+
+    // And from the entrances of the goal's cluster in to the goal
+    searchCluster( snapshot, context, toNode, true );
+    nodesSearched += context.nodesSearched;
+    for( int i=0; i<numberOfGoalLinks; ++i )
+    {
+        const CCPathFinderNetwork::SearchState &state = context.states[entranceNodes[clusterEntrances[clusterEntranceStarts[toCluster]+i]]];
+        goalCosts[i] = state.searchID == context.searchID && state.closed ? state.cost : -1.0f;
+    }
+
+    // A* over the entrances, with one past the last entrance standing in for the goal
+    const int goal = numberOfEntrances;
+    const CCVector3 &goalPoint = snapshot.points[toNode];
+    context.begin( numberOfEntrances + 1 );
+    for( int i=0; i<numberOfStartLinks; ++i )
+    {
+        if( startCosts[i] >= 0.0f )
+        {
+            const int entrance = clusterEntrances[clusterEntranceStarts[fromCluster]+i];
+            Relax( context, entrance, -1, -1, startCosts[i], startCosts[i] + Distance2D( snapshot.points[entranceNodes[entrance]], goalPoint ) );
+        }
+    }
+
+    bool found = false;
+    while( context.openHeapLength > 0 )
+    {
+        const int current = context.openHeapPop();
+        CCPathFinderNetwork::SearchState &state = context.states[current];
+        state.closed = true;
+        if( current == goal )
+        {
+            found = true;
+            break;
+        }
+        nodesSearched++;
+
+        // Entrances to the goal's cluster link on to the goal
+        if( nodeClusters[entranceNodes[current]] == toCluster )
+        {
+            for( int i=0; i<numberOfGoalLinks; ++i )
+            {
+                if( clusterEntrances[clusterEntranceStarts[toCluster]+i] == current )
+                {
+                    if( goalCosts[i] >= 0.0f )
+                    {
+                        const float cost = state.cost + goalCosts[i];
+                        Relax( context, goal, current, -1, cost, cost );
+                    }
+                    break;
+                }
+            }
+        }
+
+        for( int i=edgeStarts[current]; i<edgeStarts[current+1]; ++i )
+        {
+            const int target = edgeTargets[i];
+            const float cost = state.cost + edgeCosts[i];
+            Relax( context, target, current, i, cost, cost + Distance2D( snapshot.points[entranceNodes[target]], goalPoint ) );
+        }
+    }
+    free( startCosts );
+
+    path.endDirection = 0;
+    path.distance = 0.0f;
+    if( found == false )
+    {
+        context.nodesSearched = nodesSearched;
+        return false;
+    }
+
+    // Walk back along the route, remembering the edge taken into each entrance
+    int routeLength = 0;
+    for( int i=context.states[goal].parent; i!=-1; i=context.states[i].parent )
+    {
+        routeLength++;
+    }
+    int *route = (int*)malloc( sizeof( int ) * routeLength * 2 );
+    int *routeEdges = route + routeLength;
+    CCASSERT( route != NULL );
+    {
+        int index = routeLength;
+        for( int i=context.states[goal].parent; i!=-1; i=context.states[i].parent )
+        {
+            index--;
+            route[index] = i;
+            routeEdges[index] = context.states[i].parentDirection;
+        }
+    }
+
+    // Refine each leg through a cluster, the legs across clusters are single connections
+    found = refine( snapshot, context, fromNode, entranceNodes[route[0]], fromCluster, path, nodesSearched );
+    for( int i=1; i<routeLength && found; ++i )
+    {
+        const int edge = routeEdges[i];
+        if( edgeDirections[edge] >= 0 )
+        {
+            path.reserve( path.endDirection + 1 );
+            path.directions[path.endDirection++] = edgeDirections[edge];
+            path.distance += edgeCosts[edge];
+        }
+        else
+        {
+            const int legFrom = entranceNodes[route[i-1]];
+            found = refine( snapshot, context, legFrom, entranceNodes[route[i]], nodeClusters[legFrom], path, nodesSearched );
+        }
+    }
+    if( found )
+    {
+        found = refine( snapshot, context, entranceNodes[route[routeLength-1]], toNode, toCluster, path, nodesSearched );
+    }
+    free( route );
+
+    context.nodesSearched = nodesSearched;
+    return found;
+}
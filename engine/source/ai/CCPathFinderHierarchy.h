@@ -0,0 +1,79 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCPathFinderHierarchy.h
+ * Description : Clusters of path nodes joined by their entrances, for searching long paths hierarchically.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCPATHFINDERHIERARCHY_H__
+#define __CCPATHFINDERHIERARCHY_H__
+
+
+class CCPathFinderHierarchy
+{
+    typedef CCPathFinderNetwork::Snapshot Snapshot;
+    typedef CCPathFinderNetwork::SearchContext SearchContext;
+    typedef CCPathFinderNetwork::Path Path;
+
+public:
+    // Splits the snapshot's nodes into clusters and caches the costs between the entrances of each cluster
+    CCPathFinderHierarchy(const Snapshot &snapshot, const float clusterSize);
+    ~CCPathFinderHierarchy();
+
+    // Plans a route between the entrances, then searches each leg of it inside its cluster
+    // Nodes sharing a cluster use the flat search, context.nodesSearched counts every node expanded
+    bool findPath(const Snapshot &snapshot, SearchContext &context, const int fromNode, const int toNode, Path &path) const;
+
+    float getClusterSize() const { return clusterSize; }
+    int getNumberOfClusters() const { return clustersWide * clustersDeep; }
+    int getNumberOfEntrances() const { return numberOfEntrances; }
+    int getNumberOfEdges() const { return numberOfEdges; }
+
+protected:
+    // Dijkstra out from a node without leaving its cluster, reverse follows the connections backwards
+    void searchCluster(const Snapshot &snapshot, SearchContext &context, const int fromNode, const bool reverse) const;
+
+    // A* from one node to another inside a cluster, adding the directions onto the path
+    bool refine(const Snapshot &snapshot, SearchContext &context, const int fromNode, const int toNode, const int cluster,
+                Path &path, int &nodesSearched) const;
+
+    // Opens the node or lowers its cost, unless it's closed or was already reached as cheaply
+    static void Relax(SearchContext &context, const int node, const int parent, const int parentDirection,
+                      const float cost, const float estimate);
+
+    void addEdge(const int target, const float cost, const int direction);
+
+protected:
+    float clusterSize;
+    float minX, minZ;
+    int clustersWide, clustersDeep;
+    int *nodeClusters;
+
+    // The connections leading into each node, for searching backwards from the goal
+    int *incomingStarts;
+    int *incomingNodes;
+    float *incomingLengths;
+
+    // Nodes with a connection into or out of their cluster
+    int numberOfEntrances;
+    int *entranceNodes;
+    int *nodeEntrances;                 // -1 for nodes inside their cluster
+    int *clusterEntranceStarts;
+    int *clusterEntrances;
+
+    // Edges between the entrances, either a connection across clusters or a cached leg through one
+    int *edgeStarts;
+    int *edgeTargets;
+    float *edgeCosts;
+    int *edgeDirections;                // The connection index for edges across clusters, -1 for legs through a cluster
+    int numberOfEdges, allocatedEdges;
+};
+
+
+#endif // __CCPATHFINDERHIERARCHY_H__
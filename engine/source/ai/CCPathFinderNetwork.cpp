@@ -9,17 +9,66 @@
 
 
 #include "CCDefines.h"
+#include "CCJobScheduler.h"
+#include "CCAtomics.h"
+#include "CCPathFinderHierarchy.h"
+
+
+// Furthest apart two nodes can be and still be connected
+#define MAX_CONNECTION_DISTANCE 200.0f
 
 
 CCPathFinderNetwork::CCPathFinderNetwork()
 {
     connectingNodes = false;
+    pathingFrom = NULL;
+    searchMode = path_search_astar;
+
+    snapshot = NULL;
+    networkVersion = 0;
+    hierarchyClusterSize = 0.0f;
+
+    maxSearchNodes = 0;
+    nodesSearched = 0;
+
+    nodeGridDirty = true;
+    nodeGridMinX = nodeGridMinZ = 0.0f;
+    nodeGridCellSize = nodeGridInverseCellSize = 1.0f;
+    nodeGridWidth = nodeGridDepth = 0;
+    nodeGridCellStarts = NULL;
+    nodeGridCellNodes = NULL;
+
+    pathCache = NULL;
+    pathCacheSize = pathCacheLength = 0;
+    pathCacheBuckets = NULL;
+    pathCacheBucketsMask = 0;
+    pathCacheHits = pathCacheMisses = 0;
+    setPathCacheSize( 256 );
 }
 
 
 CCPathFinderNetwork::~CCPathFinderNetwork()
 {
 	nodes.deleteObjectsAndList();
+    if( snapshot != NULL )
+    {
+        snapshot->release();
+    }
+    delete[] pathCache;
+    FREE_POINTER( pathCacheBuckets );
+    FREE_POINTER( nodeGridCellStarts );
+    FREE_POINTER( nodeGridCellNodes );
+}
+
+
+void CCPathFinderNetwork::indexNodes()
+{
+    for( int i=0; i<nodes.length; ++i )
+    {
+        nodes.list[i]->index = i;
+    }
+    nodeGridDirty = true;
+    networkVersion++;
 }
 
 
@@ -98,7 +147,13 @@ void CCPathFinderNetwork::addNode(const CCVector3 point, CCCollideable *parent)
 	PathNode *node = new PathNode();
 	node->point = point;
     node->parent = parent;
+    node->index = nodes.length;
+
+    // Grow by doubling rather than CCPtrList's fixed steps, networks can run to tens of thousands of nodes
+    nodes.reserve( nodes.length + 1 );
 	nodes.add( node );
+    nodeGridDirty = true;
+    networkVersion++;
 }
 
 
@@ -155,16 +210,34 @@ void CCPathFinderNetwork::removeCollideable(CCCollideable *collideable)
 {
     pathingFrom = NULL;
 
+    // Compact the list in one pass
+    CCVector3 removedMin( MAXFLOAT ), removedMax( -MAXFLOAT );
+    int length = 0;
 	for( int i=0; i<nodes.length; ++i )
 	{
 		PathNode *node = nodes.list[i];
 		if( node->parent == collideable )
 		{
-			nodes.remove( node );
+            removedMin.x = MIN( removedMin.x, node->point.x );
+            removedMin.z = MIN( removedMin.z, node->point.z );
+            removedMax.x = MAX( removedMax.x, node->point.x );
+            removedMax.z = MAX( removedMax.z, node->point.z );
             delete node;
-			--i;
 		}
+        else
+        {
+            nodes.list[length++] = node;
+        }
 	}
+
+    if( length != nodes.length )
+    {
+        nodes.length = length;
+        indexNodes();
+
+        // Drop the connections to the removed nodes
+        reconnect( removedMin, removedMax );
+    }
 }
 
 
@@ -225,6 +298,7 @@ void CCPathFinderNetwork::linkDistantNodes()
             float x = startX;
             float z = startZ;
             float increment = 150.0;
+            nodes.reserve( nodes.length + (int)( ( ( endX - startX ) / increment + 1.0f ) * ( ( endZ - startZ ) / increment + 1.0f ) ) );
             while( x < endX && z < endZ )
             {
                 x += increment;
@@ -248,16 +322,21 @@ void CCPathFinderNetwork::removeFillerNodes()
 {
     pathingFrom = NULL;
 
+    int length = 0;
     for( int i=0; i<nodes.length; ++i )
     {
         PathNode *node = nodes.list[i];
         if( node->parent == NULL )
         {
-            nodes.remove( node );
             delete node;
-            --i;
+        }
+        else
+        {
+            nodes.list[length++] = node;
         }
     }
+    nodes.length = length;
+    indexNodes();
 }
 
 
@@ -265,6 +344,8 @@ void CCPathFinderNetwork::clear()
 {
 	nodes.deleteObjects();
     pathingFrom = NULL;
+    nodeGridDirty = true;
+    networkVersion++;
 }
 
 
@@ -275,33 +356,216 @@ void CCPathFinderNetwork::connect()
 	removeFillerNodes();
 	linkDistantNodes();
 
-    // Reset our connections
+    updateNodeGrid();
+    if( nodeGridWidth > 0 )
+    {
+        const CCVector3 min( nodeGridMinX, 0.0f, nodeGridMinZ );
+        const CCVector3 max( nodeGridMinX + nodeGridWidth * nodeGridCellSize, 0.0f, nodeGridMinZ + nodeGridDepth * nodeGridCellSize );
+        connectNodes( min, max );
+    }
+
+    connectingNodes = false;
+}
+
+
+void CCPathFinderNetwork::reconnect(const CCVector3 &min, const CCVector3 &max)
+{
+    connectingNodes = true;
+    pathingFrom = NULL;
+
+    // Anyone within reach of the area may have a connection into it
+    CCVector3 reachMin = min, reachMax = max;
+    reachMin.sub( MAX_CONNECTION_DISTANCE );
+    reachMax.add( MAX_CONNECTION_DISTANCE );
+    connectNodes( reachMin, reachMax );
+
+    connectingNodes = false;
+}
+
+
+void CCPathFinderNetwork::reconnect(CCCollideable *collideable)
+{
+    CCUpdateCollisions( collideable );
+    CCVector3 min = collideable->aabbMin, max = collideable->aabbMax;
 	for( int i=0; i<nodes.length; ++i )
 	{
-		PathNode *node = nodes.list[i];
-        CCPtrList<PathNode::PathConnection> &connections = node->connections;
-        connections.deleteObjects();
+		const PathNode *node = nodes.list[i];
+		if( node->parent == collideable )
+		{
+            min.x = MIN( min.x, node->point.x );
+            min.z = MIN( min.z, node->point.z );
+            max.x = MAX( max.x, node->point.x );
+            max.z = MAX( max.z, node->point.z );
+		}
 	}
+    reconnect( min, max );
+}
 
-	const float maxNodeDistance = CC_SQUARE( 200.0f );
-	for( int i=0; i<nodes.length; ++i )
-	{
-		PathNode *currentNode = nodes.list[i];
-        CCPtrList<PathNode::PathConnection> &connections = currentNode->connections;
 
-		for( int j=0; j<nodes.length; ++j )
-		{
-			const PathNode *targetNode = nodes.list[j];
-			if( currentNode != targetNode )
-			{
-				const float distance = CCVector3Distance2D( currentNode->point, targetNode->point );
-				if( distance < maxNodeDistance )
-				{
-                    const float angle = CCAngleTowards( currentNode->point, targetNode->point );
-
-                    // Check to see if we already have this angle
-                    //if( false )
+void CCPathFinderNetwork::binStaticCollideables(StaticBins &bins, const int startX, const int startZ, const int endX, const int endZ)
+{
+    bins.startX = startX;
+    bins.startZ = startZ;
+    bins.width = endX - startX + 1;
+    bins.depth = endZ - startZ + 1;
+
+    CCPtrList<CCCollideable> &collideables = gEngine->collisionManager.collideables;
+    if( collideables.length == 0 )
+    {
+        return;
+    }
+
+    // Only the statics overlapping our cells can block a connection
+    const float areaMinX = nodeGridMinX + startX * nodeGridCellSize;
+    const float areaMinZ = nodeGridMinZ + startZ * nodeGridCellSize;
+    const float areaMaxX = nodeGridMinX + ( endX + 1 ) * nodeGridCellSize;
+    const float areaMaxZ = nodeGridMinZ + ( endZ + 1 ) * nodeGridCellSize;
+    bins.collideables = (CCCollideable**)malloc( sizeof( CCCollideable* ) * collideables.length );
+    CCASSERT( bins.collideables != NULL );
+    for( int i=0; i<collideables.length; ++i )
+    {
+        CCCollideable *collideable = collideables.list[i];
+        if( collideable->isActive() && collideable->isCollideable() && CCHasFlag( collideable->collideableType, collision_static ) )
+        {
+            CCUpdateCollisions( collideable );
+            if( collideable->aabbMax.x >= areaMinX && collideable->aabbMin.x <= areaMaxX &&
+                collideable->aabbMax.z >= areaMinZ && collideable->aabbMin.z <= areaMaxZ )
+            {
+                bins.collideables[bins.numberOfCollideables++] = collideable;
+            }
+        }
+    }
+
+    if( bins.numberOfCollideables == 0 )
+    {
+        return;
+    }
+
+    // Counting sort the statics into every cell they touch
+    const int numberOfCells = bins.width * bins.depth;
+    bins.cellStarts = (int*)malloc( sizeof( int ) * ( numberOfCells + 1 ) );
+    CCASSERT( bins.cellStarts != NULL );
+    for( int i=0; i<=numberOfCells; ++i )
+    {
+        bins.cellStarts[i] = 0;
+    }
+
+    for( int pass=0; pass<2; ++pass )
+    {
+        for( int i=0; i<bins.numberOfCollideables; ++i )
+        {
+            const CCCollideable *collideable = bins.collideables[i];
+            const int cellStartX = MAX( getNodeGridX( collideable->aabbMin.x ), startX ) - startX;
+            const int cellEndX = MIN( getNodeGridX( collideable->aabbMax.x ), endX ) - startX;
+            const int cellStartZ = MAX( getNodeGridZ( collideable->aabbMin.z ), startZ ) - startZ;
+            const int cellEndZ = MIN( getNodeGridZ( collideable->aabbMax.z ), endZ ) - startZ;
+            for( int z=cellStartZ; z<=cellEndZ; ++z )
+            {
+                for( int x=cellStartX; x<=cellEndX; ++x )
+                {
+                    const int cell = z * bins.width + x;
+                    if( pass == 0 )
+                    {
+                        bins.cellStarts[cell+1]++;
+                    }
+                    else
+                    {
+                        bins.cellIndices[bins.cellStarts[cell]++] = i;
+                    }
+                }
+            }
+        }
+
+        if( pass == 0 )
+        {
+            for( int i=0; i<numberOfCells; ++i )
+            {
+                bins.cellStarts[i+1] += bins.cellStarts[i];
+            }
+            bins.cellIndices = (int*)malloc( sizeof( int ) * MAX( bins.cellStarts[numberOfCells], 1 ) );
+            CCASSERT( bins.cellIndices != NULL );
+        }
+    }
+
+    // Each cell's start was bumped along as it was filled
+    for( int i=numberOfCells; i>0; --i )
+    {
+        bins.cellStarts[i] = bins.cellStarts[i-1];
+    }
+    bins.cellStarts[0] = 0;
+
+    bins.stamps = (int*)malloc( sizeof( int ) * bins.numberOfCollideables );
+    bins.nearby = (CCCollideable**)malloc( sizeof( CCCollideable* ) * bins.numberOfCollideables );
+    CCASSERT( bins.stamps != NULL && bins.nearby != NULL );
+    for( int i=0; i<bins.numberOfCollideables; ++i )
+    {
+        bins.stamps[i] = 0;
+    }
+}
+
+
+void CCPathFinderNetwork::connectNodes(const CCVector3 &min, const CCVector3 &max)
+{
+    updateNodeGrid();
+    if( nodeGridWidth == 0 )
+    {
+        return;
+    }
+
+    networkVersion++;
+
+    // Statics are gathered from up to a connection away from the nodes being connected
+    StaticBins bins;
+    binStaticCollideables( bins,
+                           getNodeGridX( min.x - MAX_CONNECTION_DISTANCE ), getNodeGridZ( min.z - MAX_CONNECTION_DISTANCE ),
+                           getNodeGridX( max.x + MAX_CONNECTION_DISTANCE ), getNodeGridZ( max.z + MAX_CONNECTION_DISTANCE ) );
+
+    const int startX = getNodeGridX( min.x ), endX = getNodeGridX( max.x );
+    const int startZ = getNodeGridZ( min.z ), endZ = getNodeGridZ( max.z );
+    for( int z=startZ; z<=endZ; ++z )
+    {
+        for( int x=startX; x<=endX; ++x )
+        {
+            const int cell = z * nodeGridWidth + x;
+            for( int i=nodeGridCellStarts[cell]; i<nodeGridCellStarts[cell+1]; ++i )
+            {
+                PathNode *node = nodes.list[nodeGridCellNodes[i]];
+                if( node->point.x >= min.x && node->point.x <= max.x && node->point.z >= min.z && node->point.z <= max.z )
+                {
+                    connectNode( node, bins );
+                }
+            }
+        }
+    }
+}
+
+
+void CCPathFinderNetwork::connectNode(PathNode *currentNode, StaticBins &bins)
+{
+    CCPtrList<PathNode::PathConnection> &connections = currentNode->connections;
+    connections.deleteObjects();
+
+    const CCVector3 &point = currentNode->point;
+    const int startX = getNodeGridX( point.x - MAX_CONNECTION_DISTANCE ), endX = getNodeGridX( point.x + MAX_CONNECTION_DISTANCE );
+    const int startZ = getNodeGridZ( point.z - MAX_CONNECTION_DISTANCE ), endZ = getNodeGridZ( point.z + MAX_CONNECTION_DISTANCE );
+
+	const float maxNodeDistance = CC_SQUARE( MAX_CONNECTION_DISTANCE );
+    for( int z=startZ; z<=endZ; ++z )
+    {
+        for( int x=startX; x<=endX; ++x )
+        {
+            const int cell = z * nodeGridWidth + x;
+            for( int j=nodeGridCellStarts[cell]; j<nodeGridCellStarts[cell+1]; ++j )
+            {
+                const PathNode *targetNode = nodes.list[nodeGridCellNodes[j]];
+                if( currentNode != targetNode )
+                {
+                    const float distance = CCVector3Distance2D( point, targetNode->point );
+                    if( distance < maxNodeDistance )
                     {
+                        const float angle = CCAngleTowards( point, targetNode->point );
+
+                        // Check to see if we already have this angle
                         int angleFoundIndex = -1;
                         for( int k=0; k<connections.length; ++k )
                         {
@@ -322,24 +586,287 @@ void CCPathFinderNetwork::connect()
                             else
                             {
                                 PathNode::PathConnection *connection = connections.list[angleFoundIndex];
-                                connections.remove( connection );
+                                connections.removeIndex( angleFoundIndex );
                                 delete connection;
                             }
                         }
+
+                        // Insert our node
+                        PathNode::PathConnection *newConnection = new PathNode::PathConnection();
+                        newConnection->distance = distance;
+                        newConnection->length = sqrtf( distance );
+                        newConnection->angle = angle;
+                        newConnection->node = targetNode;
+                        connections.add( newConnection );
                     }
+                }
+            }
+        }
+    }
 
-                    // Insert our node
-                    PathNode::PathConnection *newConnection = new PathNode::PathConnection();
-                    newConnection->distance = distance;
-                    newConnection->angle = angle;
-                    newConnection->node = targetNode;
-                    connections.add( newConnection );
-				}
-			}
-		}
-	}
+    // Gather the statics around us once, then test all our connections against them
+    // A connection with the same angle as a blocked one would be blocked too, so it's fine to test after culling
+    if( connections.length > 0 && bins.numberOfCollideables > 0 )
+    {
+        const int stamp = currentNode->index + 1;
+        int numberOfNearby = 0;
+        for( int z=MAX( startZ, bins.startZ ); z<=MIN( endZ, bins.startZ + bins.depth - 1 ); ++z )
+        {
+            for( int x=MAX( startX, bins.startX ); x<=MIN( endX, bins.startX + bins.width - 1 ); ++x )
+            {
+                const int cell = ( z - bins.startZ ) * bins.width + ( x - bins.startX );
+                for( int i=bins.cellStarts[cell]; i<bins.cellStarts[cell+1]; ++i )
+                {
+                    const int index = bins.cellIndices[i];
+                    if( bins.stamps[index] != stamp )
+                    {
+                        bins.stamps[index] = stamp;
+                        bins.nearby[numberOfNearby++] = bins.collideables[index];
+                    }
+                }
+            }
+        }
 
-    connectingNodes = false;
+        if( numberOfNearby > 0 )
+        {
+            // Nodes sitting inside a static, such as filler nodes, can still connect out of it
+            for( int i=connections.length-1; i>=0; --i )
+            {
+                PathNode::PathConnection *connection = connections.list[i];
+                if( CCBasicLineCollisionCheck( bins.nearby, numberOfNearby, NULL, point, connection->node->point,
+                                               NULL, false, collision_static, true ) != NULL )
+                {
+                    connections.removeIndex( i );
+                    delete connection;
+                }
+            }
+        }
+    }
+}
+
+
+void CCPathFinderNetwork::updateNodeGrid()
+{
+    if( nodeGridDirty == false )
+    {
+        return;
+    }
+    nodeGridDirty = false;
+
+    FREE_POINTER( nodeGridCellStarts );
+    FREE_POINTER( nodeGridCellNodes );
+    nodeGridWidth = nodeGridDepth = 0;
+    if( nodes.length == 0 )
+    {
+        return;
+    }
+
+    float maxX, maxZ;
+    nodeGridMinX = maxX = nodes.list[0]->point.x;
+    nodeGridMinZ = maxZ = nodes.list[0]->point.z;
+    for( int i=1; i<nodes.length; ++i )
+    {
+        const CCVector3 &point = nodes.list[i]->point;
+        nodeGridMinX = MIN( nodeGridMinX, point.x );
+        nodeGridMinZ = MIN( nodeGridMinZ, point.z );
+        maxX = MAX( maxX, point.x );
+        maxZ = MAX( maxZ, point.z );
+    }
+
+    // Aim for a couple of nodes per cell, without letting the grid get too big
+    const int maxCellsPerSide = 1024;
+    const float width = maxX - nodeGridMinX;
+    const float depth = maxZ - nodeGridMinZ;
+    float cellSize = sqrtf( MAX( width * depth, 1.0f ) * 2.0f / nodes.length );
+    cellSize = MAX( cellSize, MAX( width, depth ) / ( maxCellsPerSide - 1 ) );
+    cellSize = MAX( cellSize, 1.0f );
+    nodeGridCellSize = cellSize;
+    nodeGridInverseCellSize = 1.0f / cellSize;
+    nodeGridWidth = (int)( width * nodeGridInverseCellSize ) + 1;
+    nodeGridDepth = (int)( depth * nodeGridInverseCellSize ) + 1;
+
+    // Counting sort the nodes into their cells
+    const int numberOfCells = nodeGridWidth * nodeGridDepth;
+    nodeGridCellStarts = (int*)malloc( sizeof( int ) * ( numberOfCells + 1 ) );
+    nodeGridCellNodes = (int*)malloc( sizeof( int ) * nodes.length );
+    CCASSERT( nodeGridCellStarts != NULL && nodeGridCellNodes != NULL );
+    for( int i=0; i<=numberOfCells; ++i )
+    {
+        nodeGridCellStarts[i] = 0;
+    }
+
+    for( int i=0; i<nodes.length; ++i )
+    {
+        const CCVector3 &point = nodes.list[i]->point;
+        const int cell = getNodeGridZ( point.z ) * nodeGridWidth + getNodeGridX( point.x );
+        nodeGridCellStarts[cell+1]++;
+    }
+
+    for( int i=0; i<numberOfCells; ++i )
+    {
+        nodeGridCellStarts[i+1] += nodeGridCellStarts[i];
+    }
+
+    // Each cell's start is bumped along as it's filled, then shifted back
+    for( int i=0; i<nodes.length; ++i )
+    {
+        const CCVector3 &point = nodes.list[i]->point;
+        const int cell = getNodeGridZ( point.z ) * nodeGridWidth + getNodeGridX( point.x );
+        nodeGridCellNodes[nodeGridCellStarts[cell]++] = i;
+    }
+
+    for( int i=numberOfCells; i>0; --i )
+    {
+        nodeGridCellStarts[i] = nodeGridCellStarts[i-1];
+    }
+    nodeGridCellStarts[0] = 0;
+}
+
+
+void CCPathFinderNetwork::beginNearestSearch(NearestSearch &search, const CCVector3 &position)
+{
+    updateNodeGrid();
+
+    search.position = position;
+    search.numberOfCandidates = 0;
+    search.ring = 0;
+    search.distance = 0.0f;
+    search.finished = nodeGridWidth == 0;
+    if( search.finished == false )
+    {
+        search.cellX = getNodeGridX( position.x );
+        search.cellZ = getNodeGridZ( position.z );
+    }
+}
+
+
+void CCPathFinderNetwork::addNearestCandidate(NearestSearch &search, const int node)
+{
+    if( search.numberOfCandidates == search.allocatedCandidates )
+    {
+        search.allocatedCandidates = search.allocatedCandidates > 0 ? search.allocatedCandidates * 2 : 64;
+        search.candidates = (NearestSearch::Candidate*)realloc( search.candidates, sizeof( NearestSearch::Candidate ) * search.allocatedCandidates );
+        CCASSERT( search.candidates != NULL );
+    }
+
+    NearestSearch::Candidate candidate;
+    candidate.distance = CCVector3Distance2D( nodes.list[node]->point, search.position );
+    candidate.node = node;
+
+    int index = search.numberOfCandidates++;
+    while( index > 0 )
+    {
+        const int parentIndex = ( index - 1 ) / 2;
+        if( search.candidates[parentIndex].distance <= candidate.distance )
+        {
+            break;
+        }
+        search.candidates[index] = search.candidates[parentIndex];
+        index = parentIndex;
+    }
+    search.candidates[index] = candidate;
+}
+
+
+const CCPathFinderNetwork::PathNode* CCPathFinderNetwork::nextNearestNode(NearestSearch &search)
+{
+    while( true )
+    {
+        // Nodes outside the rings searched so far are at least this far away
+        float bound = MAXFLOAT;
+        const int searched = search.ring - 1;
+        if( searched < 0 )
+        {
+            bound = 0.0f;
+        }
+        else
+        {
+            const float cellSize = nodeGridCellSize;
+            if( search.cellX - searched > 0 )
+            {
+                bound = MIN( bound, search.position.x - ( nodeGridMinX + ( search.cellX - searched ) * cellSize ) );
+            }
+            if( search.cellX + searched < nodeGridWidth-1 )
+            {
+                bound = MIN( bound, ( nodeGridMinX + ( search.cellX + searched + 1 ) * cellSize ) - search.position.x );
+            }
+            if( search.cellZ - searched > 0 )
+            {
+                bound = MIN( bound, search.position.z - ( nodeGridMinZ + ( search.cellZ - searched ) * cellSize ) );
+            }
+            if( search.cellZ + searched < nodeGridDepth-1 )
+            {
+                bound = MIN( bound, ( nodeGridMinZ + ( search.cellZ + searched + 1 ) * cellSize ) - search.position.z );
+            }
+
+            if( bound != MAXFLOAT )
+            {
+                bound = bound > 0.0f ? bound * bound : 0.0f;
+            }
+        }
+
+        // The closest candidate is safe to hand out once nothing unsearched can be closer
+        if( search.numberOfCandidates > 0 && search.candidates[0].distance <= bound )
+        {
+            const NearestSearch::Candidate closest = search.candidates[0];
+            const NearestSearch::Candidate last = search.candidates[--search.numberOfCandidates];
+            int index = 0;
+            while( true )
+            {
+                int childIndex = index * 2 + 1;
+                if( childIndex >= search.numberOfCandidates )
+                {
+                    break;
+                }
+                if( childIndex + 1 < search.numberOfCandidates && search.candidates[childIndex+1].distance < search.candidates[childIndex].distance )
+                {
+                    childIndex++;
+                }
+                if( last.distance <= search.candidates[childIndex].distance )
+                {
+                    break;
+                }
+                search.candidates[index] = search.candidates[childIndex];
+                index = childIndex;
+            }
+            search.candidates[index] = last;
+
+            search.distance = closest.distance;
+            return nodes.list[closest.node];
+        }
+
+        if( search.finished )
+        {
+            return NULL;
+        }
+
+        // Search the next ring of cells out
+        const int ring = search.ring++;
+        const int startX = search.cellX - ring, endX = search.cellX + ring;
+        const int startZ = search.cellZ - ring, endZ = search.cellZ + ring;
+        for( int z=MAX( startZ, 0 ); z<=MIN( endZ, nodeGridDepth-1 ); ++z )
+        {
+            // Only the edges of the ring are new
+            const bool edgeRow = z == startZ || z == endZ;
+            const int step = edgeRow ? 1 : endX - startX;
+            for( int x=startX; x<=endX; x+=MAX( step, 1 ) )
+            {
+                if( x >= 0 && x < nodeGridWidth )
+                {
+                    const int cell = z * nodeGridWidth + x;
+                    for( int i=nodeGridCellStarts[cell]; i<nodeGridCellStarts[cell+1]; ++i )
+                    {
+                        addNearestCandidate( search, nodeGridCellNodes[i] );
+                    }
+                }
+            }
+        }
+
+        if( startX <= 0 && startZ <= 0 && endX >= nodeGridWidth-1 && endZ >= nodeGridDepth-1 )
+        {
+            search.finished = true;
+        }
+    }
 }
 
 
@@ -347,16 +874,15 @@ uint CCPathFinderNetwork::findClosestNodes(const CCVector3 &position, const floa
 {
 	uint found = 0;
 
-	for( int i=0; i<nodes.length && found<length; ++i )
+    // As before the radius is compared against the squared distance
+    NearestSearch search;
+    beginNearestSearch( search, position );
+    const PathNode *node;
+	while( found < length && ( node = nextNearestNode( search ) ) != NULL && search.distance < radius )
 	{
-		const PathNode *node = nodes.list[i];
 		if( node->connections.length > 0 )
 		{
-			float distance = CCVector3Distance2D( position, node->point );
-			if( distance < radius )
-			{
-				vectors[found++] = &node->point;
-			}
+            vectors[found++] = &node->point;
 		}
 	}
 
@@ -366,75 +892,57 @@ uint CCPathFinderNetwork::findClosestNodes(const CCVector3 &position, const floa
 
 const CCPathFinderNetwork::PathNode* CCPathFinderNetwork::findClosestNodeToPathTarget(CCCollideable *objectToPath, const CCVector3 &position, const bool withConnections)
 {
-	int closestNode = -1;
-	float closestDistance = MAXFLOAT;
-
-	for( int i=0; i<nodes.length; ++i )
+    // Check the nodes in order of distance, the first one we can reach is the closest
+    NearestSearch search;
+    beginNearestSearch( search, position );
+    const PathNode *node;
+    while( ( node = nextNearestNode( search ) ) != NULL )
 	{
-		PathNode *node = nodes.list[i];
 		if( withConnections == false || node->connections.length > 0 )
 		{
-			const float distance = CCVector3Distance2D( node->point, position );
-			if( distance < closestDistance )
-			{
-                CCCollideable *hitObject = CCOctreeMovementCollisionCheck( objectToPath, position, node->point );
-                if( hitObject != NULL )
-                {
-                    continue;
-                }
-                if( hitObject == NULL )
-                {
-                    closestDistance = distance;
-                    closestNode = i;
-                }
-			}
+            if( objectToPath == NULL || CCOctreeMovementCollisionCheck( objectToPath, position, node->point ) == NULL )
+            {
+                return node;
+            }
 		}
 	}
 
-	if( closestNode != -1 )
-	{
-		return nodes.list[closestNode];
-	}
-
 	return NULL;
 }
 
 
 const CCPathFinderNetwork::PathNode* CCPathFinderNetwork::findClosestNode(const CCVector3 &position)
 {
-    int closestNode = -1;
-	float closestDistance = MAXFLOAT;
+    NearestSearch search;
+    beginNearestSearch( search, position );
+    return nextNearestNode( search );
+}
 
-	for( int i=0; i<nodes.length; ++i )
-	{
-		PathNode *node = nodes.list[i];
-        const float distance = CCVector3Distance2D( node->point, position );
-        if( distance < closestDistance )
+
+int CCPathFinderNetwork::findNearestNodes(const CCVector3 &position, const int k, const PathNode **nearestNodes, const bool withConnections)
+{
+    int found = 0;
+
+    NearestSearch search;
+    beginNearestSearch( search, position );
+    const PathNode *node;
+    while( found < k && ( node = nextNearestNode( search ) ) != NULL )
+    {
+        if( withConnections == false || node->connections.length > 0 )
         {
-            closestDistance = distance;
-            closestNode = i;
+            nearestNodes[found++] = node;
         }
-	}
-
-	if( closestNode != -1 )
-	{
-		return nodes.list[closestNode];
-	}
+    }
 
-	return NULL;
+    return found;
 }
 
-static const CCPathFinderNetwork::PathNode *pathFromNode;
-static const CCPathFinderNetwork::PathNode *pathTargetNode;
-static int compare(const void *a, const void *b)
+// CCVector3Distance2D shares a static buffer, so the job threads need their own
+static inline float Distance2D(const CCVector3 &from, const CCVector3 &to)
 {
-	const CCPathFinderNetwork::PathNode::PathConnection &pathA = *pathFromNode->connections.list[ *(int*)a ];
-	const CCPathFinderNetwork::PathNode::PathConnection &pathB = *pathFromNode->connections.list[ *(int*)b ];
-
-	const float pathADistance = CCVector3Distance2D( pathA.node->point, pathTargetNode->point );
-	const float pathBDistance = CCVector3Distance2D( pathB.node->point, pathTargetNode->point );
-
-	return (int)( pathADistance - pathBDistance );
+    const float x = to.x - from.x;
+    const float z = to.z - from.z;
+    return sqrtf( x * x + z * z );
 }
 
 
@@ -442,12 +950,23 @@ bool CCPathFinderNetwork::findPath(CCCollideable *objectToPath, Path &pathResult
 {
     if( fromNode != NULL && toNode != NULL )
     {
+        pathingFrom = fromNode;
+        if( searchMode == path_search_astar )
+        {
+            if( findPathAStar( objectToPath, path, fromNode, toNode ) )
+            {
+                pathResult = path;
+                return true;
+            }
+            return false;
+        }
+
         NodesList<const PathNode, 50> previousNodes;
         previousNodes.add( fromNode );
 
-        pathTargetNode = toNode;
         path.distance = 0.0f;
-        pathingFrom = fromNode;
+        path.endDirection = 0;
+        path.reserve( 50 );
         if( followPath( objectToPath, path, 0, 0.0f, previousNodes, fromNode, toNode ) )
         {
             pathResult = path;
@@ -458,6 +977,675 @@ bool CCPathFinderNetwork::findPath(CCCollideable *objectToPath, Path &pathResult
 }
 
 
+bool CCPathFinderNetwork::findPathAStar(CCCollideable *objectToPath, Path &path, const PathNode *fromNode, const PathNode *toNode)
+{
+    CCASSERT( fromNode->index >= 0 && fromNode->index < nodes.length && nodes.list[fromNode->index] == fromNode );
+
+    const bool found = Search( *getSnapshot(), searchContext, objectToPath, fromNode->index, toNode->index, maxSearchNodes, path );
+    nodesSearched = searchContext.nodesSearched;
+    return found;
+}
+
+
+void CCPathFinderNetwork::setHierarchyClusterSize(const float clusterSize)
+{
+    hierarchyClusterSize = clusterSize;
+}
+
+
+bool CCPathFinderNetwork::Search(const Snapshot &snapshot, SearchContext &context, CCCollideable *objectToPath,
+                                 const int fromNode, const int toNode, const int maxSearchNodes, Path &path)
+{
+    if( snapshot.hierarchy != NULL && objectToPath == NULL )
+    {
+        return snapshot.hierarchy->findPath( snapshot, context, fromNode, toNode, path );
+    }
+    return SearchSnapshot( snapshot, context, objectToPath, fromNode, toNode, maxSearchNodes, path );
+}
+
+
+bool CCPathFinderNetwork::SearchSnapshot(const Snapshot &snapshot, SearchContext &context, CCCollideable *objectToPath,
+                                         const int fromNode, const int toNode, const int maxSearchNodes, Path &path,
+                                         const int *nodeClusters, const int cluster)
+{
+    CCASSERT( fromNode >= 0 && fromNode < snapshot.numberOfNodes && toNode >= 0 && toNode < snapshot.numberOfNodes );
+    context.begin( snapshot.numberOfNodes );
+    SearchState *states = context.states;
+    const uint searchID = context.searchID;
+    const CCVector3 &toPoint = snapshot.points[toNode];
+
+    SearchState &fromState = states[fromNode];
+    fromState.searchID = searchID;
+    fromState.closed = false;
+    fromState.cost = 0.0f;
+    fromState.estimate = Distance2D( snapshot.points[fromNode], toPoint );
+    fromState.parent = -1;
+    fromState.parentDirection = -1;
+    context.openHeapPush( fromNode );
+
+    while( context.openHeapLength > 0 )
+    {
+        const int current = context.openHeapPop();
+        SearchState &state = states[current];
+        state.closed = true;
+
+        if( current == toNode )
+        {
+            // Walk back up the parents to fill in the directions
+            int length = 0;
+            for( int i=current; states[i].parent != -1; i=states[i].parent )
+            {
+                length++;
+            }
+
+            path.endDirection = 0;
+            path.reserve( length );
+            path.endDirection = length;
+            path.distance = state.cost;
+            for( int i=current; states[i].parent != -1; i=states[i].parent )
+            {
+                path.directions[--length] = states[i].parentDirection;
+            }
+            return true;
+        }
+
+        context.nodesSearched++;
+        if( maxSearchNodes > 0 && context.nodesSearched > maxSearchNodes )
+        {
+            break;
+        }
+
+        const CCVector3 &point = snapshot.points[current];
+        const int firstConnection = snapshot.connectionStarts[current];
+        const int numberOfConnections = snapshot.connectionStarts[current+1] - firstConnection;
+        for( int i=0; i<numberOfConnections; ++i )
+        {
+            const int target = snapshot.connectionNodes[firstConnection+i];
+            if( nodeClusters != NULL && nodeClusters[target] != cluster )
+            {
+                continue;
+            }
+
+            SearchState &targetState = states[target];
+            const bool visited = targetState.searchID == searchID;
+            if( visited && targetState.closed )
+            {
+                continue;
+            }
+
+            const float cost = state.cost + snapshot.connectionLengths[firstConnection+i];
+            if( visited && cost >= targetState.cost )
+            {
+                continue;
+            }
+
+            // Only pay for the collision check on connections that would improve the path
+            const CCVector3 &targetPoint = snapshot.points[target];
+            if( objectToPath != NULL && CCOctreeMovementCollisionCheck( objectToPath, point, targetPoint ) != NULL )
+            {
+                continue;
+            }
+
+            targetState.cost = cost;
+            targetState.estimate = cost + Distance2D( targetPoint, toPoint );
+            targetState.parent = current;
+            targetState.parentDirection = i;
+            if( visited )
+            {
+                context.openHeapSiftUp( targetState.heapIndex );
+            }
+            else
+            {
+                targetState.searchID = searchID;
+                targetState.closed = false;
+                context.openHeapPush( target );
+            }
+        }
+    }
+
+    return false;
+}
+
+
+CCPathFinderNetwork::SearchContext::SearchContext()
+{
+    states = NULL;
+    allocatedStates = 0;
+    searchID = 0;
+    openHeap = NULL;
+    openHeapLength = 0;
+    nodesSearched = 0;
+}
+
+
+CCPathFinderNetwork::SearchContext::~SearchContext()
+{
+    FREE_POINTER( states );
+    FREE_POINTER( openHeap );
+}
+
+
+#ifdef CCJOBSCHEDULER_THREADS
+static pthread_key_t defaultSearchContextKey;
+static pthread_once_t defaultSearchContextOnce = PTHREAD_ONCE_INIT;
+
+
+void CCPathFinderNetwork::SearchContext::DeleteDefault(void *context)
+{
+    delete (SearchContext*)context;
+}
+
+
+void CCPathFinderNetwork::SearchContext::CreateDefaultKey()
+{
+    pthread_key_create( &defaultSearchContextKey, &DeleteDefault );
+}
+#endif
+
+
+CCPathFinderNetwork::SearchContext& CCPathFinderNetwork::SearchContext::Default()
+{
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_once( &defaultSearchContextOnce, &CreateDefaultKey );
+    SearchContext *context = (SearchContext*)pthread_getspecific( defaultSearchContextKey );
+    if( context == NULL )
+    {
+        context = new SearchContext();
+        pthread_setspecific( defaultSearchContextKey, context );
+    }
+    return *context;
+#else
+    // Without worker threads everything searches from the one thread
+    static SearchContext context;
+    return context;
+#endif
+}
+
+
+void CCPathFinderNetwork::SearchContext::begin(const int numberOfNodes)
+{
+    if( numberOfNodes > allocatedStates )
+    {
+        FREE_POINTER( states );
+        FREE_POINTER( openHeap );
+        allocatedStates = numberOfNodes;
+        states = (SearchState*)malloc( sizeof( SearchState ) * allocatedStates );
+        openHeap = (int*)malloc( sizeof( int ) * allocatedStates );
+        CCASSERT( states != NULL && openHeap != NULL );
+
+        for( int i=0; i<allocatedStates; ++i )
+        {
+            states[i].searchID = 0;
+        }
+        searchID = 0;
+    }
+
+    // States stamped by older searches count as unvisited
+    searchID++;
+    if( searchID == 0 )
+    {
+        for( int i=0; i<allocatedStates; ++i )
+        {
+            states[i].searchID = 0;
+        }
+        searchID = 1;
+    }
+
+    openHeapLength = 0;
+    nodesSearched = 0;
+}
+
+
+// Lower estimates first, on a tie prefer the node further along its path
+#define OPEN_HEAP_LESS( A, B ) ( states[A].estimate < states[B].estimate || \
+                                 ( states[A].estimate == states[B].estimate && states[A].cost > states[B].cost ) )
+
+void CCPathFinderNetwork::SearchContext::openHeapPush(const int node)
+{
+    const int heapIndex = openHeapLength++;
+    openHeap[heapIndex] = node;
+    states[node].heapIndex = heapIndex;
+    openHeapSiftUp( heapIndex );
+}
+
+
+int CCPathFinderNetwork::SearchContext::openHeapPop()
+{
+    const int node = openHeap[0];
+    openHeapLength--;
+    if( openHeapLength > 0 )
+    {
+        openHeap[0] = openHeap[openHeapLength];
+        states[openHeap[0]].heapIndex = 0;
+        openHeapSiftDown( 0 );
+    }
+    return node;
+}
+
+
+void CCPathFinderNetwork::SearchContext::openHeapSiftUp(int heapIndex)
+{
+    const int node = openHeap[heapIndex];
+    while( heapIndex > 0 )
+    {
+        const int parentIndex = ( heapIndex - 1 ) / 2;
+        const int parent = openHeap[parentIndex];
+        if( OPEN_HEAP_LESS( node, parent ) == false )
+        {
+            break;
+        }
+        openHeap[heapIndex] = parent;
+        states[parent].heapIndex = heapIndex;
+        heapIndex = parentIndex;
+    }
+    openHeap[heapIndex] = node;
+    states[node].heapIndex = heapIndex;
+}
+
+
+void CCPathFinderNetwork::SearchContext::openHeapSiftDown(int heapIndex)
+{
+    const int node = openHeap[heapIndex];
+    while( true )
+    {
+        int childIndex = heapIndex * 2 + 1;
+        if( childIndex >= openHeapLength )
+        {
+            break;
+        }
+        if( childIndex + 1 < openHeapLength && OPEN_HEAP_LESS( openHeap[childIndex+1], openHeap[childIndex] ) )
+        {
+            childIndex++;
+        }
+
+        const int child = openHeap[childIndex];
+        if( OPEN_HEAP_LESS( child, node ) == false )
+        {
+            break;
+        }
+        openHeap[heapIndex] = child;
+        states[child].heapIndex = heapIndex;
+        heapIndex = childIndex;
+    }
+    openHeap[heapIndex] = node;
+    states[node].heapIndex = heapIndex;
+}
+
+#undef OPEN_HEAP_LESS
+
+
+CCPathFinderNetwork::Snapshot::Snapshot(const CCPtrList<PathNode> &nodes, const int version)
+{
+    this->version = version;
+    references = 1;
+    clusterSize = 0.0f;
+    hierarchy = NULL;
+    numberOfNodes = nodes.length;
+
+    int numberOfConnections = 0;
+    for( int i=0; i<nodes.length; ++i )
+    {
+        numberOfConnections += nodes.list[i]->connections.length;
+    }
+
+    points = (CCVector3*)malloc( sizeof( CCVector3 ) * MAX( numberOfNodes, 1 ) );
+    connectionStarts = (int*)malloc( sizeof( int ) * ( numberOfNodes + 1 ) );
+    connectionNodes = (int*)malloc( sizeof( int ) * MAX( numberOfConnections, 1 ) );
+    connectionLengths = (float*)malloc( sizeof( float ) * MAX( numberOfConnections, 1 ) );
+    CCASSERT( points != NULL && connectionStarts != NULL && connectionNodes != NULL && connectionLengths != NULL );
+
+    // Connections keep their order so the directions found index straight into each node's connections
+    int connection = 0;
+    for( int i=0; i<nodes.length; ++i )
+    {
+        const PathNode *node = nodes.list[i];
+        points[i] = node->point;
+        connectionStarts[i] = connection;
+        for( int j=0; j<node->connections.length; ++j )
+        {
+            const PathNode::PathConnection *pathConnection = node->connections.list[j];
+            connectionNodes[connection] = pathConnection->node->index;
+            connectionLengths[connection] = pathConnection->length;
+            connection++;
+        }
+    }
+    connectionStarts[numberOfNodes] = connection;
+}
+
+
+CCPathFinderNetwork::Snapshot::~Snapshot()
+{
+    if( hierarchy != NULL )
+    {
+        delete hierarchy;
+    }
+
+    FREE_POINTER( points );
+    FREE_POINTER( connectionStarts );
+    FREE_POINTER( connectionNodes );
+    FREE_POINTER( connectionLengths );
+}
+
+
+void CCPathFinderNetwork::Snapshot::retain()
+{
+    CCAtomicAdd( references, 1 );
+}
+
+
+void CCPathFinderNetwork::Snapshot::release()
+{
+    if( CCAtomicAdd( references, -1 ) == 1 )
+    {
+        delete this;
+    }
+}
+
+
+CCPathFinderNetwork::Snapshot* CCPathFinderNetwork::getSnapshot()
+{
+    if( snapshot == NULL || snapshot->version != networkVersion || snapshot->clusterSize != hierarchyClusterSize )
+    {
+        if( snapshot != NULL )
+        {
+            snapshot->release();
+        }
+        snapshot = new Snapshot( nodes, networkVersion );
+        snapshot->clusterSize = hierarchyClusterSize;
+        if( hierarchyClusterSize > 0.0f && nodes.length > 0 )
+        {
+            snapshot->hierarchy = new CCPathFinderHierarchy( *snapshot, hierarchyClusterSize );
+        }
+    }
+    return snapshot;
+}
+
+
+// Searches a snapshot on a job thread then hands the result back on the engine thread
+class CCPathRequestCallback : public CCLambdaSafeCallback
+{
+public:
+    CCPathRequestCallback(CCPathFinderNetwork *network,
+                          const CCPathFinderNetwork::PathNode *fromNode, const CCPathFinderNetwork::PathNode *toNode,
+                          CCLambdaCallback *onResult)
+    {
+        this->network = network;
+        this->activeHandle = network->activeHandle;
+        snapshot = network->getSnapshot();
+        snapshot->retain();
+        maxSearchNodes = network->maxSearchNodes;
+
+        this->fromNode = fromNode;
+        this->toNode = toNode;
+        fromIndex = fromNode->index;
+        toIndex = toNode->index;
+        this->onResult = onResult;
+        found = false;
+    }
+
+    ~CCPathRequestCallback()
+    {
+        snapshot->release();
+
+        // Only left if the network was deleted before we finished
+        if( onResult != NULL )
+        {
+            delete onResult;
+        }
+    }
+
+protected:
+    // Run on a job thread, only touches the snapshot
+    void run()
+    {
+        found = CCPathFinderNetwork::Search( *snapshot, CCPathFinderNetwork::SearchContext::Default(), NULL,
+                                             fromIndex, toIndex, maxSearchNodes, path );
+    }
+
+    // Finish on the engine thread
+    void finish()
+    {
+        network->finishPathRequest( snapshot->version, fromNode, toNode, found, path, onResult );
+        onResult = NULL;
+    }
+
+private:
+    CCPathFinderNetwork *network;
+    CCPathFinderNetwork::Snapshot *snapshot;
+    int maxSearchNodes;
+
+    const CCPathFinderNetwork::PathNode *fromNode, *toNode;
+    int fromIndex, toIndex;
+    CCLambdaCallback *onResult;
+
+    bool found;
+    CCPathFinderNetwork::Path path;
+};
+
+
+void CCPathFinderNetwork::requestPath(const PathNode *fromNode, const PathNode *toNode, CCLambdaCallback *onResult)
+{
+    CCASSERT( fromNode != NULL && toNode != NULL && onResult != NULL );
+
+    const PathCacheEntry *cached = findCachedPath( fromNode->index, toNode->index );
+    if( cached != NULL )
+    {
+        pathCacheHits++;
+        PathRequestResult result;
+        result.fromNode = fromNode;
+        result.toNode = toNode;
+        result.found = cached->found;
+        result.invalidated = false;
+        result.path = cached->path;
+
+        onResult->runParameters = &result;
+        onResult->safeRun();
+        delete onResult;
+        return;
+    }
+    pathCacheMisses++;
+
+    CCPathRequestCallback *callback = new CCPathRequestCallback( this, fromNode, toNode, onResult );
+    if( gEngine != NULL && gEngine->jobScheduler.isRunning() )
+    {
+        CCJobScheduler &jobScheduler = gEngine->jobScheduler;
+        jobScheduler.submit( jobScheduler.createJob( callback, job_priority_normal, true ) );
+    }
+    else
+    {
+        // Without workers search straight away
+        callback->safeRun();
+        delete callback;
+    }
+}
+
+
+void CCPathFinderNetwork::finishPathRequest(const int version, const PathNode *fromNode, const PathNode *toNode,
+                                            const bool found, const Path &path, CCLambdaCallback *onResult)
+{
+    PathRequestResult result;
+    if( version == networkVersion )
+    {
+        cachePath( fromNode->index, toNode->index, found, path );
+        result.fromNode = fromNode;
+        result.toNode = toNode;
+        result.found = found;
+        result.invalidated = false;
+        result.path = path;
+    }
+    else
+    {
+        result.fromNode = NULL;
+        result.toNode = NULL;
+        result.found = false;
+        result.invalidated = true;
+    }
+
+    onResult->runParameters = &result;
+    onResult->safeRun();
+    delete onResult;
+}
+
+
+void CCPathFinderNetwork::setPathCacheSize(const int size)
+{
+    delete[] pathCache;
+    pathCache = NULL;
+    FREE_POINTER( pathCacheBuckets );
+
+    pathCacheSize = size;
+    if( pathCacheSize > 0 )
+    {
+        pathCache = new PathCacheEntry[pathCacheSize];
+
+        int numberOfBuckets = 1;
+        while( numberOfBuckets < pathCacheSize * 2 )
+        {
+            numberOfBuckets *= 2;
+        }
+        pathCacheBuckets = (int*)malloc( sizeof( int ) * numberOfBuckets );
+        CCASSERT( pathCacheBuckets != NULL );
+        pathCacheBucketsMask = numberOfBuckets - 1;
+    }
+    clearPathCache();
+}
+
+
+void CCPathFinderNetwork::clearPathCache()
+{
+    pathCacheLength = 0;
+    pathCacheHead = pathCacheTail = -1;
+    pathCacheVersion = networkVersion;
+    if( pathCacheBuckets != NULL )
+    {
+        for( int i=0; i<=pathCacheBucketsMask; ++i )
+        {
+            pathCacheBuckets[i] = -1;
+        }
+    }
+}
+
+
+static inline uint PathCacheHash(const int fromNode, const int toNode)
+{
+    return (uint)fromNode * 73856093u ^ (uint)toNode * 19349663u;
+}
+
+
+void CCPathFinderNetwork::unlinkCachedPath(const int index)
+{
+    PathCacheEntry &entry = pathCache[index];
+    if( entry.lruPrevious != -1 )
+    {
+        pathCache[entry.lruPrevious].lruNext = entry.lruNext;
+    }
+    else
+    {
+        pathCacheHead = entry.lruNext;
+    }
+
+    if( entry.lruNext != -1 )
+    {
+        pathCache[entry.lruNext].lruPrevious = entry.lruPrevious;
+    }
+    else
+    {
+        pathCacheTail = entry.lruPrevious;
+    }
+}
+
+
+const CCPathFinderNetwork::PathCacheEntry* CCPathFinderNetwork::findCachedPath(const int fromNode, const int toNode)
+{
+    if( pathCacheVersion != networkVersion )
+    {
+        clearPathCache();
+    }
+
+    if( pathCacheLength == 0 )
+    {
+        return NULL;
+    }
+
+    const int bucket = PathCacheHash( fromNode, toNode ) & pathCacheBucketsMask;
+    for( int i=pathCacheBuckets[bucket]; i!=-1; i=pathCache[i].bucketNext )
+    {
+        PathCacheEntry &entry = pathCache[i];
+        if( entry.fromNode == fromNode && entry.toNode == toNode )
+        {
+            // Move to the front
+            if( pathCacheHead != i )
+            {
+                unlinkCachedPath( i );
+                entry.lruPrevious = -1;
+                entry.lruNext = pathCacheHead;
+                pathCache[pathCacheHead].lruPrevious = i;
+                pathCacheHead = i;
+            }
+            return &entry;
+        }
+    }
+    return NULL;
+}
+
+
+void CCPathFinderNetwork::cachePath(const int fromNode, const int toNode, const bool found, const Path &path)
+{
+    if( pathCacheSize == 0 )
+    {
+        return;
+    }
+
+    // Another request may have cached the same search since
+    if( findCachedPath( fromNode, toNode ) != NULL )
+    {
+        return;
+    }
+
+    int index;
+    if( pathCacheLength < pathCacheSize )
+    {
+        index = pathCacheLength++;
+    }
+    else
+    {
+        // Evict the least recently used
+        index = pathCacheTail;
+        unlinkCachedPath( index );
+
+        const PathCacheEntry &evicted = pathCache[index];
+        int *link = &pathCacheBuckets[PathCacheHash( evicted.fromNode, evicted.toNode ) & pathCacheBucketsMask];
+        while( *link != index )
+        {
+            link = &pathCache[*link].bucketNext;
+        }
+        *link = evicted.bucketNext;
+    }
+
+    PathCacheEntry &entry = pathCache[index];
+    entry.fromNode = fromNode;
+    entry.toNode = toNode;
+    entry.found = found;
+    entry.path = path;
+
+    entry.lruPrevious = -1;
+    entry.lruNext = pathCacheHead;
+    if( pathCacheHead != -1 )
+    {
+        pathCache[pathCacheHead].lruPrevious = index;
+    }
+    pathCacheHead = index;
+    if( pathCacheTail == -1 )
+    {
+        pathCacheTail = index;
+    }
+
+    const int bucket = PathCacheHash( fromNode, toNode ) & pathCacheBucketsMask;
+    entry.bucketNext = pathCacheBuckets[bucket];
+    pathCacheBuckets[bucket] = index;
+}
+
+
 bool CCPathFinderNetwork::followPath(CCCollideable *objectToPath,
                                      Path &path, const int currentDirection,
                                      const float currentDistance,
@@ -479,14 +1667,24 @@ bool CCPathFinderNetwork::followPath(CCCollideable *objectToPath,
 		return false;
 	}
 
-	pathFromNode = fromNode;
+    // Try the connections closest to the target first
     const CCPtrList<PathNode::PathConnection> &connections = fromNode->connections;
 	int *values = new int[connections.length];
+    float *distances = new float[connections.length];
 	for( int i=0; i<connections.length; ++i )
 	{
-		values[i] = i;
+        const float distance = Distance2D( connections.list[i]->node->point, toNode->point );
+        int j = i;
+        while( j > 0 && distance < distances[j-1] )
+        {
+            values[j] = values[j-1];
+            distances[j] = distances[j-1];
+            j--;
+        }
+		values[j] = i;
+        distances[j] = distance;
 	}
-	qsort( values, connections.length, sizeof( int ), compare );
+    delete[] distances;
 
 	for( int i=0; i<connections.length; ++i )
 	{
@@ -501,10 +1699,13 @@ bool CCPathFinderNetwork::followPath(CCCollideable *objectToPath,
 		}
 
 
-        CCCollideable *collidedWith = CCOctreeMovementCollisionCheck( objectToPath, fromNode->point, targetNode->point );
-        if( collidedWith != NULL )
+        if( objectToPath != NULL )
         {
-            continue;
+            CCCollideable *collidedWith = CCOctreeMovementCollisionCheck( objectToPath, fromNode->point, targetNode->point );
+            if( collidedWith != NULL )
+            {
+                continue;
+            }
         }
 
 		const float pathDistance = currentDistance + nextConnection->distance;
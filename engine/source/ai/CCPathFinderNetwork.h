@@ -14,9 +14,20 @@
 #define __CCPATHFINDERNETWORK_H__
 
 
-class CCPathFinderNetwork
+class CCPathFinderHierarchy;
+
+class CCPathFinderNetwork : public virtual CCActiveAllocation
 {
+    friend class CCPathRequestCallback;
+    friend class CCPathFinderHierarchy;
+
 public:
+    enum PathSearchMode
+    {
+        path_search_astar,              // Shortest path over the connections
+        path_search_depth_first,        // The original greedy depth first search, limited to 50 steps
+    };
+
 	CCPathFinderNetwork();
 	~CCPathFinderNetwork();
 
@@ -34,6 +45,12 @@ public:
 	// Connect our nodes
 	void connect();
 
+    // Rebuilds only the connections of the nodes within reach of the area, without touching the filler nodes
+    void reconnect(const CCVector3 &min, const CCVector3 &max);
+
+    // Reconnects around a collideable and its nodes, call after adding or moving it
+    void reconnect(CCCollideable *collideable);
+
     uint findClosestNodes(const CCVector3 &position, const float &radius, const CCVector3 **vectors, const uint &length);
 
 	struct PathNode
@@ -41,37 +58,130 @@ public:
 		PathNode()
         {
             parent = NULL;
+            index = -1;
         }
 
 		CCVector3 point;
 
 		struct PathConnection
 		{
-			float distance;
+			float distance;         // Squared
+			float length;           // Not squared, the cost of following the connection
 			float angle;
 			const PathNode *node;
 		};
 
         CCCollideable *parent;
 		CCPtrList<PathConnection> connections;
+
+        // Our place in the network's node list, used to index the search state
+        int index;
 	};
 	const PathNode* findClosestNodeToPathTarget(CCCollideable *objectToPath, const CCVector3 &position, const bool withConnections);
 	const PathNode* findClosestNode(const CCVector3 &position);
 
+    // Fills in up to k of the nodes closest to the position, closest first, returns how many were found
+    int findNearestNodes(const CCVector3 &position, const int k, const PathNode **nearestNodes, const bool withConnections=false);
+
 	struct Path
 	{
 		Path()
 		{
+            directions = NULL;
+            allocatedDirections = 0;
 			endDirection = 0;
 			distance = 0.0f;
 		}
 
-		int directions[50];
+        Path(const Path &other)
+        {
+            directions = NULL;
+            allocatedDirections = 0;
+            *this = other;
+        }
+
+        ~Path()
+        {
+            FREE_POINTER( directions );
+        }
+
+        Path& operator=(const Path &other)
+        {
+            if( this != &other )
+            {
+                reserve( other.endDirection );
+                for( int i=0; i<other.endDirection; ++i )
+                {
+                    directions[i] = other.directions[i];
+                }
+                endDirection = other.endDirection;
+                distance = other.distance;
+            }
+            return *this;
+        }
+
+        // Grows the directions to hold at least length entries, keeping the ones already set
+        void reserve(const int length)
+        {
+            if( length > allocatedDirections )
+            {
+                int newAllocated = allocatedDirections > 0 ? allocatedDirections : 64;
+                while( newAllocated < length )
+                {
+                    newAllocated *= 2;
+                }
+
+                int *newDirections = (int*)malloc( sizeof( int ) * newAllocated );
+                CCASSERT( newDirections != NULL );
+                for( int i=0; i<endDirection; ++i )
+                {
+                    newDirections[i] = directions[i];
+                }
+                FREE_POINTER( directions );
+                directions = newDirections;
+                allocatedDirections = newAllocated;
+            }
+        }
+
+        // Connection indices to follow from the start node
+		int *directions;
+        int allocatedDirections;
 		int endDirection;
 		float distance;
 	};
+	// objectToPath is collision checked along each connection, pass NULL to only search the connections
 	bool findPath(CCCollideable *objectToPath, Path &pathResult, const PathNode *fromNode, const PathNode *toNode);
 
+    void setSearchMode(const PathSearchMode mode) { searchMode = mode; }
+
+    // Limits how many nodes A* may expand before giving up, 0 for no limit
+    void setMaxSearchNodes(const int maxNodes) { maxSearchNodes = maxNodes; }
+
+    // Nodes expanded by the last A* search
+    int getNodesSearched() const { return nodesSearched; }
+
+    // Groups the nodes into square clusters for long searches, which plan between the cluster entrances first
+    // Pass 0 for the flat search, searches with an objectToPath stay flat as the cluster costs skip collision checks
+    void setHierarchyClusterSize(const float clusterSize);
+
+    // Handed to a path request's callback through its runParameters
+    struct PathRequestResult
+    {
+        const PathNode *fromNode, *toNode;
+        bool found;
+        bool invalidated;               // The network changed during the search and the nodes may be gone, request again
+        Path path;
+    };
+
+    // Queues an A* search of the connections on the job threads, which work on a read only snapshot of the network
+    // onResult is run on the engine thread then deleted, cache hits are handed back straight away
+    void requestPath(const PathNode *fromNode, const PathNode *toNode, CCLambdaCallback *onResult);
+
+    // How many recent request results to keep, the cache is emptied whenever the network changes
+    void setPathCacheSize(const int size);
+    int getPathCacheHits() const { return pathCacheHits; }
+    int getPathCacheMisses() const { return pathCacheMisses; }
+
 protected:
 	template <typename T, int TLENGTH> struct NodesList : public CCPtrList<T>
 	{
@@ -94,14 +204,237 @@ protected:
 	// Used for path finding
 	Path path;
 	const PathNode *pathingFrom;
+    PathSearchMode searchMode;
+
+    // A* search over the connections, objectToPath can be NULL to skip the collision checks
+    bool findPathAStar(CCCollideable *objectToPath, Path &path, const PathNode *fromNode, const PathNode *toNode);
+
+    // Keep the node indices in step with the node list
+    void indexNodes();
+
+    // Read only copy of the nodes and their connections in the same order, shared with the searches on the job threads
+    struct Snapshot
+    {
+        Snapshot(const CCPtrList<PathNode> &nodes, const int version);
+        ~Snapshot();
+
+        // Deleted by whichever thread releases it last
+        void retain();
+        void release();
+
+        int version;
+        volatile int references;
+
+        // Built along with the snapshot when a cluster size is set
+        float clusterSize;
+        CCPathFinderHierarchy *hierarchy;
+
+        int numberOfNodes;
+        CCVector3 *points;
+        int *connectionStarts;          // Offsets into the connection arrays, one more than the number of nodes
+        int *connectionNodes;
+        float *connectionLengths;
+    };
+
+    // Rebuilt when the network has changed since it was taken
+    Snapshot* getSnapshot();
+    Snapshot *snapshot;
+
+    // Bumped whenever the nodes or connections change
+    int networkVersion;
+
+    // A* scratch state for each node, stamped with the search that last touched it so it never needs clearing
+    struct SearchState
+    {
+        uint searchID;
+        bool closed;
+        int heapIndex;
+        float cost;
+        float estimate;
+        int parent;
+        int parentDirection;
+    };
+
+    struct SearchContext
+    {
+        SearchContext();
+        ~SearchContext();
+
+        // The calling thread's context, used by the searches on the job threads
+        static SearchContext& Default();
+        static void CreateDefaultKey();
+        static void DeleteDefault(void *context);
+
+        // Starts a new search over numberOfNodes
+        void begin(const int numberOfNodes);
+
+        // Binary heap of node indices ordered by estimate
+        void openHeapPush(const int node);
+        int openHeapPop();
+        void openHeapSiftUp(int heapIndex);
+        void openHeapSiftDown(int heapIndex);
+
+        SearchState *states;
+        int allocatedStates;
+        uint searchID;
+
+        int *openHeap;
+        int openHeapLength;
+
+        int nodesSearched;
+    };
+
+    // Our own context for searches on the engine thread
+    SearchContext searchContext;
+
+    // Searches through the hierarchy when the snapshot has one and there's no objectToPath
+    static bool Search(const Snapshot &snapshot, SearchContext &context, CCCollideable *objectToPath,
+                       const int fromNode, const int toNode, const int maxSearchNodes, Path &path);
+
+    // Flat A*, optionally kept inside one cluster of nodeClusters
+    static bool SearchSnapshot(const Snapshot &snapshot, SearchContext &context, CCCollideable *objectToPath,
+                               const int fromNode, const int toNode, const int maxSearchNodes, Path &path,
+                               const int *nodeClusters=NULL, const int cluster=-1);
+
+    float hierarchyClusterSize;
+
+    int maxSearchNodes;
+    int nodesSearched;
+
+    // Called on the engine thread once a requested search has finished
+    void finishPathRequest(const int version, const PathNode *fromNode, const PathNode *toNode,
+                           const bool found, const Path &path, CCLambdaCallback *onResult);
+
+    // Least recently used cache of request results, chained in buckets hashed on the node indices
+    struct PathCacheEntry
+    {
+        int fromNode, toNode;
+        bool found;
+        Path path;
+
+        int lruPrevious, lruNext;
+        int bucketNext;
+    };
+    const PathCacheEntry* findCachedPath(const int fromNode, const int toNode);
+    void cachePath(const int fromNode, const int toNode, const bool found, const Path &path);
+    void clearPathCache();
+    void unlinkCachedPath(const int index);
+
+    PathCacheEntry *pathCache;
+    int pathCacheSize, pathCacheLength;
+    int *pathCacheBuckets;
+    int pathCacheBucketsMask;
+    int pathCacheHead, pathCacheTail;   // Most and least recently used
+    int pathCacheVersion;
+    int pathCacheHits, pathCacheMisses;
+
     bool followPath(CCCollideable *objectToPath,
                     Path &path, const int currentDirection,
                     const float currentDistance,
                     NodesList<const PathNode, 50> &previousNode,
                     const PathNode *fromNode, const PathNode *toNode);
 
-	NodesList<PathNode, 500> nodes;
+	CCPtrList<PathNode> nodes;
     bool connectingNodes;
+
+    // Static collideables binned over a block of the node grid cells while connecting, used for line of sight
+    struct StaticBins
+    {
+        StaticBins()
+        {
+            startX = startZ = 0;
+            width = depth = 0;
+            cellStarts = NULL;
+            cellIndices = NULL;
+            collideables = NULL;
+            numberOfCollideables = 0;
+            stamps = NULL;
+            nearby = NULL;
+        }
+
+        ~StaticBins()
+        {
+            FREE_POINTER( cellStarts );
+            FREE_POINTER( cellIndices );
+            FREE_POINTER( collideables );
+            FREE_POINTER( stamps );
+            FREE_POINTER( nearby );
+        }
+
+        int startX, startZ;
+        int width, depth;
+        int *cellStarts;                // Offsets into cellIndices, one more than the number of cells
+        int *cellIndices;               // Indices into collideables
+        CCCollideable **collideables;
+        int numberOfCollideables;
+
+        // Stamped with the node being connected, so each collideable is gathered once per node
+        int *stamps;
+        CCCollideable **nearby;
+    };
+    void binStaticCollideables(StaticBins &bins, const int startX, const int startZ, const int endX, const int endZ);
+
+    // Connects the nodes inside the area to their neighbours found through the node grid
+    void connectNodes(const CCVector3 &min, const CCVector3 &max);
+    void connectNode(PathNode *node, StaticBins &bins);
+
+    // Uniform grid of node indices over x and z, rebuilt when the nodes have changed
+    void updateNodeGrid();
+    bool nodeGridDirty;
+    float nodeGridMinX, nodeGridMinZ;
+    float nodeGridCellSize, nodeGridInverseCellSize;
+    int nodeGridWidth, nodeGridDepth;
+    int *nodeGridCellStarts;            // Offsets into nodeGridCellNodes, one more than the number of cells
+    int *nodeGridCellNodes;
+
+    inline int getNodeGridX(const float x) const
+    {
+        const int cellX = (int)( ( x - nodeGridMinX ) * nodeGridInverseCellSize );
+        return cellX < 0 ? 0 : cellX >= nodeGridWidth ? nodeGridWidth-1 : cellX;
+    }
+
+    inline int getNodeGridZ(const float z) const
+    {
+        const int cellZ = (int)( ( z - nodeGridMinZ ) * nodeGridInverseCellSize );
+        return cellZ < 0 ? 0 : cellZ >= nodeGridDepth ? nodeGridDepth-1 : cellZ;
+    }
+
+    // Walks outwards from a position through rings of grid cells, handing out nodes in order of distance
+    struct NearestSearch
+    {
+        NearestSearch()
+        {
+            candidates = NULL;
+            numberOfCandidates = 0;
+            allocatedCandidates = 0;
+        }
+
+        ~NearestSearch()
+        {
+            FREE_POINTER( candidates );
+        }
+
+        struct Candidate
+        {
+            float distance;             // Squared
+            int node;
+        };
+
+        CCVector3 position;
+        int cellX, cellZ;
+        int ring;
+        bool finished;
+
+        // Squared distance to the last node handed out
+        float distance;
+
+        // Min heap of the nodes found in the rings searched so far
+        Candidate *candidates;
+        int numberOfCandidates, allocatedCandidates;
+    };
+    void beginNearestSearch(NearestSearch &search, const CCVector3 &position);
+    const PathNode* nextNearestNode(NearestSearch &search);
+    void addNearestCandidate(NearestSearch &search, const int node);
 };
 
 
@@ -0,0 +1,380 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmark.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+#include "CCObjects.h"
+#include "CCSceneBase.h"
+
+#ifdef HEADLESS
+#include "CCHeadlessRenderer.h"
+#endif
+
+
+struct CCBenchmarkCase
+{
+    const char *name;
+    CCBenchmarkFunction function;
+    int count;
+    int frames;
+};
+
+static const CCBenchmarkCase BenchmarkCases[] =
+{
+    { "frames", &CCBenchmarkFrames, 2000, 500 },
+    { "jobs", &CCBenchmarkJobs, 10000, 0 },
+    { "callbacks", &CCBenchmarkCallbacks, 200000, 0 },
+    { "allocations", &CCBenchmarkAllocations, 100000, 0 },
+    { "culling", &CCBenchmarkCulling, 50000, 500 },
+    { "dedup", &CCBenchmarkDedup, 5000, 20 },
+    { "crowd", &CCBenchmarkCrowd, 5000, 500 },
+    { "churn", &CCBenchmarkChurn, 20000, 100 },
+    { "queries", &CCBenchmarkQueries, 50000, 10 },
+    { "movers", &CCBenchmarkMovers, 5000, 300 },
+    { "pathfinding", &CCBenchmarkPathFinding, 10000, 200 },
+    { "pathrequests", &CCBenchmarkPathRequests, 500, 50 },
+    { "connect", &CCBenchmarkConnect, 20000, 100 },
+    { "pathasync", &CCBenchmarkPathAsync, 1000, 100 },
+    { "hierarchy", &CCBenchmarkHierarchy, 100000, 100 },
+    { "transforms", &CCBenchmarkTransforms, 100000, 100 },
+    { "matrices", &CCBenchmarkMatrices, 100000, 20 },
+    { "rotations", &CCBenchmarkRotations, 100000, 20 },
+    { "sorting", &CCBenchmarkSorting, 20000, 100 },
+    { "renderqueue", &CCBenchmarkRenderQueue, 5000, 200 },
+    { "vertexbuffers", &CCBenchmarkVertexBuffers, 2000, 200 },
+    { "meshes", &CCBenchmarkMeshes, 500, 100 },
+    { "meshfiles", &CCBenchmarkMeshFiles, 20, 0 },
+    { "objparser", &CCBenchmarkOBJParser, 1000000, 3 },
+    { "modelloads", &CCBenchmarkModelLoads, 50, 3 },
+};
+static const int NumberOfBenchmarkCases = sizeof( BenchmarkCases ) / sizeof( CCBenchmarkCase );
+
+
+
+void CCBenchmarkTiming::report(const char *name) const
+{
+    printf( "%-12s avg %9.3fms   min %9.3fms   max %9.3fms\n", name, average() * 1000.0, min * 1000.0, max * 1000.0 );
+}
+
+
+
+CCBenchmarkEngine::CCBenchmarkEngine()
+{
+    camera = NULL;
+
+    // Run as fast as we can
+    fpsLimit = 0.0;
+}
+
+
+CCBenchmarkEngine::~CCBenchmarkEngine()
+{
+    for( int i=0; i<scenes.length; ++i )
+    {
+        CCSceneBase *scene = scenes.list[i];
+        DELETE_OBJECT( scene );
+    }
+    scenes.freeList();
+
+    DELETE_POINTER( camera );
+}
+
+
+void CCBenchmarkEngine::addScene(CCSceneBase *scene)
+{
+    scenes.add( scene );
+    scene->setup();
+}
+
+
+void CCBenchmarkEngine::runFrames(const int frames)
+{
+    CCBenchmarkTiming callbacks, jobs, update, render, total, submit;
+#ifdef HEADLESS
+    CCHeadlessRenderer *headlessRenderer = (CCHeadlessRenderer*)renderer;
+    CCBenchmarkTiming drawCalls, vertices, indices, stateChanges, uniforms, uploadedBytes, clientArrayBytes;
+#endif
+
+    const double startTime = CCEngine::GetSystemTime();
+    for( int i=0; i<frames; ++i )
+    {
+#ifdef HEADLESS
+        headlessRenderer->beginFrame();
+#endif
+        if( renderQueue != NULL )
+        {
+            renderQueue->resetStats();
+        }
+
+        updateEngineThread();
+
+        callbacks.add( frameTimings.callbacks );
+        jobs.add( frameTimings.jobs );
+        update.add( frameTimings.update );
+        render.add( frameTimings.render );
+        total.add( frameTimings.total );
+        if( renderQueue != NULL )
+        {
+            submit.add( renderQueue->getSubmitTime() );
+        }
+
+#ifdef HEADLESS
+        const CCRenderStats &stats = headlessRenderer->getStats();
+        drawCalls.add( stats.drawCalls() );
+        vertices.add( stats.vertices );
+        indices.add( stats.indices );
+        stateChanges.add( stats.stateChanges );
+        uniforms.add( stats.commands[command_uniform3fv] + stats.commands[command_uniform4fv] + stats.commands[command_uniformMatrix4fv] );
+        uploadedBytes.add( stats.uploadedBytes );
+        clientArrayBytes.add( stats.clientArrayBytes );
+#endif
+    }
+    const double duration = CCEngine::GetSystemTime() - startTime;
+
+    printf( "%i frames in %.3fs, %.1f fps\n", frames, duration, frames / duration );
+    callbacks.report( "callbacks" );
+    jobs.report( "jobs" );
+    update.report( "update" );
+    render.report( "render" );
+    total.report( "total" );
+    if( renderQueue != NULL )
+    {
+        submit.report( "  submit" );
+    }
+
+#ifdef HEADLESS
+    printf( "per frame: %.0f draw calls, %.0f vertices, %.0f indices, %.0f state changes, %.0f uniform uploads\n",
+            drawCalls.average(), vertices.average(), indices.average(), stateChanges.average(), uniforms.average() );
+    printf( "per frame: %.0f bytes uploaded to buffers, %.0f bytes read from client arrays\n", uploadedBytes.average(), clientArrayBytes.average() );
+#endif
+}
+
+
+void CCBenchmarkEngine::start()
+{
+    camera = new CCCameraBase();
+    camera->setupViewport();
+    camera->setLookAt( CCVector3(), CCVector3( 0.0f, 500.0f, 1000.0f ) );
+}
+
+
+void CCBenchmarkEngine::updateLoop()
+{
+    for( int i=0; i<scenes.length; ++i )
+    {
+        scenes.list[i]->update( time );
+    }
+
+    camera->update();
+}
+
+
+void CCBenchmarkEngine::renderLoop()
+{
+    renderer->bind();
+    renderer->clear( true );
+    camera->setViewport();
+    GLResetMatrix();
+
+    for( CCRenderPass pass=render_background; pass<render_finished; pass++ )
+    {
+        for( int alpha=0; alpha<2; ++alpha )
+        {
+            CCRenderVisibleObjects( camera, pass, alpha == 1 );
+            for( int i=0; i<scenes.length; ++i )
+            {
+                scenes.list[i]->render( camera, pass, alpha == 1 );
+            }
+        }
+    }
+
+    renderer->resolve();
+}
+
+
+
+CCBenchmarkGrid::CCBenchmarkGrid(const int count, const float spacing)
+{
+    size = (int)ceilf( sqrtf( (float)count ) );
+    this->spacing = spacing;
+    offset = size * spacing * 0.5f;
+}
+
+
+CCCollideable* CCBenchmarkGrid::createCollideable(CCSceneBase *scene, const int index, const float size) const
+{
+    CCCollideable *collideable = new CCCollideable();
+    collideable->setSquareCollisionBounds( size );
+    collideable->setPositionXYZ( ( index % this->size ) * spacing - offset, 0.0f, ( index / this->size ) * spacing - offset );
+    collideable->setScene( scene );
+    return collideable;
+}
+
+
+
+bool CCBenchmarkCubesScene::updateScene(const CCTime &time)
+{
+    const float movement = sinf( lifetime * 2.0f ) * 20.0f * time.delta;
+    for( int i=0; i<movers.length; ++i )
+    {
+        movers.list[i]->translate( movement, 0.0f, 0.0f );
+    }
+    return super::updateScene( time );
+}
+
+
+void CCBenchmarkAddCubes(CCBenchmarkEngine *engine, const int count, const float spacing, const int moverInterval, const bool withModels)
+{
+    const CCBenchmarkGrid grid( count, spacing );
+    CCBenchmarkCubesScene *scene = NULL;
+    for( int i=0; i<count; ++i )
+    {
+        scene = engine->getScene( scene );
+        CCCollideable *collideable = grid.createCollideable( scene, i, spacing * 0.5f );
+        if( withModels )
+        {
+            collideable->setModel( CCBenchmarkCreateCubeModel( spacing * 0.5f ) );
+        }
+
+        if( moverInterval > 0 && i % moverInterval == 0 )
+        {
+            scene->addMover( collideable );
+        }
+    }
+}
+
+
+CCModelBase* CCBenchmarkCreateCubeModel(const float size)
+{
+    CCModelBase *model = new CCModelBase();
+    CCPrimitiveCube *cube = new CCPrimitiveCube();
+    cube->setupSquare( size );
+    model->addPrimitive( cube );
+    return model;
+}
+
+
+char* CCBenchmarkCreateTorusOBJ(const int rings, const int sides, const float radius, const float thickness)
+{
+    const int vertices = ( rings + 1 ) * ( sides + 1 );
+    const int faces = rings * sides * 2;
+    const int size = vertices * 3 * 48 + faces * 112 + 1;
+    char *data = (char*)malloc( size );
+    int length = 0;
+
+    for( int i=0; i<=rings; ++i )
+    {
+        const float u = (float)i / rings;
+        const float ringAngle = u * CC_PI * 2.0f;
+        for( int j=0; j<=sides; ++j )
+        {
+            const float v = (float)j / sides;
+            const float sideAngle = v * CC_PI * 2.0f;
+            const float nx = cosf( sideAngle ) * cosf( ringAngle );
+            const float ny = sinf( sideAngle );
+            const float nz = cosf( sideAngle ) * sinf( ringAngle );
+            const float centreX = cosf( ringAngle ) * radius;
+            const float centreZ = sinf( ringAngle ) * radius;
+
+            length += sprintf( &data[length], "v %f %f %f\n", centreX + nx * thickness, ny * thickness, centreZ + nz * thickness );
+            length += sprintf( &data[length], "vt %f %f\n", u, v );
+            length += sprintf( &data[length], "vn %f %f %f\n", nx, ny, nz );
+        }
+    }
+
+    for( int i=0; i<rings; ++i )
+    {
+        for( int j=0; j<sides; ++j )
+        {
+            // OBJ indices start at 1
+            const int a = i * ( sides + 1 ) + j + 1;
+            const int b = a + sides + 1;
+            length += sprintf( &data[length], "f %i/%i/%i %i/%i/%i %i/%i/%i\n", a, a, a, b, b, b, a+1, a+1, a+1 );
+            length += sprintf( &data[length], "f %i/%i/%i %i/%i/%i %i/%i/%i\n", b, b, b, b+1, b+1, b+1, a+1, a+1, a+1 );
+        }
+    }
+
+    CCASSERT( length < size );
+    return data;
+}
+
+
+void CCBenchmarkFrames(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    // Every 8th cube moves
+    CCBenchmarkAddCubes( engine, count, 20.0f, 8, true );
+    engine->runFrames( frames );
+}
+
+
+
+CCBenchmarkEngine* CCBenchmarkCreateEngine()
+{
+    CCBenchmarkEngine *engine = new CCBenchmarkEngine();
+    gEngine = engine;
+    engine->setupNativeThread();
+    engine->createRenderer();
+    if( engine->setupEngineThread() == false )
+    {
+        printf( "Failed to setup the renderer\n" );
+        delete engine;
+        return NULL;
+    }
+    return engine;
+}
+
+
+int CCBenchmarkMain(int argc, char *argv[])
+{
+    if( argc < 2 )
+    {
+        printf( "usage: %s <benchmark> [count] [frames]\n", argv[0] );
+        for( int i=0; i<NumberOfBenchmarkCases; ++i )
+        {
+            printf( "  %-16s count %6i   frames %6i\n", BenchmarkCases[i].name, BenchmarkCases[i].count, BenchmarkCases[i].frames );
+        }
+        return 1;
+    }
+
+    const CCBenchmarkCase *benchmark = NULL;
+    for( int i=0; i<NumberOfBenchmarkCases; ++i )
+    {
+        if( CCText::Equals( BenchmarkCases[i].name, argv[1] ) )
+        {
+            benchmark = &BenchmarkCases[i];
+            break;
+        }
+    }
+
+    if( benchmark == NULL )
+    {
+        printf( "Unknown benchmark %s\n", argv[1] );
+        return 1;
+    }
+
+    const int count = argc > 2 ? atoi( argv[2] ) : benchmark->count;
+    const int frames = argc > 3 ? atoi( argv[3] ) : benchmark->frames;
+    if( count <= 0 || frames < 0 )
+    {
+        printf( "%s needs a count above 0 and frames of at least 0\n", benchmark->name );
+        return 1;
+    }
+
+    CCBenchmarkEngine *engine = CCBenchmarkCreateEngine();
+    if( engine == NULL )
+    {
+        return 1;
+    }
+
+    printf( "%s - count %i, frames %i\n", benchmark->name, count, frames );
+    benchmark->function( engine, count, frames );
+
+    delete engine;
+    return 0;
+}
@@ -0,0 +1,228 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmark.h
+ * Description : Runs synthetic workloads through the engine and reports timings.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCBENCHMARK_H__
+#define __CCBENCHMARK_H__
+
+
+#include "CCEngine.h"
+#include "CCSceneBase.h"
+
+
+// Min, average and max of a value sampled over a benchmark run
+struct CCBenchmarkTiming
+{
+    CCBenchmarkTiming()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        min = 0.0;
+        max = 0.0;
+        total = 0.0;
+        samples = 0;
+    }
+
+    void add(const double value)
+    {
+        if( samples == 0 || value < min )
+        {
+            min = value;
+        }
+        if( samples == 0 || value > max )
+        {
+            max = value;
+        }
+        total += value;
+        samples++;
+    }
+
+    double average() const
+    {
+        return samples > 0 ? total / samples : 0.0;
+    }
+
+    // Prints the timing in milliseconds
+    void report(const char *name) const;
+
+    double min, max, total;
+    int samples;
+};
+
+
+// Engine used by benchmark builds, which define CCAppEngine as CCBenchmarkEngine in their CCApp.h
+// Build with HEADLESS to run without a GPU
+class CCBenchmarkEngine : public CCEngine
+{
+    typedef CCEngine super;
+
+public:
+    CCBenchmarkEngine();
+    virtual ~CCBenchmarkEngine();
+
+    void addScene(CCSceneBase *scene);
+    CCCameraBase* getCamera() { return camera; }
+
+    // Returns the scene while it has room for another object, otherwise adds a new SCENE
+    // Scenes are limited to MAX_OBJECTS
+    template <class SCENE> SCENE* getScene(SCENE *scene)
+    {
+        if( scene == NULL || scene->getNumberOfObjects() >= MAX_OBJECTS-1 )
+        {
+            scene = new SCENE();
+            addScene( scene );
+        }
+        return scene;
+    }
+
+    // Runs the engine thread for the number of frames and prints the per phase timings
+    void runFrames(const int frames);
+
+protected:
+    virtual void start();
+    virtual void updateLoop();
+    virtual void renderLoop();
+
+protected:
+    CCCameraBase *camera;
+    CCPtrList<CCSceneBase> scenes;
+};
+
+
+// Square grid of cells on the ground, centred on the origin
+struct CCBenchmarkGrid
+{
+    CCBenchmarkGrid(const int count, const float spacing);
+
+    // Collideable with square bounds of size at the centre of the cell, added to the scene
+    CCCollideable* createCollideable(CCSceneBase *scene, const int index, const float size) const;
+
+    int size;
+    float spacing;
+    float offset;
+};
+
+
+// Cubes, some of which move back and forth
+class CCBenchmarkCubesScene : public CCSceneBase
+{
+    typedef CCSceneBase super;
+
+public:
+    void addMover(CCCollideable *collideable) { movers.add( collideable ); }
+
+protected:
+    virtual bool updateScene(const CCTime &time);
+
+protected:
+    CCPtrList<CCCollideable> movers;
+};
+
+// Lays count cubes out on a grid across as many scenes as needed, a moverInterval of 0 keeps them all static
+extern void CCBenchmarkAddCubes(CCBenchmarkEngine *engine, const int count, const float spacing, const int moverInterval, const bool withModels);
+
+// Model holding a single cube
+extern CCModelBase* CCBenchmarkCreateCubeModel(const float size);
+
+// Writes a torus out as OBJ text, with the seams duplicated as modelling packages do, free the result
+extern char* CCBenchmarkCreateTorusOBJ(const int rings, const int sides, const float radius, const float thickness);
+
+
+// Benchmarks take the engine, the size of the workload and the number of frames to run
+typedef void (*CCBenchmarkFunction)(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Grid of cubes rendered through the octree, with a portion of them moving every frame
+extern void CCBenchmarkFrames(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Throughput of synthetic jobs through the job scheduler with 1, 2, 4 and 8 workers
+extern void CCBenchmarkJobs(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Many threads posting callbacks to one consumer through the locked list and the lock-free queues
+extern void CCBenchmarkCallbacks(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Creates, validates and releases active allocations
+extern void CCBenchmarkAllocations(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Static grid of collideables culled through the octree by a moving camera
+extern void CCBenchmarkCulling(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Lists large objects spanning many octree leafs, searching for duplicates against a listed set
+extern void CCBenchmarkDedup(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Every collideable walking around, refreshing its place in the octree each frame
+extern void CCBenchmarkCrowd(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Traversal of an octree after long churn, against a freshly built one
+extern void CCBenchmarkChurn(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Collision queries on a single thread, then spread across workers
+extern void CCBenchmarkQueries(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Moveables colliding with each other, without and then with the sweep and prune broadphase
+extern void CCBenchmarkMovers(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Path quality and search time over a grid of path nodes
+extern void CCBenchmarkPathFinding(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Many agents looking up their closest reachable path nodes and searching every frame
+extern void CCBenchmarkPathRequests(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Building a path network's connections from scratch, then reconnecting around changed walls
+extern void CCBenchmarkConnect(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Many agents re-pathing through asynchronous, cached path requests
+extern void CCBenchmarkPathAsync(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Long searches across a large walled map, flat against the cluster hierarchy
+extern void CCBenchmarkHierarchy(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Trees of objects moving every frame, refreshing their own matrices against the transform store
+extern void CCBenchmarkTransforms(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Speed of the vectorised matrix functions against their scalar versions
+extern void CCBenchmarkMatrices(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Refreshing model matrices from angles against from quaternions
+extern void CCBenchmarkRotations(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Sorting the visible list by packed keys against the old qsort, as the camera orbits
+extern void CCBenchmarkSorting(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Cubes in mixed shaders and render states drawn immediately, then sorted through the render queue
+extern void CCBenchmarkRenderQueue(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Static spheres and resized cubes drawn from client arrays, then from cached buffer objects
+extern void CCBenchmarkVertexBuffers(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Generated model loaded, welded and cache ordered, then drawn indexed and as a triangle soup
+extern void CCBenchmarkMeshes(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Load times of a generated model from OBJ text and from its precompiled mesh file
+extern void CCBenchmarkMeshFiles(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Single pass OBJ parser timed against ObjLoader3 on count triangles
+extern void CCBenchmarkOBJParser(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Many models parsed at once on the job workers against one after another, with wall time and peak memory
+extern void CCBenchmarkModelLoads(CCBenchmarkEngine *engine, const int count, const int frames);
+
+// Engine with its renderer setup and set as gEngine, NULL if the renderer failed
+extern CCBenchmarkEngine* CCBenchmarkCreateEngine();
+
+// Command line entry point, expects: <benchmark> [count] [frames]
+extern int CCBenchmarkMain(int argc, char *argv[]);
+
+
+#endif // __CCBENCHMARK_H__
@@ -0,0 +1,53 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkAllocations.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+// Creates, validates and releases active allocations, CCTestActiveAllocations checks stale handles stay inactive
+void CCBenchmarkAllocations(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    CCActiveAllocation **allocations = (CCActiveAllocation**)malloc( sizeof( CCActiveAllocation* ) * count );
+    CCActiveHandle *handles = (CCActiveHandle*)malloc( sizeof( CCActiveHandle ) * count );
+    CCASSERT( allocations != NULL && handles != NULL );
+
+    double startTime = CCEngine::GetSystemTime();
+    for( int i=0; i<count; ++i )
+    {
+        allocations[i] = new CCActiveAllocation();
+        handles[i] = allocations[i]->activeHandle;
+    }
+    const double createDuration = CCEngine::GetSystemTime() - startTime;
+
+    int active = 0;
+    startTime = CCEngine::GetSystemTime();
+    for( int i=0; i<count; ++i )
+    {
+        if( CCActiveAllocation::IsCallbackActive( handles[i] ) )
+        {
+            active++;
+        }
+    }
+    const double validateDuration = CCEngine::GetSystemTime() - startTime;
+
+    startTime = CCEngine::GetSystemTime();
+    for( int i=0; i<count; ++i )
+    {
+        delete allocations[i];
+    }
+    const double releaseDuration = CCEngine::GetSystemTime() - startTime;
+
+    free( handles );
+    free( allocations );
+
+    printf( "create   %9.3fms\n", createDuration * 1000.0 );
+    printf( "validate %9.3fms  %i active\n", validateDuration * 1000.0, active );
+    printf( "release  %9.3fms\n", releaseDuration * 1000.0 );
+}
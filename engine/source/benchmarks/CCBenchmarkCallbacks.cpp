@@ -0,0 +1,199 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkCallbacks.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+#include "CCCallbackQueue.h"
+
+#if !defined WP8 && !defined WIN8
+#include <pthread.h>
+#endif
+
+
+static int CallbacksRun = 0;
+
+CCLAMBDA_UNSAFE( BenchmarkCallback,
+{
+    CallbacksRun++;
+});
+
+
+enum BenchmarkQueueType
+{
+    queue_locked_list,
+    queue_unbounded,
+    queue_bounded,
+    queue_max
+};
+
+static const char *BenchmarkQueueNames[queue_max] =
+{
+    "locked list",
+    "unbounded",
+    "bounded",
+};
+
+
+// The previous dispatch, a list guarded by a mutex that pops from the front
+struct LockedCallbackList
+{
+    LockedCallbackList()
+    {
+#if !defined WP8 && !defined WIN8
+        pthread_mutex_init( &lock, NULL );
+#endif
+    }
+
+    ~LockedCallbackList()
+    {
+#if !defined WP8 && !defined WIN8
+        pthread_mutex_destroy( &lock );
+#endif
+    }
+
+    CCPtrList<CCLambdaCallback> callbacks;
+#if !defined WP8 && !defined WIN8
+    pthread_mutex_t lock;
+#endif
+};
+
+
+struct BenchmarkProducer
+{
+    BenchmarkQueueType type;
+    int count;
+
+    LockedCallbackList *lockedList;
+    CCCallbackQueue *unbounded;
+    CCBoundedCallbackQueue *bounded;
+};
+
+
+static void* ProduceCallbacks(void *data)
+{
+    const BenchmarkProducer *producer = (const BenchmarkProducer*)data;
+    for( int i=0; i<producer->count; ++i )
+    {
+        CCLambdaCallback *callback = new BenchmarkCallback();
+        if( producer->type == queue_locked_list )
+        {
+#if !defined WP8 && !defined WIN8
+            pthread_mutex_lock( &producer->lockedList->lock );
+            producer->lockedList->callbacks.add( callback );
+            pthread_mutex_unlock( &producer->lockedList->lock );
+#endif
+        }
+        else if( producer->type == queue_unbounded )
+        {
+            producer->unbounded->push( callback );
+        }
+        else
+        {
+            // Wait on the consumer when full
+            while( producer->bounded->push( callback ) == false )
+            {
+                usleep( 0 );
+            }
+        }
+    }
+    return NULL;
+}
+
+
+static CCLambdaCallback* ConsumeCallback(BenchmarkQueueType type, LockedCallbackList &lockedList, CCCallbackQueue &unbounded, CCBoundedCallbackQueue &bounded)
+{
+    CCLambdaCallback *callback = NULL;
+    if( type == queue_locked_list )
+    {
+#if !defined WP8 && !defined WIN8
+        pthread_mutex_lock( &lockedList.lock );
+        if( lockedList.callbacks.length > 0 )
+        {
+            callback = lockedList.callbacks.pop();
+        }
+        pthread_mutex_unlock( &lockedList.lock );
+#endif
+    }
+    else if( type == queue_unbounded )
+    {
+        callback = unbounded.pop();
+    }
+    else
+    {
+        callback = bounded.pop();
+    }
+    return callback;
+}
+
+
+// Many producers posting callbacks to a single consuming thread, as the url and file managers do
+void CCBenchmarkCallbacks(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+#if !defined WP8 && !defined WIN8
+
+    static const int producerCounts[] = { 1, 2, 4, 8, 16 };
+    static const int maxProducers = 16;
+
+    for( uint i=0; i<sizeof( producerCounts ) / sizeof( int ); ++i )
+    {
+        const int numberOfProducers = producerCounts[i];
+        printf( "%2i producers", numberOfProducers );
+
+        for( int type=0; type<queue_max; ++type )
+        {
+            LockedCallbackList lockedList;
+            CCCallbackQueue unbounded;
+            CCBoundedCallbackQueue bounded( 1024 );
+
+            BenchmarkProducer producers[maxProducers];
+            pthread_t threads[maxProducers];
+
+            CallbacksRun = 0;
+            const int total = ( count / numberOfProducers ) * numberOfProducers;
+
+            const double startTime = CCEngine::GetSystemTime();
+            for( int p=0; p<numberOfProducers; ++p )
+            {
+                BenchmarkProducer &producer = producers[p];
+                producer.type = (BenchmarkQueueType)type;
+                producer.count = count / numberOfProducers;
+                producer.lockedList = &lockedList;
+                producer.unbounded = &unbounded;
+                producer.bounded = &bounded;
+                pthread_create( &threads[p], NULL, &ProduceCallbacks, &producer );
+            }
+
+            // Consume on this thread until every callback has run
+            while( CallbacksRun < total )
+            {
+                CCLambdaCallback *callback = ConsumeCallback( (BenchmarkQueueType)type, lockedList, unbounded, bounded );
+                if( callback != NULL )
+                {
+                    callback->safeRun();
+                    delete callback;
+                }
+            }
+
+            for( int p=0; p<numberOfProducers; ++p )
+            {
+                pthread_join( threads[p], NULL );
+            }
+            const double duration = CCEngine::GetSystemTime() - startTime;
+
+            printf( "   %s %8.3fms", BenchmarkQueueNames[type], duration * 1000.0 );
+        }
+        printf( "\n" );
+    }
+
+#else
+
+    printf( "Producer threads aren't supported on this platform\n" );
+
+#endif
+}
@@ -0,0 +1,116 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkChurn.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+// Visits every node and object in the tree, returns the number of nodes
+static int TraverseTree(const CCOctree *tree, int &entries)
+{
+    int nodes = 1;
+    for( int i=0; i<tree->objects.length; ++i )
+    {
+        if( tree->objects.list[i]->octreeRender )
+        {
+            entries++;
+        }
+    }
+
+    if( tree->leafs != NULL )
+    {
+        for( uint i=0; i<8; ++i )
+        {
+            nodes += TraverseTree( tree->leafs[i], entries );
+        }
+    }
+    return nodes;
+}
+
+
+static void TimeTraversal(const CCOctree *tree, const int frames, const char *name)
+{
+    CCBenchmarkTiming timing;
+    int nodes = 0, entries = 0;
+    for( int frame=0; frame<frames; ++frame )
+    {
+        entries = 0;
+        const double startTime = CCEngine::GetSystemTime();
+        nodes = TraverseTree( tree, entries );
+        timing.add( CCEngine::GetSystemTime() - startTime );
+    }
+
+    int blocksInUse, blocksAllocated;
+    CCOctreeGetPoolStats( &blocksInUse, &blocksAllocated );
+    printf( "%s: %i nodes holding %i entries, %i/%i leaf blocks in use\n", name, nodes, entries, blocksInUse, blocksAllocated );
+    timing.report( name );
+}
+
+
+// Objects swarm around hotspots which keep jumping across the world, so the octree is split and merged
+// all over, then we compare walking the churned tree against walking one freshly built from the same objects
+void CCBenchmarkChurn(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    const float worldSize = 100000.0f;
+    const float swarmSize = 2000.0f;
+    const int numberOfHotspots = 8;
+
+    CCPtrList<CCCollideable> collideables;
+    CCSceneBase *scene = NULL;
+    for( int i=0; i<count; ++i )
+    {
+        scene = engine->getScene( scene );
+        CCCollideable *collideable = new CCCollideable();
+        collideable->setSquareCollisionBounds( 10.0f );
+        collideable->setPositionXYZ( CCFloatRandomDualSided() * worldSize, 0.0f, CCFloatRandomDualSided() * worldSize );
+        collideable->setScene( scene );
+        collideables.add( collideable );
+    }
+
+    CCVector3 hotspots[numberOfHotspots];
+    CCBenchmarkTiming churn;
+    const int churnFrames = frames * 10;
+    for( int frame=0; frame<churnFrames; ++frame )
+    {
+        const double startTime = CCEngine::GetSystemTime();
+
+        // Move one hotspot each frame
+        CCVector3 &moved = hotspots[frame % numberOfHotspots];
+        moved.x = CCFloatRandomDualSided() * worldSize;
+        moved.z = CCFloatRandomDualSided() * worldSize;
+
+        // And send a slice of the objects to swarm the hotspots
+        for( int i=frame % 16; i<collideables.length; i+=16 )
+        {
+            const CCVector3 &hotspot = hotspots[i % numberOfHotspots];
+            collideables.list[i]->setPositionXYZ( hotspot.x + CCFloatRandomDualSided() * swarmSize,
+                                                  0.0f,
+                                                  hotspot.z + CCFloatRandomDualSided() * swarmSize );
+        }
+
+        CCOctreeCompactTrees( MAX_OCTREE_COMPACTS_PER_FRAME );
+        churn.add( CCEngine::GetSystemTime() - startTime );
+    }
+    churn.report( "churn" );
+
+    CCOctree *octree = engine->collisionManager.octree;
+    TimeTraversal( octree, frames, "churned" );
+
+    // Rebuild the tree from scratch with the objects where they are now
+    for( int i=0; i<collideables.length; ++i )
+    {
+        CCOctreeRemoveObject( collideables.list[i] );
+    }
+    CCOctreeDeleteLeafs( octree );
+    for( int i=0; i<collideables.length; ++i )
+    {
+        CCOctreeAddObject( octree, collideables.list[i] );
+    }
+    TimeTraversal( octree, frames, "fresh" );
+}
@@ -0,0 +1,98 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkConnect.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+static int CountConnections(CCPathFinderNetwork &network, const CCVector3 &position, const int k)
+{
+    const CCPathFinderNetwork::PathNode **nearest = (const CCPathFinderNetwork::PathNode**)malloc( sizeof( CCPathFinderNetwork::PathNode* ) * k );
+    const int found = network.findNearestNodes( position, k, nearest );
+    int connections = 0;
+    for( int i=0; i<found; ++i )
+    {
+        connections += nearest[i]->connections.length;
+    }
+    free( nearest );
+    return connections;
+}
+
+
+// Builds a network of count nodes around static walls, then reconnects around walls added and removed
+void CCBenchmarkConnect(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    // connect() fills the area between the corner nodes with a grid spaced 150 apart
+    const float spacing = 150.0f;
+    const float size = ceilf( sqrtf( (float)count ) ) * spacing;
+    const CCVector3 extents( size * 2.0f );
+
+    CCSceneBase *scene = engine->getScene<CCSceneBase>( NULL );
+
+    CCCollideable *anchor = new CCCollideable();
+    anchor->setScene( scene );
+
+    CCPathFinderNetwork network;
+    network.addNode( CCVector3( 0.0f, 0.0f, 0.0f ), anchor );
+    network.addNode( CCVector3( size, 0.0f, 0.0f ), anchor );
+    network.addNode( CCVector3( 0.0f, 0.0f, size ), anchor );
+    network.addNode( CCVector3( size, 0.0f, size ), anchor );
+
+    // Static walls the connections have to route around
+    const int numberOfWalls = MAX( count / 100, 1 );
+    CCPtrList<CCCollideable> walls;
+    for( int i=0; i<numberOfWalls+frames; ++i )
+    {
+        scene = engine->getScene( scene );
+
+        CCCollideable *wall = new CCCollideable();
+        wall->setCollisionBounds( spacing * ( 0.5f + CCFloatRandom() * 3.0f ), spacing, spacing * 0.25f );
+        wall->setPositionXYZ( CCFloatRandom() * size, 0.0f, CCFloatRandom() * size );
+        wall->collideableType = collision_box | collision_static;
+        CCUpdateCollisions( wall );
+        walls.add( wall );
+
+        // The rest are placed later to time reconnecting around them
+        if( i < numberOfWalls )
+        {
+            wall->setScene( scene );
+            network.addCollideable( wall, extents );
+        }
+    }
+
+    const double startTime = CCEngine::GetSystemTime();
+    network.connect();
+    const double connectTime = CCEngine::GetSystemTime() - startTime;
+    printf( "%i walls, connected in %.3fms\n", numberOfWalls, connectTime * 1000.0 );
+
+    CCBenchmarkTiming adding, removing;
+    for( int i=0; i<frames; ++i )
+    {
+        CCCollideable *wall = walls.list[numberOfWalls+i];
+        scene = engine->getScene( scene );
+        wall->setScene( scene );
+
+        double frameStartTime = CCEngine::GetSystemTime();
+        network.addCollideable( wall, extents );
+        network.reconnect( wall );
+        adding.add( CCEngine::GetSystemTime() - frameStartTime );
+
+        // Take every other one back out again
+        if( i % 2 == 1 )
+        {
+            frameStartTime = CCEngine::GetSystemTime();
+            network.removeCollideable( wall );
+            removing.add( CCEngine::GetSystemTime() - frameStartTime );
+        }
+    }
+
+    adding.report( "add and reconnect a wall" );
+    removing.report( "remove a wall" );
+    printf( "connections around the centre %i\n", CountConnections( network, CCVector3( size * 0.5f, 0.0f, size * 0.5f ), 100 ) );
+}
@@ -0,0 +1,65 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkCrowd.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+// Crowd wandering around, each step refreshes the mover's place in the octree
+class CCBenchmarkCrowdScene : public CCSceneBase
+{
+    typedef CCSceneBase super;
+
+public:
+    // Walks in a direction picked from the index
+    void addWalker(CCCollideable *collideable, const int index)
+    {
+        const float heading = index * 2.39996f;
+        headings.add( new CCVector3( cosf( heading ), 0.0f, sinf( heading ) ) );
+        walkers.add( collideable );
+    }
+
+    virtual void destruct()
+    {
+        headings.deleteObjectsAndList();
+        super::destruct();
+    }
+
+protected:
+    virtual bool updateScene(const CCTime &time)
+    {
+        // Turn back every few seconds so the crowd stays together
+        const float speed = 40.0f * ( sinf( lifetime * 0.5f ) > 0.0f ? 1.0f : -1.0f ) * time.delta;
+        for( int i=0; i<walkers.length; ++i )
+        {
+            const CCVector3 &heading = *headings.list[i];
+            walkers.list[i]->translate( heading.x * speed, 0.0f, heading.z * speed );
+        }
+        return super::updateScene( time );
+    }
+
+protected:
+    CCPtrList<CCCollideable> walkers;
+    CCPtrList<CCVector3> headings;
+};
+
+
+void CCBenchmarkCrowd(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    const float spacing = 30.0f;
+    const CCBenchmarkGrid grid( count, spacing );
+    CCBenchmarkCrowdScene *scene = NULL;
+    for( int i=0; i<count; ++i )
+    {
+        scene = engine->getScene( scene );
+        scene->addWalker( grid.createCollideable( scene, i, spacing * 0.25f ), i );
+    }
+
+    engine->runFrames( frames );
+}
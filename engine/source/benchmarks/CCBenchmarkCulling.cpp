@@ -0,0 +1,75 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkCulling.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+// Times its octree scans and skips sorting the results
+class CCBenchmarkCullingCamera : public CCCameraBase
+{
+public:
+    CCBenchmarkTiming culling, nodesVisited, leafs, visibles;
+
+protected:
+    virtual void updateVisibleCollideables()
+    {
+        const double startTime = CCEngine::GetSystemTime();
+        CCOctreeScanVisibleCollideables( frustum, visibleCollideables );
+        culling.add( CCEngine::GetSystemTime() - startTime );
+
+        const CCOctreeScanStats &stats = CCOctreeGetScanStats();
+        nodesVisited.add( stats.nodesVisited );
+        leafs.add( stats.leafsInside + stats.leafsIntersecting );
+        visibles.add( visibleCollideables.length );
+    }
+};
+
+
+static int CountOctreeNodes(const CCOctree *tree)
+{
+    int count = 1;
+    if( tree->leafs != NULL )
+    {
+        for( uint i=0; i<8; ++i )
+        {
+            count += CountOctreeNodes( tree->leafs[i] );
+        }
+    }
+    return count;
+}
+
+
+// Static grid of collideables scanned by a camera sweeping around the grid
+void CCBenchmarkCulling(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    const float spacing = 20.0f;
+    CCBenchmarkAddCubes( engine, count, spacing, 0, false );
+
+    const float gridExtent = ceilf( sqrtf( (float)count ) ) * spacing * 0.5f;
+    printf( "%i octree nodes\n", CountOctreeNodes( engine->collisionManager.octree ) );
+
+    CCBenchmarkCullingCamera *camera = new CCBenchmarkCullingCamera();
+    camera->setupViewport();
+
+    for( int i=0; i<frames; ++i )
+    {
+        const float angle = ( i / (float)frames ) * CC_PI * 2.0f;
+        const CCVector3 lookAt( cosf( angle ) * gridExtent * 0.5f, 0.0f, sinf( angle ) * gridExtent * 0.5f );
+
+        camera->flagUpdate();
+        camera->setLookAt( lookAt, CCVector3( 0.0f, 400.0f, 600.0f ) );
+        camera->update();
+    }
+
+    camera->culling.report( "culling" );
+    printf( "per scan: %.0f nodes visited, %.0f leafs, %.0f visible\n", camera->nodesVisited.average(), camera->leafs.average(), camera->visibles.average() );
+
+    delete camera;
+}
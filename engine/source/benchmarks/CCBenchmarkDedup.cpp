@@ -0,0 +1,91 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkDedup.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+static void ListAllLeafs(CCOctree *tree, CCPtrList<CCOctree> &leafs)
+{
+    if( tree->leafs != NULL )
+    {
+        for( uint i=0; i<8; ++i )
+        {
+            ListAllLeafs( tree->leafs[i], leafs );
+        }
+    }
+    else if( tree->objects.length > 0 )
+    {
+        leafs.add( tree );
+    }
+}
+
+
+// How CCOctreeListVisibles used to dedup, searching the results for every object
+static void ListVisiblesSearching(const CCPtrList<CCOctree> &leafs, CCPtrList<CCCollideable> &collideables)
+{
+    for( int leafIndex=0; leafIndex<leafs.length; ++leafIndex )
+    {
+        const CCOctree *leaf = leafs.list[leafIndex];
+        for( int i=0; i<leaf->objects.length; ++i )
+        {
+            CCCollideable *collideable = leaf->objects.list[i];
+            if( collideables.find( collideable ) == -1 )
+            {
+                collideables.add( collideable );
+            }
+        }
+    }
+}
+
+
+// Large objects spanning many leafs, listed from every leaf in the tree
+void CCBenchmarkDedup(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    const float spacing = 50.0f;
+    const float size = 400.0f;
+    const CCBenchmarkGrid grid( count, spacing );
+    CCSceneBase *scene = NULL;
+    for( int i=0; i<count; ++i )
+    {
+        scene = engine->getScene( scene );
+        grid.createCollideable( scene, i, size );
+    }
+
+    CCPtrList<CCOctree> leafs;
+    ListAllLeafs( engine->collisionManager.octree, leafs );
+
+    int entries = 0;
+    for( int i=0; i<leafs.length; ++i )
+    {
+        entries += leafs.list[i]->objects.length;
+    }
+    printf( "%i leafs holding %i entries for %i objects\n", leafs.length, entries, count );
+
+    CCBenchmarkTiming searching, hashed;
+    CCPtrList<CCCollideable> searchingResults, hashedResults;
+    CCOctreeListedSet listed;
+    for( int frame=0; frame<frames; ++frame )
+    {
+        searchingResults.length = 0;
+        double startTime = CCEngine::GetSystemTime();
+        ListVisiblesSearching( leafs, searchingResults );
+        searching.add( CCEngine::GetSystemTime() - startTime );
+
+        hashedResults.length = 0;
+        startTime = CCEngine::GetSystemTime();
+        listed.begin();
+        CCOctreeListVisibles( leafs, hashedResults, listed );
+        hashed.add( CCEngine::GetSystemTime() - startTime );
+    }
+
+    searching.report( "searching" );
+    hashed.report( "listed set" );
+    printf( "%i objects listed before, %i after\n", searchingResults.length, hashedResults.length );
+}
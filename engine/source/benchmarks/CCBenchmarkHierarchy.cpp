@@ -0,0 +1,140 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkHierarchy.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+struct CCBenchmarkSearches
+{
+    CCBenchmarkSearches()
+    {
+        found = 0;
+        nodesSearched = 0.0;
+        totalLength = 0.0f;
+    }
+
+    CCBenchmarkTiming timing;
+    int found;
+    double nodesSearched;
+    float totalLength;
+};
+
+
+static void RunSearches(CCPathFinderNetwork &network, const CCPathFinderNetwork::PathNode **pairs, const int numberOfSearches,
+                        CCBenchmarkSearches &results)
+{
+    CCPathFinderNetwork::Path path;
+    for( int i=0; i<numberOfSearches; ++i )
+    {
+        const double startTime = CCEngine::GetSystemTime();
+        const bool found = network.findPath( NULL, path, pairs[i*2], pairs[i*2+1] );
+        results.timing.add( CCEngine::GetSystemTime() - startTime );
+
+        results.nodesSearched += network.getNodesSearched();
+        if( found )
+        {
+            results.found++;
+            results.totalLength += path.distance;
+        }
+    }
+}
+
+
+// A large walled map searched corner to corner, flat and then through the cluster hierarchy
+void CCBenchmarkHierarchy(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    // connect() fills the area between the corner nodes with a grid spaced 150 apart
+    const float spacing = 150.0f;
+    const float size = ceilf( sqrtf( (float)count ) ) * spacing;
+    const float clusterSize = spacing * 16.0f;
+
+    CCSceneBase *scene = engine->getScene<CCSceneBase>( NULL );
+
+    CCCollideable *anchor = new CCCollideable();
+    anchor->setScene( scene );
+
+    CCPathFinderNetwork network;
+    network.addNode( CCVector3( 0.0f, 0.0f, 0.0f ), anchor );
+    network.addNode( CCVector3( size, 0.0f, 0.0f ), anchor );
+    network.addNode( CCVector3( 0.0f, 0.0f, size ), anchor );
+    network.addNode( CCVector3( size, 0.0f, size ), anchor );
+
+    // Long static walls with a few gaps, so searches have to wind around them
+    const int numberOfWalls = (int)( size / ( spacing * 6.0f ) );
+    for( int i=0; i<numberOfWalls; ++i )
+    {
+        const bool alongX = i % 2 == 0;
+        const float offset = ( i + 0.5f ) * size / numberOfWalls;
+        const int numberOfSegments = 8;
+        const float segmentLength = size / numberOfSegments;
+        for( int j=0; j<numberOfSegments; ++j )
+        {
+            // Leave a gap
+            if( CCFloatRandom() < 0.25f )
+            {
+                continue;
+            }
+
+            scene = engine->getScene( scene );
+
+            const float along = ( j + 0.5f ) * segmentLength;
+            CCCollideable *wall = new CCCollideable();
+            wall->collideableType = collision_box | collision_static;
+            if( alongX )
+            {
+                wall->setCollisionBounds( segmentLength * 0.9f, spacing, spacing * 0.5f );
+                wall->setPositionXYZ( along, 0.0f, offset );
+            }
+            else
+            {
+                wall->setCollisionBounds( spacing * 0.5f, spacing, segmentLength * 0.9f );
+                wall->setPositionXYZ( offset, 0.0f, along );
+            }
+            wall->setScene( scene );
+        }
+    }
+
+    double startTime = CCEngine::GetSystemTime();
+    network.connect();
+    printf( "connected in %.3fms\n", ( CCEngine::GetSystemTime() - startTime ) * 1000.0 );
+
+    // Long searches from one side of the map to the other
+    const int numberOfSearches = MAX( frames, 1 );
+    const CCPathFinderNetwork::PathNode **pairs = (const CCPathFinderNetwork::PathNode**)malloc( sizeof( CCPathFinderNetwork::PathNode* ) * numberOfSearches * 2 );
+    for( int i=0; i<numberOfSearches; ++i )
+    {
+        pairs[i*2] = network.findClosestNodeToPathTarget( NULL, CCVector3( CCFloatRandom() * size * 0.2f, 0.0f, CCFloatRandom() * size ), true );
+        pairs[i*2+1] = network.findClosestNodeToPathTarget( NULL, CCVector3( size - CCFloatRandom() * size * 0.2f, 0.0f, CCFloatRandom() * size ), true );
+    }
+
+    CCBenchmarkSearches flat;
+    RunSearches( network, pairs, numberOfSearches, flat );
+
+    // The first search builds the hierarchy
+    network.setHierarchyClusterSize( clusterSize );
+    CCPathFinderNetwork::Path path;
+    startTime = CCEngine::GetSystemTime();
+    network.findPath( NULL, path, pairs[0], pairs[0] );
+    printf( "hierarchy built in %.3fms\n", ( CCEngine::GetSystemTime() - startTime ) * 1000.0 );
+
+    CCBenchmarkSearches hierarchical;
+    RunSearches( network, pairs, numberOfSearches, hierarchical );
+
+    printf( "%i searches\n", numberOfSearches );
+    printf( "flat         found %i, %.0f nodes expanded on average\n", flat.found, flat.nodesSearched / numberOfSearches );
+    flat.timing.report( "flat" );
+    printf( "hierarchical found %i, %.0f nodes expanded on average\n", hierarchical.found, hierarchical.nodesSearched / numberOfSearches );
+    hierarchical.timing.report( "hierarchical" );
+    if( flat.totalLength > 0.0f )
+    {
+        printf( "hierarchical paths are %.3fx the length of the flat ones\n", hierarchical.totalLength / flat.totalLength );
+    }
+    free( pairs );
+}
@@ -0,0 +1,64 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkJobs.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+#include "CCJobScheduler.h"
+
+
+static volatile float JobsSink = 0.0f;
+
+
+// Burns a fixed amount of cpu, standing in for a decode or mesh processing job
+CCLAMBDA_1_UNSAFE( BenchmarkJob, int, seed,
+{
+    float value = (float)seed;
+    for( int i=0; i<2000; ++i )
+    {
+        value += sinf( value + (float)i );
+    }
+    JobsSink = value;
+});
+
+
+void CCBenchmarkJobs(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    static const int workerCounts[] = { 1, 2, 4, 8 };
+    double singleWorkerDuration = 0.0;
+
+    for( uint i=0; i<sizeof( workerCounts ) / sizeof( int ); ++i )
+    {
+        const int numberOfWorkers = workerCounts[i];
+
+        CCJobScheduler scheduler;
+        if( scheduler.start( numberOfWorkers ) == false )
+        {
+            printf( "Worker threads aren't supported on this platform\n" );
+            return;
+        }
+
+        const double startTime = CCEngine::GetSystemTime();
+        for( int job=0; job<count; ++job )
+        {
+            scheduler.submit( new BenchmarkJob( job ) );
+        }
+        scheduler.waitForIdle();
+        const double duration = CCEngine::GetSystemTime() - startTime;
+
+        scheduler.stop();
+
+        if( numberOfWorkers == 1 )
+        {
+            singleWorkerDuration = duration;
+        }
+
+        printf( "%2i workers  %9.3fms   %10.0f jobs/s   speedup %.2fx\n",
+                numberOfWorkers, duration * 1000.0, count / duration, singleWorkerDuration / duration );
+    }
+}
@@ -0,0 +1,89 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkMatrices.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+static void RandomMatrix(CCMatrix &matrix)
+{
+    float *values = matrix.data();
+    for( int i=0; i<16; ++i )
+    {
+        values[i] = CCFloatRandomDualSided() * 10.0f;
+    }
+}
+
+
+// Time taken by the vectorised matrix functions and the scalar ones, CCTestMatrices checks they agree
+void CCBenchmarkMatrices(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    CCMatrix *matrices = (CCMatrix*)malloc( sizeof( CCMatrix ) * count );
+    CCMatrix *results = (CCMatrix*)malloc( sizeof( CCMatrix ) * count );
+    CCVector3 *points = (CCVector3*)malloc( sizeof( CCVector3 ) * count );
+    CCVector3 *transformed = (CCVector3*)malloc( sizeof( CCVector3 ) * count );
+    for( int i=0; i<count; ++i )
+    {
+        RandomMatrix( matrices[i] );
+        points[i] = CCVector3( CCFloatRandomDualSided() * 100.0f, CCFloatRandomDualSided() * 100.0f, CCFloatRandomDualSided() * 100.0f );
+    }
+
+    CCBenchmarkTiming multiply, multiplyScalar, inverse, inverseScalar, batch, batchScalar;
+    for( int frame=0; frame<frames; ++frame )
+    {
+        double startTime = CCEngine::GetSystemTime();
+        for( int i=1; i<count; ++i )
+        {
+            CCMatrixMultiply( results[i], matrices[i-1], matrices[i] );
+        }
+        multiply.add( CCEngine::GetSystemTime() - startTime );
+
+        startTime = CCEngine::GetSystemTime();
+        for( int i=1; i<count; ++i )
+        {
+            CCMatrixMultiplyScalar( results[i], matrices[i-1], matrices[i] );
+        }
+        multiplyScalar.add( CCEngine::GetSystemTime() - startTime );
+
+        startTime = CCEngine::GetSystemTime();
+        for( int i=0; i<count; ++i )
+        {
+            CCMatrixInverse( results[i], matrices[i] );
+        }
+        inverse.add( CCEngine::GetSystemTime() - startTime );
+
+        startTime = CCEngine::GetSystemTime();
+        for( int i=0; i<count; ++i )
+        {
+            CCMatrixInverseScalar( results[i], matrices[i] );
+        }
+        inverseScalar.add( CCEngine::GetSystemTime() - startTime );
+
+        startTime = CCEngine::GetSystemTime();
+        CCMatrixTransformPoints( transformed, matrices[frame%count], points, count );
+        batch.add( CCEngine::GetSystemTime() - startTime );
+
+        startTime = CCEngine::GetSystemTime();
+        CCMatrixTransformPointsScalar( transformed, matrices[frame%count], points, count );
+        batchScalar.add( CCEngine::GetSystemTime() - startTime );
+    }
+
+    printf( "%i matrices and points per run\n", count );
+    multiply.report( "multiply" );
+    multiplyScalar.report( "  scalar" );
+    inverse.report( "inverse" );
+    inverseScalar.report( "  scalar" );
+    batch.report( "points" );
+    batchScalar.report( "  scalar" );
+
+    FREE_POINTER( matrices );
+    FREE_POINTER( results );
+    FREE_POINTER( points );
+    FREE_POINTER( transformed );
+}
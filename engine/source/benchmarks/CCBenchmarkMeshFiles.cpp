@@ -0,0 +1,57 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkMeshFiles.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+#include "CCPrimitives.h"
+#include "CCPrimitiveOBJ.h"
+#include "CCMeshFile.h"
+
+
+// Loads the same model count times from OBJ text and from its precompiled mesh file
+void CCBenchmarkMeshFiles(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    char *text = CCBenchmarkCreateTorusOBJ( 128, 64, 6.0f, 2.0f );
+    const uint textLength = strlen( text );
+
+    // Converted once, as the asset pipeline would
+    CCData meshData;
+    {
+        CCPrimitiveOBJ *source = new CCPrimitiveOBJ();
+        source->loadData( text );
+        source->saveMeshFile( meshData, "torus" );
+        DELETE_OBJECT( source );
+    }
+    printf( "OBJ %u bytes, mesh file %u bytes\n", textLength, meshData.length );
+
+    CCBenchmarkTiming textTimes, binaryTimes;
+    float textWidth = 0.0f, binaryWidth = 0.0f;
+    for( int i=0; i<count; ++i )
+    {
+        double startTime = CCEngine::GetSystemTime();
+        CCPrimitiveOBJ *primitive = new CCPrimitiveOBJ();
+        primitive->loadData( text );
+        textTimes.add( CCEngine::GetSystemTime() - startTime );
+        textWidth = primitive->getWidth();
+        DELETE_OBJECT( primitive );
+
+        startTime = CCEngine::GetSystemTime();
+        primitive = new CCPrimitiveOBJ();
+        primitive->loadMeshData( meshData.buffer, meshData.length );
+        binaryTimes.add( CCEngine::GetSystemTime() - startTime );
+        binaryWidth = primitive->getWidth();
+        DELETE_OBJECT( primitive );
+    }
+    free( text );
+
+    textTimes.report( "text" );
+    binaryTimes.report( "binary" );
+    printf( "%.1fx faster, width %.3f from text and %.3f from binary\n",
+            textTimes.average() / MAX( binaryTimes.average(), 1e-9 ), textWidth, binaryWidth );
+}
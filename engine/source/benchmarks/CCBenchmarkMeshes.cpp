@@ -0,0 +1,175 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkMeshes.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+#include "CCPrimitives.h"
+#include "CCPrimitiveOBJ.h"
+#include "CCIndexedMesh.h"
+
+
+// The loaded mesh drawn as the triangle soup models were drawn as before welding
+class CCBenchmarkSoupOBJ : public CCPrimitiveOBJ
+{
+    typedef CCPrimitiveOBJ super;
+
+public:
+    // Expands our welded vertices back out into one per triangle corner
+    void unweld()
+    {
+        if( indices == NULL )
+        {
+            return;
+        }
+
+        float *soupVertices = (float*)malloc( sizeof( float ) * indexCount * 3 );
+        float *soupNormals = (float*)malloc( sizeof( float ) * indexCount * 3 );
+        float *soupUVs = (float*)malloc( sizeof( float ) * indexCount * 2 );
+        for( uint i=0; i<indexCount; ++i )
+        {
+            const uint index = indexType == GL_UNSIGNED_SHORT ? ((ushort*)indices)[i] : ((uint*)indices)[i];
+            memcpy( &soupVertices[i*3], &vertices[index*3], sizeof( float ) * 3 );
+            memcpy( &soupNormals[i*3], &normals[index*3], sizeof( float ) * 3 );
+            memcpy( &soupUVs[i*2], &modelUVs[index*2], sizeof( float ) * 2 );
+        }
+
+        free( vertices );
+        free( normals );
+        free( modelUVs );
+        FREE_POINTER( indices );
+
+        vertices = soupVertices;
+        normals = soupNormals;
+        modelUVs = soupUVs;
+        vertexCount = indexCount;
+        indexCount = 0;
+    }
+
+    // Welds and orders our soup as the loaders do, reporting what each step costs and saves
+    void reportWelding()
+    {
+        const double startTime = CCEngine::GetSystemTime();
+        CCIndexedMesh mesh;
+        CCMeshWeld( mesh, vertices, normals, modelUVs, vertexCount );
+        const double weldedTime = CCEngine::GetSystemTime();
+        const float weldedACMR = CCMeshACMR( mesh.indices, mesh.indexCount, mesh.vertexCount );
+
+        CCMeshOptimiseVertexCache( mesh.indices, mesh.indexCount, mesh.vertexCount );
+        const double orderedTime = CCEngine::GetSystemTime();
+        const float orderedACMR = CCMeshACMR( mesh.indices, mesh.indexCount, mesh.vertexCount );
+
+        CCMeshOptimiseVertexFetch( mesh );
+        const double fetchedTime = CCEngine::GetSystemTime();
+
+        printf( "%u triangles, %u soup vertices welded to %u, %.1f%% fewer\n",
+                vertexCount / 3, vertexCount, mesh.vertexCount, 100.0f - mesh.vertexCount * 100.0f / vertexCount );
+        printf( "weld %.3fms, vertex cache order %.3fms, vertex fetch order %.3fms\n",
+                ( weldedTime - startTime ) * 1000.0, ( orderedTime - weldedTime ) * 1000.0, ( fetchedTime - orderedTime ) * 1000.0 );
+        printf( "ACMR: soup 3.000, welded %.3f, cache ordered %.3f\n", weldedACMR, orderedACMR );
+    }
+};
+
+
+class CCBenchmarkMeshesScene : public CCSceneBase
+{
+    typedef CCSceneBase super;
+
+public:
+    // Draws a copy of welded, keeping a copy of soup to swap in
+    void addModel(CCCollideable *collideable, const CCPrimitiveOBJ *welded, const CCPrimitiveOBJ *soup)
+    {
+        CCPrimitiveOBJ *weldedCopy = new CCPrimitiveOBJ();
+        weldedCopy->copy( welded );
+        CCPrimitiveOBJ *soupCopy = new CCPrimitiveOBJ();
+        soupCopy->copy( soup );
+
+        CCModelBase *model = new CCModelBase();
+        model->addPrimitive( weldedCopy );
+        idle.add( soupCopy );
+        models.add( model );
+        collideable->setModel( model );
+    }
+
+    virtual void destruct()
+    {
+        super::destruct();
+        idle.deleteObjectsAndList();
+        models.freeList();
+        sources.deleteObjectsAndList();
+    }
+
+    // The primitives our copies point into, freed after them
+    void own(CCPrimitiveBase *primitive)
+    {
+        sources.add( primitive );
+    }
+
+    // Swaps each model's primitive for its other copy
+    void swapPrimitives()
+    {
+        for( int i=0; i<models.length; ++i )
+        {
+            CCPrimitiveBase *&primitive = models.list[i]->primitives.list[0];
+            CCPrimitiveBase *other = idle.list[i];
+            idle.list[i] = primitive;
+            primitive = other;
+        }
+    }
+
+protected:
+    CCPtrList<CCModelBase> models;
+    CCObjectPtrList<CCPrimitiveBase> idle;
+    CCObjectPtrList<CCPrimitiveBase> sources;
+};
+
+
+// Welds a generated model, then draws copies of it indexed and as a soup
+void CCBenchmarkMeshes(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    char *data = CCBenchmarkCreateTorusOBJ( 96, 48, 6.0f, 2.0f );
+
+    CCPrimitiveOBJ *welded = new CCPrimitiveOBJ();
+    const double startTime = CCEngine::GetSystemTime();
+    welded->loadData( data );
+    printf( "load and weld %.3fms\n", ( CCEngine::GetSystemTime() - startTime ) * 1000.0 );
+
+    CCBenchmarkSoupOBJ *soup = new CCBenchmarkSoupOBJ();
+    soup->loadData( data );
+    soup->unweld();
+    soup->reportWelding();
+    free( data );
+
+    const float spacing = 20.0f;
+    const CCBenchmarkGrid grid( count, spacing );
+    CCPtrList<CCBenchmarkMeshesScene> scenes;
+    CCBenchmarkMeshesScene *scene = NULL;
+    for( int i=0; i<count; ++i )
+    {
+        CCBenchmarkMeshesScene *previous = scene;
+        scene = engine->getScene( scene );
+        if( scene != previous )
+        {
+            scenes.add( scene );
+        }
+        scene->addModel( grid.createCollideable( scene, i, spacing * 0.5f ), welded, soup );
+    }
+    scenes.list[0]->own( welded );
+    scenes.list[0]->own( soup );
+
+    printf( "\nindexed\n" );
+    engine->runFrames( frames );
+
+    for( int i=0; i<scenes.length; ++i )
+    {
+        scenes.list[i]->swapPrimitives();
+    }
+    printf( "\nsoup\n" );
+    engine->runFrames( frames );
+    scenes.freeList();
+}
@@ -0,0 +1,192 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkModelLoads.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+#include "CCPrimitives.h"
+#include "CCPrimitiveOBJ.h"
+#include "CCJobScheduler.h"
+
+#ifdef CCJOBSCHEDULER_THREADS
+#include <sys/resource.h>
+#endif
+
+
+// Counts the loads handed back to the engine thread
+class CCBenchmarkLoadingOBJ : public CCPrimitiveOBJ
+{
+    typedef CCPrimitiveOBJ super;
+
+public:
+    static int Loaded;
+
+    virtual void loaded()
+    {
+        Loaded++;
+    }
+};
+int CCBenchmarkLoadingOBJ::Loaded = 0;
+
+
+// Process wide high water mark of resident memory in megabytes, it never goes down
+static float PeakMemory()
+{
+#ifdef CCJOBSCHEDULER_THREADS
+    struct rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) == 0 )
+    {
+#ifdef __APPLE__
+        return usage.ru_maxrss / ( 1024.0f * 1024.0f );
+#else
+        return usage.ru_maxrss / 1024.0f;
+#endif
+    }
+#endif
+    return 0.0f;
+}
+
+
+// Different sized models, as a level's worth of assets would be
+static void CreateModelTexts(CCText *texts, const int count)
+{
+    for( int i=0; i<count; ++i )
+    {
+        char *text = CCBenchmarkCreateTorusOBJ( 48 + ( i % 5 ) * 16, 32, 6.0f, 2.0f );
+        texts[i].set( text );
+        free( text );
+    }
+}
+
+
+// Pumps the engine thread until the jobs are done and their results are in
+static void WaitForLoads(CCBenchmarkEngine *engine, const int expected)
+{
+    for( int i=0; i<100000 && CCBenchmarkLoadingOBJ::Loaded < expected; ++i )
+    {
+        engine->jobScheduler.waitForIdle();
+        engine->updateEngineThread();
+    }
+    engine->updateEngineThread();
+}
+
+
+// Loads count models one after another on the engine thread, then all at once through loadDataAsync
+// Then deletes half of a batch straight after queuing it, their loads must be dropped
+void CCBenchmarkModelLoads(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    CCText *texts = new CCText[count];
+    CCBenchmarkLoadingOBJ **models = (CCBenchmarkLoadingOBJ**)malloc( sizeof( CCBenchmarkLoadingOBJ* ) * (uint)count );
+    uint textBytes = 0;
+    {
+        CreateModelTexts( texts, count );
+        for( int i=0; i<count; ++i )
+        {
+            textBytes += texts[i].length;
+        }
+    }
+    printf( "%i models, %.1fMB of OBJ text, %i workers\n",
+            count, textBytes / ( 1024.0f * 1024.0f ), engine->jobScheduler.getNumberOfWorkers() );
+
+    CCBenchmarkTiming serialTimes, parallelTimes;
+
+    // For reference, each model parsed in turn on the engine thread
+    for( int frame=0; frame<MAX( frames, 1 ); ++frame )
+    {
+        // The texts are let go of as they're parsed, so they're rebuilt each time
+        if( frame > 0 )
+        {
+            CreateModelTexts( texts, count );
+        }
+
+        const double startTime = CCEngine::GetSystemTime();
+        for( int i=0; i<count; ++i )
+        {
+            models[i] = new CCBenchmarkLoadingOBJ();
+            models[i]->loadData( texts[i].buffer );
+            texts[i].setSize( 0 );
+        }
+        serialTimes.add( CCEngine::GetSystemTime() - startTime );
+
+        for( int i=0; i<count; ++i )
+        {
+            DELETE_OBJECT( models[i] );
+        }
+    }
+    const float serialPeak = PeakMemory();
+
+    // Every model queued at once, the texts are moved into the loads
+    for( int frame=0; frame<MAX( frames, 1 ); ++frame )
+    {
+        CreateModelTexts( texts, count );
+
+        const double startTime = CCEngine::GetSystemTime();
+        CCBenchmarkLoadingOBJ::Loaded = 0;
+        for( int i=0; i<count; ++i )
+        {
+            models[i] = new CCBenchmarkLoadingOBJ();
+            models[i]->loadDataAsync( texts[i] );
+        }
+        WaitForLoads( engine, count );
+        parallelTimes.add( CCEngine::GetSystemTime() - startTime );
+
+        if( CCBenchmarkLoadingOBJ::Loaded != count )
+        {
+            printf( "Only %i of %i models loaded\n", CCBenchmarkLoadingOBJ::Loaded, count );
+        }
+        for( int i=0; i<count; ++i )
+        {
+            DELETE_OBJECT( models[i] );
+        }
+    }
+    const float parallelPeak = PeakMemory();
+
+    // Deleting models mid load drops their results instead of waiting on them
+    {
+        CreateModelTexts( texts, count );
+
+        CCBenchmarkLoadingOBJ::Loaded = 0;
+        for( int i=0; i<count; ++i )
+        {
+            models[i] = new CCBenchmarkLoadingOBJ();
+            models[i]->loadDataAsync( texts[i] );
+        }
+
+        const double startTime = CCEngine::GetSystemTime();
+        int kept = 0;
+        for( int i=0; i<count; ++i )
+        {
+            if( i % 2 == 1 )
+            {
+                DELETE_OBJECT( models[i] );
+            }
+            else
+            {
+                kept++;
+            }
+        }
+        const double deleteTime = CCEngine::GetSystemTime() - startTime;
+
+        WaitForLoads( engine, kept );
+        printf( "Deleted %i loading models in %.3fms, %i of %i kept models loaded\n",
+                count - kept, deleteTime * 1000.0, CCBenchmarkLoadingOBJ::Loaded, kept );
+
+        for( int i=0; i<count; ++i )
+        {
+            DELETE_OBJECT( models[i] );
+        }
+    }
+
+    serialTimes.report( "serial" );
+    parallelTimes.report( "parallel" );
+    printf( "%.1fx faster, peak resident memory %.1fMB after the serial loads and %.1fMB after the parallel loads\n",
+            serialTimes.average() / MAX( parallelTimes.average(), 1e-9 ), serialPeak, parallelPeak );
+
+    free( models );
+    delete[] texts;
+}
@@ -0,0 +1,94 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkMovers.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+#include "CCSweepAndPrune.h"
+
+
+// Walks forward, turning every now and then
+class CCBenchmarkMover : public CCMoveable
+{
+    typedef CCMoveable super;
+
+public:
+    CCBenchmarkMover(const float turnInterval)
+    {
+        gravity = false;
+        collideableType = collision_box | collision_moveable;
+        movementSpeed = 150.0f;
+        movementDirection.z = 1.0f;
+        this->turnInterval = turnInterval;
+        turnTimer = turnInterval;
+    }
+
+    virtual bool update(const CCTime &time)
+    {
+        turnTimer -= time.delta;
+        if( turnTimer <= 0.0f )
+        {
+            turnTimer = turnInterval;
+            rotateY( 90.0f + CCFloatRandom() * 180.0f );
+        }
+        return super::update( time );
+    }
+
+protected:
+    float turnInterval;
+    float turnTimer;
+};
+
+
+static void AddMovers(CCBenchmarkEngine *engine, const int count, const float arenaSize)
+{
+    // A few walls to bump into
+    const int numberOfWalls = count / 20;
+    CCSceneBase *scene = NULL;
+    for( int i=0; i<count+numberOfWalls; ++i )
+    {
+        scene = engine->getScene( scene );
+        const float x = CCFloatRandomDualSided() * arenaSize;
+        const float z = CCFloatRandomDualSided() * arenaSize;
+        if( i < numberOfWalls )
+        {
+            CCCollideable *wall = new CCCollideable();
+            wall->collideableType = collision_box | collision_static;
+            wall->setCollisionBounds( 60.0f, 20.0f, 10.0f );
+            wall->setPositionXYZ( x, 0.0f, z );
+            wall->setScene( scene );
+        }
+        else
+        {
+            CCBenchmarkMover *mover = new CCBenchmarkMover( 1.0f + CCFloatRandom() * 3.0f );
+            mover->setSquareCollisionBounds( 4.0f );
+            mover->setRotationY( CCFloatRandom() * 360.0f );
+            mover->setPositionXYZ( x, 0.0f, z );
+            mover->setScene( scene );
+        }
+    }
+}
+
+
+// Thousands of movers wandering an arena, first sub-stepping through the octree and then using the broadphase
+void CCBenchmarkMovers(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    const float arenaSize = sqrtf( (float)count ) * 20.0f;
+    AddMovers( engine, count, arenaSize );
+
+    printf( "octree sub-stepping\n" );
+    engine->runFrames( frames );
+
+    engine->collisionManager.enableBroadphase( true );
+    printf( "\nsweep and prune\n" );
+    engine->runFrames( frames );
+
+    const CCSweepAndPrune *broadphase = engine->collisionManager.broadphase;
+    printf( "%i entries, %i candidate pairs, %i endpoint swaps last frame\n",
+            broadphase->getNumberOfEntries(), broadphase->getNumberOfPairs(), broadphase->getNumberOfSwaps() );
+}
@@ -0,0 +1,79 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkOBJParser.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+#include "CCOBJParser.h"
+#include "ObjLoader.h"
+
+
+// Times parsing a generated torus of count triangles into a triangle soup, with ObjLoader3 as well when given
+static void TimeParsers(const int count, const int frames, const bool withObjLoader)
+{
+    const int sides = MAX( (int)sqrtf( count / 4.0f ), 2 );
+    char *data = CCBenchmarkCreateTorusOBJ( sides * 2, sides, 6.0f, 2.0f );
+    const uint length = strlen( data );
+    printf( "\n%i triangles, %u bytes of OBJ\n", sides * sides * 4, length );
+
+    CCBenchmarkTiming objLoader, parser;
+    for( int frame=0; frame<frames; ++frame )
+    {
+        if( withObjLoader )
+        {
+            // ObjLoader3 splits the text in place, so it needs its own copy, as CCPrimitiveOBJ used to make
+            const double startTime = CCEngine::GetSystemTime();
+            CCText text = data;
+            ObjMesh *mesh = LoadOBJTextData( text );
+            if( mesh != NULL )
+            {
+                DeleteOBJ( mesh->m_iMeshID );
+            }
+            objLoader.add( CCEngine::GetSystemTime() - startTime );
+        }
+
+        const double startTime = CCEngine::GetSystemTime();
+        CCOBJParser objParser;
+        objParser.parse( data, length );
+
+        float *vertices, *normals, *uvs;
+        uint vertexCount;
+        CCMinMax mmX, mmY, mmZ;
+        if( objParser.createSoup( &vertices, &normals, &uvs, vertexCount, mmX, mmY, mmZ ) )
+        {
+            free( vertices );
+            free( normals );
+            free( uvs );
+        }
+        parser.add( CCEngine::GetSystemTime() - startTime );
+    }
+    free( data );
+
+    if( withObjLoader )
+    {
+        objLoader.report( "ObjLoader3" );
+    }
+    parser.report( "CCOBJParser" );
+    if( withObjLoader )
+    {
+        printf( "%.1fx faster\n", objLoader.average() / MAX( parser.average(), 1e-9 ) );
+    }
+}
+
+
+// Times the parser on a generated model of count triangles, CCTestOBJParser checks what it reads
+void CCBenchmarkOBJParser(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    // ObjLoader3's line list grows 16 entries at a time, so it's only compared on smaller models
+    const int comparedCount = MIN( count, 100000 );
+    TimeParsers( comparedCount, frames, true );
+    if( count > comparedCount )
+    {
+        TimeParsers( count, frames, false );
+    }
+}
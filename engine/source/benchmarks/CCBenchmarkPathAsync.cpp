@@ -0,0 +1,129 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkPathAsync.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+struct CCBenchmarkPathAgent
+{
+    const CCPathFinderNetwork::PathNode *node;
+    bool waiting;
+    int arrivals;
+};
+
+
+// Agents heading between rally points, re-pathing as soon as their last request comes back
+void CCBenchmarkPathAsync(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    // connect() fills the area between the corner nodes with a grid spaced 150 apart
+    const float spacing = 150.0f;
+    const float size = 100.0f * spacing;
+
+    CCSceneBase *scene = new CCSceneBase();
+    engine->addScene( scene );
+    CCCollideable *anchor = new CCCollideable();
+    anchor->setScene( scene );
+
+    CCPathFinderNetwork network;
+    network.addNode( CCVector3( 0.0f, 0.0f, 0.0f ), anchor );
+    network.addNode( CCVector3( size, 0.0f, 0.0f ), anchor );
+    network.addNode( CCVector3( 0.0f, 0.0f, size ), anchor );
+    network.addNode( CCVector3( size, 0.0f, size ), anchor );
+    network.connect();
+
+    const int numberOfRallyPoints = 32;
+    const CCPathFinderNetwork::PathNode *rallyPoints[numberOfRallyPoints];
+    for( int i=0; i<numberOfRallyPoints; ++i )
+    {
+        rallyPoints[i] = network.findClosestNode( CCVector3( CCFloatRandom() * size, 0.0f, CCFloatRandom() * size ) );
+    }
+
+    CCBenchmarkPathAgent *agents = (CCBenchmarkPathAgent*)malloc( sizeof( CCBenchmarkPathAgent ) * count );
+    for( int i=0; i<count; ++i )
+    {
+        CCBenchmarkPathAgent &agent = agents[i];
+        agent.node = rallyPoints[i % numberOfRallyPoints];
+        agent.waiting = false;
+        agent.arrivals = 0;
+    }
+
+    // The agent arrives the moment its path comes back
+    CCLAMBDA_1_UNSAFE( PathResult, CCBenchmarkPathAgent*, agent,
+    {
+        const CCPathFinderNetwork::PathRequestResult *result = (const CCPathFinderNetwork::PathRequestResult*)runParameters;
+        if( result->found )
+        {
+            agent->node = result->toNode;
+            agent->arrivals++;
+        }
+        agent->waiting = false;
+    });
+
+    // For reference, how long the same number of searches take one after another on the engine thread
+    CCPathFinderNetwork::Path path;
+    double startTime = CCEngine::GetSystemTime();
+    for( int i=0; i<count; ++i )
+    {
+        network.findPath( NULL, path, agents[i].node, rallyPoints[(int)( CCFloatRandom() * numberOfRallyPoints ) % numberOfRallyPoints] );
+    }
+    printf( "%i synchronous searches took %.3fms\n", count, ( CCEngine::GetSystemTime() - startTime ) * 1000.0 );
+
+    CCBenchmarkTiming requesting, frameTiming;
+    int requests = 0;
+    for( int frame=0; frame<frames; ++frame )
+    {
+        startTime = CCEngine::GetSystemTime();
+        for( int i=0; i<count; ++i )
+        {
+            CCBenchmarkPathAgent &agent = agents[i];
+            if( agent.waiting == false )
+            {
+                agent.waiting = true;
+                requests++;
+                const CCPathFinderNetwork::PathNode *goal = rallyPoints[(int)( CCFloatRandom() * numberOfRallyPoints ) % numberOfRallyPoints];
+                network.requestPath( agent.node, goal, new PathResult( &agent ) );
+            }
+        }
+        const double requestedTime = CCEngine::GetSystemTime();
+        requesting.add( requestedTime - startTime );
+
+        engine->updateEngineThread();
+        frameTiming.add( CCEngine::GetSystemTime() - requestedTime );
+    }
+
+    // Let the stragglers come back before the network goes
+    int waiting = count;
+    for( int i=0; i<1000 && waiting > 0; ++i )
+    {
+        engine->jobScheduler.waitForIdle();
+        engine->updateEngineThread();
+
+        waiting = 0;
+        for( int j=0; j<count; ++j )
+        {
+            if( agents[j].waiting )
+            {
+                waiting++;
+            }
+        }
+    }
+
+    int arrivals = 0;
+    for( int i=0; i<count; ++i )
+    {
+        arrivals += agents[i].arrivals;
+    }
+
+    printf( "%i agents, %i requests, %i arrivals, %i cache hits, %i cache misses\n",
+            count, requests, arrivals, network.getPathCacheHits(), network.getPathCacheMisses() );
+    requesting.report( "requesting per frame" );
+    frameTiming.report( "engine frame" );
+    free( agents );
+}
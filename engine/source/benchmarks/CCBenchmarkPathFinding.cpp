@@ -0,0 +1,122 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkPathFinding.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+// Walks the path's connections to measure its real length
+static float PathLength(const CCPathFinderNetwork::PathNode *fromNode, const CCPathFinderNetwork::Path &path)
+{
+    float length = 0.0f;
+    const CCPathFinderNetwork::PathNode *node = fromNode;
+    for( int i=0; i<path.endDirection; ++i )
+    {
+        const CCPathFinderNetwork::PathNode::PathConnection *connection = node->connections.list[path.directions[i]];
+        length += connection->length;
+        node = connection->node;
+    }
+    return length;
+}
+
+
+struct CCBenchmarkPathResults
+{
+    CCBenchmarkPathResults()
+    {
+        found = 0;
+        totalLength = 0.0f;
+    }
+
+    CCBenchmarkTiming timing;
+    int found;
+    float totalLength;
+};
+
+
+static void FindPath(CCPathFinderNetwork &network, const CCPathFinderNetwork::PathSearchMode mode,
+                     const CCPathFinderNetwork::PathNode *fromNode, const CCPathFinderNetwork::PathNode *toNode,
+                     CCBenchmarkPathResults &results, float &length)
+{
+    CCPathFinderNetwork::Path path;
+    network.setSearchMode( mode );
+
+    const double startTime = CCEngine::GetSystemTime();
+    const bool found = network.findPath( NULL, path, fromNode, toNode );
+    results.timing.add( CCEngine::GetSystemTime() - startTime );
+
+    length = found ? PathLength( fromNode, path ) : 0.0f;
+    if( found )
+    {
+        results.found++;
+    }
+}
+
+
+// A grid of 10k path nodes, searched between random nodes with A* and the original depth first search
+void CCBenchmarkPathFinding(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    // connect() fills the area between the corner nodes with a grid spaced 150 apart
+    const float spacing = 150.0f;
+    const float size = ceilf( sqrtf( (float)count ) ) * spacing;
+
+    // Corner nodes need a parent so connect() doesn't treat them as filler
+    CCSceneBase *scene = new CCSceneBase();
+    engine->addScene( scene );
+    CCCollideable *anchor = new CCCollideable();
+    anchor->setScene( scene );
+
+    CCPathFinderNetwork network;
+    network.addNode( CCVector3( 0.0f, 0.0f, 0.0f ), anchor );
+    network.addNode( CCVector3( size, 0.0f, 0.0f ), anchor );
+    network.addNode( CCVector3( 0.0f, 0.0f, size ), anchor );
+    network.addNode( CCVector3( size, 0.0f, size ), anchor );
+
+    double startTime = CCEngine::GetSystemTime();
+    network.connect();
+    printf( "connected in %.3fms\n", ( CCEngine::GetSystemTime() - startTime ) * 1000.0 );
+
+    CCBenchmarkPathResults astar, depthFirst;
+    int bothFound = 0;
+    float astarLength = 0.0f, depthFirstLength = 0.0f, straightLength = 0.0f;
+    const int numberOfSearches = MAX( frames, 1 );
+    for( int i=0; i<numberOfSearches; ++i )
+    {
+        // Keep some searches short enough for the depth first search's 50 step limit
+        const float range = ( i % 2 == 0 ? 0.15f : 1.0f ) * size;
+        const CCVector3 from( CCFloatRandom() * size, 0.0f, CCFloatRandom() * size );
+        const CCVector3 to( from.x + CCFloatRandomDualSided() * range, 0.0f, from.z + CCFloatRandomDualSided() * range );
+        const CCPathFinderNetwork::PathNode *fromNode = network.findClosestNode( from );
+        const CCPathFinderNetwork::PathNode *toNode = network.findClosestNode( to );
+
+        float length, otherLength;
+        FindPath( network, CCPathFinderNetwork::path_search_astar, fromNode, toNode, astar, length );
+        FindPath( network, CCPathFinderNetwork::path_search_depth_first, fromNode, toNode, depthFirst, otherLength );
+        astar.totalLength += length;
+
+        if( length > 0.0f && otherLength > 0.0f )
+        {
+            bothFound++;
+            astarLength += length;
+            depthFirstLength += otherLength;
+            straightLength += CCVector3Distance2D( fromNode->point, toNode->point, false );
+        }
+    }
+
+    printf( "%i searches\n", numberOfSearches );
+    printf( "astar        found %i\n", astar.found );
+    astar.timing.report( "astar" );
+    printf( "depth first  found %i\n", depthFirst.found );
+    depthFirst.timing.report( "depth first" );
+    if( bothFound > 0 )
+    {
+        printf( "where both found a path, astar is %.3fx and depth first %.3fx the straight line distance\n",
+                astarLength / straightLength, depthFirstLength / straightLength );
+    }
+}
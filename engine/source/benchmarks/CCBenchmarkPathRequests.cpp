@@ -0,0 +1,93 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkPathRequests.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+// Agents wandering a walled area, each looking up its closest reachable nodes and searching for a path every frame
+void CCBenchmarkPathRequests(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    // connect() fills the area between the corner nodes with a grid spaced 150 apart
+    const float spacing = 150.0f;
+    const float size = 50.0f * spacing;
+
+    CCSceneBase *scene = engine->getScene<CCSceneBase>( NULL );
+
+    // Corner nodes need a parent so connect() doesn't treat them as filler
+    CCCollideable *anchor = new CCCollideable();
+    anchor->setScene( scene );
+
+    CCPathFinderNetwork network;
+    network.addNode( CCVector3( 0.0f, 0.0f, 0.0f ), anchor );
+    network.addNode( CCVector3( size, 0.0f, 0.0f ), anchor );
+    network.addNode( CCVector3( 0.0f, 0.0f, size ), anchor );
+    network.addNode( CCVector3( size, 0.0f, size ), anchor );
+    network.connect();
+
+    // Scattered walls so the closest node isn't always reachable
+    const int numberOfWalls = 200;
+    CCPtrList<CCCollideable> agents;
+    for( int i=0; i<numberOfWalls+count; ++i )
+    {
+        scene = engine->getScene( scene );
+
+        CCCollideable *collideable = new CCCollideable();
+        if( i < numberOfWalls )
+        {
+            collideable->setCollisionBounds( spacing * ( 0.5f + CCFloatRandom() * 3.0f ), spacing, spacing * 0.25f );
+        }
+        else
+        {
+            collideable->setSquareCollisionBounds( 10.0f );
+            agents.add( collideable );
+        }
+        collideable->setPositionXYZ( CCFloatRandom() * size, 0.0f, CCFloatRandom() * size );
+        collideable->setScene( scene );
+    }
+
+    CCBenchmarkTiming lookups, searches;
+    int requests = 0, unreachable = 0, found = 0;
+    CCPathFinderNetwork::Path path;
+    for( int frame=0; frame<frames; ++frame )
+    {
+        double lookupTime = 0.0, searchTime = 0.0;
+        for( int i=0; i<agents.length; ++i )
+        {
+            CCCollideable *agent = agents.list[i];
+            const CCVector3 target( CCFloatRandom() * size, 0.0f, CCFloatRandom() * size );
+
+            double startTime = CCEngine::GetSystemTime();
+            const CCPathFinderNetwork::PathNode *fromNode = network.findClosestNodeToPathTarget( agent, agent->getConstPosition(), true );
+            const CCPathFinderNetwork::PathNode *toNode = network.findClosestNodeToPathTarget( agent, target, true );
+            lookupTime += CCEngine::GetSystemTime() - startTime;
+            requests++;
+
+            if( fromNode == NULL || toNode == NULL )
+            {
+                unreachable++;
+                continue;
+            }
+
+            startTime = CCEngine::GetSystemTime();
+            if( network.findPath( agent, path, fromNode, toNode ) )
+            {
+                found++;
+            }
+            searchTime += CCEngine::GetSystemTime() - startTime;
+        }
+
+        lookups.add( lookupTime );
+        searches.add( searchTime );
+    }
+
+    printf( "%i agents, %i requests, %i without reachable nodes, %i paths found\n", agents.length, requests, unreachable, found );
+    lookups.report( "closest node lookups per frame" );
+    searches.report( "path searches per frame" );
+}
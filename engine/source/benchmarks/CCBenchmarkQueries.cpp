@@ -0,0 +1,111 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkQueries.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+#include "CCJobScheduler.h"
+
+
+struct CCBenchmarkQuery
+{
+    CCVector3 min, max;
+    CCCollideable *hit;
+    int numberOfCollideables;
+};
+
+
+static void RunQueries(CCCollisionQueryContext &context, CCBenchmarkQuery *queries, const int count)
+{
+    for( int i=0; i<count; ++i )
+    {
+        CCBenchmarkQuery &query = queries[i];
+        query.hit = CCOctreeCollideableScan( context, query.min, query.max );
+        query.numberOfCollideables = context.numberOfCollideables;
+    }
+}
+
+
+// Each worker queries with its thread's default context
+CCLAMBDA_2_UNSAFE( BenchmarkQueryJob, CCBenchmarkQuery*, queries, int, count,
+{
+    RunQueries( CCCollisionQueryContext::Default(), queries, count );
+});
+
+
+// Runs the same box queries on one thread and then across workers, CCTestCollisionQueries checks the results match
+void CCBenchmarkQueries(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    const float spacing = 40.0f;
+    const int numberOfObjects = 10000;
+    const CCBenchmarkGrid grid( numberOfObjects, spacing );
+    CCSceneBase *scene = NULL;
+    for( int i=0; i<numberOfObjects; ++i )
+    {
+        scene = engine->getScene( scene );
+        grid.createCollideable( scene, i, spacing * 0.4f );
+    }
+
+    CCBenchmarkQuery *expected = (CCBenchmarkQuery*)malloc( sizeof( CCBenchmarkQuery ) * count );
+    CCBenchmarkQuery *queries = (CCBenchmarkQuery*)malloc( sizeof( CCBenchmarkQuery ) * count );
+    for( int i=0; i<count; ++i )
+    {
+        const float size = spacing * ( 0.1f + CCFloatRandom() * 2.0f );
+        CCBenchmarkQuery &query = expected[i];
+        query.min.set( CCFloatRandomDualSided() * grid.offset, -size, CCFloatRandomDualSided() * grid.offset );
+        query.max = query.min;
+        query.max.add( size );
+    }
+
+    CCCollisionQueryContext *context = new CCCollisionQueryContext();
+    double startTime = CCEngine::GetSystemTime();
+    RunQueries( *context, expected, count );
+    const double singleDuration = CCEngine::GetSystemTime() - startTime;
+    delete context;
+    printf( "single thread  %9.3fms\n", singleDuration * 1000.0 );
+
+    static const int workerCounts[] = { 2, 4, 8 };
+    for( uint workers=0; workers<sizeof( workerCounts ) / sizeof( int ); ++workers )
+    {
+        CCJobScheduler scheduler;
+        if( scheduler.start( workerCounts[workers] ) == false )
+        {
+            printf( "Worker threads aren't supported on this platform\n" );
+            break;
+        }
+
+        CCBenchmarkTiming timing;
+        for( int frame=0; frame<MAX( frames, 1 ); ++frame )
+        {
+            for( int i=0; i<count; ++i )
+            {
+                queries[i].min = expected[i].min;
+                queries[i].max = expected[i].max;
+                queries[i].hit = NULL;
+                queries[i].numberOfCollideables = -1;
+            }
+
+            // Small slices so the workers interleave their queries
+            const int sliceSize = 64;
+            startTime = CCEngine::GetSystemTime();
+            for( int first=0; first<count; first+=sliceSize )
+            {
+                scheduler.submit( new BenchmarkQueryJob( &queries[first], MIN( sliceSize, count - first ) ) );
+            }
+            scheduler.waitForIdle();
+            timing.add( CCEngine::GetSystemTime() - startTime );
+        }
+        scheduler.stop();
+
+        printf( "%2i workers\n", workerCounts[workers] );
+        timing.report( "queries" );
+    }
+
+    free( expected );
+    free( queries );
+}
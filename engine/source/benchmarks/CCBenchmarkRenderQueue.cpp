@@ -0,0 +1,51 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkRenderQueue.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+#include "CCPrimitives.h"
+
+
+// A grid of cubes alternating between two shaders, with every third one unculled and every fifth one
+// ignoring depth, drawn immediately then through the render queue
+void CCBenchmarkRenderQueue(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    static const char *shaders[] = { "basic", "phong" };
+    const float spacing = 20.0f;
+    const CCBenchmarkGrid grid( count, spacing );
+    CCSceneBase *scene = NULL;
+    for( int i=0; i<count; ++i )
+    {
+        scene = engine->getScene( scene );
+        CCCollideable *collideable = grid.createCollideable( scene, i, spacing * 0.5f );
+
+        CCModelBase *model = CCBenchmarkCreateCubeModel( spacing * 0.5f );
+        model->shader = shaders[i%2];
+        collideable->setModel( model );
+
+        if( i % 3 == 0 )
+        {
+            collideable->setCulling( false );
+        }
+        if( i % 5 == 0 )
+        {
+            collideable->setReadDepth( false );
+        }
+    }
+
+    printf( "immediate\n" );
+    engine->runFrames( frames );
+
+    engine->enableRenderQueue( true );
+    printf( "\nqueued\n" );
+    engine->runFrames( frames );
+    printf( "%i draws submitted through the queue last frame\n", engine->renderQueue->getNumberOfSubmitted() );
+
+    engine->enableRenderQueue( false );
+}
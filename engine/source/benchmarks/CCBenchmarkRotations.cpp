@@ -0,0 +1,119 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkRotations.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+static float MatrixDifference(const CCMatrix &a, const CCMatrix &b)
+{
+    float difference = 0.0f;
+    for( int i=0; i<4; ++i )
+    {
+        for( int j=0; j<4; ++j )
+        {
+            difference = MAX( difference, fabsf( a.m[i][j] - b.m[i][j] ) );
+        }
+    }
+    return difference;
+}
+
+
+static CCVector3 RandomRotation()
+{
+    return CCVector3( CCFloatRandom() * 360.0f, CCFloatRandom() * 360.0f, CCFloatRandom() * 360.0f );
+}
+
+
+// The cost of refreshing model matrices from angles against from quaternions,
+// CCTestRotations checks the conversions between them
+void CCBenchmarkRotations(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    CCRenderable **renderables = (CCRenderable**)malloc( sizeof( CCRenderable* ) * count );
+    for( int i=0; i<count; ++i )
+    {
+        CCRenderable *renderable = new CCRenderable();
+        renderable->setPositionXYZ( CCFloatRandomDualSided() * 1000.0f, 0.0f, CCFloatRandomDualSided() * 1000.0f );
+        renderable->setRotation( RandomRotation() );
+        if( i % 2 == 0 )
+        {
+            renderable->setScale( 0.5f + CCFloatRandom() );
+        }
+        renderables[i] = renderable;
+    }
+
+    CCBenchmarkTiming euler, quaternionAngles, quaternionDirect;
+
+    // Every renderable turning each frame
+    for( int frame=0; frame<frames; ++frame )
+    {
+        const double startTime = CCEngine::GetSystemTime();
+        for( int i=0; i<count; ++i )
+        {
+            renderables[i]->rotateY( 1.0f );
+            renderables[i]->refreshModelMatrix();
+        }
+        euler.add( CCEngine::GetSystemTime() - startTime );
+    }
+
+    CCMatrix *expected = (CCMatrix*)malloc( sizeof( CCMatrix ) * count );
+    for( int i=0; i<count; ++i )
+    {
+        expected[i] = renderables[i]->getModelMatrix();
+        renderables[i]->enableQuaternionRotation( true );
+        renderables[i]->refreshModelMatrix();
+    }
+
+    float difference = 0.0f;
+    for( int i=0; i<count; ++i )
+    {
+        difference = MAX( difference, MatrixDifference( expected[i], renderables[i]->getModelMatrix() ) );
+    }
+    FREE_POINTER( expected );
+    printf( "largest difference between the angle and quaternion matrices %g\n", difference );
+
+    // Still turned by angles, converted to a quaternion on each change
+    for( int frame=0; frame<frames; ++frame )
+    {
+        const double startTime = CCEngine::GetSystemTime();
+        for( int i=0; i<count; ++i )
+        {
+            renderables[i]->rotateY( 1.0f );
+            renderables[i]->refreshModelMatrix();
+        }
+        quaternionAngles.add( CCEngine::GetSystemTime() - startTime );
+    }
+
+    // Turned by quaternion, which keeps the angles in sync
+    CCQuaternion turn;
+    CCQuaternionFromEuler( turn, CCVector3( 0.0f, 1.0f, 0.0f ) );
+    for( int frame=0; frame<frames; ++frame )
+    {
+        const double startTime = CCEngine::GetSystemTime();
+        for( int i=0; i<count; ++i )
+        {
+            CCRenderable *renderable = renderables[i];
+            CCQuaternionMultiply( *renderable->quaternion, *renderable->quaternion, turn );
+            renderable->quaternionUpdated();
+            renderable->refreshModelMatrix();
+        }
+        quaternionDirect.add( CCEngine::GetSystemTime() - startTime );
+    }
+
+    printf( "%i renderables turning every frame\n", count );
+    euler.report( "angles" );
+    quaternionAngles.report( "quaternion set by angles" );
+    quaternionDirect.report( "quaternion" );
+
+    for( int i=0; i<count; ++i )
+    {
+        DELETE_OBJECT( renderables[i] );
+    }
+    FREE_POINTER( renderables );
+}
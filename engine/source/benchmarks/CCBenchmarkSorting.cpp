@@ -0,0 +1,161 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkSorting.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+
+
+// The comparison the visible list used to be sorted with through qsort
+static int LegacyZCompare(const void *a, const void *b)
+{
+    const CCCollideable *objectA = CCOctreeGetVisibleCollideables( *(int*)a );
+    const CCCollideable *objectB = CCOctreeGetVisibleCollideables( *(int*)b );
+    const int drawOrderA = objectA->getDrawOrder();
+    const int drawOrderB = objectB->getDrawOrder();
+
+    if( drawOrderA == 200 && drawOrderB == 200 )
+    {
+        const CCVector3 &cameraPosition = CCCameraBase::CurrentCamera->getRotatedPosition();
+        const float distanceA = CCVector3Distance( objectA->getConstPosition(), cameraPosition, true );
+        const float distanceB = CCVector3Distance( objectB->getConstPosition(), cameraPosition, true );
+        return (int)( distanceB - distanceA );
+    }
+    return drawOrderA - drawOrderB;
+}
+
+
+// Sees the benchmark's objects instead of scanning the octrees, and times sorting them both ways
+class CCBenchmarkSortingCamera : public CCCameraBase
+{
+public:
+    CCBenchmarkSortingCamera()
+    {
+        legacySorted = NULL;
+        shuffle = false;
+        misordered = 0;
+    }
+
+    ~CCBenchmarkSortingCamera()
+    {
+        FREE_POINTER( legacySorted );
+    }
+
+    CCPtrList<CCCollideable> objects;
+    CCBenchmarkTiming coherent, shuffled, legacy;
+    bool shuffle;
+    int misordered;
+
+protected:
+    virtual void updateVisibleCollideables()
+    {
+        const int count = objects.length;
+        visibleCollideables.length = 0;
+        for( int i=0; i<count; ++i )
+        {
+            visibleCollideables.add( objects.list[i] );
+        }
+
+        double startTime = CCEngine::GetSystemTime();
+        sortVisibleCollideables();
+        ( shuffle ? shuffled : coherent ).add( CCEngine::GetSystemTime() - startTime );
+
+        // Draw orders must never go backwards, and draw order 200 must be drawn back to front
+        for( int i=1; i<count; ++i )
+        {
+            const CCCollideable *previous = visibleCollideables.list[sortedVisibleCollideables[i-1]];
+            const CCCollideable *current = visibleCollideables.list[sortedVisibleCollideables[i]];
+            if( previous->getDrawOrder() > current->getDrawOrder() )
+            {
+                misordered++;
+            }
+            else if( previous->getDrawOrder() == 200 && current->getDrawOrder() == 200 &&
+                     CCVector3Distance( previous->getConstPosition(), rotatedPosition, true ) <
+                     CCVector3Distance( current->getConstPosition(), rotatedPosition, true ) )
+            {
+                misordered++;
+            }
+        }
+
+        if( legacySorted == NULL )
+        {
+            legacySorted = (int*)malloc( sizeof( int ) * count );
+        }
+        startTime = CCEngine::GetSystemTime();
+        for( int i=0; i<count; ++i )
+        {
+            legacySorted[i] = i;
+        }
+        qsort( legacySorted, count, sizeof( int ), &LegacyZCompare );
+        legacy.add( CCEngine::GetSystemTime() - startTime );
+    }
+
+    int *legacySorted;
+};
+
+
+// Visible objects in a few draw orders, some transparent, sorted as the camera slowly orbits them
+// Every tenth frame the list comes back from the scan in a different order
+void CCBenchmarkSorting(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    static const int drawOrders[] = { -50, 100, 100, 100, 150, 200, 200 };
+    static const int numberOfDrawOrders = sizeof( drawOrders ) / sizeof( int );
+
+    CCBenchmarkSortingCamera *camera = new CCBenchmarkSortingCamera();
+    camera->setupViewport();
+    camera->objects.reserve( count );
+
+    CCSceneBase *scene = NULL;
+    for( int i=0; i<count; ++i )
+    {
+        scene = engine->getScene( scene );
+        CCCollideable *object = new CCCollideable();
+        object->setPositionXYZ( CCFloatRandomDualSided() * 1000.0f, CCFloatRandom() * 50.0f, CCFloatRandomDualSided() * 1000.0f );
+        object->setDrawOrder( drawOrders[i%numberOfDrawOrders] );
+        if( i % 7 == 0 )
+        {
+            object->setTransparent();
+        }
+        object->setScene( scene );
+        camera->objects.add( object );
+    }
+
+    for( int frame=0; frame<frames; ++frame )
+    {
+        camera->shuffle = frame % 10 == 0;
+        if( camera->shuffle )
+        {
+            // Rotate the list, as a scan starting from a different leaf would
+            CCPtrList<CCCollideable> &objects = camera->objects;
+            const int offset = (int)( CCFloatRandom() * objects.length );
+            CCPtrList<CCCollideable> rotated;
+            rotated.reserve( objects.length );
+            for( int i=0; i<objects.length; ++i )
+            {
+                rotated.add( objects.list[( i + offset ) % objects.length] );
+            }
+            for( int i=0; i<objects.length; ++i )
+            {
+                objects.list[i] = rotated.list[i];
+            }
+        }
+
+        const float angle = ( frame / (float)frames ) * CC_PI * 0.25f;
+        camera->flagUpdate();
+        camera->setLookAt( CCVector3(), CCVector3( cosf( angle ) * 1500.0f, 500.0f, sinf( angle ) * 1500.0f ) );
+        camera->update();
+    }
+
+    printf( "%i visible objects\n", count );
+    camera->coherent.report( "keys" );
+    camera->shuffled.report( "  reordered" );
+    camera->legacy.report( "qsort" );
+    printf( "%i objects out of order\n", camera->misordered );
+
+    delete camera;
+}
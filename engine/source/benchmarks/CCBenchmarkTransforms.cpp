@@ -0,0 +1,152 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkTransforms.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+#include "CCTransformStore.h"
+
+
+// Each object's world matrix built from its parent's, as objects refresh them without the store
+static void RefreshWorldMatrices(CCPtrList<CCObject> &objects)
+{
+    // Parents are listed before their children
+    for( int i=0; i<objects.length; ++i )
+    {
+        CCObject *object = objects.list[i];
+        object->refreshWorldMatrix( object->parent != NULL ? &object->parent->getWorldMatrix() : NULL );
+    }
+}
+
+
+// Spins every fourth tree and bobs every tenth object
+static void MoveObjects(CCPtrList<CCObject> &roots, CCPtrList<CCObject> &objects, const int frame)
+{
+    for( int i=frame%4; i<roots.length; i+=4 )
+    {
+        roots.list[i]->rotateY( 1.0f );
+    }
+
+    const float height = sinf( frame * 0.1f ) * 10.0f;
+    for( int i=frame%10; i<objects.length; i+=10 )
+    {
+        objects.list[i]->setPositionY( height );
+    }
+}
+
+
+static float MatrixDifference(const CCMatrix &a, const CCMatrix &b)
+{
+    float difference = 0.0f;
+    for( int i=0; i<4; ++i )
+    {
+        for( int j=0; j<4; ++j )
+        {
+            difference = MAX( difference, fabsf( a.m[i][j] - b.m[i][j] ) );
+        }
+    }
+    return difference;
+}
+
+
+// Trees of objects four children wide and four levels deep, spun and bobbed every frame, refreshing their
+// world matrices object by object, then through the transform store
+void CCBenchmarkTransforms(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    const int childrenPerObject = 4;
+    const int levels = 4;
+
+    CCPtrList<CCObject> roots, objects;
+    objects.reserve( count );
+
+    CCSceneBase *scene = NULL;
+    while( objects.length < count )
+    {
+        scene = engine->getScene( scene );
+        CCObject *root = new CCObject();
+        root->setPositionXYZ( CCFloatRandomDualSided() * 10000.0f, 0.0f, CCFloatRandomDualSided() * 10000.0f );
+        root->setScene( scene );
+        roots.add( root );
+        objects.add( root );
+
+        // Breadth first, so each level's parents are already listed
+        int levelStart = objects.length-1;
+        for( int level=1; level<levels && objects.length<count; ++level )
+        {
+            const int levelEnd = objects.length;
+            for( int i=levelStart; i<levelEnd && objects.length<count; ++i )
+            {
+                for( int j=0; j<childrenPerObject && objects.length<count; ++j )
+                {
+                    CCObject *child = new CCObject();
+                    child->setPositionXYZ( CCFloatRandomDualSided() * 20.0f, 0.0f, CCFloatRandomDualSided() * 20.0f );
+                    child->setRotationY( CCFloatRandom() * 360.0f );
+                    if( j % 2 == 0 )
+                    {
+                        child->setScale( 0.5f + CCFloatRandom() );
+                    }
+                    objects.list[i]->addChild( child );
+                    objects.add( child );
+                }
+            }
+            levelStart = levelEnd;
+        }
+    }
+    printf( "%i objects in %i trees\n", objects.length, roots.length );
+
+    CCBenchmarkTiming unstored;
+    int frame = 0;
+    for( ; frame<frames; ++frame )
+    {
+        const double startTime = CCEngine::GetSystemTime();
+        MoveObjects( roots, objects, frame );
+        RefreshWorldMatrices( objects );
+        unstored.add( CCEngine::GetSystemTime() - startTime );
+    }
+    unstored.report( "objects" );
+
+    // Keep the last results to check the store against
+    CCMatrix *expected = (CCMatrix*)malloc( sizeof( CCMatrix ) * objects.length );
+    for( int i=0; i<objects.length; ++i )
+    {
+        expected[i] = objects.list[i]->getWorldMatrix();
+    }
+
+    // Our objects are already in their scenes, so bind them ourselves
+    engine->enableTransformStore( true );
+    CCTransformStore *store = engine->transformStore;
+    for( int i=0; i<roots.length; ++i )
+    {
+        roots.list[i]->bindTransforms();
+    }
+    store->update();
+
+    float difference = 0.0f;
+    for( int i=0; i<objects.length; ++i )
+    {
+        difference = MAX( difference, MatrixDifference( expected[i], store->getWorldMatrix( objects.list[i]->getTransformIndex() ) ) );
+    }
+    FREE_POINTER( expected );
+    printf( "largest difference from the objects' own matrices %g\n", difference );
+
+    CCBenchmarkTiming stored;
+    int updated = 0;
+    for( ; frame<frames*2; ++frame )
+    {
+        const double startTime = CCEngine::GetSystemTime();
+        MoveObjects( roots, objects, frame );
+        store->update();
+        stored.add( CCEngine::GetSystemTime() - startTime );
+        updated += store->getNumberOfUpdated();
+    }
+    stored.report( "store" );
+    printf( "%.0f world matrices rebuilt per frame\n", frames > 0 ? (float)updated / frames : 0.0f );
+
+    roots.freeList();
+    objects.freeList();
+}
@@ -0,0 +1,83 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCBenchmarkVertexBuffers.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCBenchmark.h"
+#include "CCPrimitives.h"
+
+
+// Spheres which never change, and every tenth object a cube which is resized every frame
+class CCBenchmarkVertexBuffersScene : public CCSceneBase
+{
+    typedef CCSceneBase super;
+
+public:
+    void addModel(CCCollideable *collideable, const int index, const float size)
+    {
+        CCModelBase *model = new CCModelBase();
+        if( index % 10 == 0 )
+        {
+            CCPrimitiveCube *cube = new CCPrimitiveCube();
+            cube->setupSquare( size );
+            model->addPrimitive( cube );
+            cubes.add( cube );
+        }
+        else
+        {
+            CCPrimitiveSphere *sphere = new CCPrimitiveSphere();
+            sphere->setup( size * 0.8f );
+            model->addPrimitive( sphere );
+        }
+        collideable->setModel( model );
+    }
+
+    ~CCBenchmarkVertexBuffersScene()
+    {
+        cubes.freeList();
+    }
+
+protected:
+    virtual bool updateScene(const CCTime &time)
+    {
+        const float size = 5.0f + sinf( lifetime * 2.0f ) * 2.0f;
+        for( int i=0; i<cubes.length; ++i )
+        {
+            cubes.list[i]->setupSquare( size );
+        }
+        return super::updateScene( time );
+    }
+
+protected:
+    CCPtrList<CCPrimitiveCube> cubes;
+};
+
+
+// The same scene drawn from client arrays, then from buffer objects
+void CCBenchmarkVertexBuffers(CCBenchmarkEngine *engine, const int count, const int frames)
+{
+    const float spacing = 20.0f;
+    const CCBenchmarkGrid grid( count, spacing );
+    CCBenchmarkVertexBuffersScene *scene = NULL;
+    for( int i=0; i<count; ++i )
+    {
+        scene = engine->getScene( scene );
+        scene->addModel( grid.createCollideable( scene, i, spacing * 0.5f ), i, spacing * 0.5f );
+    }
+
+    printf( "client arrays\n" );
+    engine->runFrames( frames );
+
+    CCVertexBufferManager &vertexBuffers = engine->renderer->vertexBufferManager;
+    vertexBuffers.setEnabled( true );
+    printf( "\nbuffer objects\n" );
+    engine->runFrames( frames );
+    printf( "%i arrays cached, %u bytes in buffer objects\n", vertexBuffers.getNumberOfCached(), vertexBuffers.getBufferedBytes() );
+
+    vertexBuffers.setEnabled( false );
+}
@@ -24,6 +24,7 @@ CCCollideable::CCCollideable(const char *objectID)
 	setSquareCollisionBounds( 1.0f );
 
 	octrees.allocate( 32 );
+    broadphaseIndex = -1;
 
     visible = false;
 
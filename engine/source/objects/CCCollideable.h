@@ -32,6 +32,9 @@ public:
 
 	CCPtrList<CCOctree> octrees;
 
+    // Our entry in the collision manager's broadphase, or -1
+    int broadphaseIndex;
+
     bool visible;
 
 protected:
@@ -94,6 +97,9 @@ public:
     virtual void setCollideable(const bool toggle) { collisionsEnabled = toggle; }
     virtual bool isMoveable() { return false; }
 
+    // How far we could move this frame, the broadphase fattens our bounds by this much
+    virtual float getBroadphaseMargin(const float delta) { return 0.0f; }
+
 	virtual void ownObject(CCCollideable *object);
 	virtual void unOwnObject(CCCollideable *object);
 
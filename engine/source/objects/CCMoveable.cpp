@@ -10,6 +10,7 @@
 #include "CCDefines.h"
 #include "CCObjects.h"
 #include "CCSceneBase.h"
+#include "CCSweepAndPrune.h"
 
 
 float CCMoveable::gravityForce = 200.0f;
@@ -41,6 +42,19 @@ CCCollideable* CCMoveable::requestCollisionWith(CCCollideable *collidedWith)
 }
 
 
+float CCMoveable::getBroadphaseMargin(const float delta)
+{
+    if( moveable == false )
+    {
+        return 0.0f;
+    }
+
+    // Generous, moving further than this just falls back to the octree
+    const float speed = movementSpeed * 2.0f + CCVector3Magnitude( additionalVelocity, false ) + fabsf( movementVelocity.y ) + gravityForce * delta;
+    return speed * delta + CC_SMALLFLOAT;
+}
+
+
 void CCMoveable::updateMovement(const float delta)
 {
     if( moveable )
@@ -107,34 +121,55 @@ float CCMoveable::applyMovementDirection(const float delta)
 void CCMoveable::applyVelocity(const float delta, const float movementMagnitude)
 {
 	const float velocityX = velocity.x * delta;
+	const float velocityY = velocity.y * delta;
 	const float velocityZ = velocity.z * delta;
+
+    // With a broadphase we can test the whole frame's movement against our candidates without sub-stepping
+    CCCollideable * const *candidates = NULL;
+    int numberOfCandidates = 0;
+    bool swept = false;
+    const CCSweepAndPrune *broadphase = gEngine->collisionManager.broadphase;
+    if( broadphase != NULL )
+    {
+        CCVector3 sweptMin( position.x - collisionBounds.x + MIN( velocityX, 0.0f ),
+                            position.y - collisionBounds.y + MIN( velocityY, 0.0f ),
+                            position.z - collisionBounds.z + MIN( velocityZ, 0.0f ) );
+        CCVector3 sweptMax( position.x + collisionBounds.x + MAX( velocityX, 0.0f ),
+                            position.y + collisionBounds.y + MAX( velocityY, 0.0f ),
+                            position.z + collisionBounds.z + MAX( velocityZ, 0.0f ) );
+        swept = broadphase->getCandidates( this, sweptMin, sweptMax, candidates, numberOfCandidates );
+    }
+
 	if( velocityX != 0.0f || velocityZ != 0.0f )
 	{
-		const CCCollideable *collidedWith = NULL;
+		CCCollideable *collidedWith = NULL;
 
-		const float velocityVsBoundingX = velocityX * inverseCollisionSize.width;
-		const float velocityVsBoundingZ = velocityZ * inverseCollisionSize.width;
-		const float absVelocityVsBoundingX = fabsf( velocityVsBoundingX );
-		const float absVelocityVsBoundingZ = fabsf( velocityVsBoundingZ );
-		if( absVelocityVsBoundingX > 1.0f || absVelocityVsBoundingZ > 1.0f )
-		{
-			const float furthestIncrement = absVelocityVsBoundingX > absVelocityVsBoundingZ ? absVelocityVsBoundingX : absVelocityVsBoundingZ;
-			const uint numberOfIncrements = (uint)( roundf( furthestIncrement + 0.5f ) );
-
-			const float inverseNumberOfIncrements = 1.0f / numberOfIncrements;
-			const float incrementsX = velocityX * inverseNumberOfIncrements;
-			const float incrementsZ = velocityZ * inverseNumberOfIncrements;
-			uint i = 0;
-			do
-			{
-				collidedWith = applyHorizontalVelocity( incrementsX, incrementsZ );
-				i++;
-			} while( i < numberOfIncrements && collidedWith == NULL );
-		}
-		else
-		{
-			collidedWith = applyHorizontalVelocity( velocityX, velocityZ );
-		}
+        if( swept == false || applySweptHorizontalVelocity( velocityX, velocityZ, candidates, numberOfCandidates, collidedWith ) == false )
+        {
+            const float velocityVsBoundingX = velocityX * inverseCollisionSize.width;
+            const float velocityVsBoundingZ = velocityZ * inverseCollisionSize.width;
+            const float absVelocityVsBoundingX = fabsf( velocityVsBoundingX );
+            const float absVelocityVsBoundingZ = fabsf( velocityVsBoundingZ );
+            if( absVelocityVsBoundingX > 1.0f || absVelocityVsBoundingZ > 1.0f )
+            {
+                const float furthestIncrement = absVelocityVsBoundingX > absVelocityVsBoundingZ ? absVelocityVsBoundingX : absVelocityVsBoundingZ;
+                const uint numberOfIncrements = (uint)( roundf( furthestIncrement + 0.5f ) );
+
+                const float inverseNumberOfIncrements = 1.0f / numberOfIncrements;
+                const float incrementsX = velocityX * inverseNumberOfIncrements;
+                const float incrementsZ = velocityZ * inverseNumberOfIncrements;
+                uint i = 0;
+                do
+                {
+                    collidedWith = applyHorizontalVelocity( incrementsX, incrementsZ );
+                    i++;
+                } while( i < numberOfIncrements && collidedWith == NULL );
+            }
+            else
+            {
+                collidedWith = applyHorizontalVelocity( velocityX, velocityZ );
+            }
+        }
 
 		// Deceleration
 		if( movementMagnitude == 0.0f )
@@ -148,50 +183,29 @@ void CCMoveable::applyVelocity(const float delta, const float movementMagnitude)
 	// Gravity
 	if( gravity )
 	{
-		const CCCollideable *collidedWith = NULL;
+		CCCollideable *collidedWith = NULL;
 		movementVelocity.y -= gravityForce * delta;
-		const float velocityY = velocity.y * delta;
 
-		if( velocityY > 0.0f )
-		{
-			const float velocityVsBoundingY = velocityY * inverseCollisionSize.height;
-			const float absVelocityVsBoundingY = fabsf( velocityVsBoundingY );
-			if( absVelocityVsBoundingY > 1.0f )
-			{
-				uint numberOfIncrements = (uint)( roundf( absVelocityVsBoundingY + 0.5f ) );
-				const float velocityIncrements = velocityY / numberOfIncrements;
-				uint i = 0;
-				do
-				{
-					collidedWith = applyVerticalVelocity( velocityIncrements );
-					i++;
-				} while( i < numberOfIncrements && collidedWith == NULL );
-			}
-			else
-			{
-				collidedWith = applyVerticalVelocity( velocityY );
-			}
-		}
-		else
-		{
-			const float velocityVsBoundingY = velocityY * inverseCollisionSize.height;
-			const float absVelocityVsBoundingY = fabsf( velocityVsBoundingY );
-			if( absVelocityVsBoundingY > 1.0f )
-			{
-				uint numberOfIncrements = (uint)( roundf( absVelocityVsBoundingY + 0.5f ) );
-				const float velocityIncrements = velocityY / numberOfIncrements;
-				uint i = 0;
-				do
-				{
-					collidedWith = applyVerticalVelocity( velocityIncrements );
-					i++;
-				} while( i < numberOfIncrements && collidedWith == NULL );
-			}
-			else
-			{
-				collidedWith = applyVerticalVelocity( velocityY );
-			}
-		}
+        if( swept == false || applySweptVerticalVelocity( velocityY, candidates, numberOfCandidates, collidedWith ) == false )
+        {
+            const float velocityVsBoundingY = velocityY * inverseCollisionSize.height;
+            const float absVelocityVsBoundingY = fabsf( velocityVsBoundingY );
+            if( absVelocityVsBoundingY > 1.0f )
+            {
+                uint numberOfIncrements = (uint)( roundf( absVelocityVsBoundingY + 0.5f ) );
+                const float velocityIncrements = velocityY / numberOfIncrements;
+                uint i = 0;
+                do
+                {
+                    collidedWith = applyVerticalVelocity( velocityIncrements );
+                    i++;
+                } while( i < numberOfIncrements && collidedWith == NULL );
+            }
+            else
+            {
+                collidedWith = applyVerticalVelocity( velocityY );
+            }
+        }
 
 		reportVerticalCollision( collidedWith );
 
@@ -329,6 +343,157 @@ CCCollideable* CCMoveable::applyVerticalVelocity(const float increment)
 }
 
 
+// Moves up to the face we hit, leaving the same gap getCollisionPosition does
+static float SweptContactPosition(const float position, const float movement, const float bounds, const float targetMin, const float targetMax)
+{
+    if( movement > 0.0f )
+    {
+        return MAX( position, MIN( position + movement, targetMin - bounds - CC_SMALLFLOAT ) );
+    }
+    return MIN( position, MAX( position + movement, targetMax + bounds + CC_SMALLFLOAT ) );
+}
+
+
+CCCollideable* CCMoveable::sweepCollision(const CCVector3 &movement, CCCollideable * const *candidates, const int numberOfCandidates,
+                                          CCCollideable *&hitObject, float &hitTime, int &hitAxis)
+{
+    const CCVector3 sourceMin( position.x - collisionBounds.x, position.y - collisionBounds.y, position.z - collisionBounds.z );
+    const CCVector3 sourceMax( position.x + collisionBounds.x, position.y + collisionBounds.y, position.z + collisionBounds.z );
+
+    // Visit the hits in order of time, then address, until one accepts the collision
+    float afterTime = -1.0f;
+    const CCCollideable *afterObject = NULL;
+    while( true )
+    {
+        hitObject = NULL;
+        for( int i=0; i<numberOfCandidates; ++i )
+        {
+            CCCollideable *checkingObject = candidates[i];
+            if( checkingObject == NULL || checkingObject == this || checkingObject->isActive() == false )
+            {
+                continue;
+            }
+
+            if( CCHasFlag( checkingObject->collideableType, collision_ui ) || CCHasFlag( checkingObject->collideableType, collision_box ) == false )
+            {
+                continue;
+            }
+
+            CCUpdateCollisions( checkingObject );
+            float time;
+            int axis;
+            if( CCSweptBoxCollisionCheck( sourceMin, sourceMax, movement, checkingObject->aabbMin, checkingObject->aabbMax, time, axis ) )
+            {
+                if( time < afterTime || ( time == afterTime && checkingObject <= afterObject ) )
+                {
+                    continue;
+                }
+
+                if( hitObject == NULL || time < hitTime || ( time == hitTime && checkingObject < hitObject ) )
+                {
+                    if( shouldCollide( checkingObject, true ) )
+                    {
+                        hitObject = checkingObject;
+                        hitTime = time;
+                        hitAxis = axis;
+                    }
+                }
+            }
+        }
+
+        // Starting inside something is left to the sub-stepped checks
+        if( hitObject == NULL || hitAxis == -1 )
+        {
+            return NULL;
+        }
+
+        CCCollideable *collidedWith = requestCollisionWith( hitObject );
+        if( collidedWith != NULL )
+        {
+            return collidedWith;
+        }
+
+        afterTime = hitTime;
+        afterObject = hitObject;
+    }
+}
+
+
+bool CCMoveable::applySweptHorizontalVelocity(const float velocityX, const float velocityZ,
+                                              CCCollideable * const *candidates, const int numberOfCandidates,
+                                              CCCollideable *&collidedWith)
+{
+    CCCollideable *hitObject;
+    float hitTime;
+    int hitAxis;
+    collidedWith = sweepCollision( CCVector3( velocityX, 0.0f, velocityZ ), candidates, numberOfCandidates, hitObject, hitTime, hitAxis );
+    if( hitObject != NULL && hitAxis == -1 )
+    {
+        return false;
+    }
+
+    if( collidedWith == NULL )
+    {
+        position.x += velocityX;
+        position.z += velocityZ;
+        return true;
+    }
+
+    // Stop at the face we hit
+    const float blockedVelocity = hitAxis == 0 ? velocityX : velocityZ;
+    float &blockedPosition = (&position.x)[hitAxis];
+    blockedPosition = SweptContactPosition( blockedPosition, blockedVelocity, (&collisionBounds.x)[hitAxis],
+                                            (&hitObject->aabbMin.x)[hitAxis], (&hitObject->aabbMax.x)[hitAxis] );
+    (&additionalVelocity.x)[hitAxis] = 0.0f;
+
+    // And slide along it
+    const int slideAxis = hitAxis == 0 ? 2 : 0;
+    const float slideVelocity = slideAxis == 0 ? velocityX : velocityZ;
+    if( slideVelocity != 0.0f )
+    {
+        CCVector3 slide;
+        (&slide.x)[slideAxis] = slideVelocity;
+        if( sweepCollision( slide, candidates, numberOfCandidates, hitObject, hitTime, hitAxis ) != NULL )
+        {
+            float &slidePosition = (&position.x)[slideAxis];
+            slidePosition = SweptContactPosition( slidePosition, slideVelocity, (&collisionBounds.x)[slideAxis],
+                                                  (&hitObject->aabbMin.x)[slideAxis], (&hitObject->aabbMax.x)[slideAxis] );
+            (&additionalVelocity.x)[slideAxis] = 0.0f;
+        }
+        else if( hitObject == NULL )
+        {
+            (&position.x)[slideAxis] += slideVelocity;
+        }
+    }
+
+    return true;
+}
+
+
+bool CCMoveable::applySweptVerticalVelocity(const float velocityY,
+                                            CCCollideable * const *candidates, const int numberOfCandidates,
+                                            CCCollideable *&collidedWith)
+{
+    CCCollideable *hitObject;
+    float hitTime;
+    int hitAxis;
+    collidedWith = sweepCollision( CCVector3( 0.0f, velocityY, 0.0f ), candidates, numberOfCandidates, hitObject, hitTime, hitAxis );
+    if( hitObject != NULL && hitAxis == -1 )
+    {
+        return false;
+    }
+
+    if( collidedWith == NULL )
+    {
+        position.y += velocityY;
+        return true;
+    }
+
+    position.y = SweptContactPosition( position.y, velocityY, collisionBounds.y, hitObject->aabbMin.y, hitObject->aabbMax.y );
+    return true;
+}
+
+
 void CCMoveable::reportVerticalCollision(const CCCollideable *collidedWith)
 {
 	if( collidedWith )
@@ -24,6 +24,7 @@ public:
 	// CCCollideable
 	virtual CCCollideable* requestCollisionWith(CCCollideable *collidedWith);
     virtual bool isMoveable() { return true; }
+    virtual float getBroadphaseMargin(const float delta);
 
 	virtual void updateMovement(const float delta);
     virtual float applyMovementDirection(const float delta);
@@ -33,6 +34,23 @@ public:
 	CCCollideable* applyHorizontalVelocity(const float velocityX, const float velocityZ);
 	CCCollideable* applyVerticalVelocity(const float increment);
 
+    // Continuous versions tested against the broadphase candidates, returns false if the move
+    // starts inside another object and should be sub-stepped instead
+    bool applySweptHorizontalVelocity(const float velocityX, const float velocityZ,
+                                      CCCollideable * const *candidates, const int numberOfCandidates,
+                                      CCCollideable *&collidedWith);
+    bool applySweptVerticalVelocity(const float velocityY,
+                                    CCCollideable * const *candidates, const int numberOfCandidates,
+                                    CCCollideable *&collidedWith);
+
+protected:
+    // Finds the earliest candidate along the movement that accepts our collision request
+    // hitObject is set to what we hit, or to what we started inside of if hitAxis is -1
+    CCCollideable* sweepCollision(const CCVector3 &movement, CCCollideable * const *candidates, const int numberOfCandidates,
+                                  CCCollideable *&hitObject, float &hitTime, int &hitAxis);
+
+public:
+
 	virtual void reportVerticalCollision(const CCCollideable *collidedWith);
 
 	static void setGravityForce(const float force) { gravityForce = force; }
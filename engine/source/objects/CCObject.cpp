@@ -74,6 +74,12 @@ void CCObject::dirtyWorldMatrix()
 {
     super::dirtyWorldMatrix();
 
+    // The transform store passes it on to our children in its update
+    if( transformIndex != -1 )
+    {
+        return;
+    }
+
     for( int i=0; i<children.length; ++i )
     {
         children.list[i]->dirtyWorldMatrix();
@@ -113,6 +119,18 @@ void CCObject::addChild(CCObject *object, const int index)
 
     object->parent = this;
 
+    if( transformIndex != -1 )
+    {
+        if( object->transformIndex == -1 )
+        {
+            object->bindTransforms();
+        }
+        else
+        {
+            gEngine->transformStore->setParent( object->transformIndex, transformIndex );
+        }
+    }
+
     if( transparentParent == false )
     {
         if( object->transparentParent )
@@ -127,6 +145,11 @@ bool CCObject::removeChild(CCObject *object)
 {
     if( children.remove( object ) )
     {
+        if( object->transformIndex != -1 )
+        {
+            gEngine->transformStore->setParent( object->transformIndex, -1 );
+        }
+
         if( children.length == 0 )
         {
             children.freeList();
@@ -139,6 +162,21 @@ bool CCObject::removeChild(CCObject *object)
 }
 
 
+void CCObject::bindTransforms()
+{
+    bindTransform( parent != NULL ? parent->transformIndex : -1 );
+
+    for( int i=0; i<children.length; ++i )
+    {
+        CCObject *child = children.list[i];
+        if( child->transformIndex == -1 )
+        {
+            child->bindTransforms();
+        }
+    }
+}
+
+
 void CCObject::moveChildToScene(CCObject *object, CCSceneBase *scene)
 {
     object->translate( &position );
@@ -65,6 +65,9 @@ public:
     void addChild(CCObject *object, const int index=-1);
     bool removeChild(CCObject *object);
 
+    // Binds us and then our children to the engine's transform store
+    void bindTransforms();
+
     // Remove an object from our child list and add it into the scene
     void moveChildToScene(CCObject *object, CCSceneBase *scene);
 
@@ -9,23 +9,32 @@
 
 #include "CCDefines.h"
 #include "CCRenderable.h"
+#include "CCTransformStore.h"
 
 
 CCRenderable::CCRenderable()
 {
     renderable = true;
 
+    transformIndex = -1;
     dirtyModelMatrix();
     updateWorldMatrix = true;
 
 	scale = NULL;
+    quaternion = NULL;
     colour = NULL;
 }
 
 
 void CCRenderable::destruct()
 {
-    DELETE_POINTER( scale );
+    if( transformIndex != -1 )
+    {
+        gEngine->transformStore->remove( transformIndex );
+    }
+
+    FREE_POINTER( scale );
+    FREE_POINTER( quaternion );
 
     DELETE_POINTER( colour );
 }
@@ -34,6 +43,18 @@ void CCRenderable::destruct()
 void CCRenderable::dirtyModelMatrix()
 {
     updateModelMatrix = true;
+
+    if( transformIndex != -1 )
+    {
+        if( quaternion != NULL )
+        {
+            gEngine->transformStore->setTransform( transformIndex, position, *quaternion, scale );
+        }
+        else
+        {
+            gEngine->transformStore->setTransform( transformIndex, position, rotation, scale );
+        }
+    }
 }
 
 
@@ -45,6 +66,28 @@ void CCRenderable::dirtyWorldMatrix()
 
 void CCRenderable::refreshModelMatrix()
 {
+    if( transformIndex != -1 )
+    {
+        if( updateModelMatrix )
+        {
+            modelMatrix = gEngine->transformStore->refreshLocalMatrix( transformIndex );
+            updateModelMatrix = false;
+            dirtyWorldMatrix();
+        }
+        return;
+    }
+
+    if( quaternion != NULL )
+    {
+        if( updateModelMatrix )
+        {
+            CCMatrixCompose( modelMatrix, position, *quaternion, scale );
+            updateModelMatrix = false;
+            dirtyWorldMatrix();
+        }
+        return;
+    }
+
 	if( updateModelMatrix )
 	{
 		CCMatrixLoadIdentity( modelMatrix );
@@ -80,6 +123,13 @@ void CCRenderable::refreshWorldMatrix(const CCMatrix *parentMatrix)
 {
     refreshModelMatrix();
 
+    // The store already knows who our parent is, and our parents don't tell us when they move
+    if( transformIndex != -1 )
+    {
+        worldMatrix = gEngine->transformStore->refreshWorldMatrix( transformIndex );
+        return;
+    }
+
 	if( updateWorldMatrix )
 	{
         if( parentMatrix )
@@ -94,6 +144,14 @@ void CCRenderable::refreshWorldMatrix(const CCMatrix *parentMatrix)
 }
 
 
+void CCRenderable::bindTransform(const int parentIndex)
+{
+    CCASSERT( transformIndex == -1 && gEngine->transformStore != NULL );
+    gEngine->transformStore->add( this, parentIndex );
+    dirtyModelMatrix();
+}
+
+
 void CCRenderable::setPosition(const CCVector3 &vector)
 {
     setPositionXYZ( vector.x, vector.y, vector.z );
@@ -162,6 +220,10 @@ void CCRenderable::translate(const float x, const float y, const float z)
 
 void CCRenderable::rotationUpdated()
 {
+    if( quaternion != NULL )
+    {
+        CCQuaternionFromEuler( *quaternion, rotation );
+    }
     dirtyModelMatrix();
 }
 
@@ -204,6 +266,40 @@ void CCRenderable::rotateZ(const float z)
 }
 
 
+void CCRenderable::enableQuaternionRotation(const bool toggle)
+{
+    if( toggle )
+    {
+        if( quaternion == NULL )
+        {
+            CCQuaternionFillPtr( &quaternion, CCQuaternion() );
+            rotationUpdated();
+        }
+    }
+    else if( quaternion != NULL )
+    {
+        FREE_POINTER( quaternion );
+        dirtyModelMatrix();
+    }
+}
+
+
+void CCRenderable::setRotation(const CCQuaternion &value)
+{
+    CCQuaternionFillPtr( &quaternion, value );
+    quaternion->normalise();
+    quaternionUpdated();
+}
+
+
+void CCRenderable::quaternionUpdated()
+{
+    CCASSERT( quaternion != NULL );
+    CCQuaternionToEuler( rotation, *quaternion );
+    dirtyModelMatrix();
+}
+
+
 void CCRenderable::setScale(const float value)
 {
     setScale( value, value, value );
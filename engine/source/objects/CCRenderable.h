@@ -17,6 +17,8 @@
 
 class CCRenderable : public CCBaseType
 {
+    friend class CCTransformStore;
+
 protected:
     long jsID;          // Used for js communication
                         // Note: If we create 300 objects a second we'll run out of ids after 82 days (2147483647/300)/60/60/24
@@ -31,12 +33,18 @@ protected:
     CCMatrix worldMatrix;
     bool updateWorldMatrix;
 
+    // Our transform in the engine's transform store, or -1 when we build our own matrices
+    int transformIndex;
+
 	CCColour *colour;
 
 public:
     CCVector3 rotation;
     CCVector3 *scale;
 
+    // Set while rotating by quaternion, rotation is then kept in sync for anything reading the angles
+    CCQuaternion *quaternion;
+
 
 public:
     typedef CCBaseType super;
@@ -68,6 +76,12 @@ public:
     void refreshWorldMatrix(const CCMatrix *parentMatrix);
 
     CCMatrix& getModelMatrix() { return modelMatrix; }
+    const CCMatrix& getWorldMatrix() const { return worldMatrix; }
+
+    // Hands our matrices over to the engine's transform store, our setters then write through to it
+    // Note: Overrides of refreshModelMatrix still render their own model matrix, but their store copy won't include their changes
+    void bindTransform(const int parentIndex);
+    int getTransformIndex() const { return transformIndex; }
 
     inline const CCVector3& getConstPosition() const { return position; }
     inline CCVector3& getPosition() { return position; }
@@ -90,6 +104,13 @@ public:
     void rotateY(const float y);
     void rotateZ(const float z);
 
+    // Switches our model matrix to being built from a quaternion, starting from our current angles
+    void enableQuaternionRotation(const bool toggle);
+    void setRotation(const CCQuaternion &value);
+
+    // Call after writing to quaternion directly, such as from an interpolator
+    void quaternionUpdated();
+
     void setScale(const float value);
     void setScale(const float x, const float y, const float z);
 
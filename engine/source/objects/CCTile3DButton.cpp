@@ -325,8 +325,7 @@ void CCTile3DButton::setTileTexturedSize()
 		OnLoadCallback(CCTile3DButton *tile)
 		{
 			this->tile = tile;
-			this->lazyPointer = tile->lazyPointer;
-			this->lazyID = tile->lazyID;
+			this->activeHandle = tile->activeHandle;
 		}
 	protected:
 		void run()
@@ -357,8 +356,7 @@ void CCTile3DButton::setTileTexturedWidth(const float width)
 		OnLoadCallback(CCTile3DButton *tile, float width)
 		{
 			this->tile = tile;
-			this->lazyPointer = tile->lazyPointer;
-			this->lazyID = tile->lazyID;
+			this->activeHandle = tile->activeHandle;
 			this->width = width;
 		}
 	protected:
@@ -391,8 +389,7 @@ void CCTile3DButton::setTileTexturedHeight(const float height)
 		OnLoadCallback(CCTile3DButton *tile, float height)
 		{
 			this->tile = tile;
-			this->lazyPointer = tile->lazyPointer;
-			this->lazyID = tile->lazyID;
+			this->activeHandle = tile->activeHandle;
 			this->height = height;
 		}
 	protected:
@@ -425,8 +422,7 @@ void CCTile3DButton::setTileTexturedFit(const float width, const float height, c
 		OnLoadCallback(CCTile3DButton *tile, float width, float height, bool crop)
 		{
 			this->tile = tile;
-			this->lazyPointer = tile->lazyPointer;
-			this->lazyID = tile->lazyID;
+			this->activeHandle = tile->activeHandle;
 			this->width = width;
 			this->height = height;
 			this->crop = crop;
@@ -0,0 +1,267 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCHeadlessRenderer.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCHeadlessRenderer.h"
+#include "CCFileManager.h"
+
+
+CCHeadlessRenderer::CCHeadlessRenderer(const float width, const float height)
+{
+    headlessSize.width = width;
+    headlessSize.height = height;
+
+    recording = false;
+    commands = NULL;
+    commandsLength = 0;
+    commandsAllocated = 0;
+
+    nextUniformLocation = 0;
+
+    nextBufferName = 0;
+    boundArrayBuffer = 0;
+}
+
+
+CCHeadlessRenderer::~CCHeadlessRenderer()
+{
+    FREE_POINTER( commands );
+}
+
+
+void CCHeadlessRenderer::beginFrame()
+{
+    stats.reset();
+    commandsLength = 0;
+}
+
+
+void CCHeadlessRenderer::record(const CCRenderCommandType type, const int param1, const int param2, const int param3)
+{
+    stats.commands[type]++;
+
+    if( recording )
+    {
+        if( commandsLength == commandsAllocated )
+        {
+            commandsAllocated = commandsAllocated == 0 ? 1024 : commandsAllocated * 2;
+            commands = (CCRenderCommand*)realloc( commands, sizeof( CCRenderCommand ) * commandsAllocated );
+            CCASSERT( commands != NULL );
+        }
+
+        CCRenderCommand &command = commands[commandsLength++];
+        command.type = type;
+        command.params[0] = param1;
+        command.params[1] = param2;
+        command.params[2] = param3;
+    }
+}
+
+
+void CCHeadlessRenderer::GLClearColor(const float r, const float g, const float b, const float a)
+{
+    clearColour.red = r;
+    clearColour.green = g;
+    clearColour.blue = b;
+    clearColour.alpha = a;
+    record( command_clearColour );
+}
+
+
+void CCHeadlessRenderer::GLClear(const bool colour)
+{
+    record( command_clear, colour ? 1 : 0 );
+}
+
+
+void CCHeadlessRenderer::GLViewport(const GLint x, const GLint y, const GLsizei width, const GLsizei height)
+{
+    if( viewportX != x || viewportY != y || viewportWidth != width || viewportHeight != height )
+    {
+        viewportX = x;
+        viewportY = y;
+        viewportWidth = width;
+        viewportHeight = height;
+        record( command_viewport, width, height );
+    }
+}
+
+
+void CCHeadlessRenderer::GLScissor(const GLint x, const GLint y, const GLsizei width, const GLsizei height)
+{
+    if( scissorX != x || scissorY != y || scissorWidth != width || scissorHeight != height )
+    {
+        scissorX = x;
+        scissorY = y;
+        scissorWidth = width;
+        scissorHeight = height;
+        record( command_scissor, width, height );
+    }
+}
+
+
+void CCHeadlessRenderer::GLEnable(const GLenum cap)
+{
+    stats.stateChanges++;
+    record( command_enable, cap );
+}
+
+
+void CCHeadlessRenderer::GLDisable(const GLenum cap)
+{
+    stats.stateChanges++;
+    record( command_disable, cap );
+}
+
+
+void CCHeadlessRenderer::GLDepthMask(const bool toggle)
+{
+    stats.stateChanges++;
+    record( command_depthMask, toggle ? 1 : 0 );
+}
+
+
+void CCHeadlessRenderer::GLCullFace(const GLenum mode)
+{
+    stats.stateChanges++;
+    record( command_cullFace, mode );
+}
+
+
+void CCHeadlessRenderer::GLBindTexture(const GLenum mode, const CCTextureName *texture)
+{
+    record( command_bindTexture, mode, texture != NULL ? texture->name() : 0 );
+}
+
+
+GLuint CCHeadlessRenderer::GLGenBuffer()
+{
+    return ++nextBufferName;
+}
+
+
+void CCHeadlessRenderer::GLDeleteBuffer(const GLuint buffer)
+{
+    if( boundArrayBuffer == buffer )
+    {
+        boundArrayBuffer = 0;
+    }
+    record( command_deleteBuffer, buffer );
+}
+
+
+void CCHeadlessRenderer::GLBindBuffer(const GLenum target, const GLuint buffer)
+{
+    if( target == GL_ARRAY_BUFFER )
+    {
+        boundArrayBuffer = buffer;
+    }
+    record( command_bindBuffer, target, buffer );
+}
+
+
+void CCHeadlessRenderer::GLBufferData(const GLenum target, const uint size, const void *data, const GLenum usage)
+{
+    // Orphaning passes no data
+    if( data != NULL )
+    {
+        stats.uploadedBytes += size;
+    }
+    record( command_bufferData, target, size, usage );
+}
+
+
+void CCHeadlessRenderer::GLBufferSubData(const GLenum target, const uint offset, const uint size, const void *data)
+{
+    stats.uploadedBytes += size;
+    record( command_bufferSubData, target, offset, size );
+}
+
+
+void CCHeadlessRenderer::GLDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    stats.vertices += count;
+    record( command_drawArrays, mode, first, count );
+}
+
+
+void CCHeadlessRenderer::GLDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+{
+    stats.indices += count;
+    record( command_drawElements, mode, count, type );
+}
+
+
+void CCHeadlessRenderer::GLVertexAttribPointer(uint index, int size, GLenum type, bool normalized, int stride, const void *pointer, const GLsizei count)
+{
+    if( boundArrayBuffer == 0 )
+    {
+        stats.clientArrayBytes += count * ( stride > 0 ? stride : size * sizeof( float ) );
+    }
+    record( command_vertexAttribPointer, index, size, count );
+}
+
+
+void CCHeadlessRenderer::GLUniform3fv(int location, int count, const GLfloat *value)
+{
+    record( command_uniform3fv, location, count );
+}
+
+
+void CCHeadlessRenderer::GLUniform4fv(int location, int count, const GLfloat *value)
+{
+    record( command_uniform4fv, location, count );
+}
+
+
+void CCHeadlessRenderer::GLUniformMatrix4fv(int location, int count, bool transpose, const GLfloat value[4][4])
+{
+    record( command_uniformMatrix4fv, location, count );
+}
+
+
+int CCHeadlessRenderer::getShaderUniformLocation(const char *name)
+{
+    // Only report the uniforms the shader declares, so we set the same uniforms as a device would
+    if( shaderSource.length > 0 && CCText::Contains( shaderSource.buffer, name ) == false )
+    {
+        return -1;
+    }
+    return nextUniformLocation++;
+}
+
+
+bool CCHeadlessRenderer::loadShader(CCShader *shader)
+{
+    CCText path = shader->name;
+    path += ".fx";
+    shaderSource.setSize( 0 );
+    CCFileManager::GetFile( path.buffer, shaderSource, Resource_Packaged, false );
+
+    shader->program = 0;
+    return true;
+}
+
+
+bool CCHeadlessRenderer::createDefaultFrameBuffer(CCFrameBufferObject &fbo)
+{
+    fbo.setFrameBuffer( 0 );
+    fbo.renderBuffer = 0;
+    fbo.depthBuffer = 0;
+    fbo.stencilBuffer = 0;
+    fbo.width = (int)headlessSize.width;
+    fbo.height = (int)headlessSize.height;
+    return true;
+}
+
+
+void CCHeadlessRenderer::refreshScreenSize()
+{
+    screenSize = headlessSize;
+}
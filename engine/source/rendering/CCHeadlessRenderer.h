@@ -0,0 +1,167 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCHeadlessRenderer.h
+ * Description : Null renderer which counts and records commands instead of drawing.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCHEADLESSRENDERER_H__
+#define __CCHEADLESSRENDERER_H__
+
+
+#include "CCRenderer.h"
+
+
+enum CCRenderCommandType
+{
+    command_clearColour,
+    command_clear,
+    command_viewport,
+    command_scissor,
+    command_enable,
+    command_disable,
+    command_depthMask,
+    command_cullFace,
+    command_bindTexture,
+    command_bindBuffer,
+    command_bufferData,
+    command_bufferSubData,
+    command_deleteBuffer,
+    command_drawArrays,
+    command_drawElements,
+    command_vertexAttribPointer,
+    command_uniform3fv,
+    command_uniform4fv,
+    command_uniformMatrix4fv,
+    command_max
+};
+
+
+struct CCRenderCommand
+{
+    CCRenderCommandType type;
+    int params[3];
+};
+
+
+// Totals of the commands issued since the last beginFrame
+struct CCRenderStats
+{
+    CCRenderStats()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for( uint i=0; i<command_max; ++i )
+        {
+            commands[i] = 0;
+        }
+        vertices = 0;
+        indices = 0;
+        stateChanges = 0;
+        uploadedBytes = 0;
+        clientArrayBytes = 0;
+    }
+
+    uint drawCalls() const { return commands[command_drawArrays] + commands[command_drawElements]; }
+
+    uint commands[command_max];
+    uint vertices;
+    uint indices;
+
+    // Enable, disable, depth mask and cull face changes issued by CCSetRenderStates
+    uint stateChanges;
+
+    // Bytes copied into buffer objects
+    uint uploadedBytes;
+
+    // Bytes of attribute arrays read from client memory, only known for attributes passed with a vertex count
+    uint clientArrayBytes;
+};
+
+
+// Used on machines without a GPU, such as build farms running benchmarks
+// Non-virtual GL entry points (texture uploads, shader binds) still require a GL library to link against, such as OSMesa or a stub
+class CCHeadlessRenderer : public CCRenderer
+{
+    typedef CCRenderer super;
+
+public:
+    CCHeadlessRenderer(const float width=1280.0f, const float height=720.0f);
+    virtual ~CCHeadlessRenderer();
+
+    // Resets the frame's stats and recorded commands
+    void beginFrame();
+
+    // Record every command issued rather than just counting them
+    void setRecording(const bool toggle) { recording = toggle; }
+
+    const CCRenderStats& getStats() const { return stats; }
+    const CCRenderCommand* getCommands() const { return commands; }
+    int getNumberOfCommands() const { return commandsLength; }
+
+    // CCRenderer
+    virtual void GLClearColor(const float r, const float g, const float b, const float a);
+    virtual void GLClear(const bool colour);
+    virtual void GLViewport(const GLint x, const GLint y, const GLsizei width, const GLsizei height);
+    virtual void GLScissor(const GLint x, const GLint y, const GLsizei width, const GLsizei height);
+    virtual void GLEnable(const GLenum cap);
+    virtual void GLDisable(const GLenum cap);
+    virtual void GLDepthMask(const bool toggle);
+
+    virtual void GLCullFace(const GLenum mode);
+
+    virtual void GLBindTexture(const GLenum mode, const CCTextureName *texture);
+
+    virtual GLuint GLGenBuffer();
+    virtual void GLDeleteBuffer(const GLuint buffer);
+    virtual void GLBindBuffer(const GLenum target, const GLuint buffer);
+    virtual void GLBufferData(const GLenum target, const uint size, const void *data, const GLenum usage);
+    virtual void GLBufferSubData(const GLenum target, const uint offset, const uint size, const void *data);
+
+    virtual void GLDrawArrays(GLenum mode, GLint first, GLsizei count);
+    virtual void GLDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices);
+
+    virtual void GLVertexAttribPointer(uint index, int size, GLenum type, bool normalized, int stride, const void *pointer, const GLsizei count);
+
+    virtual void GLUniform3fv(int location, int count, const GLfloat *value);
+    virtual void GLUniform4fv(int location, int count, const GLfloat *value);
+    virtual void GLUniformMatrix4fv(int location, int count, bool transpose, const GLfloat value[4][4]);
+
+protected:
+    virtual int getShaderUniformLocation(const char *name);
+    virtual bool loadShader(CCShader *shader);
+
+    virtual bool createDefaultFrameBuffer(CCFrameBufferObject &fbo);
+    virtual void refreshScreenSize();
+
+    void record(const CCRenderCommandType type, const int param1=0, const int param2=0, const int param3=0);
+
+protected:
+    CCSize headlessSize;
+
+    CCRenderStats stats;
+
+    GLuint nextBufferName;
+    GLuint boundArrayBuffer;
+
+    bool recording;
+    CCRenderCommand *commands;
+    int commandsLength;
+    int commandsAllocated;
+
+    // Source of the shader being loaded, used to only report uniforms a real device would find
+    CCData shaderSource;
+    int nextUniformLocation;
+};
+
+
+#endif // __CCHEADLESSRENDERER_H__
@@ -0,0 +1,372 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCIndexedMesh.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCIndexedMesh.h"
+
+
+CCIndexedMesh::CCIndexedMesh()
+{
+    vertices = NULL;
+    normals = NULL;
+    uvs = NULL;
+    vertexCount = 0;
+
+    indices = NULL;
+    indexCount = 0;
+}
+
+
+CCIndexedMesh::~CCIndexedMesh()
+{
+    FREE_POINTER( vertices );
+    FREE_POINTER( normals );
+    FREE_POINTER( uvs );
+    FREE_POINTER( indices );
+}
+
+
+static inline uint HashFloats(uint hash, const float *values, const int count)
+{
+    // FNV-1a over the bits
+    for( int i=0; i<count; ++i )
+    {
+        union { float f; uint u; } bits;
+        bits.f = values[i];
+        hash = ( hash ^ bits.u ) * 16777619u;
+    }
+    return hash;
+}
+
+
+static inline void CopyVertex(float *destination, const float *source, const int count)
+{
+    for( int i=0; i<count; ++i )
+    {
+        // Adding zero turns -0 into 0, so they weld together
+        destination[i] = source[i] + 0.0f;
+    }
+}
+
+
+bool CCMeshWeld(CCIndexedMesh &mesh, const float *vertices, const float *normals, const float *uvs, const uint soupCount)
+{
+    if( vertices == NULL || soupCount == 0 )
+    {
+        return false;
+    }
+
+    uint tableSize = 16;
+    while( tableSize < soupCount * 2 )
+    {
+        tableSize *= 2;
+    }
+    const uint tableMask = tableSize - 1;
+    int *table = (int*)malloc( sizeof( int ) * tableSize );
+    memset( table, -1, sizeof( int ) * tableSize );
+
+    mesh.vertices = (float*)malloc( sizeof( float ) * soupCount * 3 );
+    mesh.normals = normals != NULL ? (float*)malloc( sizeof( float ) * soupCount * 3 ) : NULL;
+    mesh.uvs = uvs != NULL ? (float*)malloc( sizeof( float ) * soupCount * 2 ) : NULL;
+    mesh.indices = (uint*)malloc( sizeof( uint ) * soupCount );
+    mesh.vertexCount = 0;
+    mesh.indexCount = soupCount;
+
+    for( uint i=0; i<soupCount; ++i )
+    {
+        float vertex[3], normal[3], uv[2];
+        CopyVertex( vertex, &vertices[i*3], 3 );
+        uint hash = HashFloats( 2166136261u, vertex, 3 );
+        if( normals != NULL )
+        {
+            CopyVertex( normal, &normals[i*3], 3 );
+            hash = HashFloats( hash, normal, 3 );
+        }
+        if( uvs != NULL )
+        {
+            CopyVertex( uv, &uvs[i*2], 2 );
+            hash = HashFloats( hash, uv, 2 );
+        }
+
+        uint slot = hash & tableMask;
+        int index = -1;
+        while( table[slot] != -1 )
+        {
+            const int candidate = table[slot];
+            if( memcmp( &mesh.vertices[candidate*3], vertex, sizeof( vertex ) ) == 0 &&
+                ( normals == NULL || memcmp( &mesh.normals[candidate*3], normal, sizeof( normal ) ) == 0 ) &&
+                ( uvs == NULL || memcmp( &mesh.uvs[candidate*2], uv, sizeof( uv ) ) == 0 ) )
+            {
+                index = candidate;
+                break;
+            }
+            slot = ( slot + 1 ) & tableMask;
+        }
+
+        if( index == -1 )
+        {
+            index = mesh.vertexCount++;
+            table[slot] = index;
+            memcpy( &mesh.vertices[index*3], vertex, sizeof( vertex ) );
+            if( normals != NULL )
+            {
+                memcpy( &mesh.normals[index*3], normal, sizeof( normal ) );
+            }
+            if( uvs != NULL )
+            {
+                memcpy( &mesh.uvs[index*2], uv, sizeof( uv ) );
+            }
+        }
+        mesh.indices[i] = index;
+    }
+
+    free( table );
+
+    // Give back what welding saved
+    mesh.vertices = (float*)realloc( mesh.vertices, sizeof( float ) * mesh.vertexCount * 3 );
+    if( mesh.normals != NULL )
+    {
+        mesh.normals = (float*)realloc( mesh.normals, sizeof( float ) * mesh.vertexCount * 3 );
+    }
+    if( mesh.uvs != NULL )
+    {
+        mesh.uvs = (float*)realloc( mesh.uvs, sizeof( float ) * mesh.vertexCount * 2 );
+    }
+    return true;
+}
+
+
+// Tipsify's next fanning vertex once the current one's triangles are all emitted
+static int SkipDeadEnd(const int *liveTriangles, int *deadEnds, uint &deadEndsLength, uint &cursor, const uint vertexCount)
+{
+    // Recently used vertices which still have triangles left
+    while( deadEndsLength > 0 )
+    {
+        const int vertex = deadEnds[--deadEndsLength];
+        if( liveTriangles[vertex] > 0 )
+        {
+            return vertex;
+        }
+    }
+
+    // Otherwise the next vertex in input order with triangles left
+    while( cursor < vertexCount )
+    {
+        if( liveTriangles[cursor] > 0 )
+        {
+            return cursor;
+        }
+        cursor++;
+    }
+    return -1;
+}
+
+
+void CCMeshOptimiseVertexCache(uint *indices, const uint indexCount, const uint vertexCount, const uint cacheSize)
+{
+    const uint triangleCount = indexCount / 3;
+    if( triangleCount < 2 || vertexCount == 0 )
+    {
+        return;
+    }
+
+    // Triangles using each vertex
+    int *liveTriangles = (int*)calloc( vertexCount, sizeof( int ) );
+    for( uint i=0; i<triangleCount*3; ++i )
+    {
+        liveTriangles[indices[i]]++;
+    }
+
+    uint *offsets = (uint*)malloc( sizeof( uint ) * ( vertexCount + 1 ) );
+    offsets[0] = 0;
+    for( uint i=0; i<vertexCount; ++i )
+    {
+        offsets[i+1] = offsets[i] + liveTriangles[i];
+    }
+
+    uint *fill = (uint*)malloc( sizeof( uint ) * vertexCount );
+    memcpy( fill, offsets, sizeof( uint ) * vertexCount );
+    uint *adjacency = (uint*)malloc( sizeof( uint ) * triangleCount * 3 );
+    for( uint i=0; i<triangleCount*3; ++i )
+    {
+        adjacency[fill[indices[i]]++] = i / 3;
+    }
+    free( fill );
+
+    // Time each vertex was last put in the cache
+    uint *cacheTimes = (uint*)calloc( vertexCount, sizeof( uint ) );
+    uint time = cacheSize + 1;
+
+    bool *emitted = (bool*)calloc( triangleCount, sizeof( bool ) );
+    int *deadEnds = (int*)malloc( sizeof( int ) * triangleCount * 3 );
+    uint deadEndsLength = 0;
+    int *candidates = (int*)malloc( sizeof( int ) * triangleCount * 3 );
+
+    uint *output = (uint*)malloc( sizeof( uint ) * triangleCount * 3 );
+    uint outputLength = 0;
+
+    uint cursor = 0;
+    int fanning = 0;
+    while( fanning >= 0 )
+    {
+        uint candidatesLength = 0;
+        for( uint i=offsets[fanning]; i<offsets[fanning+1]; ++i )
+        {
+            const uint triangle = adjacency[i];
+            if( emitted[triangle] == false )
+            {
+                for( int j=0; j<3; ++j )
+                {
+                    const uint vertex = indices[triangle*3+j];
+                    output[outputLength++] = vertex;
+                    deadEnds[deadEndsLength++] = vertex;
+                    candidates[candidatesLength++] = vertex;
+                    liveTriangles[vertex]--;
+                    if( time - cacheTimes[vertex] > cacheSize )
+                    {
+                        cacheTimes[vertex] = time++;
+                    }
+                }
+                emitted[triangle] = true;
+            }
+        }
+
+        // Prefer the candidate which will still be in the cache after emitting its remaining triangles
+        int next = -1;
+        int bestPriority = -1;
+        for( uint i=0; i<candidatesLength; ++i )
+        {
+            const int vertex = candidates[i];
+            if( liveTriangles[vertex] > 0 )
+            {
+                int priority = 0;
+                if( time - cacheTimes[vertex] + 2 * liveTriangles[vertex] <= cacheSize )
+                {
+                    priority = time - cacheTimes[vertex];
+                }
+                if( priority > bestPriority )
+                {
+                    bestPriority = priority;
+                    next = vertex;
+                }
+            }
+        }
+
+        if( next == -1 )
+        {
+            next = SkipDeadEnd( liveTriangles, deadEnds, deadEndsLength, cursor, vertexCount );
+        }
+        fanning = next;
+    }
+
+    CCASSERT( outputLength == triangleCount * 3 );
+    memcpy( indices, output, sizeof( uint ) * outputLength );
+
+    free( output );
+    free( candidates );
+    free( deadEnds );
+    free( emitted );
+    free( cacheTimes );
+    free( adjacency );
+    free( offsets );
+    free( liveTriangles );
+}
+
+
+static float* RemapArray(float *values, const uint *remap, const uint vertexCount, const int stride)
+{
+    if( values == NULL )
+    {
+        return NULL;
+    }
+
+    float *remapped = (float*)malloc( sizeof( float ) * vertexCount * stride );
+    for( uint i=0; i<vertexCount; ++i )
+    {
+        memcpy( &remapped[remap[i]*stride], &values[i*stride], sizeof( float ) * stride );
+    }
+    free( values );
+    return remapped;
+}
+
+
+void CCMeshOptimiseVertexFetch(CCIndexedMesh &mesh)
+{
+    const uint unused = (uint)-1;
+    uint *remap = (uint*)malloc( sizeof( uint ) * mesh.vertexCount );
+    memset( remap, 0xff, sizeof( uint ) * mesh.vertexCount );
+
+    uint next = 0;
+    for( uint i=0; i<mesh.indexCount; ++i )
+    {
+        uint &index = mesh.indices[i];
+        if( remap[index] == unused )
+        {
+            remap[index] = next++;
+        }
+        index = remap[index];
+    }
+
+    // Vertices no triangle uses go last
+    for( uint i=0; i<mesh.vertexCount; ++i )
+    {
+        if( remap[i] == unused )
+        {
+            remap[i] = next++;
+        }
+    }
+
+    mesh.vertices = RemapArray( mesh.vertices, remap, mesh.vertexCount, 3 );
+    mesh.normals = RemapArray( mesh.normals, remap, mesh.vertexCount, 3 );
+    mesh.uvs = RemapArray( mesh.uvs, remap, mesh.vertexCount, 2 );
+    free( remap );
+}
+
+
+float CCMeshACMR(const uint *indices, const uint indexCount, const uint vertexCount, const uint cacheSize)
+{
+    const uint triangleCount = indexCount / 3;
+    if( triangleCount == 0 )
+    {
+        return 0.0f;
+    }
+
+    // When each vertex last went into the cache, counting insertions, as it's first in first out
+    uint *inserted = (uint*)malloc( sizeof( uint ) * vertexCount );
+    memset( inserted, 0xff, sizeof( uint ) * vertexCount );
+
+    uint misses = 0;
+    for( uint i=0; i<triangleCount*3; ++i )
+    {
+        const uint vertex = indices[i];
+        if( inserted[vertex] == (uint)-1 || misses - inserted[vertex] >= cacheSize )
+        {
+            inserted[vertex] = misses++;
+        }
+    }
+    free( inserted );
+
+    return (float)misses / triangleCount;
+}
+
+
+ushort* CCMeshShortIndices(const CCIndexedMesh &mesh)
+{
+    if( mesh.vertexCount > 65536 )
+    {
+        return NULL;
+    }
+
+    ushort *indices = (ushort*)malloc( sizeof( ushort ) * mesh.indexCount );
+    for( uint i=0; i<mesh.indexCount; ++i )
+    {
+        indices[i] = (ushort)mesh.indices[i];
+    }
+    return indices;
+}
@@ -0,0 +1,52 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCIndexedMesh.h
+ * Description : Welds triangle soups into indexed meshes and orders them for the vertex cache.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCINDEXEDMESH_H__
+#define __CCINDEXEDMESH_H__
+
+
+// Unique vertices and the triangles indexing them
+// Arrays are malloc'd, whoever takes them sets them to NULL so they're not freed with the mesh
+struct CCIndexedMesh
+{
+    CCIndexedMesh();
+    ~CCIndexedMesh();
+
+    float *vertices;
+    float *normals;
+    float *uvs;
+    uint vertexCount;
+
+    uint *indices;
+    uint indexCount;
+};
+
+
+// Vertices sharing the same position, normal and uv become one, normals and uvs are optional
+extern bool CCMeshWeld(CCIndexedMesh &mesh, const float *vertices, const float *normals, const float *uvs, const uint soupCount);
+
+// Reorders the triangles so their vertices are reused while they're still in the post transform cache,
+// using Tipsify from Sander, Nehab and Barczak's "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+extern void CCMeshOptimiseVertexCache(uint *indices, const uint indexCount, const uint vertexCount, const uint cacheSize=16);
+
+// Renumbers the vertices in the order the triangles first use them, so they're fetched in order
+extern void CCMeshOptimiseVertexFetch(CCIndexedMesh &mesh);
+
+// Average vertices transformed per triangle through a FIFO cache, 3 for a soup and 0.5 at best
+extern float CCMeshACMR(const uint *indices, const uint indexCount, const uint vertexCount, const uint cacheSize=16);
+
+// Narrows the indices to 16 bit, returns NULL if there's too many vertices
+extern ushort* CCMeshShortIndices(const CCIndexedMesh &mesh);
+
+
+#endif // __CCINDEXEDMESH_H__
@@ -7,9 +7,71 @@
  *-----------------------------------------------------------
  */
 
+#include "CCDefines.h"
 #include "CCMatrix.h"
 
-#include "CCMathTools.h"
+
+// Define CCMATRIX_SCALAR to build without SSE2 or NEON
+#if !defined CCMATRIX_SCALAR
+    #if defined __SSE2__ || defined _M_X64 || ( defined _M_IX86_FP && _M_IX86_FP >= 2 )
+        #define CCMATRIX_SSE
+        #include <emmintrin.h>
+    #elif defined __ARM_NEON__ || defined __ARM_NEON || defined _M_ARM
+        #define CCMATRIX_NEON
+        #include <arm_neon.h>
+    #endif
+#endif
+
+
+// Four floats at a time, matrices are read and written a row at a time so they don't need to be aligned
+#if defined CCMATRIX_SSE
+
+typedef __m128 Float4;
+
+static inline Float4 Load(const float *source) { return _mm_loadu_ps( source ); }
+static inline void Store(float *result, const Float4 value) { _mm_storeu_ps( result, value ); }
+static inline Float4 Splat(const float value) { return _mm_set1_ps( value ); }
+static inline Float4 Add(const Float4 a, const Float4 b) { return _mm_add_ps( a, b ); }
+static inline Float4 Sub(const Float4 a, const Float4 b) { return _mm_sub_ps( a, b ); }
+static inline Float4 Mul(const Float4 a, const Float4 b) { return _mm_mul_ps( a, b ); }
+static inline Float4 MulAdd(const Float4 add, const Float4 a, const Float4 b) { return _mm_add_ps( add, _mm_mul_ps( a, b ) ); }
+
+// ( a1, a0, a3, a2 )
+static inline Float4 SwapPairs(const Float4 a) { return _mm_shuffle_ps( a, a, _MM_SHUFFLE( 2, 3, 0, 1 ) ); }
+
+// ( a2, a3, a0, a1 )
+static inline Float4 SwapHalves(const Float4 a) { return _mm_shuffle_ps( a, a, _MM_SHUFFLE( 1, 0, 3, 2 ) ); }
+
+// ( a0, a2, b0, b2 ) and ( a1, a3, b1, b3 )
+static inline Float4 EvenLanes(const Float4 a, const Float4 b) { return _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) ); }
+static inline Float4 OddLanes(const Float4 a, const Float4 b) { return _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) ); }
+
+// ( a0, a1, b0, b1 ) and ( a2, a3, b2, b3 )
+static inline Float4 LowHalves(const Float4 a, const Float4 b) { return _mm_movelh_ps( a, b ); }
+static inline Float4 HighHalves(const Float4 a, const Float4 b) { return _mm_movehl_ps( b, a ); }
+
+static inline float First(const Float4 a) { return _mm_cvtss_f32( a ); }
+
+#elif defined CCMATRIX_NEON
+
+typedef float32x4_t Float4;
+
+static inline Float4 Load(const float *source) { return vld1q_f32( source ); }
+static inline void Store(float *result, const Float4 value) { vst1q_f32( result, value ); }
+static inline Float4 Splat(const float value) { return vdupq_n_f32( value ); }
+static inline Float4 Add(const Float4 a, const Float4 b) { return vaddq_f32( a, b ); }
+static inline Float4 Sub(const Float4 a, const Float4 b) { return vsubq_f32( a, b ); }
+static inline Float4 Mul(const Float4 a, const Float4 b) { return vmulq_f32( a, b ); }
+static inline Float4 MulAdd(const Float4 add, const Float4 a, const Float4 b) { return vmlaq_f32( add, a, b ); }
+static inline Float4 SwapPairs(const Float4 a) { return vrev64q_f32( a ); }
+static inline Float4 SwapHalves(const Float4 a) { return vcombine_f32( vget_high_f32( a ), vget_low_f32( a ) ); }
+static inline Float4 EvenLanes(const Float4 a, const Float4 b) { return vuzpq_f32( a, b ).val[0]; }
+static inline Float4 OddLanes(const Float4 a, const Float4 b) { return vuzpq_f32( a, b ).val[1]; }
+static inline Float4 LowHalves(const Float4 a, const Float4 b) { return vcombine_f32( vget_low_f32( a ), vget_low_f32( b ) ); }
+static inline Float4 HighHalves(const Float4 a, const Float4 b) { return vcombine_f32( vget_high_f32( a ), vget_high_f32( b ) ); }
+static inline float First(const Float4 a) { return vgetq_lane_f32( a, 0 ); }
+
+#endif
 
 
 void CCMatrixLoadIdentity(CCMatrix &result)
@@ -21,9 +83,43 @@ void CCMatrixLoadIdentity(CCMatrix &result)
     result.m[3][3] = 1.0f;
 }
 
+
 void CCMatrixMultiply(CCMatrix &result, const CCMatrix &srcA, const CCMatrix &srcB)
 {
-    static CCMatrix tmp;
+#if defined CCMATRIX_SSE || defined CCMATRIX_NEON
+
+    // Everything is read before anything is written, so result may be either source
+    const Float4 b0 = Load( srcB.m[0] );
+    const Float4 b1 = Load( srcB.m[1] );
+    const Float4 b2 = Load( srcB.m[2] );
+    const Float4 b3 = Load( srcB.m[3] );
+
+    Float4 rows[4];
+    for( int i=0; i<4; ++i )
+    {
+        const float *a = srcA.m[i];
+        Float4 row = Mul( Splat( a[0] ), b0 );
+        row = MulAdd( row, Splat( a[1] ), b1 );
+        row = MulAdd( row, Splat( a[2] ), b2 );
+        rows[i] = MulAdd( row, Splat( a[3] ), b3 );
+    }
+
+    for( int i=0; i<4; ++i )
+    {
+        Store( result.m[i], rows[i] );
+    }
+
+#else
+
+    CCMatrixMultiplyScalar( result, srcA, srcB );
+
+#endif
+}
+
+
+void CCMatrixMultiplyScalar(CCMatrix &result, const CCMatrix &srcA, const CCMatrix &srcB)
+{
+    CCMatrix tmp;
     for( int i=0; i<4; ++i )
     {
         tmp.m[i][0] = (srcA.m[i][0] * srcB.m[0][0]) + (srcA.m[i][1] * srcB.m[1][0]) + (srcA.m[i][2] * srcB.m[2][0]) + (srcA.m[i][3] * srcB.m[3][0]);
@@ -35,10 +131,99 @@ void CCMatrixMultiply(CCMatrix &result, const CCMatrix &srcA, const CCMatrix &sr
 }
 
 
-bool CCMatrixInverse(CCMatrix &result, CCMatrix &source)
+bool CCMatrixInverse(CCMatrix &result, const CCMatrix &source)
+{
+#if defined CCMATRIX_SSE || defined CCMATRIX_NEON
+
+    // Cofactors worked out on the transposed matrix, four at a time, after Intel's SSE inverse
+    const Float4 source0 = Load( source.m[0] );
+    const Float4 source1 = Load( source.m[1] );
+    const Float4 source2 = Load( source.m[2] );
+    const Float4 source3 = Load( source.m[3] );
+
+    Float4 tmp = LowHalves( source0, source1 );
+    Float4 row1 = LowHalves( source2, source3 );
+    const Float4 row0 = EvenLanes( tmp, row1 );
+    row1 = OddLanes( row1, tmp );
+
+    tmp = HighHalves( source0, source1 );
+    Float4 row3 = HighHalves( source2, source3 );
+    Float4 row2 = EvenLanes( tmp, row3 );
+    row3 = OddLanes( row3, tmp );
+
+    Float4 minor0, minor1, minor2, minor3;
+
+    tmp = SwapPairs( Mul( row2, row3 ) );
+    minor0 = Mul( row1, tmp );
+    minor1 = Mul( row0, tmp );
+    tmp = SwapHalves( tmp );
+    minor0 = Sub( Mul( row1, tmp ), minor0 );
+    minor1 = SwapHalves( Sub( Mul( row0, tmp ), minor1 ) );
+
+    tmp = SwapPairs( Mul( row1, row2 ) );
+    minor0 = MulAdd( minor0, row3, tmp );
+    minor3 = Mul( row0, tmp );
+    tmp = SwapHalves( tmp );
+    minor0 = Sub( minor0, Mul( row3, tmp ) );
+    minor3 = SwapHalves( Sub( Mul( row0, tmp ), minor3 ) );
+
+    tmp = SwapPairs( Mul( SwapHalves( row1 ), row3 ) );
+    row2 = SwapHalves( row2 );
+    minor0 = MulAdd( minor0, row2, tmp );
+    minor2 = Mul( row0, tmp );
+    tmp = SwapHalves( tmp );
+    minor0 = Sub( minor0, Mul( row2, tmp ) );
+    minor2 = SwapHalves( Sub( Mul( row0, tmp ), minor2 ) );
+
+    tmp = SwapPairs( Mul( row0, row1 ) );
+    minor2 = MulAdd( minor2, row3, tmp );
+    minor3 = Sub( Mul( row2, tmp ), minor3 );
+    tmp = SwapHalves( tmp );
+    minor2 = Sub( Mul( row3, tmp ), minor2 );
+    minor3 = Sub( minor3, Mul( row2, tmp ) );
+
+    tmp = SwapPairs( Mul( row0, row3 ) );
+    minor1 = Sub( minor1, Mul( row2, tmp ) );
+    minor2 = MulAdd( minor2, row1, tmp );
+    tmp = SwapHalves( tmp );
+    minor1 = MulAdd( minor1, row2, tmp );
+    minor2 = Sub( minor2, Mul( row1, tmp ) );
+
+    tmp = SwapPairs( Mul( row0, row2 ) );
+    minor1 = MulAdd( minor1, row3, tmp );
+    minor3 = Sub( minor3, Mul( row1, tmp ) );
+    tmp = SwapHalves( tmp );
+    minor1 = Sub( minor1, Mul( row3, tmp ) );
+    minor3 = MulAdd( minor3, row1, tmp );
+
+    Float4 det = Mul( row0, minor0 );
+    det = Add( SwapHalves( det ), det );
+    det = Add( SwapPairs( det ), det );
+    const float determinant = First( det );
+    if( determinant == 0.0f )
+    {
+        return false;
+    }
+
+    const Float4 inverseDet = Splat( 1.0f / determinant );
+    Store( result.m[0], Mul( minor0, inverseDet ) );
+    Store( result.m[1], Mul( minor1, inverseDet ) );
+    Store( result.m[2], Mul( minor2, inverseDet ) );
+    Store( result.m[3], Mul( minor3, inverseDet ) );
+    return true;
+
+#else
+
+    return CCMatrixInverseScalar( result, source );
+
+#endif
+}
+
+
+bool CCMatrixInverseScalar(CCMatrix &result, const CCMatrix &source)
 {
-    float *m = source.data();
-    float *inv = result.data();
+    const float *m = &source.m[0][0];
+    float inv[16];
 
     inv[0]  = m[5]*m[10]*m[15]  - m[5]*m[11]*m[14]  - m[9]*m[6]*m[15]   + m[9]*m[7]*m[14]   + m[13]*m[6]*m[11]  - m[13]*m[7]*m[10];
     inv[4]  = -m[4]*m[10]*m[15] + m[4]*m[11]*m[14]  + m[8]*m[6]*m[15]   - m[8]*m[7]*m[14]   - m[12]*m[6]*m[11]  + m[12]*m[7]*m[10];
@@ -64,15 +249,139 @@ bool CCMatrixInverse(CCMatrix &result, CCMatrix &source)
     }
 
     det = 1.0f / det;
+    float *out = result.data();
     for( int i=0; i<16; ++i )
     {
-        inv[i] *= det;
+        out[i] = inv[i] * det;
     }
 
     return true;
 }
 
 
+void CCMatrixTransformVector4(float result[4], const CCMatrix &matrix, const float vector[4])
+{
+#if defined CCMATRIX_SSE || defined CCMATRIX_NEON
+
+    Float4 out = Mul( Splat( vector[0] ), Load( matrix.m[0] ) );
+    out = MulAdd( out, Splat( vector[1] ), Load( matrix.m[1] ) );
+    out = MulAdd( out, Splat( vector[2] ), Load( matrix.m[2] ) );
+    out = MulAdd( out, Splat( vector[3] ), Load( matrix.m[3] ) );
+    Store( result, out );
+
+#else
+
+    CCMatrixTransformVector4Scalar( result, matrix, vector );
+
+#endif
+}
+
+
+void CCMatrixTransformVector4Scalar(float result[4], const CCMatrix &matrix, const float vector[4])
+{
+    float out[4];
+    for( int i=0; i<4; ++i )
+    {
+        out[i] = vector[0] * matrix.m[0][i] + vector[1] * matrix.m[1][i] + vector[2] * matrix.m[2][i] + vector[3] * matrix.m[3][i];
+    }
+    memcpy( result, out, sizeof( out ) );
+}
+
+
+void CCMatrixTransformPoint(CCVector3 &result, const CCMatrix &matrix, const CCVector3 &point)
+{
+    CCMatrixTransformPoints( &result, matrix, &point, 1 );
+}
+
+
+void CCMatrixTransformPoints(CCVector3 *results, const CCMatrix &matrix, const CCVector3 *points, const int count)
+{
+    int i = 0;
+
+#if defined CCMATRIX_SSE || defined CCMATRIX_NEON
+
+    // Four points at a time, split into their x, y and z lanes
+    const Float4 m00 = Splat( matrix.m[0][0] ), m01 = Splat( matrix.m[0][1] ), m02 = Splat( matrix.m[0][2] );
+    const Float4 m10 = Splat( matrix.m[1][0] ), m11 = Splat( matrix.m[1][1] ), m12 = Splat( matrix.m[1][2] );
+    const Float4 m20 = Splat( matrix.m[2][0] ), m21 = Splat( matrix.m[2][1] ), m22 = Splat( matrix.m[2][2] );
+    const Float4 m30 = Splat( matrix.m[3][0] ), m31 = Splat( matrix.m[3][1] ), m32 = Splat( matrix.m[3][2] );
+
+    for( ; i+4<=count; i+=4 )
+    {
+        const float *source = &points[i].x;
+        float *destination = &results[i].x;
+
+#if defined CCMATRIX_SSE
+
+        const Float4 a0 = Load( source );
+        const Float4 a1 = Load( source+4 );
+        const Float4 a2 = Load( source+8 );
+        const Float4 x = _mm_shuffle_ps( a0, _mm_shuffle_ps( a1, a2, _MM_SHUFFLE( 1, 1, 2, 2 ) ), _MM_SHUFFLE( 2, 0, 3, 0 ) );
+        const Float4 y = EvenLanes( _mm_shuffle_ps( a0, a1, _MM_SHUFFLE( 0, 0, 1, 1 ) ), _mm_shuffle_ps( a1, a2, _MM_SHUFFLE( 2, 2, 3, 3 ) ) );
+        const Float4 z = EvenLanes( _mm_shuffle_ps( a0, a1, _MM_SHUFFLE( 1, 1, 2, 2 ) ), _mm_shuffle_ps( a2, a2, _MM_SHUFFLE( 3, 3, 0, 0 ) ) );
+
+#else
+
+        const float32x4x3_t lanes = vld3q_f32( source );
+        const Float4 x = lanes.val[0];
+        const Float4 y = lanes.val[1];
+        const Float4 z = lanes.val[2];
+
+#endif
+
+        const Float4 outX = MulAdd( MulAdd( MulAdd( m30, x, m00 ), y, m10 ), z, m20 );
+        const Float4 outY = MulAdd( MulAdd( MulAdd( m31, x, m01 ), y, m11 ), z, m21 );
+        const Float4 outZ = MulAdd( MulAdd( MulAdd( m32, x, m02 ), y, m12 ), z, m22 );
+
+#if defined CCMATRIX_SSE
+
+        // Back to x, y, z triples, the points are all loaded so results may be the points
+        const Float4 xy01 = _mm_unpacklo_ps( outX, outY );
+        const Float4 xy23 = _mm_unpackhi_ps( outX, outY );
+        Store( destination, _mm_shuffle_ps( xy01, _mm_shuffle_ps( outZ, xy01, _MM_SHUFFLE( 2, 2, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 1, 0 ) ) );
+        Store( destination+4, _mm_shuffle_ps( _mm_shuffle_ps( xy01, outZ, _MM_SHUFFLE( 1, 1, 3, 3 ) ), xy23, _MM_SHUFFLE( 1, 0, 2, 0 ) ) );
+        Store( destination+8, _mm_shuffle_ps( _mm_shuffle_ps( outZ, xy23, _MM_SHUFFLE( 2, 2, 2, 2 ) ), _mm_shuffle_ps( xy23, outZ, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+
+#else
+
+        float32x4x3_t out;
+        out.val[0] = outX;
+        out.val[1] = outY;
+        out.val[2] = outZ;
+        vst3q_f32( destination, out );
+
+#endif
+    }
+
+#endif
+
+    for( ; i<count; ++i )
+    {
+        const CCVector3 &point = points[i];
+        const float x = point.x * matrix.m[0][0] + point.y * matrix.m[1][0] + point.z * matrix.m[2][0] + matrix.m[3][0];
+        const float y = point.x * matrix.m[0][1] + point.y * matrix.m[1][1] + point.z * matrix.m[2][1] + matrix.m[3][1];
+        const float z = point.x * matrix.m[0][2] + point.y * matrix.m[1][2] + point.z * matrix.m[2][2] + matrix.m[3][2];
+        results[i].x = x;
+        results[i].y = y;
+        results[i].z = z;
+    }
+}
+
+
+void CCMatrixTransformPointsScalar(CCVector3 *results, const CCMatrix &matrix, const CCVector3 *points, const int count)
+{
+    for( int i=0; i<count; ++i )
+    {
+        float in[4] = { points[i].x, points[i].y, points[i].z, 1.0f };
+        float out[4];
+        CCMatrixTransformVector4Scalar( out, matrix, in );
+        results[i].x = out[0];
+        results[i].y = out[1];
+        results[i].z = out[2];
+    }
+}
+
+
 void CCMatrixTranspose(CCMatrix &result, CCMatrix &source)
 {
     for( int i=0; i<4; ++i )
@@ -231,3 +540,37 @@ void CCMatrixRotateDegrees(CCMatrix &result, float angle, float x, float y, floa
         CCMatrixMultiply( result, rotMat, result );
     }
 }
+
+
+void CCMatrixCompose(CCMatrix &result, const CCVector3 &position, const CCQuaternion &rotation, const CCVector3 *scale)
+{
+    const float x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+    const float xx = x * x, yy = y * y, zz = z * z;
+    const float xy = x * y, yz = y * z, zx = z * x;
+    const float xw = x * w, yw = y * w, zw = z * w;
+
+    const float scaleX = scale != NULL ? scale->x : 1.0f;
+    const float scaleY = scale != NULL ? scale->y : 1.0f;
+    const float scaleZ = scale != NULL ? scale->z : 1.0f;
+
+    // Rows are the rotated axes, scaled per column as CCMatrixScale before the rotations would
+    result.m[0][0] = ( 1.0f - 2.0f * ( yy + zz ) ) * scaleX;
+    result.m[0][1] = 2.0f * ( xy + zw ) * scaleY;
+    result.m[0][2] = 2.0f * ( zx - yw ) * scaleZ;
+    result.m[0][3] = 0.0f;
+
+    result.m[1][0] = 2.0f * ( xy - zw ) * scaleX;
+    result.m[1][1] = ( 1.0f - 2.0f * ( xx + zz ) ) * scaleY;
+    result.m[1][2] = 2.0f * ( yz + xw ) * scaleZ;
+    result.m[1][3] = 0.0f;
+
+    result.m[2][0] = 2.0f * ( zx + yw ) * scaleX;
+    result.m[2][1] = 2.0f * ( yz - xw ) * scaleY;
+    result.m[2][2] = ( 1.0f - 2.0f * ( xx + yy ) ) * scaleZ;
+    result.m[2][3] = 0.0f;
+
+    result.m[3][0] = position.x;
+    result.m[3][1] = position.y;
+    result.m[3][2] = position.z;
+    result.m[3][3] = 1.0f;
+}
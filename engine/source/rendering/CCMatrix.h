@@ -26,9 +26,20 @@ struct CCMatrix
 
 extern void CCMatrixLoadIdentity(CCMatrix &result);
 
+// Uses SSE2 or NEON where available, result may be one of the sources
 extern void CCMatrixMultiply(CCMatrix &result, const CCMatrix &srcA, const CCMatrix &srcB);
-
-extern bool CCMatrixInverse(CCMatrix &result, CCMatrix &source);
+extern bool CCMatrixInverse(CCMatrix &result, const CCMatrix &source);
+
+// Vectors are rows multiplied through the matrix, points have a w of 1
+extern void CCMatrixTransformVector4(float result[4], const CCMatrix &matrix, const float vector[4]);
+extern void CCMatrixTransformPoint(CCVector3 &result, const CCMatrix &matrix, const CCVector3 &point);
+extern void CCMatrixTransformPoints(CCVector3 *results, const CCMatrix &matrix, const CCVector3 *points, const int count);
+
+// Plain versions, used without SSE2 or NEON and to check the vectorised ones against
+extern void CCMatrixMultiplyScalar(CCMatrix &result, const CCMatrix &srcA, const CCMatrix &srcB);
+extern bool CCMatrixInverseScalar(CCMatrix &result, const CCMatrix &source);
+extern void CCMatrixTransformVector4Scalar(float result[4], const CCMatrix &matrix, const float vector[4]);
+extern void CCMatrixTransformPointsScalar(CCVector3 *results, const CCMatrix &matrix, const CCVector3 *points, const int count);
 extern void CCMatrixTranspose(CCMatrix &result, CCMatrix &source);
 
 extern void CCMatrixFrustum(CCMatrix &result, float left, float right, float bottom, float top, float nearZ, float farZ);
@@ -40,5 +51,8 @@ extern void CCMatrixTranslate(CCMatrix &result, float tx, float ty, float tz);
 extern void CCMatrixPosition(CCMatrix &result, float tx, float ty, float tz);
 extern void CCMatrixRotateDegrees(CCMatrix &result, float angle, float x, float y, float z);
 
+// Builds a model matrix straight from a quaternion, matching translating, scaling then rotating by the same angles
+extern void CCMatrixCompose(CCMatrix &result, const CCVector3 &position, const CCQuaternion &rotation, const CCVector3 *scale);
+
 
 #endif // __CCMATRIX_H__
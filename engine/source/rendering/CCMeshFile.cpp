@@ -0,0 +1,344 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCMeshFile.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCMeshFile.h"
+#include "CCFileManager.h"
+
+#if !defined WP8 && !defined WIN8 && !defined QT
+#define CCMESHFILE_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+static inline uint AlignOffset(const uint offset)
+{
+    return ( offset + 3 ) & ~3u;
+}
+
+
+CCMeshFile::CCMeshFile()
+{
+    header = NULL;
+    mapping = NULL;
+    mappingSize = 0;
+}
+
+
+CCMeshFile::~CCMeshFile()
+{
+    close();
+}
+
+
+bool CCMeshFile::open(const char *filePath, CCResourceType resourceType)
+{
+    close();
+
+    if( resourceType == Resource_Unknown )
+    {
+        resourceType = CCFileManager::FindFile( filePath );
+        if( resourceType == Resource_Unknown )
+        {
+            return false;
+        }
+    }
+
+#ifdef CCMESHFILE_MMAP
+#ifdef ANDROID
+    // Packaged files are compressed into the apk
+    if( resourceType != Resource_Packaged )
+#endif
+    {
+        CCText fullFilePath;
+        CCFileManager::GetFilePath( fullFilePath, filePath, resourceType );
+
+        const int file = ::open( fullFilePath.buffer, O_RDONLY );
+        if( file != -1 )
+        {
+            struct stat info;
+            if( fstat( file, &info ) == 0 && info.st_size >= (off_t)sizeof( CCMeshFileHeader ) )
+            {
+                void *data = mmap( NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0 );
+                if( data != MAP_FAILED )
+                {
+                    mapping = data;
+                    mappingSize = (uint)info.st_size;
+                    header = (const CCMeshFileHeader*)mapping;
+                }
+            }
+            ::close( file );
+
+            if( header != NULL )
+            {
+                return validate();
+            }
+        }
+    }
+#endif
+
+    if( CCFileManager::GetFile( filePath, fileData, resourceType, false ) <= 0 )
+    {
+        return false;
+    }
+    header = (const CCMeshFileHeader*)fileData.buffer;
+    return validate();
+}
+
+
+bool CCMeshFile::openData(const char *data, const uint length)
+{
+    close();
+
+    if( data == NULL || length == 0 )
+    {
+        return false;
+    }
+    fileData.set( data, length );
+    header = (const CCMeshFileHeader*)fileData.buffer;
+    return validate();
+}
+
+
+void CCMeshFile::close()
+{
+#ifdef CCMESHFILE_MMAP
+    if( mapping != NULL )
+    {
+        munmap( mapping, mappingSize );
+        mapping = NULL;
+        mappingSize = 0;
+    }
+#endif
+    header = NULL;
+}
+
+
+bool CCMeshFile::validate()
+{
+    const uint length = mapping != NULL ? mappingSize : fileData.length;
+    if( length < sizeof( CCMeshFileHeader ) ||
+        memcmp( header->magic, "CCMF", 4 ) != 0 ||
+        header->fileSize != length )
+    {
+        DEBUGLOG( "CCMeshFile::validate() not a mesh file\n" );
+        close();
+        return false;
+    }
+
+    if( header->version != CCMESHFILE_VERSION )
+    {
+        DEBUGLOG( "CCMeshFile::validate() version %u, expected %u\n", header->version, CCMESHFILE_VERSION );
+        close();
+        return false;
+    }
+
+    uint floatsPerVertex = 3;
+    if( ( header->streams & CCMeshFile_Normals ) != 0 )
+    {
+        floatsPerVertex += 3;
+    }
+    if( ( header->streams & CCMeshFile_UVs ) != 0 )
+    {
+        floatsPerVertex += 2;
+    }
+
+    // Sizes are checked in 64 bit so huge counts can't wrap around
+    const unsigned long long vertexBytes = (unsigned long long)header->vertexCount * floatsPerVertex * sizeof( float );
+    const unsigned long long indexBytes = (unsigned long long)header->indexCount * header->indexSize;
+    const unsigned long long submeshBytes = (unsigned long long)header->submeshCount * sizeof( CCMeshFileSubmesh );
+
+    bool valid = header->vertexCount > 0 &&
+                 ( header->indexSize == 0 || header->indexSize == 2 || header->indexSize == 4 ) &&
+                 ( header->indexSize == 0 ) == ( header->indexCount == 0 ) &&
+                 ( header->submeshesOffset & 3 ) == 0 && ( header->verticesOffset & 3 ) == 0 && ( header->indicesOffset & 3 ) == 0 &&
+                 header->submeshesOffset + submeshBytes <= length &&
+                 header->verticesOffset + vertexBytes <= length &&
+                 header->indicesOffset + indexBytes <= length &&
+                 header->namesOffset <= length;
+
+    for( uint i=0; valid && i<header->submeshCount; ++i )
+    {
+        const CCMeshFileSubmesh &submesh = getSubmesh( i );
+        const unsigned long long lastIndex = (unsigned long long)submesh.firstIndex + submesh.indexCount;
+        const uint elements = header->indexCount > 0 ? header->indexCount : header->vertexCount;
+        const unsigned long long nameStart = (unsigned long long)header->namesOffset + submesh.nameOffset;
+
+        // Names must start inside the names region, which runs to the end of the file
+        valid = lastIndex <= elements && submesh.nameOffset < length - header->namesOffset && nameStart < length;
+    }
+
+    // Every index must point at a vertex, checked once here so drawing never reads past the vertices
+    if( valid && header->indexCount > 0 )
+    {
+        uint maxIndex = 0;
+        if( header->indexSize == 2 )
+        {
+            const ushort *indices = (const ushort*)getIndices();
+            for( uint i=0; i<header->indexCount; ++i )
+            {
+                maxIndex = MAX( maxIndex, (uint)indices[i] );
+            }
+        }
+        else
+        {
+            const uint *indices = (const uint*)getIndices();
+            for( uint i=0; i<header->indexCount; ++i )
+            {
+                maxIndex = MAX( maxIndex, indices[i] );
+            }
+        }
+        valid = maxIndex < header->vertexCount;
+    }
+
+    // Names must be terminated within the file
+    if( valid && header->submeshCount > 0 )
+    {
+        const char *data = (const char*)header;
+        valid = data[length-1] == 0;
+    }
+
+    if( valid == false )
+    {
+        DEBUGLOG( "CCMeshFile::validate() corrupt\n" );
+        close();
+        return false;
+    }
+    return true;
+}
+
+
+float* CCMeshFile::getVertices() const
+{
+    return (float*)( (char*)header + header->verticesOffset );
+}
+
+
+float* CCMeshFile::getNormals() const
+{
+    if( ( header->streams & CCMeshFile_Normals ) == 0 )
+    {
+        return NULL;
+    }
+    return getVertices() + header->vertexCount * 3;
+}
+
+
+float* CCMeshFile::getUVs() const
+{
+    if( ( header->streams & CCMeshFile_UVs ) == 0 )
+    {
+        return NULL;
+    }
+    float *normals = getNormals();
+    return normals != NULL ? normals + header->vertexCount * 3 : getVertices() + header->vertexCount * 3;
+}
+
+
+void* CCMeshFile::getIndices() const
+{
+    if( header->indexCount == 0 )
+    {
+        return NULL;
+    }
+    return (char*)header + header->indicesOffset;
+}
+
+
+const CCMeshFileSubmesh& CCMeshFile::getSubmesh(const uint index) const
+{
+    CCASSERT( index < header->submeshCount );
+    const CCMeshFileSubmesh *submeshes = (const CCMeshFileSubmesh*)( (const char*)header + header->submeshesOffset );
+    return submeshes[index];
+}
+
+
+const char* CCMeshFile::getMaterialName(const uint index) const
+{
+    return (const char*)header + header->namesOffset + getSubmesh( index ).nameOffset;
+}
+
+
+void CCMeshFile::Write(CCData &fileData,
+                       const float *vertices, const float *normals, const float *uvs, const uint vertexCount,
+                       const void *indices, const uint indexCount, const uint indexSize,
+                       const CCMinMax &mmX, const CCMinMax &mmY, const CCMinMax &mmZ,
+                       const CCMeshFileSubmesh *submeshes, const char **materialNames, const uint submeshCount)
+{
+    CCMeshFileHeader header;
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.magic, "CCMF", 4 );
+    header.version = CCMESHFILE_VERSION;
+    header.vertexCount = vertexCount;
+    header.streams = ( normals != NULL ? CCMeshFile_Normals : 0 ) | ( uvs != NULL ? CCMeshFile_UVs : 0 );
+    header.indexCount = indices != NULL ? indexCount : 0;
+    header.indexSize = indices != NULL ? indexSize : 0;
+    header.min[0] = mmX.min;
+    header.min[1] = mmY.min;
+    header.min[2] = mmZ.min;
+    header.max[0] = mmX.max;
+    header.max[1] = mmY.max;
+    header.max[2] = mmZ.max;
+    header.submeshCount = submeshCount;
+
+    const uint positionBytes = sizeof( float ) * vertexCount * 3;
+    const uint normalBytes = normals != NULL ? positionBytes : 0;
+    const uint uvBytes = uvs != NULL ? sizeof( float ) * vertexCount * 2 : 0;
+    const uint indexBytes = header.indexCount * header.indexSize;
+
+    header.submeshesOffset = AlignOffset( sizeof( CCMeshFileHeader ) );
+    header.verticesOffset = header.submeshesOffset + sizeof( CCMeshFileSubmesh ) * submeshCount;
+    header.indicesOffset = AlignOffset( header.verticesOffset + positionBytes + normalBytes + uvBytes );
+    header.namesOffset = header.indicesOffset + indexBytes;
+
+    uint namesLength = 0;
+    for( uint i=0; i<submeshCount; ++i )
+    {
+        namesLength += strlen( materialNames[i] != NULL ? materialNames[i] : "" ) + 1;
+    }
+    header.fileSize = header.namesOffset + namesLength;
+
+    fileData.setSize( header.fileSize );
+    char *data = fileData.buffer;
+    memset( data, 0, header.fileSize );
+    memcpy( data, &header, sizeof( header ) );
+
+    CCMeshFileSubmesh *fileSubmeshes = (CCMeshFileSubmesh*)( data + header.submeshesOffset );
+    uint nameOffset = 0;
+    for( uint i=0; i<submeshCount; ++i )
+    {
+        const char *name = materialNames[i] != NULL ? materialNames[i] : "";
+        const uint nameLength = strlen( name ) + 1;
+
+        fileSubmeshes[i] = submeshes[i];
+        fileSubmeshes[i].nameOffset = nameOffset;
+        memcpy( data + header.namesOffset + nameOffset, name, nameLength );
+        nameOffset += nameLength;
+    }
+
+    char *stream = data + header.verticesOffset;
+    memcpy( stream, vertices, positionBytes );
+    stream += positionBytes;
+    if( normals != NULL )
+    {
+        memcpy( stream, normals, normalBytes );
+        stream += normalBytes;
+    }
+    if( uvs != NULL )
+    {
+        memcpy( stream, uvs, uvBytes );
+    }
+
+    if( indexBytes > 0 )
+    {
+        memcpy( data + header.indicesOffset, indices, indexBytes );
+    }
+}
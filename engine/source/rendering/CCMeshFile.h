@@ -0,0 +1,106 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCMeshFile.h
+ * Description : Precompiled binary meshes, drawn straight from the loaded file.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCMESHFILE_H__
+#define __CCMESHFILE_H__
+
+
+#define CCMESHFILE_EXTENSION ".ccmesh"
+#define CCMESHFILE_VERSION 1
+
+enum CCMeshFileStreams
+{
+    CCMeshFile_Normals  = 0x1,
+    CCMeshFile_UVs      = 0x2
+};
+
+
+// Every offset is in bytes from the start of the file and 4 byte aligned, so the streams can be used in place
+// Layout: header, submesh table, positions, normals, uvs, indices, null terminated material names
+struct CCMeshFileHeader
+{
+    char magic[4];              // CCMF
+    uint version;
+    uint fileSize;
+
+    uint vertexCount;
+    uint streams;               // CCMeshFileStreams stored after the positions
+    uint indexCount;
+    uint indexSize;             // 2 or 4 bytes, 0 for a triangle soup
+
+    float min[3];
+    float max[3];
+
+    uint submeshCount;
+    uint submeshesOffset;
+    uint verticesOffset;
+    uint indicesOffset;
+    uint namesOffset;
+};
+
+
+// A run of triangles sharing a material
+struct CCMeshFileSubmesh
+{
+    uint firstIndex;
+    uint indexCount;
+    uint nameOffset;            // From the header's namesOffset
+};
+
+
+class CCMeshFile
+{
+public:
+    CCMeshFile();
+    ~CCMeshFile();
+
+    // Memory maps the file where the platform allows it, otherwise reads it in whole
+    bool open(const char *filePath, CCResourceType resourceType);
+
+    // Takes a copy of a file already in memory
+    bool openData(const char *data, const uint length);
+
+    const CCMeshFileHeader& getHeader() const { return *header; }
+
+    // Mapped privately, so writes such as moving the vertices to their origin never reach the file
+    float* getVertices() const;
+    float* getNormals() const;
+    float* getUVs() const;
+    void* getIndices() const;
+
+    const CCMeshFileSubmesh& getSubmesh(const uint index) const;
+    const char* getMaterialName(const uint index) const;
+
+    // Serialises a mesh, normals, uvs and indices are optional
+    // Submeshes' nameOffsets are filled in from the materialNames
+    static void Write(CCData &fileData,
+                      const float *vertices, const float *normals, const float *uvs, const uint vertexCount,
+                      const void *indices, const uint indexCount, const uint indexSize,
+                      const CCMinMax &mmX, const CCMinMax &mmY, const CCMinMax &mmZ,
+                      const CCMeshFileSubmesh *submeshes, const char **materialNames, const uint submeshCount);
+
+protected:
+    // Checks every table and stream lies within the file, and every index points at a vertex
+    bool validate();
+    void close();
+
+protected:
+    const CCMeshFileHeader *header;
+
+    void *mapping;
+    uint mappingSize;
+    CCData fileData;            // When we can't map
+};
+
+
+#endif // __CCMESHFILE_H__
@@ -13,6 +13,9 @@
 #include "CCAppManager.h"
 #include "CCFileManager.h"
 #include "CCPrimitiveOBJ.h"
+#include "CCModel3DS.h"
+#include "CCIndexedMesh.h"
+#include "CCMeshFile.h"
 
 #ifdef WP8
 #include <ppl.h>
@@ -20,14 +23,17 @@
 #endif
 
 
-static bool ASYNC_LOAD_IN_PROGRESS = false;
-
-
 CCPrimitive3D::CCPrimitive3D()
 {
     vertexCount = 0;
     fileSize = 0;
 
+    indices = NULL;
+    indexCount = 0;
+    indexType = GL_UNSIGNED_SHORT;
+
+    meshFile = NULL;
+
     modelUVs = NULL;
     adjustedUVs = NULL;
 
@@ -41,27 +47,39 @@ CCPrimitive3D::CCPrimitive3D()
 void CCPrimitive3D::destruct()
 {
     submodels.deleteObjects();
-    
-	while( ASYNC_LOAD_IN_PROGRESS )
-	{
-		//DEBUGLOG( "CCPrimtive3D::destruct() waiting...\n" );
-		usleep( 1 );
-	}
+
+    // Pending loads parse into their own primitive and are dropped once we're gone, so there's nothing to wait on
 
     if( cached )
     {
         modelUVs = NULL;
         vertices = NULL;
         normals = NULL;
+        indices = NULL;
     }
+    else if( meshFile != NULL )
+    {
+        // Our arrays belong to the file
+        gRenderer->derefVertexPointer( ATTRIB_VERTEX, vertices );
+        gRenderer->derefVertexPointer( ATTRIB_NORMAL, normals );
+        gRenderer->derefVertexPointer( ATTRIB_TEXCOORD, modelUVs );
+        modelUVs = NULL;
+        vertices = NULL;
+        normals = NULL;
+        indices = NULL;
+    }
+
+    FREE_POINTER( indices );
 
     if( modelUVs != NULL )
     {
+        gRenderer->derefVertexPointer( ATTRIB_TEXCOORD, modelUVs );
         free( modelUVs );
     }
 
     if( adjustedUVs != NULL )
     {
+        gRenderer->derefVertexPointer( ATTRIB_TEXCOORD, adjustedUVs );
         free( adjustedUVs );
     }
 
@@ -70,58 +88,132 @@ void CCPrimitive3D::destruct()
 
 
 void CCPrimitive3D::loadDataAsync(const char *fileData)
+{
+    CCText data( fileData );
+    loadDataAsync( data );
+}
+
+
+void CCPrimitive3D::loadDataAsync(CCText &fileData)
 {
 	// Result on engine thread
-	CCLAMBDA_2( Result, CCPrimitive3D, that, bool, loaded, {
-        if( loaded )
-        {
-            that->loaded();
-        }
-        else
-        {
-            CCText script = "CCPrimitive3D.Loaded( ";
-            script += that->primitiveID;
-            script += " );";
-            CCAppManager::WebJSEval( script.buffer, false, false );
-        }
-    });
+	class Result : public CCLambdaSafeCallback
+	{
+	public:
+		// that may already be deleted, so its handle is passed in rather than read
+		Result(CCPrimitive3D *that, const CCActiveHandle &activeHandle, CCPrimitive3D *load, bool loaded)
+		{
+			this->that = that;
+			this->activeHandle = activeHandle;
+			this->load = load;
+			this->loaded = loaded;
+		}
 
-	class Load : public CCLambdaSafeCallback															
-	{																									
-	public:																								
-		Load(CCPrimitive3D *that, CCText fileData, bool loaded)													
-		{																								
-			this->that = that;																		
-			this->lazyPointer = that->lazyPointer;														
-			this->lazyID = that->lazyID;																
-			this->fileData = fileData;																		
-			this->loaded = loaded;                                            							
-		}																								
-	protected:		
-		// Run on a random thread																					
-		void run()																					
-		{																								
-			DEBUGLOG( "ASYNC_LOAD_IN_PROGRESS=true %s\n", that->filename.buffer );
-            CCASSERT( ASYNC_LOAD_IN_PROGRESS == false );
-			ASYNC_LOAD_IN_PROGRESS = true;
-        
-			loaded = that->loadData( fileData.buffer );
-		
-			DEBUGLOG( "ASYNC_LOAD_IN_PROGRESS=false %s\n", that->filename.buffer );
-			ASYNC_LOAD_IN_PROGRESS = false;
-		}		
-		// Finish on the jobs thread																						
-		void finish()																					
-		{																								
-			gEngine->jobsToEngineThread( new Result( that, loaded ) );
-		}																								
-	private:																						
-		CCPrimitive3D *that;																					
-		CCText fileData;																					
-		bool loaded;                                                       								
+		// Deleted on the engine thread whether or not we ran, as the renderer may be told about the load's arrays
+		~Result()
+		{
+			DELETE_OBJECT( load );
+		}
+	protected:
+		void run()
+		{
+			if( loaded )
+			{
+				that->swapMesh( load );
+				that->loaded();
+			}
+			else
+			{
+				CCText script = "CCPrimitive3D.Loaded( ";
+				script += that->primitiveID;
+				script += " );";
+				CCAppManager::WebJSEval( script.buffer, false, false );
+			}
+		}
+	private:
+		CCPrimitive3D *that;
+		CCPrimitive3D *load;
+		bool loaded;
 	};
 
-    gEngine->engineToJobsThread( new Load( this, fileData, false ) );
+	// Each load parses into its own primitive, so any number can run at once without touching us
+	class Load : public CCLambdaCallback
+	{
+	public:
+		Load(CCPrimitive3D *that, CCPrimitive3D *load, CCText &fileData)
+		{
+			this->that = that;
+			this->activeHandle = that->activeHandle;
+			this->load = load;
+			this->fileData.swap( fileData );
+			this->loaded = false;
+		}
+
+		// Only reached with load set if the job was dropped before it ran, in which case it's still empty
+		~Load()
+		{
+			DELETE_OBJECT( load );
+		}
+	protected:
+		// Run on a random thread
+		void run()
+		{
+			// Skip the parse if we were deleted while queued
+			if( load != NULL && CCActiveAllocation::IsCallbackActive( activeHandle ) )
+			{
+				loaded = load->loadData( fileData.buffer );
+			}
+			fileData.setSize( 0 );
+		}
+		// Finish on the jobs thread
+		void finish()
+		{
+			gEngine->jobsToEngineThread( new Result( that, activeHandle, load, loaded ) );
+			load = NULL;
+		}
+	private:
+		CCPrimitive3D *that;
+		CCActiveHandle activeHandle;
+		CCPrimitive3D *load;
+		CCText fileData;
+		bool loaded;
+	};
+
+    // Parses don't depend on each other, so they're spread across the job workers
+    gEngine->jobScheduler.submit( new Load( this, newPrimitive(), fileData ) );
+}
+
+
+void CCPrimitive3D::swapMesh(CCPrimitive3D *other)
+{
+    CCSwap( vertices, other->vertices );
+    CCSwap( normals, other->normals );
+    CCSwap( modelUVs, other->modelUVs );
+    CCSwap( adjustedUVs, other->adjustedUVs );
+    CCSwap( vertexCount, other->vertexCount );
+    CCSwap( fileSize, other->fileSize );
+
+    CCSwap( indices, other->indices );
+    CCSwap( indexCount, other->indexCount );
+    CCSwap( indexType, other->indexType );
+    CCSwap( meshFile, other->meshFile );
+    CCSwap( cached, other->cached );
+
+    CCSwap( width, other->width );
+    CCSwap( height, other->height );
+    CCSwap( depth, other->depth );
+    CCSwap( mmX, other->mmX );
+    CCSwap( mmY, other->mmY );
+    CCSwap( mmZ, other->mmZ );
+    CCSwap( movedToOrigin, other->movedToOrigin );
+    CCSwap( origin, other->origin );
+
+    // Our new arrays haven't been handed to the renderer yet
+    vertexPointersCached = false;
+    if( textureInfo != NULL )
+    {
+        adjustTextureUVs();
+    }
 }
 
 
@@ -198,6 +290,8 @@ void CCPrimitive3D::adjustTextureUVs()
                     adjustedUVs[y] = modelUVs[y] * yScale;
                 }
 
+                gRenderer->cacheVertexPointer( ATTRIB_TEXCOORD, adjustedUVs, sizeof( float ) * vertexCount * 2 );
+                gRenderer->updateVertexPointer( ATTRIB_TEXCOORD, adjustedUVs );
                 return;
             }
         }
@@ -206,6 +300,7 @@ void CCPrimitive3D::adjustTextureUVs()
     // Clear out our adjustedUVs if we haven't processed them above
     if( adjustedUVs != NULL )
     {
+        gRenderer->derefVertexPointer( ATTRIB_TEXCOORD, adjustedUVs );
         free( adjustedUVs );
         adjustedUVs = NULL;
     }
@@ -213,6 +308,201 @@ void CCPrimitive3D::adjustTextureUVs()
 }
 
 
+void CCPrimitive3D::cacheVertexPointers()
+{
+    // Copies share the cached arrays of the primitive they were copied from
+    const uint vertexBytes = sizeof( float ) * vertexCount * 3;
+    const uint uvBytes = sizeof( float ) * vertexCount * 2;
+    gRenderer->cacheVertexPointer( ATTRIB_VERTEX, vertices, vertexBytes );
+    gRenderer->cacheVertexPointer( ATTRIB_NORMAL, normals, vertexBytes );
+    gRenderer->cacheVertexPointer( ATTRIB_TEXCOORD, modelUVs, uvBytes );
+    gRenderer->cacheVertexPointer( ATTRIB_TEXCOORD, adjustedUVs, uvBytes );
+}
+
+
+bool CCPrimitive3D::weldVertices()
+{
+    CCIndexedMesh mesh;
+    if( CCMeshWeld( mesh, vertices, normals, modelUVs, vertexCount ) == false )
+    {
+        return false;
+    }
+
+    CCMeshOptimiseVertexCache( mesh.indices, mesh.indexCount, mesh.vertexCount );
+    CCMeshOptimiseVertexFetch( mesh );
+
+    ushort *shortIndices = CCMeshShortIndices( mesh );
+    if( shortIndices == NULL && gRenderer != NULL && gRenderer->uintIndexSupport == false )
+    {
+        // Too many vertices for this device, so keep drawing the soup
+        return false;
+    }
+
+    FREE_POINTER( vertices );
+    FREE_POINTER( normals );
+    FREE_POINTER( modelUVs );
+    vertices = mesh.vertices;
+    normals = mesh.normals;
+    modelUVs = mesh.uvs;
+    mesh.vertices = mesh.normals = mesh.uvs = NULL;
+
+    FREE_POINTER( indices );
+    if( shortIndices != NULL )
+    {
+        indices = shortIndices;
+        indexType = GL_UNSIGNED_SHORT;
+    }
+    else
+    {
+        indices = mesh.indices;
+        indexType = GL_UNSIGNED_INT;
+        mesh.indices = NULL;
+    }
+
+    vertexCount = mesh.vertexCount;
+    indexCount = mesh.indexCount;
+    return true;
+}
+
+
+bool CCPrimitive3D::loadMeshFile(const char *file, const CCResourceType resourceType)
+{
+    CCMeshFile *mesh = new CCMeshFile();
+    if( mesh->open( file, resourceType ) == false )
+    {
+        delete mesh;
+        return false;
+    }
+    return useMeshFile( mesh );
+}
+
+
+bool CCPrimitive3D::loadMeshData(const char *data, const uint length)
+{
+    CCMeshFile *mesh = new CCMeshFile();
+    if( mesh->openData( data, length ) == false )
+    {
+        delete mesh;
+        return false;
+    }
+    return useMeshFile( mesh );
+}
+
+
+bool CCPrimitive3D::useMeshFile(CCMeshFile *file)
+{
+    CCASSERT( vertices == NULL && meshFile == NULL );
+
+    const CCMeshFileHeader &header = file->getHeader();
+    if( header.indexSize == 4 && gRenderer != NULL && gRenderer->uintIndexSupport == false )
+    {
+        DEBUGLOG( "CCPrimitive3D::useMeshFile() 32 bit indices are unsupported\n" );
+        delete file;
+        return false;
+    }
+
+    meshFile = file;
+    vertices = file->getVertices();
+    normals = file->getNormals();
+    modelUVs = file->getUVs();
+    vertexCount = header.vertexCount;
+
+    indices = file->getIndices();
+    indexCount = header.indexCount;
+    indexType = header.indexSize == 4 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+
+    mmX.min = header.min[0];
+    mmY.min = header.min[1];
+    mmZ.min = header.min[2];
+    mmX.max = header.max[0];
+    mmY.max = header.max[1];
+    mmZ.max = header.max[2];
+    width = mmX.size();
+    height = mmY.size();
+    depth = mmZ.size();
+    return true;
+}
+
+
+void CCPrimitive3D::saveMeshFile(CCData &fileData, const char *materialName) const
+{
+    CCMeshFileSubmesh submesh;
+    submesh.firstIndex = 0;
+    submesh.indexCount = indices != NULL ? indexCount : vertexCount;
+    submesh.nameOffset = 0;
+
+    const uint indexSize = indexType == GL_UNSIGNED_INT ? 4 : 2;
+    CCMeshFile::Write( fileData, vertices, normals, modelUVs, vertexCount, indices, indexCount, indexSize,
+                       mmX, mmY, mmZ, &submesh, &materialName, 1 );
+}
+
+
+bool CCPrimitive3D::ConvertToMeshFile(const char *sourceFile, const CCResourceType resourceType, const char *meshFile)
+{
+    CCText lowerCaseFile = sourceFile;
+    lowerCaseFile.toLowerCase();
+
+    CCPrimitive3D *primitive = NULL;
+    if( CCText::Contains( lowerCaseFile, ".3ds" ) )
+    {
+        // 3DS models are only loaded from the package
+        CCPrimitive3DS *primitive3ds = new CCPrimitive3DS();
+        if( primitive3ds->load( sourceFile ) )
+        {
+            primitive = primitive3ds;
+        }
+        else
+        {
+            DELETE_OBJECT( primitive3ds );
+        }
+    }
+    else
+    {
+        CCData fileData;
+        if( CCFileManager::GetFile( sourceFile, fileData, resourceType, false ) > 0 )
+        {
+            CCPrimitiveOBJ *primitiveOBJ = new CCPrimitiveOBJ();
+            if( primitiveOBJ->loadData( fileData.buffer ) )
+            {
+                primitive = primitiveOBJ;
+            }
+            else
+            {
+                DELETE_OBJECT( primitiveOBJ );
+            }
+        }
+    }
+
+    if( primitive == NULL )
+    {
+        return false;
+    }
+
+    CCText materialName = sourceFile;
+    materialName.stripDirectory();
+    materialName.stripExtension();
+
+    CCData meshData;
+    primitive->saveMeshFile( meshData, materialName.buffer );
+    DELETE_OBJECT( primitive );
+
+    return CCFileManager::SaveCachedFile( meshFile, meshData.buffer, meshData.length );
+}
+
+
+void CCPrimitive3D::renderTriangles()
+{
+    if( indices != NULL )
+    {
+        gRenderer->GLDrawElements( GL_TRIANGLES, indexCount, indexType, indices );
+    }
+    else
+    {
+        gRenderer->GLDrawArrays( GL_TRIANGLES, 0, vertexCount );
+    }
+}
+
+
 const CCMinMax CCPrimitive3D::getYMinMaxAtZ(const float atZ) const
 {
     CCMinMax mmYAtZ;
@@ -249,6 +539,8 @@ void CCPrimitive3D::moveVerticesToOriginAsync(CCLambdaSafeCallback *callback)
 {
 	// Result on engine thread
     CCLAMBDA_2( Result, CCPrimitive3D, that, CCLambdaSafeCallback*, callback, {
+        // The renderer's caches are only touched on the engine thread
+        gRenderer->updateVertexPointer( ATTRIB_VERTEX, that->vertices );
         that->movedVerticesToOrigin();
 
 		if( callback != NULL )
@@ -270,6 +562,7 @@ void CCPrimitive3D::moveVerticesToOriginAsync(CCLambdaSafeCallback *callback)
         gEngine->jobsToEngineThread( new Result( that, callback ) );
     });
 
+    // Moves edit the vertices in place, so they stay in order on the jobs thread
     gEngine->engineToJobsThread( new Move( this, callback ) );
 }
 
@@ -300,8 +593,6 @@ void CCPrimitive3D::moveVerticesToOrigin()
             mmZ.consider( z );
         }
 
-        gRenderer->updateVertexPointer( ATTRIB_VERTEX, vertices );
-
         movedToOrigin = true;
     }
 }
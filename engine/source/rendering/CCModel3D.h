@@ -15,6 +15,8 @@
 #define __CCMODEL3D_H__
 
 
+class CCMeshFile;
+
 class CCPrimitive3D : public CCPrimitiveBase
 {
     typedef CCPrimitiveBase super;
@@ -99,6 +101,15 @@ protected:
 
 	uint vertexCount;
 	uint fileSize;
+
+    // Welded meshes index their vertices, otherwise they're drawn as a triangle soup
+    void *indices;
+    uint indexCount;
+    GLenum indexType;
+
+    // Our arrays point into this when loaded from a mesh file
+    CCMeshFile *meshFile;
+
     float *modelUVs;	// Original model UV coordinates
     float *adjustedUVs;	// Adjuested UV coordinates for texture (non-square textures are blitted into a square buffer)
 
@@ -122,10 +133,22 @@ public:
         this->filename = filename;
     }
 
+    // Parses on a job thread, loads don't wait on each other and are dropped if we're deleted first
     void loadDataAsync(const char *fileData);
+    void loadDataAsync(CCText &fileData);     // Takes the text, leaving fileData empty
     virtual bool loadData(const char *fileData) { return false; }
     virtual void loaded() {}
 
+    // Draws straight from a precompiled mesh file, see CCMeshFile.h
+    bool loadMeshFile(const char *file, const CCResourceType resourceType);
+    bool loadMeshData(const char *data, const uint length);
+
+    // Converts our mesh to the mesh file format, as one submesh
+    void saveMeshFile(CCData &fileData, const char *materialName=NULL) const;
+
+    // Loads an OBJ or 3DS model and saves it as a mesh file in the cache
+    static bool ConvertToMeshFile(const char *sourceFile, const CCResourceType resourceType, const char *meshFile);
+
     virtual void removeTexture();
     virtual void setSubmodelTextureHandleIndex(const char *submodelName, const int index);
 
@@ -133,6 +156,25 @@ public:
     // as non-square textures load into a square texture which means the mapping requires adjustment
     virtual void adjustTextureUVs();
 
+protected:
+    virtual void cacheVertexPointers();
+
+    // Welds our triangle soup into unique vertices and triangles ordered for the vertex cache
+    // Loaders call this on the thread they load on, before we're first drawn
+    bool weldVertices();
+
+    bool useMeshFile(CCMeshFile *file);
+
+    // An empty primitive of our type for async loads to parse into
+    virtual CCPrimitive3D* newPrimitive() const { return NULL; }
+
+    // Exchanges our mesh with another primitive's, on the engine thread
+    void swapMesh(CCPrimitive3D *other);
+
+    void renderTriangles();
+
+public:
+
     float getWidth() { return width; }
     float getHeight() { return height; }
     float getDepth() { return depth; }
@@ -38,16 +38,7 @@ CCPrimitive3DS::CCPrimitive3DS()
 
 void CCPrimitive3DS::destruct()
 {
-    if( modelUVs != NULL )
-    {
-        free( modelUVs );
-    }
-
-    if( adjustedUVs != NULL )
-    {
-        free( adjustedUVs );
-    }
-
+    // Our UVs are freed by CCPrimitive3D
     super::destruct();
 }
 
@@ -197,6 +188,8 @@ bool CCPrimitive3DS::load(const char* file)
         height = mmY.size();
         depth = mmZ.size();
 
+        weldVertices();
+
         delete object;
         return true;
     }
@@ -211,8 +204,8 @@ void CCPrimitive3DS::renderVertices(const bool textured)
     CCRenderer::CCSetRenderStates( true );
 
 	GLVertexPointer( 3, GL_FLOAT, 0, vertices, vertexCount );
-    gRenderer->GLVertexAttribPointer( ATTRIB_NORMAL, 3, GL_FLOAT, true, 0, normals, vertexCount );
+    GLNormalPointer( 3, GL_FLOAT, 0, normals, vertexCount );
     CCSetTexCoords( adjustedUVs != NULL ? adjustedUVs : modelUVs );
 
-	gRenderer->GLDrawArrays( GL_TRIANGLES, 0, vertexCount );
+	renderTriangles();
 }
@@ -44,7 +44,13 @@ void CCModelBase::render(const bool alpha)
             refreshModelMatrix();
             GLMultMatrixf( modelMatrix );
 
-            gRenderer->setShader( shader );
+            // When queued, the shader's only bound once the queue is submitted
+            CCRenderQueue *renderQueue = gEngine->renderQueue;
+            const bool queued = renderQueue != NULL && renderQueue->isRecording();
+            if( queued == false )
+            {
+                gRenderer->setShader( shader );
+            }
 
             if( colour != NULL )
             {
@@ -56,7 +62,14 @@ void CCModelBase::render(const bool alpha)
                 for( int i=0; i<primitives.length; ++i )
                 {
                     CCPrimitiveBase *primitive = primitives.list[i];
-                    primitive->render();
+                    if( queued )
+                    {
+                        renderQueue->add( primitive, shader );
+                    }
+                    else
+                    {
+                        primitive->render();
+                    }
                 }
             }
 
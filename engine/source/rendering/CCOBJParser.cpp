@@ -0,0 +1,389 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCOBJParser.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCOBJParser.h"
+
+
+// Exactly representable as doubles
+static const double PowersOf10[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+static inline bool IsDigit(const char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+
+static inline bool IsSpace(const char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+
+static inline bool IsLineEnd(const char *text, const char *end)
+{
+    return text >= end || *text == '\n' || *text == '\r' || *text == '#' || *text == 0;
+}
+
+
+static inline const char* SkipSpaces(const char *text, const char *end)
+{
+    while( text < end && IsSpace( *text ) )
+    {
+        text++;
+    }
+    return text;
+}
+
+
+// Parses an OBJ index and makes it zero based, returns NULL if there's no number
+static const char* ParseIndex(const char *text, const char *end, const uint elements, int &index)
+{
+    bool negative = false;
+    if( text < end && ( *text == '-' || *text == '+' ) )
+    {
+        negative = *text == '-';
+        text++;
+    }
+
+    if( text >= end || IsDigit( *text ) == false )
+    {
+        return NULL;
+    }
+
+    uint value = 0;
+    while( text < end && IsDigit( *text ) )
+    {
+        // Anything past a billion is out of range anyway
+        if( value < 1000000000 )
+        {
+            value = value * 10 + ( *text - '0' );
+        }
+        text++;
+    }
+
+    // Negative indices count back from the last element read so far, 0 is never valid
+    if( value == 0 || value > elements )
+    {
+        index = -1;
+    }
+    else
+    {
+        index = negative ? (int)( elements - value ) : (int)( value - 1 );
+    }
+    return text;
+}
+
+
+CCOBJParser::CCOBJParser()
+{
+}
+
+
+const char* CCOBJParser::ParseFloat(const char *text, const char *end, float &value)
+{
+    bool negative = false;
+    if( text < end && ( *text == '-' || *text == '+' ) )
+    {
+        negative = *text == '-';
+        text++;
+    }
+
+    // Up to 17 significant digits are kept, the rest only scale the result
+    const unsigned long long mantissaLimit = 10000000000000000ULL;
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+
+    while( text < end && IsDigit( *text ) )
+    {
+        if( mantissa < mantissaLimit )
+        {
+            mantissa = mantissa * 10 + ( *text - '0' );
+        }
+        else
+        {
+            exponent++;
+        }
+        hasDigits = true;
+        text++;
+    }
+
+    if( text < end && *text == '.' )
+    {
+        text++;
+        while( text < end && IsDigit( *text ) )
+        {
+            if( mantissa < mantissaLimit )
+            {
+                mantissa = mantissa * 10 + ( *text - '0' );
+                exponent--;
+            }
+            hasDigits = true;
+            text++;
+        }
+    }
+
+    if( hasDigits == false )
+    {
+        return NULL;
+    }
+
+    if( text < end && ( *text == 'e' || *text == 'E' ) )
+    {
+        const char *exponentText = text + 1;
+        bool negativeExponent = false;
+        if( exponentText < end && ( *exponentText == '-' || *exponentText == '+' ) )
+        {
+            negativeExponent = *exponentText == '-';
+            exponentText++;
+        }
+
+        // Without digits the e isn't part of the number
+        if( exponentText < end && IsDigit( *exponentText ) )
+        {
+            int written = 0;
+            while( exponentText < end && IsDigit( *exponentText ) )
+            {
+                if( written < 10000 )
+                {
+                    written = written * 10 + ( *exponentText - '0' );
+                }
+                exponentText++;
+            }
+            exponent += negativeExponent ? -written : written;
+            text = exponentText;
+        }
+    }
+
+    double result = (double)mantissa;
+    if( mantissa != 0 && exponent != 0 )
+    {
+        if( exponent > 0 )
+        {
+            result = exponent <= 22 ? result * PowersOf10[exponent] : result * pow( 10.0, exponent );
+        }
+        else
+        {
+            result = exponent >= -22 ? result / PowersOf10[-exponent] : result / pow( 10.0, -exponent );
+        }
+    }
+
+    value = (float)( negative ? -result : result );
+    return text;
+}
+
+
+bool CCOBJParser::parse(const char *data, const uint length)
+{
+    positions.length = 0;
+    uvs.length = 0;
+    normals.length = 0;
+    corners.length = 0;
+
+    // Exporters write roughly a vertex or a face every 32 bytes, guessing saves most of the regrowing
+    const uint estimate = length / 32;
+    positions.reserve( estimate );
+    corners.reserve( estimate * 3 );
+
+    const char *text = data;
+    const char *end = data + length;
+    while( text < end && *text != 0 )
+    {
+        text = SkipSpaces( text, end );
+        if( text + 1 < end )
+        {
+            if( text[0] == 'v' )
+            {
+                if( IsSpace( text[1] ) )
+                {
+                    text = parseVector( text + 2, end, positions, 3 );
+                }
+                else if( text + 2 < end && IsSpace( text[2] ) )
+                {
+                    if( text[1] == 't' )
+                    {
+                        text = parseVector( text + 3, end, uvs, 2 );
+                    }
+                    else if( text[1] == 'n' )
+                    {
+                        text = parseVector( text + 3, end, normals, 3 );
+                    }
+                }
+            }
+            else if( text[0] == 'f' && IsSpace( text[1] ) )
+            {
+                text = parseFace( text + 2, end );
+            }
+        }
+
+        if( text == NULL )
+        {
+            DEBUGLOG( "CCOBJParser::parse() malformed line\n" );
+            return false;
+        }
+
+        // Skip whatever's left of the line, such as comments, a vt's w or lines we don't use
+        while( text < end && *text != '\n' && *text != 0 )
+        {
+            text++;
+        }
+        if( text < end && *text == '\n' )
+        {
+            text++;
+        }
+    }
+
+    return true;
+}
+
+
+const char* CCOBJParser::parseVector(const char *text, const char *end, GrowingArray<float> &array, const int size)
+{
+    float *vector = array.extend( size );
+    for( int i=0; i<size; ++i )
+    {
+        text = SkipSpaces( text, end );
+
+        // A uv's v is optional
+        if( i > 0 && size == 2 && IsLineEnd( text, end ) )
+        {
+            vector[i] = 0.0f;
+            continue;
+        }
+
+        text = ParseFloat( text, end, vector[i] );
+        if( text == NULL )
+        {
+            return NULL;
+        }
+    }
+    return text;
+}
+
+
+const char* CCOBJParser::parseFace(const char *text, const char *end)
+{
+    const uint positionCount = getPositionCount();
+    const uint uvCount = getUVCount();
+    const uint normalCount = getNormalCount();
+
+    int first[3], previous[3];
+    int cornerCount = 0;
+    while( true )
+    {
+        text = SkipSpaces( text, end );
+        if( IsLineEnd( text, end ) )
+        {
+            break;
+        }
+
+        int corner[3] = { -1, -1, -1 };
+        text = ParseIndex( text, end, positionCount, corner[0] );
+        if( text == NULL || corner[0] == -1 )
+        {
+            return NULL;
+        }
+
+        // Missing or out of range uvs and normals are left as zero
+        if( text < end && *text == '/' )
+        {
+            text++;
+            if( text < end && *text != '/' )
+            {
+                text = ParseIndex( text, end, uvCount, corner[1] );
+                if( text == NULL )
+                {
+                    return NULL;
+                }
+            }
+
+            if( text < end && *text == '/' )
+            {
+                text++;
+                text = ParseIndex( text, end, normalCount, corner[2] );
+                if( text == NULL )
+                {
+                    return NULL;
+                }
+            }
+        }
+
+        if( IsLineEnd( text, end ) == false && IsSpace( *text ) == false )
+        {
+            return NULL;
+        }
+
+        // Polygons are fanned around their first corner
+        if( cornerCount == 0 )
+        {
+            memcpy( first, corner, sizeof( corner ) );
+        }
+        else if( cornerCount >= 2 )
+        {
+            int *triangle = corners.extend( 9 );
+            memcpy( &triangle[0], first, sizeof( first ) );
+            memcpy( &triangle[3], previous, sizeof( previous ) );
+            memcpy( &triangle[6], corner, sizeof( corner ) );
+        }
+        memcpy( previous, corner, sizeof( corner ) );
+        cornerCount++;
+    }
+    return text;
+}
+
+
+bool CCOBJParser::createSoup(float **vertices, float **normals, float **uvs, uint &vertexCount,
+                             CCMinMax &mmX, CCMinMax &mmY, CCMinMax &mmZ) const
+{
+    vertexCount = getCornerCount();
+    if( vertexCount == 0 )
+    {
+        return false;
+    }
+
+    float *soupVertices = (float*)malloc( sizeof( float ) * vertexCount * 3 );
+    float *soupNormals = (float*)calloc( vertexCount * 3, sizeof( float ) );
+    float *soupUVs = (float*)calloc( vertexCount * 2, sizeof( float ) );
+
+    for( uint i=0; i<vertexCount; ++i )
+    {
+        const int *corner = &corners.data[i*3];
+
+        const float *position = &positions.data[corner[0]*3];
+        soupVertices[i*3+0] = position[0];
+        soupVertices[i*3+1] = position[1];
+        soupVertices[i*3+2] = position[2];
+        mmX.consider( position[0] );
+        mmY.consider( position[1] );
+        mmZ.consider( position[2] );
+
+        if( corner[1] != -1 )
+        {
+            const float *uv = &this->uvs.data[corner[1]*2];
+            soupUVs[i*2+0] = uv[0];
+            soupUVs[i*2+1] = 1.0f - uv[1];
+        }
+
+        if( corner[2] != -1 )
+        {
+            memcpy( &soupNormals[i*3], &this->normals.data[corner[2]*3], sizeof( float ) * 3 );
+        }
+    }
+
+    *vertices = soupVertices;
+    *normals = soupNormals;
+    *uvs = soupUVs;
+    return true;
+}
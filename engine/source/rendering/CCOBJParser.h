@@ -0,0 +1,101 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCOBJParser.h
+ * Description : Single pass OBJ text parser.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCOBJPARSER_H__
+#define __CCOBJPARSER_H__
+
+
+// Scans the text once, in place, without allocating per line or token
+// Handles v, vt, vn and f lines, other lines are skipped
+// Face corners may be v, v/vt, v/vt/vn or v//vn, with negative indices counting back from the last element read
+class CCOBJParser
+{
+public:
+    CCOBJParser();
+
+    // Faces are fanned into triangles, fails on malformed numbers or positions out of range
+    bool parse(const char *data, const uint length);
+
+    // Expands the triangles into one vertex per corner, missing normals and uvs are zeroed
+    // uvs are flipped vertically for GL, the arrays are malloc'd and become the caller's
+    bool createSoup(float **vertices, float **normals, float **uvs, uint &vertexCount,
+                    CCMinMax &mmX, CCMinMax &mmY, CCMinMax &mmZ) const;
+
+    // Parses a float as written by OBJ exporters, returns where it stopped, or NULL if there's no number
+    static const char* ParseFloat(const char *text, const char *end, float &value);
+
+    uint getPositionCount() const { return positions.length / 3; }
+    uint getUVCount() const { return uvs.length / 2; }
+    uint getNormalCount() const { return normals.length / 3; }
+    const float* getPositions() const { return positions.data; }
+    const float* getUVs() const { return uvs.data; }
+    const float* getNormals() const { return normals.data; }
+
+    // Position, uv and normal index of each triangle corner, -1 when missing
+    uint getCornerCount() const { return corners.length / 3; }
+    const int* getCorners() const { return corners.data; }
+
+protected:
+    // Doubles its capacity as it fills, so a file costs a handful of allocations
+    template <typename T> struct GrowingArray
+    {
+        GrowingArray()
+        {
+            data = NULL;
+            length = 0;
+            allocated = 0;
+        }
+
+        ~GrowingArray()
+        {
+            FREE_POINTER( data );
+        }
+
+        void reserve(const uint size)
+        {
+            if( size > allocated )
+            {
+                allocated = size;
+                data = (T*)realloc( data, sizeof( T ) * allocated );
+            }
+        }
+
+        // Space for count more elements
+        T* extend(const uint count)
+        {
+            if( length + count > allocated )
+            {
+                reserve( MAX( allocated * 2, length + count ) );
+            }
+            T *end = &data[length];
+            length += count;
+            return end;
+        }
+
+        T *data;
+        uint length;
+        uint allocated;
+    };
+
+    const char* parseVector(const char *text, const char *end, GrowingArray<float> &array, const int size);
+    const char* parseFace(const char *text, const char *end);
+
+protected:
+    GrowingArray<float> positions;
+    GrowingArray<float> uvs;
+    GrowingArray<float> normals;
+    GrowingArray<int> corners;
+};
+
+
+#endif // __CCOBJPARSER_H__
@@ -24,6 +24,7 @@ CCPrimitiveBase::CCPrimitiveBase(const long primitiveID)
 	normals = NULL;
 	textureInfo = NULL;
     frameBufferID = -1;
+    vertexPointersCached = false;
 }
 
 
@@ -37,6 +38,7 @@ void CCPrimitiveBase::destruct()
 
 	if( normals != NULL )
 	{
+		gRenderer->derefVertexPointer( ATTRIB_NORMAL, normals );
         free( normals );
 	}
 
@@ -152,5 +154,11 @@ void CCPrimitiveBase::render()
 		gEngine->textureManager->setTextureIndex( 0 );
 	}
 
+    if( vertexPointersCached == false )
+    {
+        cacheVertexPointers();
+        vertexPointersCached = true;
+    }
+
 	renderVertices( usingTexture );
 }
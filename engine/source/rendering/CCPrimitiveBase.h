@@ -38,6 +38,9 @@ protected:
 	TextureInfo *textureInfo;
     int frameBufferID;
 
+    // Our arrays are handed to the renderer on our first render, as loading may run on a job thread
+    bool vertexPointersCached;
+
 
     
 public:
@@ -76,6 +79,10 @@ public:
 	virtual void render();
 	virtual void renderVertices(const bool textured) = 0;
 	virtual void renderOutline() {};
+
+protected:
+    // Tell the renderer which of our arrays it can keep in buffer objects
+    virtual void cacheVertexPointers() {};
 };
 
 
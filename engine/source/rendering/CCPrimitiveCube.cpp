@@ -160,4 +160,12 @@ void CCPrimitiveCube::setup(const float bottomDepth, const float topDepth,
     addVertex( vertices, vertexIndex,   rightTop,       top,    frontTop );
     addVertex( vertices, vertexIndex,   leftTop,        top,    backTop );
     addVertex( vertices, vertexIndex,   rightTop,       top,    backTop );
+
+    gRenderer->updateVertexPointer( ATTRIB_VERTEX, vertices );
+}
+
+
+void CCPrimitiveCube::cacheVertexPointers()
+{
+    gRenderer->cacheVertexPointer( ATTRIB_VERTEX, vertices, sizeof( float ) * vertexCount * 3 );
 }
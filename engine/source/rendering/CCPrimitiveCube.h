@@ -45,6 +45,9 @@ public:
                const float y, const float height,
                const float leftBottom, const float rightBottom,
                const float leftTop, const float rightTop);
+
+protected:
+    virtual void cacheVertexPointers();
 };
 
 
@@ -15,9 +15,6 @@
 #define __CCPRIMITIVEOBJ_H__
 
 
-#include "ObjLoader.h"
-
-
 class CCPrimitiveOBJ : public CCPrimitive3D
 {
     typedef CCPrimitive3D super;
@@ -28,8 +25,9 @@ public:
 
 	static void LoadOBJ(const char *file, const CCResourceType resourceType, CCLambdaCallback *callback);
     virtual bool loadData(const char *fileData);
+
 protected:
-	bool loadOBJMesh(ObjMesh *objMesh);
+    virtual CCPrimitive3D* newPrimitive() const { return new CCPrimitiveOBJ(); }
 
     // PrimitiveBase
 public:
@@ -22,6 +22,12 @@ void CCPrimitiveSphere::renderVertices(const bool textured)
 }
 
 
+void CCPrimitiveSphere::cacheVertexPointers()
+{
+    gRenderer->cacheVertexPointer( ATTRIB_VERTEX, vertices, sizeof( float ) * vertexCount * 3 );
+}
+
+
 static void appendNormals(CCVector3 *normal, const float *vertices, float *normals, const uint n, const float z)
 {
     normal->set( vertices[n-3], vertices[n-2], vertices[n-1] * z );
@@ -24,6 +24,9 @@ public:
 	virtual void renderVertices(const bool textured);
 
 	void setup(const float radius);
+protected:
+    virtual void cacheVertexPointers();
+
 protected:
 	uint vertexCount;
 };
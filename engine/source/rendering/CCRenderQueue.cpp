@@ -0,0 +1,234 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCRenderQueue.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCRenderQueue.h"
+#include "CCPrimitives.h"
+
+
+CCRenderQueue::CCRenderQueue()
+{
+    recording = false;
+    recordingPass = render_background;
+    recordingAlpha = false;
+
+    keys = NULL;
+    order = NULL;
+    keysAllocated = 0;
+
+    numberOfSubmitted = 0;
+    submitTime = 0.0;
+}
+
+
+CCRenderQueue::~CCRenderQueue()
+{
+    for( int pass=0; pass<render_finished; ++pass )
+    {
+        for( int alpha=0; alpha<2; ++alpha )
+        {
+            FREE_POINTER( buckets[pass][alpha].commands );
+        }
+    }
+
+    FREE_POINTER( keys );
+    FREE_POINTER( order );
+}
+
+
+void CCRenderQueue::begin(const CCRenderPass pass, const bool alpha)
+{
+    CCASSERT( recording == false );
+    recording = true;
+    recordingPass = pass;
+    recordingAlpha = alpha;
+    getBucket( pass, alpha ).length = 0;
+
+    // Shader names are only held onto until we're submitted
+    shaders.length = 0;
+}
+
+
+void CCRenderQueue::add(CCPrimitiveBase *primitive, const char *shader)
+{
+    CCASSERT( recording );
+
+    Bucket &bucket = getBucket( recordingPass, recordingAlpha );
+    if( bucket.length == bucket.allocated )
+    {
+        bucket.allocated = bucket.allocated > 0 ? bucket.allocated * 2 : 256;
+        bucket.commands = (CCDrawCommand*)realloc( bucket.commands, sizeof( CCDrawCommand ) * bucket.allocated );
+        CCASSERT( bucket.commands != NULL );
+    }
+
+    CCDrawCommand &command = bucket.commands[bucket.length++];
+    command.primitive = primitive;
+    command.shader = shader;
+    command.shaderID = getShaderID( shader );
+
+    const CCCameraBase *camera = CCCameraBase::CurrentCamera;
+    command.world = camera->pushedMatrix[camera->currentPush];
+    command.colour = CCGetColour();
+
+    command.states = 0;
+    if( CCRenderer::CCGetBlendState() )
+    {
+        command.states |= CCDrawCommand::state_blend;
+    }
+    if( CCRenderer::CCGetDepthReadState() )
+    {
+        command.states |= CCDrawCommand::state_depthRead;
+    }
+    if( CCRenderer::CCGetDepthWriteState() )
+    {
+        command.states |= CCDrawCommand::state_depthWrite;
+    }
+    if( CCRenderer::CCGetCullingState() )
+    {
+        command.states |= CCDrawCommand::state_culling;
+    }
+    if( CCRenderer::CCGetCullingType() == GL_FRONT )
+    {
+        command.states |= CCDrawCommand::state_frontCulling;
+    }
+}
+
+
+void CCRenderQueue::submit()
+{
+    CCASSERT( recording );
+    recording = false;
+
+    Bucket &bucket = getBucket( recordingPass, recordingAlpha );
+    const int count = bucket.length;
+    if( count == 0 )
+    {
+        return;
+    }
+
+    const double startTime = CCEngine::GetSystemTime();
+
+    if( count > keysAllocated )
+    {
+        keysAllocated = MAX( count, keysAllocated * 2 );
+        FREE_POINTER( keys );
+        FREE_POINTER( order );
+        keys = (CCSortKey*)malloc( sizeof( CCSortKey ) * keysAllocated );
+        order = (int*)malloc( sizeof( int ) * keysAllocated );
+        CCASSERT( keys != NULL && order != NULL );
+    }
+
+    for( int i=0; i<count; ++i )
+    {
+        order[i] = i;
+    }
+
+    if( recordingAlpha == false )
+    {
+        // Shader, then texture, then render states, then the order they were queued in
+        for( int i=0; i<count; ++i )
+        {
+            const CCDrawCommand &command = bucket.commands[i];
+            const int textureIndex = command.primitive->getTextureHandleIndex();
+            const CCSortKey texture = textureIndex > 0 ? (CCSortKey)( textureIndex & 0xffff ) : 0;
+            keys[i] = ( (CCSortKey)( command.shaderID & 0xff ) << 56 ) |
+                      ( texture << 40 ) |
+                      ( (CCSortKey)( command.states & 0xff ) << 32 ) |
+                      (CCSortKey)i;
+        }
+        sorter.sort( keys, order, count );
+    }
+
+    // Put the render states back as they were queued with once we're done
+    const bool blend = CCRenderer::CCGetBlendState();
+    const bool depthRead = CCRenderer::CCGetDepthReadState();
+    const bool depthWrite = CCRenderer::CCGetDepthWriteState();
+    const bool culling = CCRenderer::CCGetCullingState();
+    const bool frontCulling = CCRenderer::CCGetCullingType() == GL_FRONT;
+
+    CCCameraBase *camera = CCCameraBase::CurrentCamera;
+    uint currentShaderID = (uint)-1;
+    for( int i=0; i<count; ++i )
+    {
+        const CCDrawCommand &command = bucket.commands[order[i]];
+
+        bool shaderChanged = false;
+        if( command.shaderID != currentShaderID )
+        {
+            currentShaderID = command.shaderID;
+            shaderChanged = gRenderer->setShader( command.shader );
+        }
+
+        // The colour is set per shader, but only tracked once, so make sure a newly bound shader has it
+        if( shaderChanged && CCGetColour().equals( command.colour ) )
+        {
+            GLColor4f( command.colour.red, command.colour.green, command.colour.blue, command.colour.alpha );
+        }
+        CCSetColour( command.colour );
+
+        const uint states = command.states;
+        CCRenderer::CCSetBlend( ( states & CCDrawCommand::state_blend ) != 0 );
+        CCRenderer::CCSetDepthRead( ( states & CCDrawCommand::state_depthRead ) != 0 );
+        CCRenderer::CCSetDepthWrite( ( states & CCDrawCommand::state_depthWrite ) != 0 );
+        CCRenderer::CCSetCulling( ( states & CCDrawCommand::state_culling ) != 0 );
+        if( states & CCDrawCommand::state_frontCulling )
+        {
+            CCRenderer::CCSetFrontCulling();
+        }
+        else
+        {
+            CCRenderer::CCSetBackCulling();
+        }
+
+        GLPushMatrix();
+        camera->pushedMatrix[camera->currentPush] = command.world;
+        command.primitive->render();
+        GLPopMatrix();
+    }
+
+    CCRenderer::CCSetBlend( blend );
+    CCRenderer::CCSetDepthRead( depthRead );
+    CCRenderer::CCSetDepthWrite( depthWrite );
+    CCRenderer::CCSetCulling( culling );
+    if( frontCulling )
+    {
+        CCRenderer::CCSetFrontCulling();
+    }
+    else
+    {
+        CCRenderer::CCSetBackCulling();
+    }
+
+    bucket.length = 0;
+    numberOfSubmitted += count;
+    submitTime += CCEngine::GetSystemTime() - startTime;
+}
+
+
+void CCRenderQueue::resetStats()
+{
+    numberOfSubmitted = 0;
+    submitTime = 0.0;
+}
+
+
+uint CCRenderQueue::getShaderID(const char *shader)
+{
+    for( int i=0; i<shaders.length; ++i )
+    {
+        const char *name = shaders.list[i];
+        if( name == shader || CCText::Equals( name, shader ) )
+        {
+            return i;
+        }
+    }
+
+    shaders.add( shader );
+    return shaders.length-1;
+}
@@ -0,0 +1,106 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCRenderQueue.h
+ * Description : Defers model draws into per pass buckets, submitted sorted by render state.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCRENDERQUEUE_H__
+#define __CCRENDERQUEUE_H__
+
+
+#include "CCRadixSort.h"
+
+class CCPrimitiveBase;
+
+
+// Everything needed to issue a primitive's draw later on
+struct CCDrawCommand
+{
+    enum States
+    {
+        state_blend         = 0x01,
+        state_depthRead     = 0x02,
+        state_depthWrite    = 0x04,
+        state_culling       = 0x08,
+        state_frontCulling  = 0x10,
+    };
+
+    CCPrimitiveBase *primitive;
+    const char *shader;
+    uint shaderID;
+    CCMatrix world;
+    CCColour colour;
+    uint states;
+};
+
+
+class CCRenderQueue
+{
+public:
+    CCRenderQueue();
+    ~CCRenderQueue();
+
+    // Model draws are queued into the pass's bucket until it's submitted
+    void begin(const CCRenderPass pass, const bool alpha);
+    inline bool isRecording() const { return recording; }
+
+    // Takes the render states, colour and model matrix currently pending
+    void add(CCPrimitiveBase *primitive, const char *shader);
+
+    // Opaque buckets are drawn grouped by shader, texture then render state
+    // Alpha buckets keep the order they were queued in, so they're only back to front if every draw in the pass is queued
+    void submit();
+
+    // Totals across every submit since the stats were last reset
+    void resetStats();
+    int getNumberOfSubmitted() const { return numberOfSubmitted; }
+    double getSubmitTime() const { return submitTime; }
+
+protected:
+    struct Bucket
+    {
+        Bucket()
+        {
+            commands = NULL;
+            length = 0;
+            allocated = 0;
+        }
+
+        CCDrawCommand *commands;
+        int length;
+        int allocated;
+    };
+
+    Bucket& getBucket(const CCRenderPass pass, const bool alpha) { return buckets[pass][alpha ? 1 : 0]; }
+
+    // Small ids for the shaders queued since begin, so they fit in the sort keys
+    uint getShaderID(const char *shader);
+
+protected:
+    Bucket buckets[render_finished][2];
+
+    bool recording;
+    CCRenderPass recordingPass;
+    bool recordingAlpha;
+
+    // Scratch kept between submits
+    CCSortKey *keys;
+    int *order;
+    int keysAllocated;
+    CCRadixSort sorter;
+
+    CCPtrList<const char> shaders;
+
+    int numberOfSubmitted;
+    double submitTime;
+};
+
+
+#endif // __CCRENDERQUEUE_H__
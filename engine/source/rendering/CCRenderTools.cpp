@@ -14,81 +14,19 @@
 //-----------------
 void CCMatrixMulVec(const float matrix[16], const float in[4], float out[4])
 {
-    int i;
-    for( i=0; i<4; ++i )
-    {
-        out[i] =
-        in[0] * matrix[0*4+i] +
-        in[1] * matrix[1*4+i] +
-        in[2] * matrix[2*4+i] +
-        in[3] * matrix[3*4+i];
-    }
+    CCMatrixTransformVector4( out, *(const CCMatrix*)matrix, in );
 }
 
 
 void CCMatrixMulMat(const float a[16], const float b[16], float r[16])
 {
-    int i, j;
-    for( i=0; i<4; ++i )
-    {
-        for( j=0; j<4; ++j )
-        {
-             r[i*4+j] = a[i*4+0]*b[0*4+j] +	a[i*4+1]*b[1*4+j] +	a[i*4+2]*b[2*4+j] +	a[i*4+3]*b[3*4+j];
-        }
-    }
+    CCMatrixMultiply( *(CCMatrix*)r, *(const CCMatrix*)a, *(const CCMatrix*)b );
 }
 
 
 bool CCMatrixInvert(const float m[16], float invOut[16])
 {
-	float inv[16];
-	inv[0]	=   m[5]*m[10]*m[15]	- m[5]*m[11]*m[14]	- m[9]*m[6]*m[15]
-			  + m[9]*m[7]*m[14]		+ m[13]*m[6]*m[11]	- m[13]*m[7]*m[10];
-	inv[4]	= - m[4]*m[10]*m[15]	+ m[4]*m[11]*m[14]	+ m[8]*m[6]*m[15]
-			  - m[8]*m[7]*m[14]		- m[12]*m[6]*m[11]	+ m[12]*m[7]*m[10];
-	inv[8]	=   m[4]*m[9]*m[15]		- m[4]*m[11]*m[13]	- m[8]*m[5]*m[15]
-			  + m[8]*m[7]*m[13]		+ m[12]*m[5]*m[11]	- m[12]*m[7]*m[9];
-	inv[12] = - m[4]*m[9]*m[14]		+ m[4]*m[10]*m[13]	+ m[8]*m[5]*m[14]
-			  - m[8]*m[6]*m[13]		- m[12]*m[5]*m[10]	+ m[12]*m[6]*m[9];
-	inv[1]	= - m[1]*m[10]*m[15]	+ m[1]*m[11]*m[14]	+ m[9]*m[2]*m[15]
-			  - m[9]*m[3]*m[14]		- m[13]*m[2]*m[11]	+ m[13]*m[3]*m[10];
-	inv[5]	=   m[0]*m[10]*m[15]	- m[0]*m[11]*m[14]	- m[8]*m[2]*m[15]
-			  + m[8]*m[3]*m[14]		+ m[12]*m[2]*m[11]	- m[12]*m[3]*m[10];
-	inv[9]	= - m[0]*m[9]*m[15]		+ m[0]*m[11]*m[13]	+ m[8]*m[1]*m[15]
-			  - m[8]*m[3]*m[13]		- m[12]*m[1]*m[11]	+ m[12]*m[3]*m[9];
-	inv[13] =   m[0]*m[9]*m[14]		- m[0]*m[10]*m[13]	- m[8]*m[1]*m[14]
-			  + m[8]*m[2]*m[13]		+ m[12]*m[1]*m[10]	- m[12]*m[2]*m[9];
-	inv[2]	=   m[1]*m[6]*m[15]		- m[1]*m[7]*m[14]	- m[5]*m[2]*m[15]
-			  + m[5]*m[3]*m[14]		+ m[13]*m[2]*m[7]	- m[13]*m[3]*m[6];
-	inv[6]	= - m[0]*m[6]*m[15]		+ m[0]*m[7]*m[14]	+ m[4]*m[2]*m[15]
-			  - m[4]*m[3]*m[14]		- m[12]*m[2]*m[7]	+ m[12]*m[3]*m[6];
-	inv[10] =   m[0]*m[5]*m[15]		- m[0]*m[7]*m[13]	- m[4]*m[1]*m[15]
-			  + m[4]*m[3]*m[13]		+ m[12]*m[1]*m[7]	- m[12]*m[3]*m[5];
-	inv[14] = - m[0]*m[5]*m[14]		+ m[0]*m[6]*m[13]	+ m[4]*m[1]*m[14]
-			  - m[4]*m[2]*m[13]		- m[12]*m[1]*m[6]	+ m[12]*m[2]*m[5];
-	inv[3]	= - m[1]*m[6]*m[11]		+ m[1]*m[7]*m[10]	+ m[5]*m[2]*m[11]
-			  - m[5]*m[3]*m[10]		- m[9]*m[2]*m[7]	+ m[9]*m[3]*m[6];
-	inv[7]	=   m[0]*m[6]*m[11]		- m[0]*m[7]*m[10]	- m[4]*m[2]*m[11]
-			  + m[4]*m[3]*m[10]		+ m[8]*m[2]*m[7]	- m[8]*m[3]*m[6];
-	inv[11] = - m[0]*m[5]*m[11]		+ m[0]*m[7]*m[9]	+ m[4]*m[1]*m[11]
-			  - m[4]*m[3]*m[9]		- m[8]*m[1]*m[7]	+ m[8]*m[3]*m[5];
-	inv[15] =   m[0]*m[5]*m[10]		- m[0]*m[6]*m[9]	- m[4]*m[1]*m[10]
-			  + m[4]*m[2]*m[9]		+ m[8]*m[1]*m[6]	- m[8]*m[2]*m[5];
-
-	float det = m[0]*inv[0] + m[1]*inv[4] + m[2]*inv[8] + m[3]*inv[12];
-	if( det == 0.0f )
-	{
-		return false;
-	}
-
-	det = 1.0f / det;
-
-	for( int i=0; i<16; ++i )
-	{
-		invOut[i] = inv[i] * det;
-	}
-
-	return true;
+    return CCMatrixInverse( *(CCMatrix*)invOut, *(const CCMatrix*)m );
 }
 
 
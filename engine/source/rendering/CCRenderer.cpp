@@ -20,6 +20,7 @@
 CCShader::CCShader(const char *name)
 {
     this->name = name;
+    uploadedCameraMatrices = false;
 }
 
 
@@ -108,9 +109,19 @@ bool CCRenderer::setup()
     // All current iPhoneOS devices support BGRA via an extension.
     BGRASupport = CCTextureBase::ExtensionSupported( "GL_IMG_texture_format_BGRA8888" );
 
+    // Core in desktop GL, an extension in GL ES 2
+#if defined IOS || defined ANDROID
+    uintIndexSupport = CCTextureBase::ExtensionSupported( "GL_OES_element_index_uint" );
+#else
+    uintIndexSupport = true;
+#endif
+
     frameBufferManager.setup();
     DEBUG_OPENGL();
 
+    // Any buffers we had went with the previous context
+    vertexBufferManager.invalidate();
+
     // Screen dimensions
     setupScreenSizeParams();
 
@@ -354,6 +365,24 @@ bool CCRenderer::setShader(const char *name, const bool useVertexColours, const
 }
 
 
+void CCRenderer::cacheVertexPointer(const uint index, const void *pointer, const uint size)
+{
+    vertexBufferManager.cache( pointer, size );
+}
+
+
+void CCRenderer::updateVertexPointer(const uint index, const void *pointer)
+{
+    vertexBufferManager.update( pointer );
+}
+
+
+void CCRenderer::derefVertexPointer(const uint index, const void *pointer)
+{
+    vertexBufferManager.deref( pointer );
+}
+
+
 void CCRenderer::CCSetRenderStates(const bool setModelViewProjectionMatrix)
 {
     if( ActiveRenderState.blendEnabled != PendingRenderState.blendEnabled )
@@ -395,7 +424,7 @@ void CCRenderer::CCSetRenderStates(const bool setModelViewProjectionMatrix)
             gRenderer->GLDisable( CC_DEPTH_WRITE );
         }
 #else
-        glDepthMask( ActiveRenderState.depthWriteEnabled ? GL_TRUE : GL_FALSE );
+        gRenderer->GLDepthMask( ActiveRenderState.depthWriteEnabled );
 #endif
     }
 
@@ -490,6 +519,12 @@ void CCRenderer::CCSetCulling(const bool toggle)
 }
 
 
+bool CCRenderer::CCGetCullingState()
+{
+    return PendingRenderState.cullingEnabled;
+}
+
+
 GLint CCRenderer::CCGetCullingType()
 {
 	return PendingRenderState.cullingType;
@@ -524,9 +559,21 @@ void CCSetModelViewProjectionMatrix()
     {
         const CCMatrix &projectionMatrix = CCCameraBase::CurrentCamera->getProjectionMatrix();
 
-        const GLint *uniforms = gRenderer->getShader()->uniforms;
-        gRenderer->GLUniformMatrix4fv( uniforms[UNIFORM_PROJECTIONMATRIX], 1, GL_FALSE, projectionMatrix.m );
-        gRenderer->GLUniformMatrix4fv( uniforms[UNIFORM_VIEWMATRIX], 1, GL_FALSE, viewMatrix.m );
+        CCShader *shader = gRenderer->getShader();
+        const GLint *uniforms = shader->uniforms;
+        if( shader->uploadedCameraMatrices == false ||
+            memcmp( shader->uploadedProjectionMatrix.m, projectionMatrix.m, sizeof( projectionMatrix.m ) ) != 0 )
+        {
+            gRenderer->GLUniformMatrix4fv( uniforms[UNIFORM_PROJECTIONMATRIX], 1, GL_FALSE, projectionMatrix.m );
+            shader->uploadedProjectionMatrix = projectionMatrix;
+        }
+        if( shader->uploadedCameraMatrices == false ||
+            memcmp( shader->uploadedViewMatrix.m, viewMatrix.m, sizeof( viewMatrix.m ) ) != 0 )
+        {
+            gRenderer->GLUniformMatrix4fv( uniforms[UNIFORM_VIEWMATRIX], 1, GL_FALSE, viewMatrix.m );
+            shader->uploadedViewMatrix = viewMatrix;
+        }
+        shader->uploadedCameraMatrices = true;
         gRenderer->GLUniformMatrix4fv( uniforms[UNIFORM_MODELMATRIX], 1, GL_FALSE, modelMatrix.m );
 
         if( uniforms[UNIFORM_MODELNORMALMATRIX] != -1 )
@@ -630,6 +677,14 @@ void CCRenderer::GLDisable(const GLenum cap)
 }
 
 
+void CCRenderer::GLDepthMask(const bool toggle)
+{
+#ifndef DXRENDERER
+	glDepthMask( toggle ? GL_TRUE : GL_FALSE );
+#endif
+}
+
+
 void CCRenderer::GLCullFace(const GLenum mode)
 {
 #ifndef DXRENDERER
@@ -646,6 +701,58 @@ void CCRenderer::GLBindTexture(const GLenum mode, const CCTextureName *texture)
 }
 
 
+GLuint CCRenderer::GLGenBuffer()
+{
+    GLuint buffer = 0;
+#ifndef DXRENDERER
+#ifndef QT
+    glGenBuffers( 1, &buffer );
+#endif
+#endif
+    return buffer;
+}
+
+
+void CCRenderer::GLDeleteBuffer(const GLuint buffer)
+{
+#ifndef DXRENDERER
+#ifndef QT
+    glDeleteBuffers( 1, &buffer );
+#endif
+#endif
+}
+
+
+void CCRenderer::GLBindBuffer(const GLenum target, const GLuint buffer)
+{
+#ifndef DXRENDERER
+#ifndef QT
+    glBindBuffer( target, buffer );
+#endif
+#endif
+}
+
+
+void CCRenderer::GLBufferData(const GLenum target, const uint size, const void *data, const GLenum usage)
+{
+#ifndef DXRENDERER
+#ifndef QT
+    glBufferData( target, size, data, usage );
+#endif
+#endif
+}
+
+
+void CCRenderer::GLBufferSubData(const GLenum target, const uint offset, const uint size, const void *data)
+{
+#ifndef DXRENDERER
+#ifndef QT
+    glBufferSubData( target, offset, size, data );
+#endif
+#endif
+}
+
+
 void CCRenderer::GLDrawArrays(GLenum mode, GLint first, GLsizei count)
 {
 #ifndef DXRENDERER
@@ -714,7 +821,7 @@ void GLVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *poin
 {
     if( gRenderer->openGL2() )
     {
-        gRenderer->GLVertexAttribPointer( ATTRIB_VERTEX, size, type, false, stride, pointer, count );
+        gRenderer->GLVertexAttribPointer( ATTRIB_VERTEX, size, type, false, stride, gRenderer->vertexBufferManager.bind( pointer ), count );
     }
     else
     {
@@ -729,7 +836,7 @@ void GLTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *po
 {
     if( gRenderer->openGL2() )
     {
-        gRenderer->GLVertexAttribPointer( ATTRIB_TEXCOORD, size, type, false, stride, pointer, 0 );
+        gRenderer->GLVertexAttribPointer( ATTRIB_TEXCOORD, size, type, false, stride, gRenderer->vertexBufferManager.bind( pointer ), 0 );
     }
     else
     {
@@ -740,6 +847,15 @@ void GLTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *po
 }
 
 
+void GLNormalPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer, const GLsizei count)
+{
+    if( gRenderer->openGL2() )
+    {
+        gRenderer->GLVertexAttribPointer( ATTRIB_NORMAL, size, type, true, stride, gRenderer->vertexBufferManager.bind( pointer ), count );
+    }
+}
+
+
 void GLColor4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
 {
     if( gRenderer->openGL2() )
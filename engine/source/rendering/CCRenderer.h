@@ -16,6 +16,8 @@
 
 
 #include "CCFrameBufferManager.h"
+#include "CCVertexBufferManager.h"
+#include "CCMatrix.h"
 
 
 enum CCRenderFlags
@@ -81,6 +83,10 @@ struct CCShader
     const char *name;
     GLint uniforms[NUM_UNIFORMS];
 
+    // The camera matrices last uploaded, so drawing many models only re-uploads their model matrix
+    CCMatrix uploadedProjectionMatrix, uploadedViewMatrix;
+    bool uploadedCameraMatrices;
+
 #ifdef QT
     class QGLShaderProgram *program;
 #else
@@ -108,10 +114,16 @@ protected:
 
 public:
     CCFrameBufferManager frameBufferManager;
+
+    // Off by default, primitives' arrays are drawn from client memory unless it's enabled
+    CCVertexBufferManager vertexBufferManager;
 	uint renderFlags;
 
     bool BGRASupport;
 
+    // Whether GL_UNSIGNED_INT indices can be drawn, meshes with more than 65536 vertices need them
+    bool uintIndexSupport;
+
 protected:
 	struct RenderState
 	{
@@ -155,11 +167,18 @@ public:
 	virtual void GLScissor(const GLint x, const GLint y, const GLsizei width, const GLsizei height);
 	virtual void GLEnable(const GLenum cap);
 	virtual void GLDisable(const GLenum cap);
+	virtual void GLDepthMask(const bool toggle);
 
 	virtual void GLCullFace(const GLenum mode);
 
 	virtual void GLBindTexture(const GLenum mode, const CCTextureName *texture);
 
+    virtual GLuint GLGenBuffer();
+    virtual void GLDeleteBuffer(const GLuint buffer);
+    virtual void GLBindBuffer(const GLenum target, const GLuint buffer);
+    virtual void GLBufferData(const GLenum target, const uint size, const void *data, const GLenum usage);
+    virtual void GLBufferSubData(const GLenum target, const uint offset, const uint size, const void *data);
+
 	virtual void GLDrawArrays(GLenum mode, GLint first, GLsizei count);
 	virtual void GLDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices);
 
@@ -188,7 +207,7 @@ public:
 
     inline FBOType getDefaultFrameBuffer() { return frameBufferManager.defaultFBO.getFrameBuffer(); }
 
-    inline const CCShader* getShader() { return currentShader; }
+    inline CCShader* getShader() { return currentShader; }
     bool setShader(const char *name, const bool useVertexColours=false, const bool useVertexNormals=false);
 
     const CCSize& getScreenSize() { return screenSize; }
@@ -196,11 +215,14 @@ public:
     float getAspectRatio() { return aspectRatio; }
 
 	// Render API wrapper
+    // Tell the renderer that the pointer's size bytes can be kept in a buffer object until it's dereferenced
+    virtual void cacheVertexPointer(const uint index, const void *pointer, const uint size);
+
     // Tell the renderer that the pointer contents has been updated
-    virtual void updateVertexPointer(const uint index, const void *pointer) {};
+    virtual void updateVertexPointer(const uint index, const void *pointer);
 
     // Tell the renderer that the pointer should no longer be cached
-    virtual void derefVertexPointer(const uint index, const void *pointer) {};
+    virtual void derefVertexPointer(const uint index, const void *pointer);
 
 	static void CCSetRenderStates(const bool setModelViewProjectionMatrix=false);
 
@@ -213,6 +235,7 @@ public:
 	static bool CCGetDepthWriteState();
 
 	static void CCSetCulling(const bool toggle);
+	static bool CCGetCullingState();
 
 	static void CCSetFrontCulling();
 	static void CCSetBackCulling();
@@ -226,6 +249,7 @@ extern void CCSetModelViewProjectionMatrix();
 
 extern void GLVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer, const GLsizei count);
 extern void GLTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer);
+extern void GLNormalPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer, const GLsizei count);
 extern void GLColor4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
 
 extern void CCSetUniformVector3(const uint uniform,
@@ -35,50 +35,42 @@ CCTextureBase::~CCTextureBase()
 
 void CCTextureBase::loadAndCreateAsync(const char *path, const CCResourceType resourceType, const CCTextureLoadOptions options, CCLambdaSafeCallback *callback)
 {
-    CCLAMBDA_4( CreateFunction, CCTextureBase, that, bool, loaded, CCTextureLoadOptions, options, CCLambdaSafeCallback*, callback, {
+    CCLAMBDA_FINISH_6( LoadFunction, CCTextureBase, that, CCText, path, CCResourceType, resourceType, CCTextureLoadOptions, options, CCLambdaSafeCallback*, callback, bool, loaded,
 
+    // Run on a random thread
+    {
         if( gEngine->paused )
         {
             loaded = false;
         }
-        
-        if( loaded )
+        else
         {
-            that->createGLTexture( options );
+            loaded = that->load( path.buffer, resourceType );
         }
+    },
 
-		if( callback != NULL )
-		{
-            callback->runParameters = (void*)loaded;
-			callback->safeRun();
-			delete callback;
-		}
-
-    });
-
-    CCLAMBDA_FINISH_6( LoadFunction, CCTextureBase, that, CCText, path, CCResourceType, resourceType, CCTextureLoadOptions, options, CCLambdaSafeCallback*, callback, bool, loaded,
-
-    // Run on a random thread
+    // Finish on the engine thread
     {
         if( gEngine->paused )
         {
             loaded = false;
         }
-        else
+
+        if( loaded )
         {
-            loaded = that->load( path.buffer, resourceType );
+            that->createGLTexture( options );
         }
-    },
 
-    // Finish on the jobs thread
-    {
-    	if( gEngine != NULL )
-    	{
-            gEngine->jobsToEngineThread( new CreateFunction( that, loaded, options, callback ) );
-    	}
+		if( callback != NULL )
+		{
+            callback->runParameters = (void*)loaded;
+			callback->safeRun();
+			delete callback;
+		}
     });
 
-    gEngine->engineToJobsThread( new LoadFunction( this, path, resourceType, options, callback, false ) );
+    // Decodes don't depend on each other, so they're spread across the job workers
+    gEngine->jobScheduler.submit( gEngine->jobScheduler.createJob( new LoadFunction( this, path, resourceType, options, callback, false ), job_priority_normal, true ) );
 }
 
 
@@ -112,6 +104,11 @@ bool CCTextureBase::ExtensionSupported(const char *extension)
 
     // It takes a bit of care to be fool-proof about parsing the OpenGL extensions string. Don't be fooled by sub-strings, etc.
     extensions = glGetString( GL_EXTENSIONS );
+    if( extensions == NULL )
+    {
+        // No context, as when running headless
+        return false;
+    }
     start = extensions;
     for(;;)
     {
@@ -0,0 +1,243 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCVertexBufferManager.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCVertexBufferManager.h"
+
+
+CCVertexBufferManager::CCVertexBufferManager()
+{
+    enabled = false;
+    lastBound = NULL;
+    boundName = 0;
+    bufferedBytes = 0;
+}
+
+
+CCVertexBufferManager::~CCVertexBufferManager()
+{
+    // Our renderer is already going, the buffers go with its context
+    buffers.deleteObjectsAndList();
+}
+
+
+void CCVertexBufferManager::setEnabled(const bool toggle)
+{
+    if( enabled == toggle )
+    {
+        return;
+    }
+
+#if defined DXRENDERER || defined QT
+    // Client arrays only
+    return;
+#endif
+
+    if( toggle && gRenderer->openGL2() == false )
+    {
+        return;
+    }
+
+    if( toggle == false )
+    {
+        for( int i=0; i<buffers.length; ++i )
+        {
+            release( *buffers.list[i] );
+        }
+
+        if( boundName != 0 )
+        {
+            gRenderer->GLBindBuffer( GL_ARRAY_BUFFER, 0 );
+            boundName = 0;
+        }
+    }
+    enabled = toggle;
+}
+
+
+void CCVertexBufferManager::cache(const void *pointer, const uint size)
+{
+    if( pointer == NULL || size == 0 )
+    {
+        return;
+    }
+
+    // Shared arrays are cached by each primitive using them
+    const int index = find( pointer );
+    if( index < buffers.length && buffers.list[index]->pointer == pointer )
+    {
+        Buffer &buffer = *buffers.list[index];
+        if( buffer.size != size )
+        {
+            release( buffer );
+            buffer.size = size;
+        }
+        return;
+    }
+
+    Buffer *buffer = new Buffer();
+    buffer->pointer = pointer;
+    buffer->size = size;
+    buffer->name = 0;
+    buffer->dirty = true;
+    buffer->streamed = false;
+    buffer->updates = 0;
+    buffers.add( buffer, index );
+}
+
+
+void CCVertexBufferManager::update(const void *pointer)
+{
+    const int index = find( pointer );
+    if( index < buffers.length && buffers.list[index]->pointer == pointer )
+    {
+        Buffer &buffer = *buffers.list[index];
+
+        // Only updates made after it's been drawn count towards streaming it
+        if( buffer.dirty == false && buffer.name != 0 )
+        {
+            buffer.updates++;
+            if( buffer.updates > 1 )
+            {
+                buffer.streamed = true;
+            }
+        }
+        buffer.dirty = true;
+    }
+}
+
+
+void CCVertexBufferManager::deref(const void *pointer)
+{
+    const int index = find( pointer );
+    if( index < buffers.length && buffers.list[index]->pointer == pointer )
+    {
+        Buffer *buffer = buffers.list[index];
+        release( *buffer );
+        if( lastBound == buffer )
+        {
+            lastBound = NULL;
+        }
+        buffers.removeIndex( index );
+        delete buffer;
+    }
+}
+
+
+const void* CCVertexBufferManager::bind(const void *pointer)
+{
+    if( enabled == false )
+    {
+        return pointer;
+    }
+
+    Buffer *buffer = lastBound;
+    if( buffer == NULL || buffer->pointer != pointer )
+    {
+        const int index = find( pointer );
+        buffer = index < buffers.length && buffers.list[index]->pointer == pointer ? buffers.list[index] : NULL;
+    }
+
+    if( buffer == NULL )
+    {
+        // Client array, which can't be read while a buffer is bound
+        if( boundName != 0 )
+        {
+            gRenderer->GLBindBuffer( GL_ARRAY_BUFFER, 0 );
+            boundName = 0;
+        }
+        return pointer;
+    }
+
+    if( buffer->name == 0 )
+    {
+        buffer->name = gRenderer->GLGenBuffer();
+        buffer->dirty = true;
+        bufferedBytes += buffer->size;
+    }
+
+    if( boundName != buffer->name )
+    {
+        gRenderer->GLBindBuffer( GL_ARRAY_BUFFER, buffer->name );
+        boundName = buffer->name;
+    }
+
+    if( buffer->dirty )
+    {
+        upload( *buffer );
+    }
+
+    lastBound = buffer;
+    return NULL;
+}
+
+
+void CCVertexBufferManager::invalidate()
+{
+    for( int i=0; i<buffers.length; ++i )
+    {
+        Buffer &buffer = *buffers.list[i];
+        buffer.name = 0;
+        buffer.dirty = true;
+    }
+    boundName = 0;
+    bufferedBytes = 0;
+}
+
+
+int CCVertexBufferManager::find(const void *pointer) const
+{
+    int low = 0, high = buffers.length;
+    while( low < high )
+    {
+        const int middle = ( low + high ) / 2;
+        if( buffers.list[middle]->pointer < pointer )
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+
+void CCVertexBufferManager::upload(Buffer &buffer)
+{
+    if( buffer.streamed )
+    {
+        // Orphan the old storage, so we don't wait on draws still reading it
+        gRenderer->GLBufferData( GL_ARRAY_BUFFER, buffer.size, NULL, GL_STREAM_DRAW );
+        gRenderer->GLBufferSubData( GL_ARRAY_BUFFER, 0, buffer.size, buffer.pointer );
+    }
+    else
+    {
+        gRenderer->GLBufferData( GL_ARRAY_BUFFER, buffer.size, buffer.pointer, GL_STATIC_DRAW );
+    }
+    buffer.dirty = false;
+}
+
+
+void CCVertexBufferManager::release(Buffer &buffer)
+{
+    if( buffer.name != 0 )
+    {
+        if( boundName == buffer.name )
+        {
+            gRenderer->GLBindBuffer( GL_ARRAY_BUFFER, 0 );
+            boundName = 0;
+        }
+        gRenderer->GLDeleteBuffer( buffer.name );
+        buffer.name = 0;
+        bufferedBytes -= buffer.size;
+    }
+    buffer.dirty = true;
+}
@@ -0,0 +1,75 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCVertexBufferManager.h
+ * Description : Keeps primitives' vertex arrays in buffer objects between draws.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCVERTEXBUFFERMANAGER_H__
+#define __CCVERTEXBUFFERMANAGER_H__
+
+
+// Arrays are looked up by their client pointer, so drawing code keeps passing the same pointers it always has
+// Pointers which aren't cached, or when buffers are disabled, are drawn from client memory as before
+class CCVertexBufferManager
+{
+public:
+    CCVertexBufferManager();
+    ~CCVertexBufferManager();
+
+    // Buffers are off by default, turning them off frees every buffer but remembers what's cached
+    void setEnabled(const bool toggle);
+    bool isEnabled() const { return enabled; }
+
+    // The pointer's size bytes are uploaded the first time they're drawn
+    void cache(const void *pointer, const uint size);
+
+    // The contents have changed, arrays updated every few frames are streamed by orphaning their buffer
+    void update(const void *pointer);
+
+    // Must be called before the pointer is freed
+    void deref(const void *pointer);
+
+    // Binds the pointer's buffer and returns the offset into it, or returns the pointer when it's not buffered
+    const void* bind(const void *pointer);
+
+    // The context was lost, so our buffers are already gone
+    void invalidate();
+
+    int getNumberOfCached() const { return buffers.length; }
+    uint getBufferedBytes() const { return bufferedBytes; }
+
+protected:
+    struct Buffer
+    {
+        const void *pointer;
+        uint size;
+        GLuint name;
+        bool dirty;
+        bool streamed;
+        int updates;
+    };
+
+    // Index of the pointer's buffer, or where it should be inserted, as buffers are kept sorted by pointer
+    int find(const void *pointer) const;
+    void upload(Buffer &buffer);
+    void release(Buffer &buffer);
+
+protected:
+    bool enabled;
+    CCPtrList<Buffer> buffers;
+    Buffer *lastBound;
+    GLuint boundName;
+
+    // Bytes held in buffer objects
+    uint bufferedBytes;
+};
+
+
+#endif // __CCVERTEXBUFFERMANAGER_H__
@@ -212,6 +212,11 @@ void CCSceneBase::addObject(CCObject *object)
     object->inScene = this;
     objects.add( object );
     CCASSERT( objects.length < MAX_OBJECTS );
+
+    if( gEngine->transformStore != NULL && object->getTransformIndex() == -1 )
+    {
+        object->bindTransforms();
+    }
 }
 
 
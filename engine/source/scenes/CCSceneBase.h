@@ -67,6 +67,7 @@ public:
 	// Add object to the scene and place in the created list
 	void addObject(CCObject *object);
 	void removeObject(CCObject* object);
+    inline int getNumberOfObjects() const { return objects.length; }
 
     void addCollideable(CCCollideable *collideable);
     void removeCollideable(CCCollideable *collideable);
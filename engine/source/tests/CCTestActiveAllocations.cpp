@@ -0,0 +1,81 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTestActiveAllocations.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTests.h"
+
+
+// Releases every other allocation and reuses their slots, the stale handles must never be reported active
+void CCTestActiveAllocations(CCBenchmarkEngine *engine)
+{
+    const int count = 100000;
+    CCActiveAllocation **allocations = (CCActiveAllocation**)malloc( sizeof( CCActiveAllocation* ) * count );
+    CCActiveHandle *handles = (CCActiveHandle*)malloc( sizeof( CCActiveHandle ) * count );
+    CCASSERT( allocations != NULL && handles != NULL );
+
+    int failures = 0;
+    for( int i=0; i<count; ++i )
+    {
+        allocations[i] = new CCActiveAllocation();
+        handles[i] = allocations[i]->activeHandle;
+    }
+
+    for( int i=0; i<count; ++i )
+    {
+        if( CCActiveAllocation::IsCallbackActive( handles[i] ) == false )
+        {
+            failures++;
+        }
+    }
+    CCTEST_CHECK( failures == 0 );
+
+    for( int i=0; i<count; i+=2 )
+    {
+        delete allocations[i];
+        allocations[i] = NULL;
+    }
+
+    failures = 0;
+    for( int i=0; i<count; i+=2 )
+    {
+        allocations[i] = new CCActiveAllocation();
+    }
+
+    for( int i=0; i<count; ++i )
+    {
+        const bool active = CCActiveAllocation::IsCallbackActive( handles[i] );
+        if( active != ( i % 2 == 1 ) )
+        {
+            failures++;
+        }
+        if( CCActiveAllocation::IsCallbackActive( allocations[i]->activeHandle ) == false )
+        {
+            failures++;
+        }
+    }
+    CCTEST_CHECK( failures == 0 );
+
+    for( int i=0; i<count; ++i )
+    {
+        delete allocations[i];
+    }
+
+    failures = 0;
+    for( int i=0; i<count; ++i )
+    {
+        if( CCActiveAllocation::IsCallbackActive( handles[i] ) )
+        {
+            failures++;
+        }
+    }
+    CCTEST_CHECK( failures == 0 );
+
+    free( handles );
+    free( allocations );
+}
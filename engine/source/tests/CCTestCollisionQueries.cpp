@@ -0,0 +1,120 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTestCollisionQueries.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTests.h"
+#include "CCJobScheduler.h"
+
+
+struct CCTestQuery
+{
+    CCVector3 min, max;
+    CCCollideable *hit;
+    int numberOfCollideables;
+};
+
+
+static void RunQueries(CCCollisionQueryContext &context, CCTestQuery *queries, const int count)
+{
+    for( int i=0; i<count; ++i )
+    {
+        CCTestQuery &query = queries[i];
+        query.hit = CCOctreeCollideableScan( context, query.min, query.max );
+        query.numberOfCollideables = context.numberOfCollideables;
+    }
+}
+
+
+// Each worker queries with its thread's default context
+CCLAMBDA_2_UNSAFE( TestQueryJob, CCTestQuery*, queries, int, count,
+{
+    RunQueries( CCCollisionQueryContext::Default(), queries, count );
+});
+
+
+// The same box queries on one thread and then interleaved across workers, the results must match
+void CCTestCollisionQueries(CCBenchmarkEngine *engine)
+{
+    const float spacing = 40.0f;
+    const int numberOfObjects = 2000;
+    const int count = 2000;
+    const CCBenchmarkGrid grid( numberOfObjects, spacing );
+    CCSceneBase *scene = NULL;
+    for( int i=0; i<numberOfObjects; ++i )
+    {
+        scene = engine->getScene( scene );
+        grid.createCollideable( scene, i, spacing * 0.4f );
+    }
+
+    CCTestQuery *expected = (CCTestQuery*)malloc( sizeof( CCTestQuery ) * count );
+    CCTestQuery *queries = (CCTestQuery*)malloc( sizeof( CCTestQuery ) * count );
+    for( int i=0; i<count; ++i )
+    {
+        const float size = spacing * ( 0.1f + CCFloatRandom() * 2.0f );
+        CCTestQuery &query = expected[i];
+        query.min.set( CCFloatRandomDualSided() * grid.offset, -size, CCFloatRandomDualSided() * grid.offset );
+        query.max = query.min;
+        query.max.add( size );
+    }
+
+    CCCollisionQueryContext *context = new CCCollisionQueryContext();
+    RunQueries( *context, expected, count );
+    delete context;
+
+    int hits = 0;
+    for( int i=0; i<count; ++i )
+    {
+        if( expected[i].hit != NULL )
+        {
+            hits++;
+        }
+    }
+    CCTEST_CHECK( hits > 0 );
+
+    static const int workerCounts[] = { 2, 4, 8 };
+    for( uint workers=0; workers<sizeof( workerCounts ) / sizeof( int ); ++workers )
+    {
+        CCJobScheduler scheduler;
+        CCTEST_CHECK( scheduler.start( workerCounts[workers] ) );
+
+        int mismatches = 0;
+        for( int round=0; round<3; ++round )
+        {
+            for( int i=0; i<count; ++i )
+            {
+                queries[i].min = expected[i].min;
+                queries[i].max = expected[i].max;
+                queries[i].hit = NULL;
+                queries[i].numberOfCollideables = -1;
+            }
+
+            // Small slices so the workers interleave their queries
+            const int sliceSize = 16;
+            for( int first=0; first<count; first+=sliceSize )
+            {
+                scheduler.submit( new TestQueryJob( &queries[first], MIN( sliceSize, count - first ) ) );
+            }
+            scheduler.waitForIdle();
+
+            for( int i=0; i<count; ++i )
+            {
+                if( queries[i].hit != expected[i].hit || queries[i].numberOfCollideables != expected[i].numberOfCollideables )
+                {
+                    mismatches++;
+                }
+            }
+        }
+        scheduler.stop();
+
+        CCTEST_CHECK( mismatches == 0 );
+    }
+
+    free( expected );
+    free( queries );
+}
@@ -0,0 +1,374 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTestJobScheduler.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTests.h"
+#include "CCJobScheduler.h"
+#include "CCAtomics.h"
+
+
+// Counts how many jobs were run, finished and deleted, and stamps the order they ran in
+class CCTestJob : public CCLambdaCallback
+{
+public:
+    static volatile int Runs;
+    static volatile int Finishes;
+    static volatile int Deletes;
+    static volatile int NextStamp;
+    static volatile int FinishedOffEngineThread;
+
+    static void Reset()
+    {
+        Runs = Finishes = Deletes = NextStamp = FinishedOffEngineThread = 0;
+    }
+
+    CCTestJob(int *stamp=NULL, const bool checkEngineThread=false)
+    {
+        this->stamp = stamp;
+        this->checkEngineThread = checkEngineThread;
+    }
+
+    ~CCTestJob()
+    {
+        CCAtomicAdd( Deletes, 1 );
+    }
+
+protected:
+    void run()
+    {
+        const int order = CCAtomicAdd( NextStamp, 1 );
+        if( stamp != NULL )
+        {
+            *stamp = order;
+        }
+        CCAtomicAdd( Runs, 1 );
+    }
+
+    void finish()
+    {
+#ifdef CCJOBSCHEDULER_THREADS
+        if( checkEngineThread && pthread_equal( pthread_self(), EngineThread ) == 0 )
+        {
+            CCAtomicAdd( FinishedOffEngineThread, 1 );
+        }
+#endif
+        CCAtomicAdd( Finishes, 1 );
+    }
+
+public:
+#ifdef CCJOBSCHEDULER_THREADS
+    static pthread_t EngineThread;
+#endif
+
+protected:
+    int *stamp;
+    bool checkEngineThread;
+};
+volatile int CCTestJob::Runs = 0;
+volatile int CCTestJob::Finishes = 0;
+volatile int CCTestJob::Deletes = 0;
+volatile int CCTestJob::NextStamp = 0;
+volatile int CCTestJob::FinishedOffEngineThread = 0;
+#ifdef CCJOBSCHEDULER_THREADS
+pthread_t CCTestJob::EngineThread;
+#endif
+
+
+// Submits more jobs from the worker it runs on
+class CCTestSpawningJob : public CCTestJob
+{
+    typedef CCTestJob super;
+
+public:
+    CCTestSpawningJob(CCJobScheduler &scheduler, const int children) :
+        scheduler( scheduler )
+    {
+        this->children = children;
+    }
+
+protected:
+    void run()
+    {
+        super::run();
+        for( int i=0; i<children; ++i )
+        {
+            scheduler.submit( new CCTestJob(), (CCJobPriority)( i % job_priority_max ) );
+        }
+    }
+
+protected:
+    CCJobScheduler &scheduler;
+    int children;
+};
+
+
+// Holds its worker until released
+class CCTestBlockingJob : public CCTestJob
+{
+public:
+    static volatile int Started;
+    static volatile int Released;
+
+protected:
+    void run()
+    {
+        CCAtomicAdd( Started, 1 );
+        while( Released == 0 )
+        {
+            sched_yield();
+        }
+        CCTestJob::run();
+    }
+};
+volatile int CCTestBlockingJob::Started = 0;
+volatile int CCTestBlockingJob::Released = 0;
+
+
+
+// Every job is run, finished and deleted once however many workers share them
+static void TestWorkers(const int numberOfWorkers)
+{
+    const int count = 2000;
+    const int rounds = 5;
+
+    CCJobScheduler scheduler;
+    CCTEST_CHECK( scheduler.start( numberOfWorkers ) );
+
+    for( int round=0; round<rounds; ++round )
+    {
+        CCTestJob::Reset();
+        for( int i=0; i<count; ++i )
+        {
+            scheduler.submit( new CCTestJob(), (CCJobPriority)( i % job_priority_max ) );
+        }
+        scheduler.waitForIdle();
+
+        CCTEST_CHECK( CCTestJob::Runs == count );
+        CCTEST_CHECK( CCTestJob::Finishes == count );
+        CCTEST_CHECK( CCTestJob::Deletes == count );
+    }
+
+    // Jobs submitting jobs from the workers, which keep them local until they're stolen
+    CCTestJob::Reset();
+    const int spawners = 200;
+    const int children = 10;
+    for( int i=0; i<spawners; ++i )
+    {
+        scheduler.submit( new CCTestSpawningJob( scheduler, children ) );
+    }
+    scheduler.waitForIdle();
+    CCTEST_CHECK( CCTestJob::Runs == spawners * ( children + 1 ) );
+    CCTEST_CHECK( CCTestJob::Deletes == spawners * ( children + 1 ) );
+
+    scheduler.stop();
+}
+
+
+// Going idle over and over, a lost wake up leaves waitForIdle blocked
+static void TestWaitForIdle()
+{
+    CCJobScheduler scheduler;
+    CCTEST_CHECK( scheduler.start( 4 ) );
+
+    CCTestJob::Reset();
+    const int rounds = 2000;
+    for( int round=0; round<rounds; ++round )
+    {
+        for( int i=0; i<=round%3; ++i )
+        {
+            scheduler.submit( new CCTestJob() );
+        }
+        scheduler.waitForIdle();
+    }
+    CCTEST_CHECK( CCTestJob::Deletes == CCTestJob::Runs );
+
+    // Nothing to wait on
+    scheduler.waitForIdle();
+    scheduler.stop();
+}
+
+
+// Diamonds of jobs submitted last first, each job must run after the ones it depends on
+static void TestDependencies()
+{
+    const int count = 500;
+    int *stamps = (int*)malloc( sizeof( int ) * count * 4 );
+    for( int i=0; i<count*4; ++i )
+    {
+        stamps[i] = -1;
+    }
+
+    CCJobScheduler scheduler;
+    CCTEST_CHECK( scheduler.start( 4 ) );
+
+    CCTestJob::Reset();
+    for( int i=0; i<count; ++i )
+    {
+        int *stamp = &stamps[i*4];
+        CCJob *top = scheduler.createJob( new CCTestJob( &stamp[0] ) );
+        CCJob *left = scheduler.createJob( new CCTestJob( &stamp[1] ), job_priority_low );
+        CCJob *right = scheduler.createJob( new CCTestJob( &stamp[2] ), job_priority_high );
+        CCJob *bottom = scheduler.createJob( new CCTestJob( &stamp[3] ) );
+        scheduler.addDependency( left, top );
+        scheduler.addDependency( right, top );
+        scheduler.addDependency( bottom, left );
+        scheduler.addDependency( bottom, right );
+
+        scheduler.submit( bottom );
+        scheduler.submit( right );
+        scheduler.submit( left );
+        scheduler.submit( top );
+    }
+    scheduler.waitForIdle();
+
+    CCTEST_CHECK( CCTestJob::Runs == count * 4 );
+    int outOfOrder = 0;
+    for( int i=0; i<count; ++i )
+    {
+        const int *stamp = &stamps[i*4];
+        if( stamp[0] < 0 || stamp[0] > stamp[1] || stamp[0] > stamp[2] || stamp[1] > stamp[3] || stamp[2] > stamp[3] )
+        {
+            outOfOrder++;
+        }
+    }
+    CCTEST_CHECK( outOfOrder == 0 );
+
+    scheduler.stop();
+    free( stamps );
+}
+
+
+// Jobs finishing on the engine thread are handed back through the engine's callbacks
+static void TestFinishOnEngineThread(CCBenchmarkEngine *engine)
+{
+    const int count = 1000;
+
+    CCJobScheduler scheduler;
+    CCTEST_CHECK( scheduler.start( 4 ) );
+
+    CCTestJob::Reset();
+#ifdef CCJOBSCHEDULER_THREADS
+    CCTestJob::EngineThread = pthread_self();
+#endif
+    for( int i=0; i<count; ++i )
+    {
+        scheduler.submit( scheduler.createJob( new CCTestJob( NULL, true ), job_priority_normal, true ) );
+    }
+    scheduler.waitForIdle();
+    CCTEST_CHECK( CCTestJob::Runs == count );
+
+    for( int i=0; i<1000 && CCTestJob::Finishes < count; ++i )
+    {
+        engine->updateEngineThread();
+    }
+    CCTEST_CHECK( CCTestJob::Finishes == count );
+    CCTEST_CHECK( CCTestJob::Deletes == count );
+    CCTEST_CHECK( CCTestJob::FinishedOffEngineThread == 0 );
+
+    scheduler.stop();
+}
+
+
+// Without workers jobs run in order on the engine's jobs thread
+static void TestJobsThreadFallback(CCBenchmarkEngine *engine)
+{
+    const int count = 100;
+    int stamps[count];
+
+    CCJobScheduler scheduler;
+    CCTEST_CHECK( scheduler.isRunning() == false );
+
+    CCTestJob::Reset();
+    for( int i=0; i<count; ++i )
+    {
+        stamps[i] = -1;
+        scheduler.submit( new CCTestJob( &stamps[i] ) );
+    }
+    CCTEST_CHECK( CCTestJob::Runs == 0 );
+
+    for( int i=0; i<1000 && CCTestJob::Runs < count; ++i )
+    {
+        engine->updateJobsThread( true );
+    }
+    CCTEST_CHECK( CCTestJob::Runs == count );
+    CCTEST_CHECK( CCTestJob::Deletes == count );
+
+    int outOfOrder = 0;
+    for( int i=0; i<count; ++i )
+    {
+        if( stamps[i] != i )
+        {
+            outOfOrder++;
+        }
+    }
+    CCTEST_CHECK( outOfOrder == 0 );
+
+    scheduler.waitForIdle();
+}
+
+
+// Stopping with jobs still queued, and with jobs waiting on a dependency that was never submitted
+static void TestStop()
+{
+    const int queued = 100;
+
+    CCJobScheduler scheduler;
+    CCTEST_CHECK( scheduler.start( 1 ) );
+
+    CCTestJob::Reset();
+    CCTestBlockingJob::Started = 0;
+    CCTestBlockingJob::Released = 0;
+    scheduler.submit( new CCTestBlockingJob() );
+    while( CCTestBlockingJob::Started == 0 )
+    {
+        sched_yield();
+    }
+
+    for( int i=0; i<queued; ++i )
+    {
+        scheduler.submit( new CCTestJob() );
+    }
+
+    int waitingStamp = -1;
+    CCJob *dependency = scheduler.createJob( new CCTestJob() );
+    CCJob *waiting = scheduler.createJob( new CCTestJob( &waitingStamp ) );
+    scheduler.addDependency( waiting, dependency );
+    scheduler.submit( waiting );
+
+    CCTestBlockingJob::Released = 1;
+    scheduler.stop();
+
+    // Everything submitted is deleted once, whether it ran or not
+    CCTEST_CHECK( CCTestJob::Runs >= 1 && CCTestJob::Runs <= queued + 1 );
+    CCTEST_CHECK( CCTestJob::Deletes == queued + 2 );
+    CCTEST_CHECK( waitingStamp == -1 );
+
+    // Never submitted, so it's still ours
+    delete dependency->callback;
+    delete dependency;
+}
+
+
+void CCTestJobScheduler(CCBenchmarkEngine *engine)
+{
+#ifdef CCJOBSCHEDULER_THREADS
+    static const int workerCounts[] = { 1, 2, 4, 8 };
+    for( uint i=0; i<sizeof( workerCounts ) / sizeof( int ); ++i )
+    {
+        TestWorkers( workerCounts[i] );
+    }
+
+    TestWaitForIdle();
+    TestDependencies();
+    TestFinishOnEngineThread( engine );
+    TestStop();
+#endif
+
+    TestJobsThreadFallback( engine );
+}
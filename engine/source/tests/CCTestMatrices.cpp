@@ -0,0 +1,125 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTestMatrices.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTests.h"
+
+
+// Largest difference relative to the expected value, or to 1 for small values
+static float Difference(const float *values, const float *expected, const int count)
+{
+    float difference = 0.0f;
+    for( int i=0; i<count; ++i )
+    {
+        difference = MAX( difference, fabsf( values[i] - expected[i] ) / MAX( 1.0f, fabsf( expected[i] ) ) );
+    }
+    return difference;
+}
+
+
+static void RandomMatrix(CCMatrix &matrix)
+{
+    float *values = matrix.data();
+    for( int i=0; i<16; ++i )
+    {
+        values[i] = CCFloatRandomDualSided() * 10.0f;
+    }
+}
+
+
+// How far the matrix times its inverse is from the identity
+static float IdentityError(const CCMatrix &matrix, const CCMatrix &inverse)
+{
+    CCMatrix identity;
+    CCMatrixMultiplyScalar( identity, matrix, inverse );
+
+    float error = 0.0f;
+    for( int i=0; i<4; ++i )
+    {
+        for( int j=0; j<4; ++j )
+        {
+            error = MAX( error, fabsf( identity.m[i][j] - ( i == j ? 1.0f : 0.0f ) ) );
+        }
+    }
+    return error;
+}
+
+
+// The vectorised matrix functions against the scalar ones over random matrices
+void CCTestMatrices(CCBenchmarkEngine *engine)
+{
+    const int count = 20000;
+    const float illConditioned = 1e-3f;
+
+    float multiply = 0.0f, inverse = 0.0f, vector = 0.0f, points = 0.0f;
+    int wellConditionedMismatches = 0;
+
+    for( int i=0; i<count; ++i )
+    {
+        CCMatrix a, b, result, expected;
+        RandomMatrix( a );
+        RandomMatrix( b );
+
+        CCMatrixMultiplyScalar( expected, a, b );
+        CCMatrixMultiply( result, a, b );
+        multiply = MAX( multiply, Difference( result.data(), expected.data(), 16 ) );
+
+        // Writing over either source
+        result = a;
+        CCMatrixMultiply( result, result, b );
+        multiply = MAX( multiply, Difference( result.data(), expected.data(), 16 ) );
+        result = b;
+        CCMatrixMultiply( result, a, result );
+        multiply = MAX( multiply, Difference( result.data(), expected.data(), 16 ) );
+
+        // The random values are coarse enough to make singular matrices, whose determinant
+        // rounds to zero in one version and not the other, the inverse found must then be meaningless
+        const bool inverted = CCMatrixInverse( result, a );
+        const bool invertedScalar = CCMatrixInverseScalar( expected, a );
+        if( inverted != invertedScalar )
+        {
+            if( IdentityError( a, inverted ? result : expected ) < illConditioned )
+            {
+                wellConditionedMismatches++;
+            }
+        }
+        else if( inverted && IdentityError( a, expected ) < illConditioned )
+        {
+            inverse = MAX( inverse, Difference( result.data(), expected.data(), 16 ) );
+        }
+
+        float in[4], out[4], expectedOut[4];
+        for( int j=0; j<4; ++j )
+        {
+            in[j] = CCFloatRandomDualSided() * 100.0f;
+        }
+        CCMatrixTransformVector4( out, a, in );
+        CCMatrixTransformVector4Scalar( expectedOut, a, in );
+        vector = MAX( vector, Difference( out, expectedOut, 4 ) );
+
+        // Enough points for the batches of four and the ones left over, transformed in place as well
+        const int numberOfPoints = 11;
+        CCVector3 source[numberOfPoints], transformed[numberOfPoints], expectedPoints[numberOfPoints];
+        for( int j=0; j<numberOfPoints; ++j )
+        {
+            source[j] = CCVector3( CCFloatRandomDualSided() * 100.0f, CCFloatRandomDualSided() * 100.0f, CCFloatRandomDualSided() * 100.0f );
+        }
+        CCMatrixTransformPointsScalar( expectedPoints, a, source, numberOfPoints );
+        CCMatrixTransformPoints( transformed, a, source, numberOfPoints );
+        points = MAX( points, Difference( &transformed[0].x, &expectedPoints[0].x, numberOfPoints*3 ) );
+        CCMatrixTransformPoints( source, a, source, numberOfPoints );
+        points = MAX( points, Difference( &source[0].x, &expectedPoints[0].x, numberOfPoints*3 ) );
+    }
+
+    CCTEST_CHECK_NEAR( multiply, 0.0, 1e-5 );
+    CCTEST_CHECK_NEAR( inverse, 0.0, 1e-3 );
+    CCTEST_CHECK( wellConditionedMismatches == 0 );
+    CCTEST_CHECK_NEAR( vector, 0.0, 1e-5 );
+    CCTEST_CHECK_NEAR( points, 0.0, 1e-4 );
+}
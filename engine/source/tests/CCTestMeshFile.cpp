@@ -0,0 +1,74 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTestMeshFile.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTests.h"
+#include "CCMeshFile.h"
+
+
+// A quad of two triangles, with its last index replaced
+static void WriteQuad(CCData &fileData, const uint indexSize, const uint lastIndex)
+{
+    const float vertices[] = { 0.0f, 0.0f, 0.0f,  1.0f, 0.0f, 0.0f,  1.0f, 1.0f, 0.0f,  0.0f, 1.0f, 0.0f };
+    const uint vertexCount = 4;
+    uint indices[] = { 0, 1, 2, 0, 2, 3 };
+    const uint indexCount = 6;
+    indices[indexCount-1] = lastIndex;
+
+    ushort shortIndices[indexCount];
+    for( uint i=0; i<indexCount; ++i )
+    {
+        shortIndices[i] = (ushort)indices[i];
+    }
+
+    CCMinMax mmX, mmY, mmZ;
+    CCMeshFileSubmesh submesh;
+    submesh.firstIndex = 0;
+    submesh.indexCount = indexCount;
+    submesh.nameOffset = 0;
+    const char *materialName = "quad";
+
+    CCMeshFile::Write( fileData, vertices, NULL, NULL, vertexCount,
+                       indexSize == 2 ? (const void*)shortIndices : (const void*)indices, indexCount, indexSize,
+                       mmX, mmY, mmZ, &submesh, &materialName, 1 );
+}
+
+
+// Mesh files with indices past their vertices, or material names outside the file, are turned away when opened
+void CCTestMeshFile(CCBenchmarkEngine *engine)
+{
+    static const uint indexSizes[] = { 2, 4 };
+    for( uint i=0; i<sizeof( indexSizes ) / sizeof( uint ); ++i )
+    {
+        const uint indexSize = indexSizes[i];
+
+        CCData valid;
+        WriteQuad( valid, indexSize, 3 );
+        CCMeshFile validFile;
+        CCTEST_CHECK( validFile.openData( valid.buffer, valid.length ) );
+
+        CCData outOfRange;
+        WriteQuad( outOfRange, indexSize, 4 );
+        CCMeshFile outOfRangeFile;
+        CCTEST_CHECK( outOfRangeFile.openData( outOfRange.buffer, outOfRange.length ) == false );
+    }
+
+    // A material name offset that wraps around to the start of the names when added in 32 bit
+    CCData corrupt;
+    WriteQuad( corrupt, 2, 3 );
+    CCMeshFileHeader *header = (CCMeshFileHeader*)corrupt.buffer;
+    CCMeshFileSubmesh *submesh = (CCMeshFileSubmesh*)( corrupt.buffer + header->submeshesOffset );
+    submesh->nameOffset = 0u - header->namesOffset;
+    CCMeshFile corruptFile;
+    CCTEST_CHECK( corruptFile.openData( corrupt.buffer, corrupt.length ) == false );
+
+    // Or lands past the end of the file
+    submesh->nameOffset = corrupt.length - header->namesOffset;
+    CCTEST_CHECK( corruptFile.openData( corrupt.buffer, corrupt.length ) == false );
+}
@@ -0,0 +1,320 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTestOBJParser.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTests.h"
+#include "CCOBJParser.h"
+#include "ObjLoader.h"
+
+
+enum FaceFormat
+{
+    Face_VTN,
+    Face_VT,
+    Face_VN,
+    Face_V,
+    Face_Formats
+};
+
+
+static const int MaxElements = 64;
+static const int MaxCorners = 256;
+
+// A random OBJ and what it should parse to
+struct RandomOBJ
+{
+    CCText text;
+
+    float positions[MaxElements*3];
+    float uvs[MaxElements*2];
+    float normals[MaxElements*3];
+    int positionCount, uvCount, normalCount;
+
+    // Position, uv and normal index of each triangle corner
+    int corners[MaxCorners*3];
+    int cornerCount;
+};
+
+
+static int RandomInt(const int range)
+{
+    return rand() % range;
+}
+
+
+static void WriteSpace(CCText &text, const bool messy)
+{
+    if( messy && RandomInt( 3 ) == 0 )
+    {
+        text += RandomInt( 2 ) == 0 ? "\t " : "  ";
+    }
+    else
+    {
+        text += " ";
+    }
+}
+
+
+static void WriteLineEnd(CCText &text, const bool messy)
+{
+    if( messy )
+    {
+        if( RandomInt( 4 ) == 0 )
+        {
+            text += " # trailing comment";
+        }
+        text += RandomInt( 2 ) == 0 ? "\r\n" : "\n";
+        if( RandomInt( 8 ) == 0 )
+        {
+            text += "\n# comment\ng group\ns off\nusemtl material\n";
+        }
+    }
+    else
+    {
+        text += "\n";
+    }
+}
+
+
+// Writes a float the ways exporters do, returning the value libc reads back
+static float WriteFloat(CCText &text, const bool messy)
+{
+    const double magnitude = pow( 10.0, RandomInt( 7 ) - 3 );
+    const double value = ( rand() / (double)RAND_MAX * 2.0 - 1.0 ) * magnitude;
+
+    char buffer[64];
+    switch( RandomInt( 4 ) )
+    {
+        case 0:
+            sprintf( buffer, "%f", value );
+            break;
+        case 1:
+            sprintf( buffer, "%.9g", value );
+            break;
+        case 2:
+            sprintf( buffer, "%.6e", value );
+            break;
+        default:
+            sprintf( buffer, "%.3f", value );
+            break;
+    }
+
+    WriteSpace( text, messy );
+    text += buffer;
+    return (float)atof( buffer );
+}
+
+
+static void WriteVector(RandomOBJ &obj, const char *keyword, float *vector, const int size, const bool messy)
+{
+    obj.text += keyword;
+    for( int i=0; i<size; ++i )
+    {
+        vector[i] = WriteFloat( obj.text, messy );
+    }
+
+    // A uv's w, which is ignored
+    if( size == 2 && messy && RandomInt( 4 ) == 0 )
+    {
+        obj.text += " 0.0";
+    }
+    WriteLineEnd( obj.text, messy );
+}
+
+
+// Relative indices count back from the last element written
+static int OBJIndex(const int index, const int count, const bool relative)
+{
+    return relative ? index - count : index + 1;
+}
+
+
+// Random blocks of vertices followed by faces using any of the vertices written so far
+static void CreateRandomOBJ(RandomOBJ &obj, const int format, const bool relative, const bool messy)
+{
+    obj.text.setSize( 0 );
+    obj.positionCount = obj.uvCount = obj.normalCount = 0;
+    obj.cornerCount = 0;
+
+    const bool hasUVs = format == Face_VTN || format == Face_VT;
+    const bool hasNormals = format == Face_VTN || format == Face_VN;
+
+    const int blocks = 1 + RandomInt( 4 );
+    for( int block=0; block<blocks; ++block )
+    {
+        for( int i=RandomInt( 8 ); i>=0 && obj.positionCount<MaxElements; --i )
+        {
+            WriteVector( obj, "v", &obj.positions[obj.positionCount++*3], 3, messy );
+        }
+        for( int i=RandomInt( 8 ); hasUVs && i>=0 && obj.uvCount<MaxElements; --i )
+        {
+            WriteVector( obj, "vt", &obj.uvs[obj.uvCount++*2], 2, messy );
+        }
+        for( int i=RandomInt( 8 ); hasNormals && i>=0 && obj.normalCount<MaxElements; --i )
+        {
+            WriteVector( obj, "vn", &obj.normals[obj.normalCount++*3], 3, messy );
+        }
+
+        for( int face=RandomInt( 6 ); face>=0; --face )
+        {
+            const int sides = 3 + RandomInt( 4 );
+            if( obj.cornerCount + ( sides - 2 ) * 3 > MaxCorners )
+            {
+                break;
+            }
+
+            obj.text += "f";
+            int polygon[6][3];
+            for( int i=0; i<sides; ++i )
+            {
+                int *corner = polygon[i];
+                corner[0] = RandomInt( obj.positionCount );
+                corner[1] = hasUVs ? RandomInt( obj.uvCount ) : -1;
+                corner[2] = hasNormals ? RandomInt( obj.normalCount ) : -1;
+
+                const int v = OBJIndex( corner[0], obj.positionCount, relative );
+                const int t = hasUVs ? OBJIndex( corner[1], obj.uvCount, relative ) : 0;
+                const int n = hasNormals ? OBJIndex( corner[2], obj.normalCount, relative ) : 0;
+
+                char buffer[64];
+                switch( format )
+                {
+                    case Face_VTN:
+                        sprintf( buffer, "%i/%i/%i", v, t, n );
+                        break;
+                    case Face_VT:
+                        sprintf( buffer, "%i/%i", v, t );
+                        break;
+                    case Face_VN:
+                        sprintf( buffer, "%i//%i", v, n );
+                        break;
+                    default:
+                        sprintf( buffer, "%i", v );
+                        break;
+                }
+                WriteSpace( obj.text, messy );
+                obj.text += buffer;
+            }
+            WriteLineEnd( obj.text, messy );
+
+            // Fanned around the first corner
+            for( int i=2; i<sides; ++i )
+            {
+                memcpy( &obj.corners[obj.cornerCount*3+0], polygon[0], sizeof( int ) * 3 );
+                memcpy( &obj.corners[obj.cornerCount*3+3], polygon[i-1], sizeof( int ) * 3 );
+                memcpy( &obj.corners[obj.cornerCount*3+6], polygon[i], sizeof( int ) * 3 );
+                obj.cornerCount += 3;
+            }
+        }
+    }
+}
+
+
+// Largest difference relative to the expected values
+static double Difference(const float *values, const float *expected, const int count)
+{
+    double largest = 0.0;
+    for( int i=0; i<count; ++i )
+    {
+        const double difference = fabs( (double)values[i] - expected[i] );
+        const double scale = MAX( fabs( (double)expected[i] ), 1e-30 );
+        largest = MAX( largest, difference / scale );
+    }
+    return largest;
+}
+
+
+// Parses random files written in every face format, with relative indices and untidy whitespace,
+// comparing them with what was written, and with ObjLoader3 for the files it can read
+void CCTestOBJParser(CCBenchmarkEngine *engine)
+{
+    const int files = 2000;
+
+    RandomOBJ *obj = new RandomOBJ();
+    int mismatches = 0, checkedWithObjLoader = 0;
+    double largestDifference = 0.0;
+
+    srand( 1 );
+    for( int file=0; file<files; ++file )
+    {
+        const int format = file % Face_Formats;
+        const bool relative = RandomInt( 2 ) == 0;
+        const bool messy = RandomInt( 2 ) == 0;
+        CreateRandomOBJ( *obj, format, relative, messy );
+
+        CCOBJParser parser;
+        bool match = parser.parse( obj->text.buffer, obj->text.length ) &&
+                     (int)parser.getPositionCount() == obj->positionCount &&
+                     (int)parser.getUVCount() == obj->uvCount &&
+                     (int)parser.getNormalCount() == obj->normalCount &&
+                     (int)parser.getCornerCount() == obj->cornerCount;
+        if( match )
+        {
+            largestDifference = MAX( largestDifference, Difference( parser.getPositions(), obj->positions, obj->positionCount * 3 ) );
+            largestDifference = MAX( largestDifference, Difference( parser.getUVs(), obj->uvs, obj->uvCount * 2 ) );
+            largestDifference = MAX( largestDifference, Difference( parser.getNormals(), obj->normals, obj->normalCount * 3 ) );
+            match = memcmp( parser.getCorners(), obj->corners, sizeof( int ) * obj->cornerCount * 3 ) == 0;
+        }
+
+        // ObjLoader3 reads v/vt/vn and v/vt faces with positive indices and single spaces
+        if( match && relative == false && messy == false && ( format == Face_VTN || format == Face_VT ) )
+        {
+            checkedWithObjLoader++;
+            CCText text = obj->text.buffer;
+            ObjMesh *mesh = LoadOBJTextData( text );
+            match = mesh != NULL &&
+                    mesh->m_iNumberOfVertices == parser.getPositionCount() &&
+                    mesh->m_iNumberOfTexCoords == parser.getUVCount() &&
+                    mesh->m_iNumberOfNormals == parser.getNormalCount();
+            if( match )
+            {
+                match = Difference( parser.getPositions(), &mesh->m_aVertexArray[0].x, obj->positionCount * 3 ) <= 1e-6 &&
+                        Difference( parser.getUVs(), &mesh->m_aTexCoordArray[0].u, obj->uvCount * 2 ) <= 1e-6 &&
+                        ( obj->normalCount == 0 || Difference( parser.getNormals(), &mesh->m_aNormalArray[0].x, obj->normalCount * 3 ) <= 1e-6 );
+            }
+
+            int corner = 0;
+            for( uint i=0; match && i<mesh->m_iNumberOfFaces; ++i )
+            {
+                const ObjFace &face = mesh->m_aFaces[i];
+                for( uint j=2; match && j<face.m_iVertexCount; ++j )
+                {
+                    const uint fan[3] = { 0, j-1, j };
+                    for( int k=0; k<3; ++k, ++corner )
+                    {
+                        const int *expected = &parser.getCorners()[corner*3];
+                        match = match &&
+                                corner < obj->cornerCount &&
+                                (int)face.m_aVertexIndices[fan[k]] == expected[0] &&
+                                (int)face.m_aTexCoordIndicies[fan[k]] == expected[1] &&
+                                ( face.m_aNormalIndices == NULL ? -1 : (int)face.m_aNormalIndices[fan[k]] ) == expected[2];
+                    }
+                }
+            }
+            match = match && corner == obj->cornerCount;
+
+            if( mesh != NULL )
+            {
+                DeleteOBJ( mesh->m_iMeshID );
+            }
+        }
+
+        if( match == false )
+        {
+            mismatches++;
+        }
+    }
+    delete obj;
+
+    CCTEST_CHECK( mismatches == 0 );
+    CCTEST_CHECK( checkedWithObjLoader > 0 );
+
+    // Against the floats libc reads back from the same text
+    CCTEST_CHECK_NEAR( largestDifference, 0.0, 1e-6 );
+}
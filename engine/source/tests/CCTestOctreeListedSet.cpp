@@ -0,0 +1,57 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTestOctreeListedSet.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTests.h"
+
+
+// Many more collideables than the set starts with room for, so it grows part way through a query
+void CCTestOctreeListedSet(CCBenchmarkEngine *engine)
+{
+    const int count = 5000;
+
+    // Only their addresses are used
+    CCCollideable *collideables = (CCCollideable*)malloc( sizeof( CCCollideable ) * count );
+
+    CCOctreeListedSet listed( 4 );
+    for( int query=0; query<3; ++query )
+    {
+        listed.begin();
+
+        int added = 0, repeated = 0;
+        for( int i=0; i<count; ++i )
+        {
+            if( listed.add( &collideables[i] ) )
+            {
+                added++;
+            }
+
+            // Listed again from a later leaf
+            if( i % 3 == 0 && listed.add( &collideables[i/2] ) )
+            {
+                repeated++;
+            }
+        }
+        CCTEST_CHECK( added == count );
+        CCTEST_CHECK( repeated == 0 );
+
+        // Everything from this query is still there after growing
+        int missing = 0;
+        for( int i=0; i<count; ++i )
+        {
+            if( listed.add( &collideables[i] ) )
+            {
+                missing++;
+            }
+        }
+        CCTEST_CHECK( missing == 0 );
+    }
+
+    free( collideables );
+}
@@ -0,0 +1,92 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTestRenderQueue.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTests.h"
+#include "CCHeadlessRenderer.h"
+
+
+// Marks its draws by passing this as the first vertex
+static const int LabelDraw = 100000;
+
+
+// A transparent tile with a label drawn straight over its model, as CCObjectText draws its text
+class CCTestLabelledTile : public CCCollideable
+{
+    typedef CCCollideable super;
+
+protected:
+    virtual void renderModel(const bool alpha)
+    {
+        super::renderModel( alpha );
+        if( alpha )
+        {
+            gRenderer->GLDrawArrays( GL_TRIANGLES, LabelDraw, 6 );
+        }
+    }
+};
+
+
+// With the render queue on, every tile's label must still be drawn straight after its own model
+void CCTestRenderQueue(CCBenchmarkEngine *engine)
+{
+    const int count = 64;
+    const float spacing = 20.0f;
+    const CCBenchmarkGrid grid( count, spacing );
+    CCSceneBase *scene = engine->getScene( (CCSceneBase*)NULL );
+    for( int i=0; i<count; ++i )
+    {
+        CCTestLabelledTile *tile = new CCTestLabelledTile();
+        tile->setSquareCollisionBounds( spacing * 0.5f );
+        tile->setPositionXYZ( ( i % grid.size ) * spacing - grid.offset, 0.0f, ( i / grid.size ) * spacing - grid.offset );
+        tile->setModel( CCBenchmarkCreateCubeModel( spacing * 0.5f ) );
+        tile->setTransparent();
+        tile->setScene( scene );
+    }
+
+    engine->enableRenderQueue( true );
+    CCHeadlessRenderer *renderer = (CCHeadlessRenderer*)engine->renderer;
+    renderer->setRecording( true );
+
+    // The first frame finds what's visible
+    for( int frame=0; frame<2; ++frame )
+    {
+        renderer->beginFrame();
+        engine->updateEngineThread();
+    }
+
+    int labels = 0, unlabelled = 0;
+    bool previousWasModel = false;
+    const CCRenderCommand *commands = renderer->getCommands();
+    for( int i=0; i<renderer->getNumberOfCommands(); ++i )
+    {
+        const CCRenderCommand &command = commands[i];
+        if( command.type != command_drawArrays && command.type != command_drawElements )
+        {
+            continue;
+        }
+
+        const bool label = command.type == command_drawArrays && command.params[1] == LabelDraw;
+        if( label )
+        {
+            labels++;
+            if( previousWasModel == false )
+            {
+                unlabelled++;
+            }
+        }
+        previousWasModel = label == false;
+    }
+
+    CCTEST_CHECK( labels > 0 );
+    CCTEST_CHECK( unlabelled == 0 );
+
+    renderer->setRecording( false );
+    engine->enableRenderQueue( false );
+}
@@ -0,0 +1,137 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTestRotations.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTests.h"
+
+
+static float MatrixDifference(const CCMatrix &a, const CCMatrix &b)
+{
+    float difference = 0.0f;
+    for( int i=0; i<4; ++i )
+    {
+        for( int j=0; j<4; ++j )
+        {
+            difference = MAX( difference, fabsf( a.m[i][j] - b.m[i][j] ) );
+        }
+    }
+    return difference;
+}
+
+
+// The model matrix a renderable builds from its angles
+static void EulerMatrix(CCMatrix &result, const CCVector3 &position, const CCVector3 &rotation, const CCVector3 *scale)
+{
+    CCRenderable renderable;
+    renderable.setPosition( position );
+    renderable.setRotation( rotation );
+    if( scale != NULL )
+    {
+        renderable.setScale( scale->x, scale->y, scale->z );
+    }
+    renderable.refreshModelMatrix();
+    result = renderable.getModelMatrix();
+    renderable.destruct();
+}
+
+
+static CCVector3 RandomRotation()
+{
+    return CCVector3( CCFloatRandom() * 360.0f, CCFloatRandom() * 360.0f, CCFloatRandom() * 360.0f );
+}
+
+
+// Angle in degrees between two rotations, from the rotation taking one to the other
+// acosf of their dot product loses too much precision for nearly equal rotations
+static float AngleBetween(const CCQuaternion &a, const CCQuaternion &b)
+{
+    const CCQuaternion inverseA( -a.x, -a.y, -a.z, a.w );
+    CCQuaternion difference;
+    CCQuaternionMultiply( difference, inverseA, b );
+    const float sinHalfAngle = sqrtf( difference.x * difference.x + difference.y * difference.y + difference.z * difference.z );
+    return CC_RADIANS_TO_DEGREES( 2.0f * atan2f( sinHalfAngle, fabsf( difference.w ) ) );
+}
+
+
+// Quaternion conversions against the matrices a renderable builds from its angles
+void CCTestRotations(CCBenchmarkEngine *engine)
+{
+    const int count = 20000;
+
+    float compose = 0.0f, eulerRoundTrip = 0.0f, quaternionRoundTrip = 0.0f, gimbalRoundTrip = 0.0f;
+    float slerpEnds = 0.0f, slerpSpeed = 0.0f, nlerpLength = 0.0f;
+
+    for( int i=0; i<count; ++i )
+    {
+        const CCVector3 position( CCFloatRandomDualSided() * 100.0f, CCFloatRandomDualSided() * 100.0f, CCFloatRandomDualSided() * 100.0f );
+        const CCVector3 scale( 0.5f + CCFloatRandom(), 0.5f + CCFloatRandom(), 0.5f + CCFloatRandom() );
+        CCVector3 rotation = RandomRotation();
+
+        // Looking straight up or down, where x and z spin around the same axis
+        const bool gimbal = i % 10 == 0;
+        if( gimbal )
+        {
+            rotation.y = i % 20 == 0 ? 90.0f : 270.0f;
+        }
+
+        CCMatrix expected, result;
+        EulerMatrix( expected, position, rotation, &scale );
+
+        // The same matrix from a quaternion of the angles
+        CCQuaternion quaternion;
+        CCQuaternionFromEuler( quaternion, rotation );
+        CCMatrixCompose( result, position, quaternion, &scale );
+        compose = MAX( compose, MatrixDifference( result, expected ) );
+
+        // Angles back out of the quaternion may differ, but must turn us the same way
+        CCVector3 angles;
+        CCQuaternionToEuler( angles, quaternion );
+        EulerMatrix( result, position, angles, &scale );
+        const float difference = MatrixDifference( result, expected );
+        if( gimbal )
+        {
+            gimbalRoundTrip = MAX( gimbalRoundTrip, difference );
+        }
+        else
+        {
+            eulerRoundTrip = MAX( eulerRoundTrip, difference );
+        }
+
+        CCQuaternion roundTrip;
+        CCQuaternionFromEuler( roundTrip, angles );
+        quaternionRoundTrip = MAX( quaternionRoundTrip, AngleBetween( roundTrip, quaternion ) );
+
+        // Interpolating between two rotations should reach both ends, at an even speed for slerp
+        CCQuaternion target, step;
+        CCQuaternionFromEuler( target, RandomRotation() );
+        CCQuaternionSlerp( step, quaternion, target, 0.0f );
+        slerpEnds = MAX( slerpEnds, AngleBetween( step, quaternion ) );
+        CCQuaternionSlerp( step, quaternion, target, 1.0f );
+        slerpEnds = MAX( slerpEnds, AngleBetween( step, target ) );
+
+        const float amount = CCFloatRandom();
+        CCQuaternionSlerp( step, quaternion, target, amount );
+        slerpSpeed = MAX( slerpSpeed, fabsf( AngleBetween( quaternion, step ) - AngleBetween( quaternion, target ) * amount ) );
+
+        CCQuaternionNlerp( step, quaternion, target, amount );
+        nlerpLength = MAX( nlerpLength, fabsf( sqrtf( step.dot( step ) ) - 1.0f ) );
+    }
+
+    // Positions up to 100 away, so the translations carry the most rounding
+    CCTEST_CHECK_NEAR( compose, 0.0, 1e-4 );
+    CCTEST_CHECK_NEAR( eulerRoundTrip, 0.0, 1e-4 );
+    CCTEST_CHECK_NEAR( gimbalRoundTrip, 0.0, 1e-4 );
+
+    // In degrees
+    CCTEST_CHECK_NEAR( quaternionRoundTrip, 0.0, 1e-2 );
+    CCTEST_CHECK_NEAR( slerpEnds, 0.0, 1e-3 );
+    CCTEST_CHECK_NEAR( slerpSpeed, 0.0, 1e-3 );
+
+    CCTEST_CHECK_NEAR( nlerpLength, 0.0, 1e-5 );
+}
@@ -0,0 +1,118 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTestTransforms.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTests.h"
+#include "CCTransformStore.h"
+
+
+static float MatrixDifference(const CCMatrix &a, const CCMatrix &b)
+{
+    float difference = 0.0f;
+    for( int i=0; i<4; ++i )
+    {
+        for( int j=0; j<4; ++j )
+        {
+            difference = MAX( difference, fabsf( a.m[i][j] - b.m[i][j] ) );
+        }
+    }
+    return difference;
+}
+
+
+// Trees four children wide and four levels deep, more than the store first makes room for
+// Objects are listed breadth first, so parents come before their children
+static void CreateTrees(CCBenchmarkEngine *engine, CCPtrList<CCObject> &roots, CCPtrList<CCObject> &objects, const int trees)
+{
+    CCSceneBase *scene = engine->getScene( (CCSceneBase*)NULL );
+    for( int tree=0; tree<trees; ++tree )
+    {
+        CCObject *root = new CCObject();
+        root->setPositionXYZ( CCFloatRandomDualSided() * 100.0f, 0.0f, CCFloatRandomDualSided() * 100.0f );
+        root->setScene( scene );
+        roots.add( root );
+        objects.add( root );
+
+        int levelStart = objects.length-1;
+        for( int level=1; level<4; ++level )
+        {
+            const int levelEnd = objects.length;
+            for( int i=levelStart; i<levelEnd; ++i )
+            {
+                for( int j=0; j<4; ++j )
+                {
+                    CCObject *child = new CCObject();
+                    child->setPositionXYZ( CCFloatRandomDualSided() * 20.0f, 0.0f, CCFloatRandomDualSided() * 20.0f );
+                    child->setRotationY( CCFloatRandom() * 360.0f );
+                    if( j % 2 == 0 )
+                    {
+                        child->setScale( 0.5f + CCFloatRandom() );
+                    }
+                    objects.list[i]->addChild( child );
+                    objects.add( child );
+                }
+            }
+            levelStart = levelEnd;
+        }
+    }
+}
+
+
+// The store's world matrices against the ones objects build for themselves, and a world matrix
+// refreshed between updates following a parent that moved after the last update
+void CCTestTransforms(CCBenchmarkEngine *engine)
+{
+    CCPtrList<CCObject> roots, objects;
+    CreateTrees( engine, roots, objects, 4 );
+
+    CCMatrix *expected = (CCMatrix*)malloc( sizeof( CCMatrix ) * objects.length );
+    for( int i=0; i<objects.length; ++i )
+    {
+        CCObject *object = objects.list[i];
+        object->refreshWorldMatrix( object->parent != NULL ? &object->parent->getWorldMatrix() : NULL );
+        expected[i] = object->getWorldMatrix();
+    }
+
+    engine->enableTransformStore( true );
+    CCTransformStore *store = engine->transformStore;
+    for( int i=0; i<roots.length; ++i )
+    {
+        roots.list[i]->bindTransforms();
+    }
+    store->update();
+    CCTEST_CHECK( store->getNumberOfTransforms() == objects.length );
+
+    float difference = 0.0f;
+    for( int i=0; i<objects.length; ++i )
+    {
+        difference = MAX( difference, MatrixDifference( expected[i], store->getWorldMatrix( objects.list[i]->getTransformIndex() ) ) );
+    }
+    CCTEST_CHECK_NEAR( difference, 0.0, 1e-3 );
+    FREE_POINTER( expected );
+
+    // The last object is a leaf three levels beneath the last root
+    CCObject *root = roots.last();
+    CCObject *leaf = objects.last();
+    leaf->refreshWorldMatrix( NULL );
+    const CCMatrix before = leaf->getWorldMatrix();
+
+    root->rotateY( 30.0f );
+    root->setPositionY( 5.0f );
+    leaf->refreshWorldMatrix( NULL );
+    const CCMatrix refreshed = leaf->getWorldMatrix();
+    CCTEST_CHECK( MatrixDifference( before, refreshed ) > 1.0f );
+
+    // The next update still reaches everyone beneath the root, and agrees with the refreshed matrix
+    store->update();
+    CCTEST_CHECK( store->hasChanged( leaf->getTransformIndex() ) );
+    CCTEST_CHECK_NEAR( MatrixDifference( refreshed, store->getWorldMatrix( leaf->getTransformIndex() ) ), 0.0, 1e-4 );
+
+    roots.freeList();
+    objects.freeList();
+}
@@ -0,0 +1,107 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTests.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTests.h"
+
+
+struct CCTestCase
+{
+    const char *name;
+    CCTestFunction function;
+};
+
+static const CCTestCase TestCases[] =
+{
+    { "allocations", &CCTestActiveAllocations },
+    { "jobs", &CCTestJobScheduler },
+    { "matrices", &CCTestMatrices },
+    { "rotations", &CCTestRotations },
+    { "objparser", &CCTestOBJParser },
+    { "transforms", &CCTestTransforms },
+    { "listedset", &CCTestOctreeListedSet },
+    { "meshfile", &CCTestMeshFile },
+    { "queries", &CCTestCollisionQueries },
+    { "renderqueue", &CCTestRenderQueue },
+};
+static const int NumberOfTestCases = sizeof( TestCases ) / sizeof( CCTestCase );
+
+static int TestFailures = 0;
+
+
+
+bool CCTestCheck(const bool condition, const char *expression, const char *file, const int line)
+{
+    if( condition == false )
+    {
+        printf( "%s:%i: failed %s\n", file, line, expression );
+        TestFailures++;
+    }
+    return condition;
+}
+
+
+bool CCTestCheckNear(const double value, const double expected, const double tolerance,
+                     const char *expression, const char *file, const int line)
+{
+    const bool near = fabs( value - expected ) <= tolerance;
+    if( near == false )
+    {
+        printf( "%s:%i: %s is %g, expected %g within %g\n", file, line, expression, value, expected, tolerance );
+        TestFailures++;
+    }
+    return near;
+}
+
+
+
+int CCTestsMain(int argc, char *argv[])
+{
+    int testsRun = 0;
+    int testsFailed = 0;
+    for( int i=0; i<NumberOfTestCases; ++i )
+    {
+        const CCTestCase &test = TestCases[i];
+        if( argc > 1 && CCText::Equals( test.name, argv[1] ) == false )
+        {
+            continue;
+        }
+
+        CCBenchmarkEngine *engine = CCBenchmarkCreateEngine();
+        if( engine == NULL )
+        {
+            return 1;
+        }
+
+        const int failuresBefore = TestFailures;
+        test.function( engine );
+        delete engine;
+
+        const int failures = TestFailures - failuresBefore;
+        printf( "%-12s %s\n", test.name, failures == 0 ? "passed" : "FAILED" );
+        testsRun++;
+        if( failures > 0 )
+        {
+            testsFailed++;
+        }
+    }
+
+    if( testsRun == 0 )
+    {
+        printf( "usage: %s [test]\n", argv[0] );
+        for( int i=0; i<NumberOfTestCases; ++i )
+        {
+            printf( "  %s\n", TestCases[i].name );
+        }
+        return 1;
+    }
+
+    printf( "%i of %i tests passed\n", testsRun - testsFailed, testsRun );
+    return testsFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,69 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTests.h
+ * Description : Checks of the engine's behaviour, failing with a non-zero exit code.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCTESTS_H__
+#define __CCTESTS_H__
+
+
+#include "CCBenchmark.h"
+
+
+// Reports a failed check, returns the condition
+extern bool CCTestCheck(const bool condition, const char *expression, const char *file, const int line);
+
+// Reports a value further than tolerance from what was expected, returns true if it's within it
+extern bool CCTestCheckNear(const double value, const double expected, const double tolerance,
+                            const char *expression, const char *file, const int line);
+
+#define CCTEST_CHECK( condition ) CCTestCheck( condition, #condition, __FILE__, __LINE__ )
+#define CCTEST_CHECK_NEAR( value, expected, tolerance ) CCTestCheckNear( value, expected, tolerance, #value, __FILE__, __LINE__ )
+
+
+// Tests are run on a fresh engine, failures are counted through the checks
+typedef void (*CCTestFunction)(CCBenchmarkEngine *engine);
+
+// Active allocations created, released and their slots reused without the stale handles reported active
+extern void CCTestActiveAllocations(CCBenchmarkEngine *engine);
+
+// Jobs across 1 to 8 workers with dependencies, engine thread finishes, the jobs thread fallback and stopping mid run
+extern void CCTestJobScheduler(CCBenchmarkEngine *engine);
+
+// Vectorised matrix multiply, inverse and transforms within tolerance of the scalar versions
+extern void CCTestMatrices(CCBenchmarkEngine *engine);
+
+// Quaternions to and from angles, matrices composed from them, slerp and nlerp
+extern void CCTestRotations(CCBenchmarkEngine *engine);
+
+// Random OBJ files in every face format against what was written, and against ObjLoader3
+extern void CCTestOBJParser(CCBenchmarkEngine *engine);
+
+// Transform store world matrices against the objects' own, and refreshed between updates
+extern void CCTestTransforms(CCBenchmarkEngine *engine);
+
+// Octree query listed sets growing mid query and starting afresh each query
+extern void CCTestOctreeListedSet(CCBenchmarkEngine *engine);
+
+// Mesh files opened with 16 and 32 bit indices, turned away when an index is past the vertices or a name is outside the file
+extern void CCTestMeshFile(CCBenchmarkEngine *engine);
+
+// Collision queries spread across 2, 4 and 8 workers against a single threaded run
+extern void CCTestCollisionQueries(CCBenchmarkEngine *engine);
+
+// Models and labels drawn in place mixed in the alpha pass with the render queue on
+extern void CCTestRenderQueue(CCBenchmarkEngine *engine);
+
+// Command line entry point, expects: [test], runs every test without one and returns non-zero if any check failed
+extern int CCTestsMain(int argc, char *argv[]);
+
+
+#endif // __CCTESTS_H__
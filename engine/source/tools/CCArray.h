@@ -50,6 +50,36 @@ public:
         CCASSERT( list != NULL );
     }
 
+    // Grows the list to hold at least size objects, keeping the objects already in it
+    void reserve(const int size)
+    {
+        if( size > allocated )
+        {
+            int newAllocated = allocated > 0 ? allocated : 16;
+            while( newAllocated < size )
+            {
+                newAllocated *= 2;
+            }
+
+            const uint sizeOfPointer = sizeof( void* );
+            T **newArray = (T**)malloc( sizeOfPointer * newAllocated );
+            CCASSERT( newArray != NULL );
+
+            if( list != NULL )
+            {
+                for( int i=0; i<length; ++i )
+                {
+                    newArray[i] = list[i];
+                }
+
+                ::free( list );
+            }
+
+            list = newArray;
+            allocated = newAllocated;
+        }
+    }
+
     void add(T *object, const int index=-1)
     {
         //CCASSERT( find( object ) == -1 );
@@ -0,0 +1,69 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCAtomics.h
+ * Description : Atomic operations shared by our lock-free structures.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCATOMICS_H__
+#define __CCATOMICS_H__
+
+
+#if defined WP8 || defined WIN8
+
+// Returns the value before the addition
+inline int CCAtomicAdd(volatile int &value, const int amount)
+{
+    return (int)InterlockedExchangeAdd( (volatile LONG*)&value, (LONG)amount );
+}
+
+inline bool CCAtomicCompareAndSwap(volatile int &value, const int expected, const int desired)
+{
+    return InterlockedCompareExchange( (volatile LONG*)&value, (LONG)desired, (LONG)expected ) == (LONG)expected;
+}
+
+// Returns the previous pointer
+template <typename T> inline T* CCAtomicExchange(T* volatile &target, T *value)
+{
+    return (T*)InterlockedExchangePointer( (PVOID volatile*)&target, (PVOID)value );
+}
+
+inline void CCMemoryBarrier()
+{
+    MemoryBarrier();
+}
+
+#else
+
+inline int CCAtomicAdd(volatile int &value, const int amount)
+{
+    return __sync_fetch_and_add( &value, amount );
+}
+
+inline bool CCAtomicCompareAndSwap(volatile int &value, const int expected, const int desired)
+{
+    return __sync_bool_compare_and_swap( &value, expected, desired );
+}
+
+template <typename T> inline T* CCAtomicExchange(T* volatile &target, T *value)
+{
+    // __sync_lock_test_and_set is only an acquire barrier, so make our previous writes visible first
+    __sync_synchronize();
+    return __sync_lock_test_and_set( &target, value );
+}
+
+inline void CCMemoryBarrier()
+{
+    __sync_synchronize();
+}
+
+#endif
+
+
+#endif // __CCATOMICS_H__
@@ -0,0 +1,221 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCCallbackQueue.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCCallbackQueue.h"
+
+
+// CCCallbackQueue
+CCCallbackQueue::CCCallbackQueue()
+{
+    front.init();
+    back.init();
+}
+
+
+void CCCallbackQueue::push(CCLambdaCallback *callback, const bool pushToFront)
+{
+    if( pushToFront )
+    {
+        front.push( callback );
+    }
+    else
+    {
+        back.push( callback );
+    }
+}
+
+
+CCLambdaCallback* CCCallbackQueue::pop()
+{
+    CCLambdaCallback *callback = front.pop();
+    if( callback == NULL )
+    {
+        callback = back.pop();
+    }
+    return callback;
+}
+
+
+bool CCCallbackQueue::isEmpty() const
+{
+    return front.isEmpty() && back.isEmpty();
+}
+
+
+void CCCallbackQueue::Lane::init()
+{
+    stub.queueNext = NULL;
+    head = &stub;
+    tail = &stub;
+}
+
+
+void CCCallbackQueue::Lane::push(CCLambdaCallback *callback)
+{
+    callback->queueNext = NULL;
+    CCLambdaCallback *previous = CCAtomicExchange( head, callback );
+
+    // Until this is set the consumer sees the list end at previous
+    previous->queueNext = callback;
+}
+
+
+CCLambdaCallback* CCCallbackQueue::Lane::pop()
+{
+    CCLambdaCallback *current = tail;
+    CCLambdaCallback *next = current->queueNext;
+
+    // Skip over the stub
+    if( current == &stub )
+    {
+        if( next == NULL )
+        {
+            return NULL;
+        }
+        tail = next;
+        current = next;
+        next = next->queueNext;
+    }
+
+    if( next != NULL )
+    {
+        CCMemoryBarrier();
+        tail = next;
+        return current;
+    }
+
+    // A producer has exchanged the head but not linked it in yet, try again next time
+    if( current != head )
+    {
+        return NULL;
+    }
+
+    // current is the last callback, put the stub back behind it so we can release it
+    push( &stub );
+    next = current->queueNext;
+    if( next != NULL )
+    {
+        CCMemoryBarrier();
+        tail = next;
+        return current;
+    }
+
+    return NULL;
+}
+
+
+bool CCCallbackQueue::Lane::isEmpty() const
+{
+    return tail == &stub && stub.queueNext == NULL;
+}
+
+
+
+// CCBoundedCallbackQueue
+CCBoundedCallbackQueue::CCBoundedCallbackQueue(const int size)
+{
+    int allocated = 2;
+    while( allocated < size )
+    {
+        allocated *= 2;
+    }
+    mask = allocated - 1;
+
+    slots = (Slot*)malloc( sizeof( Slot ) * allocated );
+    CCASSERT( slots != NULL );
+    for( int i=0; i<allocated; ++i )
+    {
+        slots[i].sequence = i;
+        slots[i].callback = NULL;
+    }
+
+    pushPosition = 0;
+    popPosition = 0;
+}
+
+
+CCBoundedCallbackQueue::~CCBoundedCallbackQueue()
+{
+    FREE_POINTER( slots );
+}
+
+
+bool CCBoundedCallbackQueue::push(CCLambdaCallback *callback)
+{
+    int position = pushPosition;
+    for( ;; )
+    {
+        Slot &slot = slots[position & mask];
+        const int sequence = slot.sequence;
+        CCMemoryBarrier();
+
+        // Positions wrap around, so compare their difference
+        const int difference = (int)( (uint)sequence - (uint)position );
+        if( difference == 0 )
+        {
+            if( CCAtomicCompareAndSwap( pushPosition, position, position + 1 ) )
+            {
+                slot.callback = callback;
+                CCMemoryBarrier();
+                slot.sequence = position + 1;
+                return true;
+            }
+        }
+        else if( difference < 0 )
+        {
+            // The consumer hasn't released this slot yet
+            return false;
+        }
+
+        position = pushPosition;
+    }
+}
+
+
+CCLambdaCallback* CCBoundedCallbackQueue::pop()
+{
+    Slot &slot = slots[popPosition & mask];
+    const int difference = (int)( (uint)slot.sequence - ( (uint)popPosition + 1 ) );
+    if( difference < 0 )
+    {
+        return NULL;
+    }
+    CCMemoryBarrier();
+
+    CCLambdaCallback *callback = slot.callback;
+    CCMemoryBarrier();
+
+    // Hand the slot back to the producers for the next lap around the ring
+    slot.sequence = (int)( (uint)popPosition + (uint)mask + 1 );
+    popPosition++;
+    return callback;
+}
+
+
+int CCBoundedCallbackQueue::popBatch(CCLambdaCallback **callbacks, const int maxCallbacks)
+{
+    int popped = 0;
+    while( popped < maxCallbacks )
+    {
+        CCLambdaCallback *callback = pop();
+        if( callback == NULL )
+        {
+            break;
+        }
+        callbacks[popped++] = callback;
+    }
+    return popped;
+}
+
+
+bool CCBoundedCallbackQueue::isEmpty() const
+{
+    return slots[popPosition & mask].sequence != (int)( (uint)popPosition + 1 );
+}
@@ -0,0 +1,98 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCCallbackQueue.h
+ * Description : Lock-free multi-producer single-consumer queues of callbacks.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCCALLBACKQUEUE_H__
+#define __CCCALLBACKQUEUE_H__
+
+
+#include "CCAtomics.h"
+
+
+// Unbounded queue linked through CCLambdaCallback::queueNext
+// Any thread can push, only the owning thread may pop
+class CCCallbackQueue
+{
+public:
+    // Number of callbacks to run per lock when draining
+    enum { batch_size = 16 };
+
+    CCCallbackQueue();
+
+    // Callbacks pushed to the front run before the rest of the queue, in the order they were pushed
+    void push(CCLambdaCallback *callback, const bool pushToFront=false);
+
+    // Returns NULL if the queue is empty, or a push is still being published
+    CCLambdaCallback* pop();
+
+    // Only reliable on the consuming thread
+    bool isEmpty() const;
+
+protected:
+    // Singly linked list, producers exchange the head and consumers walk from the tail
+    struct Lane
+    {
+        void init();
+        void push(CCLambdaCallback *callback);
+        CCLambdaCallback* pop();
+        bool isEmpty() const;
+
+        CCLambdaCallback * volatile head;
+        CCLambdaCallback *tail;
+
+        // Placeholder kept in the list so producers never touch the tail
+        class Stub : public CCLambdaCallback
+        {
+        protected:
+            void run() {}
+        };
+        Stub stub;
+    };
+
+    Lane front, back;
+};
+
+
+// Fixed size queue of callbacks, pushing fails when the queue is full
+// Any thread can push, only the owning thread may pop
+class CCBoundedCallbackQueue
+{
+public:
+    // Size is rounded up to a power of two
+    CCBoundedCallbackQueue(const int size=1024);
+    ~CCBoundedCallbackQueue();
+
+    bool push(CCLambdaCallback *callback);
+    CCLambdaCallback* pop();
+
+    // Pops up to maxCallbacks into callbacks, returns the number popped
+    int popBatch(CCLambdaCallback **callbacks, const int maxCallbacks);
+
+    bool isEmpty() const;
+
+protected:
+    // Each slot's sequence tells producers and the consumer whose turn it is to use it
+    struct Slot
+    {
+        volatile int sequence;
+        CCLambdaCallback *callback;
+    };
+
+    Slot *slots;
+    int mask;
+
+    volatile int pushPosition;
+    int popPosition;
+};
+
+
+#endif // __CCCALLBACKQUEUE_H__
@@ -11,28 +11,42 @@
 
 
 // CCActiveAllocation
-CCPtrList<void> CCActiveAllocation::ActiveAllocations;
-long CCActiveAllocation::NextAllocationID = 0;
+CCActiveAllocation::Slot* CCActiveAllocation::SlotPages[max_pages] = { NULL };
+int CCActiveAllocation::NumberOfSlots = 0;
+int CCActiveAllocation::FreeSlot = -1;
 
 
 CCActiveAllocation::CCActiveAllocation()
 {
     CCNativeThreadLock();
 
-#ifdef DEBUGON
-    for( int i=0; i<ActiveAllocations.length; ++i )
+    // Reuse a released slot, or take the next unused one
+    int index = FreeSlot;
+    if( index != -1 )
     {
-        if( ActiveAllocations.list[i] == this )
+        FreeSlot = SlotPages[index / slots_per_page][index % slots_per_page].nextFreeSlot;
+    }
+    else
+    {
+        index = NumberOfSlots++;
+        const int page = index / slots_per_page;
+        CCASSERT( page < max_pages );
+        if( SlotPages[page] == NULL )
         {
-            CCASSERT( false );
-            break;
+            Slot *slots = (Slot*)calloc( slots_per_page, sizeof( Slot ) );
+            CCASSERT( slots != NULL );
+            SlotPages[page] = slots;
         }
     }
-#endif
 
-    lazyPointer = this;
-    lazyID = NextAllocationID++;
-    ActiveAllocations.add( lazyPointer );
+    Slot &slot = SlotPages[index / slots_per_page][index % slots_per_page];
+    if( slot.generation == 0 )
+    {
+        slot.generation = 1;
+    }
+
+    activeHandle.index = (uint)index;
+    activeHandle.generation = slot.generation;
     CCNativeThreadUnlock();
 }
 
@@ -41,55 +55,44 @@ CCActiveAllocation::~CCActiveAllocation()
 {
     CCNativeThreadLock();
 
-    ActiveAllocations.remove( this );
+    const int index = (int)activeHandle.index;
+    Slot &slot = SlotPages[index / slots_per_page][index % slots_per_page];
+    CCASSERT( slot.generation == activeHandle.generation );
 
-#ifdef DEBUGON
-    for( int i=0; i<ActiveAllocations.length; ++i )
+    // Invalidate any pending callbacks, a generation of 0 is never active
+    uint generation = slot.generation + 1;
+    if( generation == 0 )
     {
-        if( ActiveAllocations.list[i] == this )
-        {
-            CCASSERT( false );
-            break;
-        }
+        generation = 1;
     }
-#endif
+    slot.generation = generation;
+
+    slot.nextFreeSlot = FreeSlot;
+    FreeSlot = index;
 
     CCNativeThreadUnlock();
 }
 
 
-bool CCActiveAllocation::IsCallbackActive(void *pendingPointer, const long pendingID)
+bool CCActiveAllocation::IsCallbackActive(const CCActiveHandle &handle)
 {
-    CCNativeThreadLock();
-    for( int i=0; i<ActiveAllocations.length; ++i )
+    if( handle.generation == 0 )
     {
-        void *activeAllocation = ActiveAllocations.list[i];
-        if( activeAllocation == pendingPointer )
-        {
-            // Perhaps the same pointer will be added later on
-            // which will lead to an incorrect call?
-            // Let's cross check with the callback's timestamp
-            if( ((CCActiveAllocation*)activeAllocation)->lazyID == pendingID )
-            {
-                CCNativeThreadUnlock();
-                return true;
-            }
-
-#ifdef DEBUGON
-
-            else
-            {
-                //DEBUGLOG( "Detected that the callback has been deleted and the memory has been replaced by another callback\n" );
-            }
-
-#else
+        return false;
+    }
 
-            break;
+    const uint page = handle.index / slots_per_page;
+    if( page >= (uint)max_pages )
+    {
+        return false;
+    }
 
-#endif
-        }
+    const Slot *slots = SlotPages[page];
+    if( slots == NULL )
+    {
+        return false;
     }
-    CCNativeThreadUnlock();
-    return false;
+
+    return slots[handle.index % slots_per_page].generation == handle.generation;
 }
 
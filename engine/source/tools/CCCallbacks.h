@@ -15,19 +15,45 @@
 #define __CCCALLBACKS_H__
 
 
+// Slot in the active allocations table, and the generation of the slot when we were allocated
+struct CCActiveHandle
+{
+    CCActiveHandle()
+    {
+        index = 0;
+        generation = 0;
+    }
+
+    uint index;
+    uint generation;
+};
+
+
 // Automatically keeps track of allocations to let you know if it's ok to callback this class
 class CCActiveAllocation
 {
 public:
     CCActiveAllocation();
     virtual ~CCActiveAllocation();
-    static bool IsCallbackActive(void *pendingPointer, const long pendingID);
 
-    void *lazyPointer;
-    long lazyID;
+    // Doesn't take a lock, the slot's generation changes once its allocation is deleted
+    static bool IsCallbackActive(const CCActiveHandle &handle);
+
+    CCActiveHandle activeHandle;
+
 protected:
-    static CCPtrList<void> ActiveAllocations;
-    static long NextAllocationID;
+    enum { slots_per_page = 4096, max_pages = 1024 };
+
+    struct Slot
+    {
+        volatile uint generation;
+        int nextFreeSlot;
+    };
+
+    // Pages are never moved or freed, so slots can be read without locking
+    static Slot *SlotPages[max_pages];
+    static int NumberOfSlots;
+    static int FreeSlot;
 };
 
 
@@ -38,10 +64,14 @@ public:
     // Use this pointer to pass in parameters for the run function callback
     void *runParameters;
 
+    // Used by CCCallbackQueue to link pending callbacks without allocating
+    CCLambdaCallback * volatile queueNext;
+
 
 	CCLambdaCallback()
 	{
 		runParameters = NULL;
+		queueNext = NULL;
 	}
 
     virtual ~CCLambdaCallback() {};
@@ -78,7 +108,7 @@ class CCLambdaSafeCallback : public CCLambdaCallback
 public:
 	virtual bool isActive()
 	{
-		if( CCActiveAllocation::IsCallbackActive( lazyPointer, lazyID ) )
+		if( CCActiveAllocation::IsCallbackActive( activeHandle ) )
         {
 			return true;
 		}
@@ -111,8 +141,7 @@ public:
     }
 
 protected:
-    void *lazyPointer;
-    long lazyID;
+    CCActiveHandle activeHandle;
 };
 
 
@@ -189,8 +218,7 @@ public:																		\
     NAME(TYPE1 *NAME1)														\
     {																		\
         this->NAME1 = NAME1;												\
-        this->lazyPointer = NAME1->lazyPointer;								\
-        this->lazyID = NAME1->lazyID;										\
+        this->activeHandle = NAME1->activeHandle;								\
     }																		\
 protected:                                                                  \
     void run()																\
@@ -209,8 +237,7 @@ public:																		\
     NAME(TYPE1 *NAME1, TYPE2 NAME2)											\
     {																		\
         this->NAME1 = NAME1;												\
-        this->lazyPointer = NAME1->lazyPointer;								\
-        this->lazyID = NAME1->lazyID;										\
+        this->activeHandle = NAME1->activeHandle;								\
         this->NAME2 = NAME2;												\
     }																		\
 protected:                                                                  \
@@ -249,8 +276,7 @@ public:																				\
     NAME(TYPE1 *NAME1, TYPE2 NAME2)													\
     {																				\
         this->NAME1 = NAME1;														\
-        this->lazyPointer = NAME1->lazyPointer;										\
-        this->lazyID = NAME1->lazyID;												\
+        this->activeHandle = NAME1->activeHandle;										\
         this->NAME2 = NAME2;														\
     }																				\
 protected:																			\
@@ -275,8 +301,7 @@ public:																					\
     NAME(TYPE1 *NAME1, TYPE2 NAME2, TYPE3 NAME3)										\
     {                                                                   				\
         this->NAME1 = NAME1;                                            				\
-        this->lazyPointer = NAME1->lazyPointer;                         				\
-        this->lazyID = NAME1->lazyID;                                   				\
+        this->activeHandle = NAME1->activeHandle;                         				\
         this->NAME2 = NAME2;                                            				\
         this->NAME3 = NAME3;                                            				\
     }                                                                   				\
@@ -299,8 +324,7 @@ public:																								\
     NAME(TYPE1 *NAME1, TYPE2 NAME2, TYPE3 NAME3)													\
     {																								\
         this->NAME1 = NAME1;																		\
-        this->lazyPointer = NAME1->lazyPointer;														\
-        this->lazyID = NAME1->lazyID;																\
+        this->activeHandle = NAME1->activeHandle;														\
         this->NAME2 = NAME2;																		\
         this->NAME3 = NAME3;                                            							\
     }																								\
@@ -327,8 +351,7 @@ public:																					\
     CLASSNAME(T1 *N1, T2 N2, T3 N3, T4 N4)                                              \
     {                                                                   				\
         this->N1 = N1;                                            						\
-        this->lazyPointer = N1->lazyPointer;                         					\
-        this->lazyID = N1->lazyID;                                   					\
+        this->activeHandle = N1->activeHandle;                         					\
         this->N2 = N2;                                            						\
         this->N3 = N3;                                            						\
         this->N4 = N4;                                            						\
@@ -377,8 +400,7 @@ public:																					\
     CLASSNAME(T1 *N1, T2 N2, T3 N3, T4 N4, T5 N5)										\
     {                                                                   				\
         this->N1 = N1;                                            						\
-        this->lazyPointer = N1->lazyPointer;                         					\
-        this->lazyID = N1->lazyID;                                   					\
+        this->activeHandle = N1->activeHandle;                         					\
         this->N2 = N2;                                            						\
         this->N3 = N3;                                            						\
         this->N4 = N4;                                            						\
@@ -405,8 +427,7 @@ public:
     CLASSNAME(T1 *N1, T2 N2, T3 N3, T4 N4, T5 N5, T6 N6)                                        \
     {                                                                                           \
         this->N1 = N1;                                                                          \
-        this->lazyPointer = N1->lazyPointer;                                                    \
-        this->lazyID = N1->lazyID;                                                              \
+        this->activeHandle = N1->activeHandle;                                                    \
         this->N2 = N2;                                                                          \
         this->N3 = N3;                                                                          \
         this->N4 = N4;                                                                          \
@@ -435,8 +456,7 @@ public:
     NAME(T1 *N1, T2 N2, T3 N3, T4 N4, T5 N5, T6 N6)                                                     \
     {                                                                                                   \
         this->N1 = N1;                                                                                  \
-        this->lazyPointer = N1->lazyPointer;                                                            \
-        this->lazyID = N1->lazyID;                                                                      \
+        this->activeHandle = N1->activeHandle;                                                            \
         this->N2 = N2;                                                                                  \
         this->N3 = N3;                                                                                  \
         this->N4 = N4;                                                                                  \
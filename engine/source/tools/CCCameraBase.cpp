@@ -45,6 +45,15 @@ CCCameraBase::CCCameraBase()
     }
 
     collideables = NULL;
+
+    visibleCollideables.allocate( MAX_VISIBLE_COLLIDEABLES );
+    sortedVisibleCollideablesAllocated = MAX_VISIBLE_COLLIDEABLES;
+    sortedVisibleCollideables = (int*)malloc( sizeof( int ) * sortedVisibleCollideablesAllocated );
+    visibleSortKeys = (CCSortKey*)malloc( sizeof( CCSortKey ) * sortedVisibleCollideablesAllocated );
+    radixSortKeys = (CCSortKey*)malloc( sizeof( CCSortKey ) * sortedVisibleCollideablesAllocated );
+    previousVisibleCollideables = (CCCollideable**)malloc( sizeof( CCCollideable* ) * sortedVisibleCollideablesAllocated );
+    CCASSERT( sortedVisibleCollideables != NULL && visibleSortKeys != NULL && radixSortKeys != NULL && previousVisibleCollideables != NULL );
+    previousVisibleLength = 0;
     
     alwaysOnTop = false;
 
@@ -56,6 +65,11 @@ CCCameraBase::CCCameraBase()
 
 CCCameraBase::~CCCameraBase()
 {
+    FREE_POINTER( sortedVisibleCollideables );
+    FREE_POINTER( visibleSortKeys );
+    FREE_POINTER( radixSortKeys );
+    FREE_POINTER( previousVisibleCollideables );
+
     if( this == CCCameraBase::CurrentCamera )
     {
         CCCameraBase::CurrentCamera = NULL;
@@ -436,10 +450,10 @@ void CCCameraBase::incrementRotationZ(const float increment)
 }
 
 
-static int (*VisibleSortFunction)(const void *, const void *) = NULL;
-void CCCameraBase::SetVisibleSortFunction(int (*callback)(const void *, const void *) )
+static CCSortKey (*VisibleSortKeyFunction)(CCCollideable *, const CCVector3 &) = NULL;
+void CCCameraBase::SetVisibleSortKeyFunction(CCSortKey (*callback)(CCCollideable *object, const CCVector3 &cameraPosition) )
 {
-	VisibleSortFunction = callback;
+	VisibleSortKeyFunction = callback;
 }
 
 
@@ -465,12 +479,62 @@ void CCCameraBase::updateVisibleCollideables()
         CCOctreeScanVisibleCollideables( frustum, visibleCollideables );
     }
 
-    for( int i=0; i<visibleCollideables.length; ++i )
+    sortVisibleCollideables();
+}
+
+
+void CCCameraBase::sortVisibleCollideables()
+{
+    const int count = visibleCollideables.length;
+    if( count > sortedVisibleCollideablesAllocated )
+    {
+        while( sortedVisibleCollideablesAllocated < count )
+        {
+            sortedVisibleCollideablesAllocated *= 2;
+        }
+        FREE_POINTER( sortedVisibleCollideables );
+        FREE_POINTER( visibleSortKeys );
+        FREE_POINTER( radixSortKeys );
+        FREE_POINTER( previousVisibleCollideables );
+        sortedVisibleCollideables = (int*)malloc( sizeof( int ) * sortedVisibleCollideablesAllocated );
+        visibleSortKeys = (CCSortKey*)malloc( sizeof( CCSortKey ) * sortedVisibleCollideablesAllocated );
+        radixSortKeys = (CCSortKey*)malloc( sizeof( CCSortKey ) * sortedVisibleCollideablesAllocated );
+        previousVisibleCollideables = (CCCollideable**)malloc( sizeof( CCCollideable* ) * sortedVisibleCollideablesAllocated );
+        CCASSERT( sortedVisibleCollideables != NULL && visibleSortKeys != NULL && radixSortKeys != NULL && previousVisibleCollideables != NULL );
+        previousVisibleLength = 0;
+    }
+
+    if( VisibleSortKeyFunction == NULL )
     {
-        sortedVisibleCollideables[i] = i;
+        for( int i=0; i<count; ++i )
+        {
+            sortedVisibleCollideables[i] = i;
+        }
+        return;
+    }
+
+    for( int i=0; i<count; ++i )
+    {
+        visibleSortKeys[i] = VisibleSortKeyFunction( visibleCollideables.list[i], rotatedPosition );
+    }
+
+    // Last frame's order is only reusable if it refers to the same objects
+    const bool sameVisible = count == previousVisibleLength &&
+                             memcmp( previousVisibleCollideables, visibleCollideables.list, sizeof( CCCollideable* ) * count ) == 0;
+
+    // Allow about as much work as a couple of radix passes before giving up on last frame's order
+    if( sameVisible == false || CCRadixSort::InsertionSort( sortedVisibleCollideables, visibleSortKeys, count, count * 2 ) == false )
+    {
+        for( int i=0; i<count; ++i )
+        {
+            radixSortKeys[i] = visibleSortKeys[i];
+            sortedVisibleCollideables[i] = i;
+        }
+        visibleSorter.sort( radixSortKeys, sortedVisibleCollideables, count );
     }
 
-    qsort( sortedVisibleCollideables, visibleCollideables.length, sizeof( int ), VisibleSortFunction );
+    memcpy( previousVisibleCollideables, visibleCollideables.list, sizeof( CCCollideable* ) * count );
+    previousVisibleLength = count;
 }
 
 
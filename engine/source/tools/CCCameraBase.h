@@ -17,6 +17,7 @@
 
 #include "CCVectors.h"
 #include "CCMatrix.h"
+#include "CCRadixSort.h"
 
 enum CCCameraFrustumPlanes
 {
@@ -110,7 +111,12 @@ public:
     void updateControls();
 
 public:
-    static void SetVisibleSortFunction(int (*callback)(const void *, const void *) );
+    // Visible objects are drawn in the order of the keys this returns, smallest first
+    static void SetVisibleSortKeyFunction(CCSortKey (*callback)(CCCollideable *object, const CCVector3 &cameraPosition) );
+
+    // Orders sortedVisibleCollideables by their sort keys
+    // When the same objects were visible last frame, last frame's order is usually only a few swaps away
+    void sortVisibleCollideables();
 
     // Don't use the octrees for scanning the visible objects
     // Optimization if you know what objects the camera will be drawing
@@ -203,9 +209,21 @@ public:
     CCMatrix pushedMatrix[MAX_PUSHES];
     int currentPush;
 
+    // Initial size of the visible lists, they grow as needed
 #define MAX_VISIBLE_COLLIDEABLES 2048
     CCPtrList<CCCollideable> visibleCollideables;
-    int sortedVisibleCollideables[MAX_VISIBLE_COLLIDEABLES];
+    int *sortedVisibleCollideables;
+    int sortedVisibleCollideablesAllocated;
+
+protected:
+    // Kept between frames for sortVisibleCollideables
+    CCSortKey *visibleSortKeys;
+    CCSortKey *radixSortKeys;
+    CCCollideable **previousVisibleCollideables;
+    int previousVisibleLength;
+    CCRadixSort visibleSorter;
+
+public:
 
     bool alwaysOnTop;
 };
@@ -9,17 +9,21 @@
 
 #include "CCDefines.h"
 #include "CCObjects.h"
+#include "CCJobScheduler.h"
+#include "CCSweepAndPrune.h"
 
 
 CCCollisionManager::CCCollisionManager(const float octreeSize)
 {
     octree = new CCOctree( NULL, CCVector3(), octreeSize );
-	pruneOctreeTimer = 0.0f;
+    broadphase = NULL;
 }
 
 
 CCCollisionManager::~CCCollisionManager()
 {
+    DELETE_POINTER( broadphase );
+
 	if( octree != NULL )
 	{
 		CCOctreeDeleteLeafs( octree );
@@ -32,6 +36,11 @@ void CCCollisionManager::addCollideable(CCCollideable* collideable)
 {
 	collideables.add( collideable );
 	CCOctreeAddObject( octree, collideable );
+
+    if( broadphase != NULL )
+    {
+        broadphase->add( collideable );
+    }
 }
 
 
@@ -39,6 +48,28 @@ void CCCollisionManager::removeCollideable(CCCollideable* collideable)
 {
     collideables.remove( collideable );
 	CCOctreeRemoveObject( collideable );
+
+    if( broadphase != NULL )
+    {
+        broadphase->remove( collideable );
+    }
+}
+
+
+void CCCollisionManager::enableBroadphase(const bool toggle)
+{
+    if( toggle && broadphase == NULL )
+    {
+        broadphase = new CCSweepAndPrune();
+        for( int i=0; i<collideables.length; ++i )
+        {
+            broadphase->add( collideables.list[i] );
+        }
+    }
+    else if( toggle == false )
+    {
+        DELETE_POINTER( broadphase );
+    }
 }
 
 
@@ -116,34 +147,231 @@ CCCollideable* CCBasicCollisionCheck(CCCollideable *sourceObject, const CCVector
 }
 
 
-#define MAX_LEAFS 64
-#define MAX_COLLIDEABLES 512
-static CCCollideable *collideables[MAX_COLLIDEABLES];
-static int numberOfCollideables;
-static void setCollideablesList(const CCVector3 &sourceMin, const CCVector3 &sourceMax)
+bool CCSweptBoxCollisionCheck(const CCVector3 &sourceMin, const CCVector3 &sourceMax, const CCVector3 &velocity,
+                              const CCVector3 &targetMin, const CCVector3 &targetMax,
+                              float &hitTime, int &hitAxis)
+{
+    float entryTime = -MAXFLOAT;
+    float exitTime = MAXFLOAT;
+    int entryAxis = -1;
+
+    for( int axis=0; axis<3; ++axis )
+    {
+        const float speed = (&velocity.x)[axis];
+        const float sMin = (&sourceMin.x)[axis];
+        const float sMax = (&sourceMax.x)[axis];
+        const float tMin = (&targetMin.x)[axis];
+        const float tMax = (&targetMax.x)[axis];
+
+        if( speed == 0.0f )
+        {
+            // Not moving on this axis, so we need to overlap the whole way
+            if( sMax < tMin || sMin > tMax )
+            {
+                return false;
+            }
+        }
+        else
+        {
+            const float inverseSpeed = 1.0f / speed;
+            const float axisEntry = ( speed > 0.0f ? tMin - sMax : tMax - sMin ) * inverseSpeed;
+            const float axisExit = ( speed > 0.0f ? tMax - sMin : tMin - sMax ) * inverseSpeed;
+            if( axisEntry > entryTime )
+            {
+                entryTime = axisEntry;
+                entryAxis = axis;
+            }
+            if( axisExit < exitTime )
+            {
+                exitTime = axisExit;
+            }
+        }
+    }
+
+    // Moving away from a box we're touching isn't a collision
+    if( entryTime > exitTime || entryTime > 1.0f || exitTime <= 0.0f )
+    {
+        return false;
+    }
+
+    if( entryTime < 0.0f )
+    {
+        // Started inside, it only counts if we're still inside at the end
+        if( exitTime < 1.0f )
+        {
+            return false;
+        }
+        hitTime = 0.0f;
+        hitAxis = -1;
+        return true;
+    }
+
+    hitTime = entryTime;
+    hitAxis = entryAxis;
+    return true;
+}
+
+
+CCOctreeListedSet::CCOctreeListedSet(const int expected)
+{
+    listed = NULL;
+    listedQueryIDs = NULL;
+    size = 0;
+    numberOfListed = 0;
+    queryID = 0;
+
+    uint initialSize = 16;
+    while( initialSize < (uint)expected * 2 )
+    {
+        initialSize *= 2;
+    }
+    resize( initialSize );
+}
+
+
+CCOctreeListedSet::~CCOctreeListedSet()
+{
+    FREE_POINTER( listed );
+    FREE_POINTER( listedQueryIDs );
+}
+
+
+void CCOctreeListedSet::begin()
+{
+    numberOfListed = 0;
+
+    queryID++;
+    if( queryID == 0 )
+    {
+        for( uint i=0; i<size; ++i )
+        {
+            listedQueryIDs[i] = 0;
+        }
+        queryID = 1;
+    }
+}
+
+
+bool CCOctreeListedSet::add(const CCCollideable *collideable)
+{
+    if( ( numberOfListed + 1 ) * 2 > size )
+    {
+        resize( size * 2 );
+    }
+
+    uint index = (uint)( ( (size_t)collideable >> 4 ) * 2654435761u ) & ( size-1 );
+    while( listedQueryIDs[index] == queryID )
+    {
+        if( listed[index] == collideable )
+        {
+            return false;
+        }
+        index = ( index + 1 ) & ( size-1 );
+    }
+
+    listed[index] = collideable;
+    listedQueryIDs[index] = queryID;
+    numberOfListed++;
+    return true;
+}
+
+
+// Rehashes this query's entries, the older ones are dropped
+void CCOctreeListedSet::resize(const uint newSize)
+{
+    const CCCollideable **oldListed = listed;
+    uint *oldQueryIDs = listedQueryIDs;
+    const uint oldSize = size;
+
+    size = newSize;
+    listed = (const CCCollideable**)malloc( sizeof( CCCollideable* ) * size );
+    listedQueryIDs = (uint*)malloc( sizeof( uint ) * size );
+    CCASSERT( listed != NULL && listedQueryIDs != NULL );
+    for( uint i=0; i<size; ++i )
+    {
+        listed[i] = NULL;
+        listedQueryIDs[i] = 0;
+    }
+
+    numberOfListed = 0;
+    for( uint i=0; i<oldSize; ++i )
+    {
+        if( oldQueryIDs[i] == queryID )
+        {
+            add( oldListed[i] );
+        }
+    }
+
+    FREE_POINTER( oldListed );
+    FREE_POINTER( oldQueryIDs );
+}
+
+
+CCCollisionQueryContext::CCCollisionQueryContext()
+{
+    numberOfCollideables = 0;
+    numberOfLeafs = 0;
+}
+
+
+#ifdef CCJOBSCHEDULER_THREADS
+static pthread_key_t defaultContextKey;
+static pthread_once_t defaultContextOnce = PTHREAD_ONCE_INIT;
+
+static void deleteDefaultContext(void *context)
+{
+    delete (CCCollisionQueryContext*)context;
+}
+
+static void createDefaultContextKey()
+{
+    pthread_key_create( &defaultContextKey, &deleteDefaultContext );
+}
+#endif
+
+
+CCCollisionQueryContext& CCCollisionQueryContext::Default()
+{
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_once( &defaultContextOnce, &createDefaultContextKey );
+    CCCollisionQueryContext *context = (CCCollisionQueryContext*)pthread_getspecific( defaultContextKey );
+    if( context == NULL )
+    {
+        context = new CCCollisionQueryContext();
+        pthread_setspecific( defaultContextKey, context );
+    }
+    return *context;
+#else
+    // Without worker threads everything queries from the one thread
+    static CCCollisionQueryContext context;
+    return context;
+#endif
+}
+
+
+void CCCollisionQueryContext::listCollideables(const CCVector3 &min, const CCVector3 &max)
 {
-	static const CCOctree *leafsList[MAX_LEAFS];
-	static int numberOfLeafs;
 	numberOfLeafs = 0;
-	CCOctreeListLeafs( gEngine->collisionManager.octree, sourceMin, sourceMax, leafsList, &numberOfLeafs );
-    CCASSERT( numberOfLeafs < MAX_LEAFS );
+	CCOctreeListLeafs( gEngine->collisionManager.octree, min, max, leafs, &numberOfLeafs );
+    CCASSERT( numberOfLeafs < MAX_QUERY_LEAFS );
     LOG_NEWMAX( "Max leafs per scan", maxLeafsPerScan, numberOfLeafs );
 
+    // Our own listed set rather than anything on the collideables, as other threads may be listing them too
 	numberOfCollideables = 0;
-	CCOctreeListCollideables( collideables, &numberOfCollideables, leafsList, numberOfLeafs );
-    CCASSERT( numberOfCollideables < MAX_COLLIDEABLES );
+    CCOctreeListCollideables( collideables, &numberOfCollideables, MAX_QUERY_COLLIDEABLES, leafs, numberOfLeafs, listed );
     LOG_NEWMAX( "Max collideables per scan", maxCollideablesPerScan, numberOfCollideables );
 }
 
 
-CCCollideable* CCOctreeCollideableScan(const CCVector3 &min, const CCVector3 &max, const CCCollideable *sourceObject, const uint flags)
+CCCollideable* CCOctreeCollideableScan(CCCollisionQueryContext &context,
+                                       const CCVector3 &min, const CCVector3 &max, const CCCollideable *sourceObject, const uint flags)
 {
-	setCollideablesList( min, max );
+	context.listCollideables( min, max );
 
 	CCCollideable *closestCollision = NULL;
-	for( int i=0; i<numberOfCollideables; ++i )
+	for( int i=0; i<context.numberOfCollideables; ++i )
 	{
-		CCCollideable *checkingObject = collideables[i];
+		CCCollideable *checkingObject = context.collideables[i];
 
 		if( checkingObject != sourceObject )
 		{
@@ -169,7 +397,14 @@ CCCollideable* CCOctreeCollideableScan(const CCVector3 &min, const CCVector3 &ma
 }
 
 
-CCCollideable* CCOctreeCollisionCheck(CCCollideable *sourceObject,
+CCCollideable* CCOctreeCollideableScan(const CCVector3 &min, const CCVector3 &max, const CCCollideable *sourceObject, const uint flags)
+{
+    return CCOctreeCollideableScan( CCCollisionQueryContext::Default(), min, max, sourceObject, flags );
+}
+
+
+CCCollideable* CCOctreeCollisionCheck(CCCollisionQueryContext &context,
+                                      CCCollideable *sourceObject,
                                       const CCVector3 &targetLocation,
                                       const bool requestCollisions,
                                       const CCCollisionFlags flags)
@@ -184,13 +419,13 @@ CCCollideable* CCOctreeCollisionCheck(CCCollideable *sourceObject,
                                          targetLocation.y + sourceObject->collisionBounds.y,
                                          targetLocation.z + sourceObject->collisionBounds.z );
 
-		setCollideablesList( sourceMin, sourceMax );
+		context.listCollideables( sourceMin, sourceMax );
 
 		CCCollideable *closestCollision = NULL;
 
-		for( int i=0; i<numberOfCollideables; ++i )
+		for( int i=0; i<context.numberOfCollideables; ++i )
 		{
-			CCCollideable *checkingObject = collideables[i];
+			CCCollideable *checkingObject = context.collideables[i];
 
 			if( checkingObject != sourceObject )
 			{
@@ -234,7 +469,16 @@ CCCollideable* CCOctreeCollisionCheck(CCCollideable *sourceObject,
 }
 
 
-CCCollideable* CCOctreeMovementCollisionCheck(CCCollideable *sourceObject, CCVector3 currentPosition, const CCVector3 &targetPosition)
+CCCollideable* CCOctreeCollisionCheck(CCCollideable *sourceObject,
+                                      const CCVector3 &targetLocation,
+                                      const bool requestCollisions,
+                                      const CCCollisionFlags flags)
+{
+    return CCOctreeCollisionCheck( CCCollisionQueryContext::Default(), sourceObject, targetLocation, requestCollisions, flags );
+}
+
+
+CCCollideable* CCOctreeMovementCollisionCheck(CCCollisionQueryContext &context, CCCollideable *sourceObject, CCVector3 currentPosition, const CCVector3 &targetPosition)
 {
     // First see if we're already colliding with an object
 	CCCollideable *collidedWith = NULL;
@@ -262,7 +506,7 @@ CCCollideable* CCOctreeMovementCollisionCheck(CCCollideable *sourceObject, CCVec
 		{
 			currentPosition.x += incrementsX;
 			currentPosition.z += incrementsZ;
-			collidedWith = CCOctreeCollisionCheck( sourceObject, currentPosition, false, collision_static );
+			collidedWith = CCOctreeCollisionCheck( context, sourceObject, currentPosition, false, collision_static );
 			i++;
 		} while( i < numberOfIncrements && collidedWith == NULL );
 	}
@@ -270,14 +514,20 @@ CCCollideable* CCOctreeMovementCollisionCheck(CCCollideable *sourceObject, CCVec
 	{
 		currentPosition.x += velocityX;
 		currentPosition.z += velocityZ;
-		collidedWith = CCOctreeCollisionCheck( sourceObject, currentPosition, false, collision_static );
+		collidedWith = CCOctreeCollisionCheck( context, sourceObject, currentPosition, false, collision_static );
 	}
 
 	return collidedWith;
 }
 
 
-void CCOctreeCollisionCheckAsync(CCCollideable *sourceObject, const CCVector3 &targetLocation, CCPtrList<CCCollideable> &collisions)
+CCCollideable* CCOctreeMovementCollisionCheck(CCCollideable *sourceObject, CCVector3 currentPosition, const CCVector3 &targetPosition)
+{
+    return CCOctreeMovementCollisionCheck( CCCollisionQueryContext::Default(), sourceObject, currentPosition, targetPosition );
+}
+
+
+void CCOctreeCollisionCheckAsync(CCCollisionQueryContext &context, CCCollideable *sourceObject, const CCVector3 &targetLocation, CCPtrList<CCCollideable> &collisions)
 {
     CCVector3 sourceMin = CCVector3( targetLocation.x - sourceObject->collisionBounds.x,
                                      targetLocation.y - sourceObject->collisionBounds.y,
@@ -287,9 +537,9 @@ void CCOctreeCollisionCheckAsync(CCCollideable *sourceObject, const CCVector3 &t
                                      targetLocation.y + sourceObject->collisionBounds.y,
                                      targetLocation.z + sourceObject->collisionBounds.z );
 
-    for( int i=0; i<numberOfCollideables; ++i )
+    for( int i=0; i<context.numberOfCollideables; ++i )
     {
-        CCCollideable *checkingObject = collideables[i];
+        CCCollideable *checkingObject = context.collideables[i];
 
         if( checkingObject != sourceObject )
         {
@@ -305,10 +555,15 @@ void CCOctreeCollisionCheckAsync(CCCollideable *sourceObject, const CCVector3 &t
 }
 
 
-void CCOctreeMovementCollisionCheckAsync(CCCollideable *sourceObject, CCVector3 currentPosition, const CCVector3 &targetPosition, CCPtrList<CCCollideable> &collisions)
+void CCOctreeCollisionCheckAsync(CCCollideable *sourceObject, const CCVector3 &targetLocation, CCPtrList<CCCollideable> &collisions)
 {
+    CCOctreeCollisionCheckAsync( CCCollisionQueryContext::Default(), sourceObject, targetLocation, collisions );
+}
+
 
-    static CCVector3 areaMin, areaMax;
+void CCOctreeMovementCollisionCheckAsync(CCCollisionQueryContext &context, CCCollideable *sourceObject, CCVector3 currentPosition, const CCVector3 &targetPosition, CCPtrList<CCCollideable> &collisions)
+{
+    CCVector3 areaMin, areaMax;
 
     if( currentPosition.x < targetPosition.x )
     {
@@ -335,7 +590,7 @@ void CCOctreeMovementCollisionCheckAsync(CCCollideable *sourceObject, CCVector3
     areaMin.y = currentPosition.y - sourceObject->collisionBounds.y;
     areaMax.y = targetPosition.y + sourceObject->collisionBounds.y;
 
-    setCollideablesList( areaMin, areaMax );
+    context.listCollideables( areaMin, areaMax );
     
 	const float velocityX = targetPosition.x - currentPosition.x;
 	const float velocityZ = targetPosition.z - currentPosition.z;
@@ -360,7 +615,7 @@ void CCOctreeMovementCollisionCheckAsync(CCCollideable *sourceObject, CCVector3
 		{
 			currentPosition.x += incrementsX;
 			currentPosition.z += incrementsZ;
-			CCOctreeCollisionCheckAsync( sourceObject, currentPosition, collisions );
+			CCOctreeCollisionCheckAsync( context, sourceObject, currentPosition, collisions );
 			i++;
 		} while( i < numberOfIncrements );
 	}
@@ -368,11 +623,17 @@ void CCOctreeMovementCollisionCheckAsync(CCCollideable *sourceObject, CCVector3
 	{
 		currentPosition.x += velocityX;
 		currentPosition.z += velocityZ;
-		CCOctreeCollisionCheckAsync( sourceObject, currentPosition, collisions );
+		CCOctreeCollisionCheckAsync( context, sourceObject, currentPosition, collisions );
 	}
 }
 
 
+void CCOctreeMovementCollisionCheckAsync(CCCollideable *sourceObject, CCVector3 currentPosition, const CCVector3 &targetPosition, CCPtrList<CCCollideable> &collisions)
+{
+    CCOctreeMovementCollisionCheckAsync( CCCollisionQueryContext::Default(), sourceObject, currentPosition, targetPosition, collisions );
+}
+
+
 static bool lineCheckGetIntersection(const float dist1, const float dist2, const CCVector3 &point1, const CCVector3 &point2, CCVector3 &hitLocation)
 {
 	if( ( dist1 * dist2 ) >= 0.0f )
@@ -457,11 +718,12 @@ static bool lineCheckBox(const CCVector3 &start, const CCVector3 &end,
 	    start.z > boxMin.z && start.z < boxMax.z )
 	{
 		hitLocation = start;
+        hitDistance = 0.0f;
 		return true;
 	}
 
-	static CCVector3 hits[6];
-	static bool hitResult[6];
+	CCVector3 hits[6];
+	bool hitResult[6];
 
 	hitResult[0] = lineCheckGetIntersection( start.x-boxMin.x, end.x-boxMin.x, start, end, hits[0] ) && lineCheckInBox( hits[0], boxMin, boxMax, 1 );
 	hitResult[1] = lineCheckGetIntersection( start.y-boxMin.y, end.y-boxMin.y, start, end, hits[1] ) && lineCheckInBox( hits[1], boxMin, boxMax, 2 );
@@ -470,9 +732,8 @@ static bool lineCheckBox(const CCVector3 &start, const CCVector3 &end,
 	hitResult[4] = lineCheckGetIntersection( start.y-boxMax.y, end.y-boxMax.y, start, end, hits[4] ) && lineCheckInBox( hits[4], boxMin, boxMax, 2 );
 	hitResult[5] = lineCheckGetIntersection( start.z-boxMax.z, end.z-boxMax.z, start, end, hits[5] ) && lineCheckInBox( hits[5], boxMin, boxMax, 3 );
 
-    static bool hit;
-    static CCVector3 distance;
-    hit = false;
+    bool hit = false;
+    CCVector3 distance;
     hitDistance = MAXFLOAT;
     for( uint i=0; i<6; ++i )
     {
@@ -505,8 +766,8 @@ CCCollideable* CCBasicLineCollisionCheck(CCCollideable **list,
 {
 	float hitDistance = MAXFLOAT;
 	CCCollideable *hitObject = NULL;
-	static CCVector3 currentHitPosition;
-    static float currentHitDistance;
+	CCVector3 currentHitPosition;
+    float currentHitDistance;
 
     for( int i=0; i<length; ++i )
 	{
@@ -569,7 +830,7 @@ CCCollideable* CCBasicLineCollisionCheck(const CCVector3 &start,
                                          const float width,
                                          CCCollideable *source)
 {
-    static CCVector3 hitLocation;
+    CCVector3 hitLocation;
     CCCollideable *hitObject = CCBasicLineCollisionCheck( gEngine->collisionManager.collideables.list,
                                                                gEngine->collisionManager.collideables.length,
                                                                source,
@@ -580,7 +841,7 @@ CCCollideable* CCBasicLineCollisionCheck(const CCVector3 &start,
                                                                true );
     if( hitObject == NULL )
     {
-        static CCVector3 minStart, minEnd, maxStart, maxEnd;
+        CCVector3 minStart, minEnd, maxStart, maxEnd;
         minStart.set( start.x - width, start.y, start.z - width );
         minEnd.set( end.x - width, start.y, end.z - width );
         maxStart.set( start.x + width, start.y, start.z + width );
@@ -619,8 +880,8 @@ bool CCBasicLineCollisionCheck(CCCollideable *checkingObject, CCCollideable *sou
     const CCVector3 &targetMin = checkingObject->aabbMin;
     const CCVector3 &targetMax = checkingObject->aabbMax;
 
-    static CCVector3 currentHitLocation;
-    static float currentHitDistance;
+    CCVector3 currentHitLocation;
+    float currentHitDistance;
     if( lineCheckBox( start, end, targetMin, targetMax, currentHitLocation, currentHitDistance ) )
     {
         return true;
@@ -713,3 +974,38 @@ uint CCCubeInFrustum(const float frustum[6][4], const CCVector3 &min, const CCVe
 	}
 	return ( c2 == 6 ) ? 2 : 1;
 }
+
+
+uint CCCubeInFrustum(const float frustum[6][4], const CCVector3 &min, const CCVector3 &max, uint &planeMask)
+{
+	for( uint i=0; i<6; ++i )
+	{
+		const uint planeBit = 1 << i;
+		if( ( planeMask & planeBit ) == 0 )
+		{
+			continue;
+		}
+
+		const float *plane = frustum[i];
+
+		// The corner furthest along the plane's normal, if it's behind the plane the whole cube is
+		const float furthestX = plane[0] > 0.0f ? max.x : min.x;
+		const float furthestY = plane[1] > 0.0f ? max.y : min.y;
+		const float furthestZ = plane[2] > 0.0f ? max.z : min.z;
+		if( plane[0] * furthestX + plane[1] * furthestY + plane[2] * furthestZ + plane[3] <= 0 )
+		{
+			return 0;
+		}
+
+		// If the nearest corner is in front of the plane, so is the whole cube
+		const float nearestX = plane[0] > 0.0f ? min.x : max.x;
+		const float nearestY = plane[1] > 0.0f ? min.y : max.y;
+		const float nearestZ = plane[2] > 0.0f ? min.z : max.z;
+		if( plane[0] * nearestX + plane[1] * nearestY + plane[2] * nearestZ + plane[3] > 0 )
+		{
+			planeMask &= ~planeBit;
+		}
+	}
+
+	return planeMask == 0 ? 2 : 1;
+}
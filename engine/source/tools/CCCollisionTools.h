@@ -16,6 +16,7 @@
 
 
 class CCCollideable;
+class CCSweepAndPrune;
 typedef struct CCOctree CCOctree;
 #include "CCPathFinderNetwork.h"
 
@@ -25,12 +26,16 @@ struct CCCollisionManager
 	~CCCollisionManager();
 
 	CCOctree *octree;
-	float pruneOctreeTimer;
+
+    // Optional, when enabled moveables test against its candidate pairs rather than sub-stepping through the octree
+    CCSweepAndPrune *broadphase;
 
     CCPtrList<CCCollideable> collideables;
 
 	void addCollideable(CCCollideable* collideable);
 	void removeCollideable(CCCollideable* collideable);
+
+    void enableBroadphase(const bool toggle);
 };
 
 
@@ -56,21 +61,91 @@ extern bool CCBasicBoxCollisionCheck(const CCVector3 &sourceMin, const CCVector3
 
 extern CCCollideable* CCBasicCollisionCheck(CCCollideable *sourceObject, const CCVector3 &targetLocation);
 
+// Continuous test of a box moving by velocity against a stationary box, hitTime is in the range 0 to 1 and
+// hitAxis is the axis of the face we hit, or -1 if we start off inside the box and are still inside it at the end
+extern bool CCSweptBoxCollisionCheck(const CCVector3 &sourceMin, const CCVector3 &sourceMax, const CCVector3 &velocity,
+                                     const CCVector3 &targetMin, const CCVector3 &targetMax,
+                                     float &hitTime, int &hitAxis);
+
+#define MAX_QUERY_LEAFS 64
+#define MAX_QUERY_COLLIDEABLES 512
+
+// The collideables a query has listed, so objects spanning several leafs are only listed once
+// Each query keeps its own, so queries on other threads can't see or clear its entries
+class CCOctreeListedSet
+{
+public:
+    CCOctreeListedSet(const int expected=MAX_QUERY_COLLIDEABLES);
+    ~CCOctreeListedSet();
+
+    // Starts a new query, entries from older queries count as empty so the table only needs clearing on wrap around
+    void begin();
+
+    // Returns false if the collideable was already listed by this query
+    bool add(const CCCollideable *collideable);
+
+protected:
+    void resize(const uint newSize);
+
+    // Open addressed, kept at most half full
+    const CCCollideable **listed;
+    uint *listedQueryIDs;
+    uint size;
+    uint numberOfListed;
+    uint queryID;
+};
+
+// Scratch space for the octree queries, each thread has its own default context
+// so queries can run beside each other as long as the octree isn't being modified
+class CCCollisionQueryContext
+{
+public:
+    CCCollisionQueryContext();
+
+    // The calling thread's context
+    static CCCollisionQueryContext& Default();
+
+    // Lists the collideables in the leafs touching the range
+    void listCollideables(const CCVector3 &min, const CCVector3 &max);
+
+    CCCollideable *collideables[MAX_QUERY_COLLIDEABLES];
+    int numberOfCollideables;
+
+protected:
+    const CCOctree *leafs[MAX_QUERY_LEAFS];
+    int numberOfLeafs;
+
+    CCOctreeListedSet listed;
+};
+
 // Is there anything in this location?
+extern CCCollideable* CCOctreeCollideableScan(CCCollisionQueryContext &context,
+                                              const CCVector3 &min, const CCVector3 &max,
+                                              const CCCollideable *sourceObject=NULL,
+                                              const uint flags=collision_box);
 extern CCCollideable* CCOctreeCollideableScan(const CCVector3 &min, const CCVector3 &max,
                                               const CCCollideable *sourceObject=NULL,
                                               const uint flags=collision_box);
 
+extern CCCollideable* CCOctreeCollisionCheck(CCCollisionQueryContext &context,
+                                             CCCollideable *sourceObject,
+                                             const CCVector3 &targetLocation,
+                                             const bool requestCollisions=false,
+                                             const CCCollisionFlags flags=collision_box);
 extern CCCollideable* CCOctreeCollisionCheck(CCCollideable *sourceObject,
                                              const CCVector3 &targetLocation,
                                              const bool requestCollisions=false,
                                              const CCCollisionFlags flags=collision_box);
 
+extern CCCollideable* CCOctreeMovementCollisionCheck(CCCollisionQueryContext &context, CCCollideable *sourceObject, CCVector3 currentPosition, const CCVector3 &targetPosition);
 extern CCCollideable* CCOctreeMovementCollisionCheck(CCCollideable *sourceObject, CCVector3 currentPosition, const CCVector3 &targetPosition);
 
 
 // Just returns a list of collideables without checking for flags or if they should collide
+// CCOctreeCollisionCheckAsync tests against the collideables last listed in the context
+extern void CCOctreeCollisionCheckAsync(CCCollisionQueryContext &context, CCCollideable *sourceObject, const CCVector3 &targetLocation, CCPtrList<CCCollideable> &collisions);
 extern void CCOctreeCollisionCheckAsync(CCCollideable *sourceObject, const CCVector3 &targetLocation, CCPtrList<CCCollideable> &collisions);
+extern void CCOctreeMovementCollisionCheckAsync(CCCollisionQueryContext &context, CCCollideable *sourceObject, CCVector3 currentPosition, const CCVector3 &targetPosition, CCPtrList<CCCollideable> &collisions);
 extern void CCOctreeMovementCollisionCheckAsync(CCCollideable *sourceObject, CCVector3 currentPosition, const CCVector3 &targetPosition, CCPtrList<CCCollideable> &collisions);
 
 // Collision test a ray
@@ -98,5 +173,9 @@ extern bool CCBasicLineCollisionCheck(CCCollideable *checkingObject,
 extern uint CCSphereInFrustum(float frustum[6][4], const float x, const float y, const float z, const float radius);
 extern uint CCCubeInFrustum(const float frustum[6][4], const CCVector3 &min, const CCVector3 &max);
 
+// Only tests the planes set in planeMask, and clears the planes the cube is fully inside of
+// so a hierarchy of cubes can skip them, returns 0 outside, 1 intersecting, 2 inside
+extern uint CCCubeInFrustum(const float frustum[6][4], const CCVector3 &min, const CCVector3 &max, uint &planeMask);
+
 
 #endif // __CCCOLLISIONTOOLS_H__
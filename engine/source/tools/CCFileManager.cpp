@@ -153,6 +153,22 @@ void CCFileManager::GetFilePath(CCText &fullFilePath, const char *filePath, CCRe
     
     fullFilePath += filename;
 
+#elif defined( HEADLESS )
+
+    if( resourceType == Resource_Packaged )
+    {
+        filename.stripDirectory();
+
+        fullFilePath = CCDeviceFileManager::dataPath.buffer;
+        fullFilePath += "packaged/";
+    }
+    else
+    {
+        fullFilePath = GetAppStorageFolder();
+    }
+
+    fullFilePath += filename;
+
 #endif
 
     // No extra stuff
@@ -261,7 +277,7 @@ bool CCFileManager::SaveCachedFile(const char *filePath, const char *data, const
         return true;
     }
 
-#elif defined( IOS ) || defined( ANDROID )
+#elif defined( IOS ) || defined( ANDROID ) || defined( HEADLESS )
 
     //DEBUGLOG( "CCFileManager::Saving %s \n", fullFilePath.buffer );
     FILE *pFile = fopen( fullFilePath.buffer, "w" );
@@ -320,7 +336,7 @@ bool CCFileManager::RenameCachedFile(const char *oldFile, CCResourceType resourc
 
     CCASSERT( false );
 
-#elif defined( IOS ) || defined( ANDROID )
+#elif defined( IOS ) || defined( ANDROID ) || defined( HEADLESS )
 
     CCText oldFilename = oldFile;
     CCText oldPath;
@@ -389,7 +405,7 @@ bool CCFileManager::DeleteFile(const char *filePath, CCResourceType resourceType
         return false;
     }
 
-#elif defined( IOS ) || defined( ANDROID )
+#elif defined( IOS ) || defined( ANDROID ) || defined( HEADLESS )
 
     //DEBUGLOG( "CCFileManager::deleteCachedFile %s \n", fullFilePath.buffer );
     if( remove( fullFilePath.buffer ) != 0 )
@@ -595,7 +611,7 @@ CCResourceType CCFileManager::FindFile(const char *filePath)
 
 const char* CCFileManager::GetAppStorageFolder()
 {
-#ifdef ANDROID
+#if defined( ANDROID ) || defined( HEADLESS )
     return CCDeviceFileManager::dataPath.buffer;
 #elif defined IOS
     return CCDeviceFileManager::GetDocsFolder();
@@ -0,0 +1,498 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCJobScheduler.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCJobScheduler.h"
+#include "CCAtomics.h"
+
+#ifdef CCJOBSCHEDULER_THREADS
+#include <unistd.h>
+#endif
+
+
+// CCJobDeque
+CCJobDeque::CCJobDeque()
+{
+    jobs = NULL;
+    head = 0;
+    length = 0;
+    allocated = 0;
+
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_init( &lock, NULL );
+#endif
+}
+
+
+CCJobDeque::~CCJobDeque()
+{
+    FREE_POINTER( jobs );
+
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_destroy( &lock );
+#endif
+}
+
+
+void CCJobDeque::pushBack(CCJob *job)
+{
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_lock( &lock );
+#endif
+
+    if( length == allocated )
+    {
+        const int newAllocated = allocated == 0 ? 64 : allocated * 2;
+        CCJob **newJobs = (CCJob**)malloc( sizeof( CCJob* ) * newAllocated );
+        CCASSERT( newJobs != NULL );
+        for( int i=0; i<length; ++i )
+        {
+            newJobs[i] = jobs[( head + i ) % allocated];
+        }
+        FREE_POINTER( jobs );
+
+        jobs = newJobs;
+        head = 0;
+        allocated = newAllocated;
+    }
+
+    jobs[( head + length ) % allocated] = job;
+    length++;
+
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_unlock( &lock );
+#endif
+}
+
+
+CCJob* CCJobDeque::popBack()
+{
+    // Avoid taking the lock on empty deques
+    if( length == 0 )
+    {
+        return NULL;
+    }
+
+    CCJob *job = NULL;
+
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_lock( &lock );
+#endif
+
+    if( length > 0 )
+    {
+        length--;
+        job = jobs[( head + length ) % allocated];
+    }
+
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_unlock( &lock );
+#endif
+
+    return job;
+}
+
+
+CCJob* CCJobDeque::popFront()
+{
+    if( length == 0 )
+    {
+        return NULL;
+    }
+
+    CCJob *job = NULL;
+
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_lock( &lock );
+#endif
+
+    if( length > 0 )
+    {
+        job = jobs[head];
+        head = ( head + 1 ) % allocated;
+        length--;
+    }
+
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_unlock( &lock );
+#endif
+
+    return job;
+}
+
+
+
+// CCJobScheduler
+CCJobScheduler::CCJobScheduler()
+{
+    numberOfWorkers = 0;
+    running = false;
+
+    queuedJobs = 0;
+    activeJobs = 0;
+    nextWorker = 0;
+
+    // Jobs fall back to the engine's jobs thread while stopped, so these outlive the workers
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_init( &sleepLock, NULL );
+    pthread_cond_init( &sleepCondition, NULL );
+    pthread_mutex_init( &idleLock, NULL );
+    pthread_cond_init( &idleCondition, NULL );
+    pthread_mutex_init( &dependencyLock, NULL );
+    pthread_key_create( &workerKey, NULL );
+#endif
+}
+
+
+CCJobScheduler::~CCJobScheduler()
+{
+    stop();
+
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_key_delete( workerKey );
+    pthread_mutex_destroy( &dependencyLock );
+    pthread_cond_destroy( &idleCondition );
+    pthread_mutex_destroy( &idleLock );
+    pthread_cond_destroy( &sleepCondition );
+    pthread_mutex_destroy( &sleepLock );
+#endif
+}
+
+
+int CCJobScheduler::DefaultNumberOfWorkers()
+{
+#ifdef CCJOBSCHEDULER_THREADS
+    const int cores = (int)sysconf( _SC_NPROCESSORS_ONLN );
+    if( cores > 1 )
+    {
+        return MIN( cores - 1, (int)max_workers );
+    }
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+
+bool CCJobScheduler::start(const int numberOfWorkers)
+{
+#ifdef CCJOBSCHEDULER_THREADS
+
+    CCASSERT( running == false );
+    if( numberOfWorkers <= 0 )
+    {
+        return false;
+    }
+
+    this->numberOfWorkers = MIN( numberOfWorkers, (int)max_workers );
+    running = true;
+
+    for( int i=0; i<this->numberOfWorkers; ++i )
+    {
+        Worker &worker = workers[i];
+        worker.scheduler = this;
+        worker.index = i;
+        pthread_create( &worker.thread, NULL, &CCJobScheduler::WorkerThread, &worker );
+    }
+    return true;
+
+#else
+
+    return false;
+
+#endif
+}
+
+
+void CCJobScheduler::stop()
+{
+#ifdef CCJOBSCHEDULER_THREADS
+
+    if( running == false )
+    {
+        return;
+    }
+
+    pthread_mutex_lock( &sleepLock );
+    running = false;
+    pthread_cond_broadcast( &sleepCondition );
+    pthread_mutex_unlock( &sleepLock );
+
+    for( int i=0; i<numberOfWorkers; ++i )
+    {
+        pthread_join( workers[i].thread, NULL );
+    }
+
+    // Drop the jobs that never ran, including those still waiting on jobs that now never will
+    for( int i=0; i<numberOfWorkers; ++i )
+    {
+        for( int priority=0; priority<job_priority_max; ++priority )
+        {
+            CCJob *job;
+            while( ( job = workers[i].deques[priority].popFront() ) != NULL )
+            {
+                delete job->callback;
+                delete job;
+            }
+        }
+    }
+
+    for( int i=0; i<waitingJobs.length; ++i )
+    {
+        CCJob *job = waitingJobs.list[i];
+        delete job->callback;
+        delete job;
+    }
+    waitingJobs.clear();
+
+    numberOfWorkers = 0;
+    queuedJobs = 0;
+    activeJobs = 0;
+
+    pthread_mutex_lock( &idleLock );
+    pthread_cond_broadcast( &idleCondition );
+    pthread_mutex_unlock( &idleLock );
+
+#endif
+}
+
+
+CCJob* CCJobScheduler::createJob(CCLambdaCallback *callback, const CCJobPriority priority, const bool finishOnEngineThread)
+{
+    return new CCJob( callback, priority, finishOnEngineThread );
+}
+
+
+void CCJobScheduler::addDependency(CCJob *job, CCJob *dependency)
+{
+    CCASSERT( job->submitted == false && dependency->submitted == false );
+    dependency->continuations.add( job );
+    job->pendingDependencies++;
+}
+
+
+void CCJobScheduler::submit(CCJob *job)
+{
+    CCAtomicAdd( activeJobs, 1 );
+
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_lock( &dependencyLock );
+#endif
+
+    job->submitted = true;
+    const bool ready = job->pendingDependencies == 0;
+    if( ready == false )
+    {
+        waitingJobs.add( job );
+    }
+
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_unlock( &dependencyLock );
+#endif
+
+    if( ready )
+    {
+        queue( job );
+    }
+}
+
+
+void CCJobScheduler::submit(CCLambdaCallback *callback, const CCJobPriority priority)
+{
+    submit( createJob( callback, priority ) );
+}
+
+
+void CCJobScheduler::waitForIdle()
+{
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_lock( &idleLock );
+    while( activeJobs > 0 )
+    {
+        pthread_cond_wait( &idleCondition, &idleLock );
+    }
+    pthread_mutex_unlock( &idleLock );
+#else
+    // Without threads, jobs run on the jobs thread which can't be waited on from here
+    CCASSERT( activeJobs == 0 );
+#endif
+}
+
+
+#ifdef CCJOBSCHEDULER_THREADS
+void* CCJobScheduler::WorkerThread(void *data)
+{
+    Worker *worker = (Worker*)data;
+    worker->scheduler->workerLoop( worker->index );
+    return NULL;
+}
+#endif
+
+
+void CCJobScheduler::workerLoop(const int workerIndex)
+{
+#ifdef CCJOBSCHEDULER_THREADS
+
+    pthread_setspecific( workerKey, &workers[workerIndex] );
+
+    while( running )
+    {
+        CCJob *job = findJob( workerIndex );
+        if( job != NULL )
+        {
+            execute( job );
+        }
+        else
+        {
+            pthread_mutex_lock( &sleepLock );
+            while( running && queuedJobs == 0 )
+            {
+                pthread_cond_wait( &sleepCondition, &sleepLock );
+            }
+            pthread_mutex_unlock( &sleepLock );
+        }
+    }
+
+#endif
+}
+
+
+void CCJobScheduler::queue(CCJob *job)
+{
+#ifdef CCJOBSCHEDULER_THREADS
+
+    if( running )
+    {
+        // Jobs spawned from a worker stay local to it, others are spread across the workers
+        int workerIndex;
+        const Worker *currentWorker = (const Worker*)pthread_getspecific( workerKey );
+        if( currentWorker != NULL )
+        {
+            workerIndex = currentWorker->index;
+        }
+        else
+        {
+            workerIndex = (int)( (uint)CCAtomicAdd( nextWorker, 1 ) % (uint)numberOfWorkers );
+        }
+
+        workers[workerIndex].deques[job->priority].pushBack( job );
+        CCAtomicAdd( queuedJobs, 1 );
+
+        pthread_mutex_lock( &sleepLock );
+        pthread_cond_signal( &sleepCondition );
+        pthread_mutex_unlock( &sleepLock );
+        return;
+    }
+
+#endif
+
+    // Without workers fall back to the engine's jobs thread
+    CCLAMBDA_2_UNSAFE( ExecuteCallback, CCJobScheduler*, scheduler, CCJob*, job,
+    {
+        scheduler->execute( job );
+    });
+
+    ExecuteCallback *callback = new ExecuteCallback( this, job );
+    if( gEngine != NULL )
+    {
+        gEngine->engineToJobsThread( callback, job->priority == job_priority_high );
+    }
+    else
+    {
+        callback->safeRun();
+        delete callback;
+    }
+}
+
+
+CCJob* CCJobScheduler::findJob(const int workerIndex)
+{
+    for( int priority=0; priority<job_priority_max; ++priority )
+    {
+        CCJob *job = workers[workerIndex].deques[priority].popBack();
+
+        // Steal from the other workers
+        for( int i=1; i<numberOfWorkers && job == NULL; ++i )
+        {
+            const int victimIndex = ( workerIndex + i ) % numberOfWorkers;
+            job = workers[victimIndex].deques[priority].popFront();
+        }
+
+        if( job != NULL )
+        {
+            CCAtomicAdd( queuedJobs, -1 );
+            return job;
+        }
+    }
+
+    return NULL;
+}
+
+
+void CCJobScheduler::execute(CCJob *job)
+{
+    CCLambdaCallback *callback = job->callback;
+    callback->safeRunOnly();
+
+    // Hand the result back to the engine thread
+    if( job->finishOnEngineThread && gEngine != NULL )
+    {
+        CCLAMBDA_1_UNSAFE( FinishCallback, CCLambdaCallback*, callback,
+        {
+            callback->safeFinishOnly();
+            delete callback;
+        });
+        gEngine->jobsToEngineThread( new FinishCallback( callback ) );
+    }
+    else
+    {
+        callback->safeFinishOnly();
+        delete callback;
+    }
+
+    // Release the jobs waiting on us
+    if( job->continuations.length > 0 )
+    {
+        CCPtrList<CCJob> readyJobs;
+
+#ifdef CCJOBSCHEDULER_THREADS
+        pthread_mutex_lock( &dependencyLock );
+#endif
+        for( int i=0; i<job->continuations.length; ++i )
+        {
+            CCJob *continuation = job->continuations.list[i];
+            continuation->pendingDependencies--;
+            if( continuation->pendingDependencies == 0 && continuation->submitted )
+            {
+                waitingJobs.remove( continuation );
+                readyJobs.add( continuation );
+            }
+        }
+#ifdef CCJOBSCHEDULER_THREADS
+        pthread_mutex_unlock( &dependencyLock );
+#endif
+
+        for( int i=0; i<readyJobs.length; ++i )
+        {
+            queue( readyJobs.list[i] );
+        }
+    }
+
+    delete job;
+
+    // Wake anyone waiting for us to go idle
+    if( CCAtomicAdd( activeJobs, -1 ) == 1 )
+    {
+#ifdef CCJOBSCHEDULER_THREADS
+        pthread_mutex_lock( &idleLock );
+        pthread_cond_broadcast( &idleCondition );
+        pthread_mutex_unlock( &idleLock );
+#endif
+    }
+}
@@ -0,0 +1,158 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCJobScheduler.h
+ * Description : Runs background jobs across a pool of work stealing worker threads.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCJOBSCHEDULER_H__
+#define __CCJOBSCHEDULER_H__
+
+
+#if !defined WP8 && !defined WIN8
+#define CCJOBSCHEDULER_THREADS
+#include <pthread.h>
+#endif
+
+
+enum CCJobPriority
+{
+    job_priority_high,
+    job_priority_normal,
+    job_priority_low,
+    job_priority_max
+};
+
+
+struct CCJob
+{
+    CCJob(CCLambdaCallback *callback, const CCJobPriority priority, const bool finishOnEngineThread)
+    {
+        this->callback = callback;
+        this->priority = priority;
+        this->finishOnEngineThread = finishOnEngineThread;
+        pendingDependencies = 0;
+        submitted = false;
+    }
+
+    // run() is called on a worker, finish() on the worker or the engine thread
+    CCLambdaCallback *callback;
+    CCJobPriority priority;
+    bool finishOnEngineThread;
+
+    // Jobs waiting on us to finish before they can run
+    CCPtrList<CCJob> continuations;
+    int pendingDependencies;
+    bool submitted;
+};
+
+
+// Double ended queue of jobs, the owning worker pops from the back and thieves steal from the front
+struct CCJobDeque
+{
+    CCJobDeque();
+    ~CCJobDeque();
+
+    void pushBack(CCJob *job);
+    CCJob* popBack();
+    CCJob* popFront();
+
+    CCJob **jobs;
+    int head, length, allocated;
+
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_t lock;
+#endif
+};
+
+
+class CCJobScheduler
+{
+public:
+    enum { max_workers = 16 };
+
+    CCJobScheduler();
+    ~CCJobScheduler();
+
+    // Number of workers to use on this device, leaving a core for the engine thread
+    static int DefaultNumberOfWorkers();
+
+    // Returns false if worker threads aren't supported, in which case jobs should be run elsewhere
+    bool start(const int numberOfWorkers);
+
+    // Joins the workers, queued jobs and jobs still waiting on their dependencies are deleted without being run
+    void stop();
+
+    bool isRunning() const { return numberOfWorkers > 0; }
+    int getNumberOfWorkers() const { return numberOfWorkers; }
+
+    // The job is owned by the scheduler once submitted
+    CCJob* createJob(CCLambdaCallback *callback, const CCJobPriority priority=job_priority_normal, const bool finishOnEngineThread=false);
+
+    // Dependencies must be added before either job is submitted
+    void addDependency(CCJob *job, CCJob *dependency);
+
+    void submit(CCJob *job);
+    void submit(CCLambdaCallback *callback, const CCJobPriority priority=job_priority_normal);
+
+    // Blocks until all submitted jobs have finished
+    void waitForIdle();
+
+    // Runs the job on the calling thread and releases its continuations
+    void execute(CCJob *job);
+
+protected:
+#ifdef CCJOBSCHEDULER_THREADS
+    static void* WorkerThread(void *data);
+#endif
+    void workerLoop(const int workerIndex);
+
+    void queue(CCJob *job);
+    CCJob* findJob(const int workerIndex);
+
+protected:
+    int numberOfWorkers;
+    bool running;
+
+    struct Worker
+    {
+        CCJobScheduler *scheduler;
+        int index;
+        CCJobDeque deques[job_priority_max];
+#ifdef CCJOBSCHEDULER_THREADS
+        pthread_t thread;
+#endif
+    };
+    Worker workers[max_workers];
+
+    // Jobs sitting in the deques, and jobs submitted but not yet finished
+    volatile int queuedJobs;
+    volatile int activeJobs;
+    volatile int nextWorker;
+
+    // Submitted jobs whose dependencies haven't finished yet
+    CCPtrList<CCJob> waitingJobs;
+
+#ifdef CCJOBSCHEDULER_THREADS
+    pthread_mutex_t sleepLock;
+    pthread_cond_t sleepCondition;
+
+    // Signalled when activeJobs drops to 0
+    pthread_mutex_t idleLock;
+    pthread_cond_t idleCondition;
+
+    // Guards job dependency bookkeeping
+    pthread_mutex_t dependencyLock;
+
+    pthread_key_t workerKey;
+#endif
+};
+
+
+#endif // __CCJOBSCHEDULER_H__
@@ -34,6 +34,12 @@ extern int CCRandomDualInt();
 extern float CCFloatRandom();
 extern float CCFloatRandomDualSided();
 extern void CCFloatSwap(float &a, float &b);
+template <typename T> inline void CCSwap(T &a, T &b)
+{
+    T temp = a;
+    a = b;
+    b = temp;
+}
 extern void CCFloatClamp(float &value, const float min, const float max);
 
 extern void CCClampInt(int &value, const int min, const int max);
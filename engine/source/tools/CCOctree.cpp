@@ -15,14 +15,16 @@
 
 static void collideablesInFrustum(const float frustum[6][4],
                                   const CCPtrList<CCCollideable> &octreeCollideables,
-                                  CCPtrList<CCCollideable> &visibleCollideables)
+                                  CCPtrList<CCCollideable> &visibleCollideables,
+                                  const int numberOfAccepted=0)
 {
     for( int i=0; i<octreeCollideables.length; ++i )
     {
         CCCollideable *collideable = octreeCollideables.list[i];
         if( collideable->isActive() && collideable->shouldRender() && collideable->octreeRender )
         {
-            if( CCCubeInFrustum( frustum, collideable->aabbMin, collideable->aabbMax ) )
+            // The first collideables come from leafs fully inside the frustum, so skip their tests
+            if( i < numberOfAccepted || CCCubeInFrustum( frustum, collideable->aabbMin, collideable->aabbMax ) )
             {
                 collideable->visible = true;
                 visibleCollideables.add( collideable );
@@ -38,8 +40,8 @@ void CCScanVisibleCollideables(const float frustum[6][4],
 {
     // Finally find all the collideables that collide with the frustum
     visibleCollideables.length = 0;
+    visibleCollideables.reserve( collideables.length );
     collideablesInFrustum( frustum, collideables, visibleCollideables );
-    CCASSERT( visibleCollideables.length < MAX_VISIBLE_COLLIDEABLES );
     LOG_NEWMAX( "Max collideables per scan", maxCollideablesPerScan, visibleCollideables.length );
 }
 
@@ -49,6 +51,14 @@ void CCRenderVisibleObjects(CCCameraBase *camera, const CCRenderPass pass, const
     CCPtrList<CCCollideable> &visibleCollideables = camera->visibleCollideables;
     const int *sortedVisibleCollideables = camera->sortedVisibleCollideables;
 
+    // Only the opaque passes are queued, text and scenes' own drawing still go down in place,
+    // which would put them in front of queued transparent models drawn after them
+    CCRenderQueue *renderQueue = alpha ? NULL : gEngine->renderQueue;
+    if( renderQueue != NULL )
+    {
+        renderQueue->begin( pass, alpha );
+    }
+
 	for( int i=0; i<visibleCollideables.length; ++i )
 	{
 		CCCollideable *object = visibleCollideables.list[sortedVisibleCollideables[i]];
@@ -65,6 +75,11 @@ void CCRenderVisibleObjects(CCCameraBase *camera, const CCRenderPass pass, const
             }
 		}
 	}
+
+    if( renderQueue != NULL )
+    {
+        renderQueue->submit();
+    }
 }
 
 
@@ -75,11 +90,114 @@ int maxCollideablesPerScan = 0;
 #endif
 
 
+// Leafs are allocated eight at a time from contiguous chunks, so siblings sit next to each other in memory
+struct CCOctreeLeafBlock
+{
+    CCOctree *leafs[8];             // Must come first, tree->leafs points here
+    CCOctree nodes[8];
+    CCOctreeLeafBlock *nextFree;
+};
+
+
+class CCOctreePool
+{
+public:
+    CCOctreePool()
+    {
+        freeBlocks = NULL;
+        blocksInUse = 0;
+    }
+
+    ~CCOctreePool()
+    {
+        for( int i=0; i<chunks.length; ++i )
+        {
+            delete[] chunks.list[i];
+        }
+        chunks.length = 0;
+    }
+
+    CCOctreeLeafBlock* allocate()
+    {
+        if( freeBlocks == NULL )
+        {
+            CCOctreeLeafBlock *chunk = new CCOctreeLeafBlock[blocks_per_chunk];
+            chunks.add( chunk );
+
+            // Push in reverse, so consecutive allocations walk forward through the chunk
+            for( int i=blocks_per_chunk-1; i>=0; --i )
+            {
+                chunk[i].nextFree = freeBlocks;
+                freeBlocks = &chunk[i];
+            }
+        }
+
+        CCOctreeLeafBlock *block = freeBlocks;
+        freeBlocks = block->nextFree;
+        block->nextFree = NULL;
+        for( uint i=0; i<8; ++i )
+        {
+            block->leafs[i] = &block->nodes[i];
+        }
+        blocksInUse++;
+        return block;
+    }
+
+    void release(CCOctreeLeafBlock *block)
+    {
+        block->nextFree = freeBlocks;
+        freeBlocks = block;
+        blocksInUse--;
+    }
+
+    static CCOctreeLeafBlock* GetBlock(CCOctree **leafs)
+    {
+        return (CCOctreeLeafBlock*)leafs;
+    }
+
+    int getBlocksInUse() const { return blocksInUse; }
+    int getBlocksAllocated() const { return chunks.length * blocks_per_chunk; }
+
+protected:
+    enum { blocks_per_chunk = 128 };
+    CCPtrList<CCOctreeLeafBlock> chunks;
+    CCOctreeLeafBlock *freeBlocks;
+    int blocksInUse;
+};
+static CCOctreePool octreePool;
+
+// Trees whose leafs may be sparse enough to merge back into them
+static CCPtrList<CCOctree> compactTrees;
+
+
+CCOctree::CCOctree()
+{
+	parent = NULL;
+	leafs = NULL;
+    compactQueued = false;
+    hSize = 0.0f;
+}
+
+
 CCOctree::CCOctree(CCOctree *inParent, const CCVector3 position, const float size)
 {
-	parent = inParent;
 	leafs = NULL;
-	objects.allocate( MAX_TREE_OBJECTS );
+    compactQueued = false;
+    setup( inParent, position, size );
+}
+
+
+void CCOctree::setup(CCOctree *inParent, const CCVector3 position, const float size)
+{
+    CCASSERT( leafs == NULL && compactQueued == false );
+	parent = inParent;
+
+    // Recycled nodes keep their object list allocation
+    objects.length = 0;
+    if( objects.list == NULL )
+    {
+        objects.allocate( MAX_TREE_OBJECTS );
+    }
 
 	hSize = size * 0.5f;
 	min = position;
@@ -91,62 +209,69 @@ CCOctree::CCOctree(CCOctree *inParent, const CCVector3 position, const float siz
 
 void CCOctreeDeleteLeafs(CCOctree *tree)
 {
-	// Ensure all our leafs are deleted
+	// Ensure all our leafs are returned
 	if( tree->leafs != NULL )
 	{
 		for( uint i=0; i<8; ++i )
 		{
-			if( tree->leafs[i] != NULL )
-			{
-				CCOctree *leaf = tree->leafs[i];
-				CCOctreeDeleteLeafs( leaf );
-			}
+            CCOctree *leaf = tree->leafs[i];
+            CCOctreeDeleteLeafs( leaf );
+
+            // Recycled leafs mustn't be left waiting to compact
+            if( leaf->compactQueued )
+            {
+                leaf->compactQueued = false;
+                compactTrees.remove( leaf );
+            }
+            leaf->objects.length = 0;
 		}
 
-		delete tree->leafs;
+		octreePool.release( CCOctreePool::GetBlock( tree->leafs ) );
 		tree->leafs = NULL;
 	}
 }
 
 
-// Create the top leafs
+void CCOctreeGetPoolStats(int *blocksInUse, int *blocksAllocated)
+{
+    *blocksInUse = octreePool.getBlocksInUse();
+    *blocksAllocated = octreePool.getBlocksAllocated();
+}
+
+
+// Setup the top leafs
 void CCOctreeSplitTopLeafs(CCOctree *tree, const uint index, CCVector3 position)
 {
 	position.y += tree->hSize;
-	CCOctree *leaf = new CCOctree( tree, position, tree->hSize );
-    tree->leafs[index+4] = leaf;
+    tree->leafs[index+4]->setup( tree, position, tree->hSize );
 }
 
 
 void CCOctreeSplit(CCOctree *tree)
 {
     CCASSERT( tree->leafs == NULL );
-	tree->leafs = (CCOctree**)malloc( sizeof( CCOctree* ) * 8 );
+	tree->leafs = octreePool.allocate()->leafs;
 
-	// Create our leaf nodes
+	// Setup our leaf nodes
 	uint index = leaf_bottom_front_left;
 	CCVector3 position = tree->min;
     position.add( tree->hSize * 0.5f );
-	CCOctree **leaf = &( tree->leafs[index] );
-	*leaf = new CCOctree( tree, position, tree->hSize );
+	tree->leafs[index]->setup( tree, position, tree->hSize );
 	CCOctreeSplitTopLeafs( tree, index, position );
 
 	index = leaf_bottom_front_right;
 	position.x += tree->hSize;
-	leaf = &( tree->leafs[index] );
-	*leaf = new CCOctree( tree, position, tree->hSize );
+	tree->leafs[index]->setup( tree, position, tree->hSize );
 	CCOctreeSplitTopLeafs( tree, index, position );
 
 	index = leaf_bottom_back_right;
 	position.z += tree->hSize;
-	leaf = &( tree->leafs[index] );
-	*leaf = new CCOctree( tree, position, tree->hSize );
+	tree->leafs[index]->setup( tree, position, tree->hSize );
 	CCOctreeSplitTopLeafs( tree, index, position );
 
 	index = leaf_bottom_back_left;
 	position.x -= tree->hSize;
-	leaf = &( tree->leafs[index] );
-	*leaf = new CCOctree( tree, position, tree->hSize );
+	tree->leafs[index]->setup( tree, position, tree->hSize );
 	CCOctreeSplitTopLeafs( tree, index, position );
 
 	// Now we need to sort our objects into our new leafs
@@ -274,32 +399,92 @@ void CCOctreeRemoveObject(CCOctree *tree, CCCollideable *collideable)
 }
 
 
+// Once a leaf has thinned out, queue its parent to see if the leafs can be merged
+static void queueCompact(const CCOctree *tree)
+{
+    CCOctree *parent = tree->parent;
+    if( parent != NULL && parent->compactQueued == false && tree->objects.length <= MAX_TREE_OBJECTS/2 )
+    {
+        parent->compactQueued = true;
+        compactTrees.add( parent );
+    }
+}
+
+
 void CCOctreeRemoveObject(CCCollideable *collideable)
 {
 	while( collideable->octrees.length > 0 )
 	{
 		CCOctree *tree = collideable->octrees.list[0];
         CCOctreeRemoveObject( tree, collideable );
-
-		if( tree->objects.length == 0 )
-		{
-			if( gEngine->collisionManager.pruneOctreeTimer <= 0.0f )
-			{
-				gEngine->collisionManager.pruneOctreeTimer = 0.5f;
-			}
-		}
+        queueCompact( tree );
 	}
 }
 
 
+// Lists the trees CCOctreeAddObject would place the range in, without modifying the octree
+static void listTargetTrees(CCOctree *tree, const CCVector3 &targetMin, const CCVector3 &targetMax, CCPtrList<CCOctree> &targets)
+{
+    // Objects outside the octree's limits live in the main tree
+    if( tree->parent == NULL && CCOctreeIsInLeaf( tree, targetMin, targetMax ) == false )
+    {
+        targets.add( tree );
+    }
+    else if( tree->leafs != NULL )
+    {
+        for( uint i=0; i<8; ++i )
+        {
+            CCOctree *leaf = tree->leafs[i];
+            if( CCOctreeIsInLeaf( leaf, targetMin, targetMax ) )
+            {
+                listTargetTrees( leaf, targetMin, targetMax, targets );
+            }
+        }
+    }
+    else
+    {
+        targets.add( tree );
+    }
+}
+
+
 void CCOctreeRefreshObject(CCCollideable *collideable)
 {
-	CCOctreeRemoveObject( collideable );
-	if( collideable->isActive() )
+	if( collideable->isActive() == false )
 	{
-		CCOctreeAddObject( gEngine->collisionManager.octree, collideable );
+        CCOctreeRemoveObject( collideable );
+        return;
 	}
 
+    CCUpdateCollisions( collideable, false );
+
+    // Find the trees we should be in now
+    static CCPtrList<CCOctree> targets;
+    targets.length = 0;
+    listTargetTrees( gEngine->collisionManager.octree, collideable->aabbMin, collideable->aabbMax, targets );
+
+    // Only leave the trees we've moved out of
+    CCPtrList<CCOctree> &octrees = collideable->octrees;
+    for( int i=octrees.length-1; i>=0; --i )
+    {
+        CCOctree *tree = octrees.list[i];
+        if( targets.find( tree ) == -1 )
+        {
+            CCOctreeRemoveObject( tree, collideable );
+            queueCompact( tree );
+        }
+    }
+
+    // And join the ones we've moved into, which may split them
+    for( int i=0; i<targets.length; ++i )
+    {
+        CCOctree *tree = targets.list[i];
+        if( octrees.find( tree ) == -1 )
+        {
+            CCOctreeAddObject( tree, collideable );
+        }
+    }
+
     //CCASSERT( collideable->numberOfOctrees > 0 );
 }
 
@@ -324,6 +509,77 @@ void CCOctreePruneTree(CCOctree *tree)
 }
 
 
+// Merges a tree's leafs back into it if they hold few enough objects between them
+static bool compactTree(CCOctree *tree)
+{
+    if( tree->leafs == NULL )
+    {
+        return false;
+    }
+
+    // Only merge leafs without leafs of their own, their parents get queued once they've merged
+    int numberOfObjects = 0;
+    for( uint i=0; i<8; ++i )
+    {
+        const CCOctree *leaf = tree->leafs[i];
+        if( leaf->leafs != NULL )
+        {
+            return false;
+        }
+        numberOfObjects += leaf->objects.length;
+    }
+
+    // Leave some headroom below the split threshold so busy trees don't split and merge every frame
+    if( numberOfObjects > MAX_TREE_OBJECTS/2 )
+    {
+        return false;
+    }
+
+    // Objects spanning several leafs should only be moved up once
+    static CCOctreeListedSet listed;
+    listed.begin();
+    for( int i=0; i<tree->objects.length; ++i )
+    {
+        listed.add( tree->objects.list[i] );
+    }
+
+    for( uint i=0; i<8; ++i )
+    {
+        CCOctree *leaf = tree->leafs[i];
+        while( leaf->objects.length > 0 )
+        {
+            CCCollideable *collideable = leaf->objects.list[leaf->objects.length-1];
+            CCOctreeRemoveObject( leaf, collideable );
+            if( listed.add( collideable ) )
+            {
+                tree->objects.add( collideable );
+                collideable->octrees.add( tree );
+            }
+        }
+    }
+
+    CCOctreeDeleteLeafs( tree );
+    return true;
+}
+
+
+void CCOctreeCompactTrees(const int maxTrees)
+{
+    for( int i=0; i<maxTrees && compactTrees.length > 0; ++i )
+    {
+        CCOctree *tree = compactTrees.list[compactTrees.length-1];
+        compactTrees.length--;
+        tree->compactQueued = false;
+
+        if( compactTree( tree ) )
+        {
+            // Now we're a leaf, our parent might be able to absorb us too
+            queueCompact( tree );
+        }
+    }
+}
+
+
 bool CCOctreeIsInLeaf(const CCOctree *leaf, const CCVector3 &targetMin, const CCVector3 &targetMax)
 {
 	const CCVector3 *sourceMin = &leaf->min;
@@ -397,60 +653,90 @@ void CCOctreeRender(CCOctree *tree)
 }
 
 
-void CCOctreeListVisibles(CCPtrList<CCOctree> &leafs, CCPtrList<CCCollideable> &collideables)
+void CCOctreeListVisibles(const CCPtrList<CCOctree> &leafs, CCPtrList<CCCollideable> &collideables, CCOctreeListedSet &listed)
 {
 	for( int leafIndex=0; leafIndex<leafs.length; ++leafIndex )
 	{
 		const CCOctree *leaf = leafs.list[leafIndex];
+        collideables.reserve( collideables.length + leaf->objects.length );
 		for( int i=0; i<leaf->objects.length; ++i )
 		{
 			CCCollideable *collideable = leaf->objects.list[i];
-
-            bool found = false;
-            for( int collideablesIndex=0; collideablesIndex<collideables.length; ++collideablesIndex )
+            if( listed.add( collideable ) )
             {
-                if( collideables.list[collideablesIndex] == collideable )
-                {
-                    found = true;
-                    break;
-                }
-            }
-
-            if( found == false )
-            {
-                collideables.list[collideables.length++] = collideable;
+                collideables.add( collideable );
             }
 		}
 	}
 }
 
 
-inline void fillLeafsInFrustum(const float frustum[6][4], CCOctree *tree, CCPtrList<CCOctree> &leafs)
+static CCOctreeScanStats scanStats;
+
+
+// Adds every leaf under the tree without testing them
+static void fillAllLeafs(CCOctree *tree, CCPtrList<CCOctree> &leafs)
 {
+    scanStats.nodesVisited++;
+
     if( tree->leafs != NULL )
     {
         for( uint i=0; i<8; ++i )
         {
-            fillLeafsInFrustum( frustum, tree->leafs[i], leafs );
+            fillAllLeafs( tree->leafs[i], leafs );
         }
     }
     else
     {
-        bool found = false;
-        for( int i=0; i<leafs.length; ++i )
+        leafs.add( tree );
+    }
+}
+
+
+// Skips the subtrees outside the frustum, and accepts the subtrees inside it without any more plane tests
+static void fillLeafsInFrustum(const float frustum[6][4], CCOctree *tree, uint planeMask,
+                               CCPtrList<CCOctree> &insideLeafs, CCPtrList<CCOctree> &intersectingLeafs)
+{
+    scanStats.nodesVisited++;
+
+    const uint result = CCCubeInFrustum( frustum, tree->min, tree->max, planeMask );
+    if( result == 0 )
+    {
+        return;
+    }
+
+    if( result == 2 )
+    {
+        scanStats.nodesAccepted++;
+        if( tree->leafs != NULL )
         {
-            if( leafs.list[i] == tree )
+            for( uint i=0; i<8; ++i )
             {
-                found = true;
-                break;
+                fillAllLeafs( tree->leafs[i], insideLeafs );
             }
         }
-
-        if( found == false && CCCubeInFrustum( frustum, tree->min, tree->max ) )
+        else
         {
-            leafs.list[leafs.length++] = tree;
+            insideLeafs.add( tree );
         }
     }
+    else if( tree->leafs != NULL )
+    {
+        for( uint i=0; i<8; ++i )
+        {
+            fillLeafsInFrustum( frustum, tree->leafs[i], planeMask, insideLeafs, intersectingLeafs );
+        }
+    }
+    else
+    {
+        intersectingLeafs.add( tree );
+    }
+}
+
+
+const CCOctreeScanStats& CCOctreeGetScanStats()
+{
+    return scanStats;
 }
 
 
@@ -463,32 +749,41 @@ CCCollideable* CCOctreeGetVisibleCollideables(const int i)
 void CCOctreeScanVisibleCollideables(const float frustum[6][4],
                                      CCPtrList<CCCollideable> &visibleCollideables)
 {
-#define MAX_LEAFS 768
-    static CCPtrList<CCOctree> leafs( MAX_LEAFS );
+    // Grown as needed, and kept around between scans
+    static CCPtrList<CCOctree> insideLeafs;
+    static CCPtrList<CCOctree> intersectingLeafs;
     static CCPtrList<CCCollideable> octreeCollideables( MAX_VISIBLE_COLLIDEABLES );
+    static CCOctreeListedSet listed( MAX_VISIBLE_COLLIDEABLES );
 
     // First find all the octrees that collide with the frustum
-    leafs.length = 0;
-    fillLeafsInFrustum( frustum, gEngine->collisionManager.octree, leafs );
-    CCASSERT( leafs.length < MAX_LEAFS );
-    LOG_NEWMAX( "Max leafs per scan", maxLeafsPerScan, leafs.length );
-
-    // Then list all the objects from the octrees
+    scanStats.nodesVisited = 0;
+    scanStats.nodesAccepted = 0;
+    insideLeafs.length = 0;
+    intersectingLeafs.length = 0;
+    fillLeafsInFrustum( frustum, gEngine->collisionManager.octree, ( 1 << frustum_max ) - 1, insideLeafs, intersectingLeafs );
+    scanStats.leafsInside = insideLeafs.length;
+    scanStats.leafsIntersecting = intersectingLeafs.length;
+    LOG_NEWMAX( "Max leafs per scan", maxLeafsPerScan, insideLeafs.length + intersectingLeafs.length );
+
+    // Then list all the objects from the octrees, starting with the ones we don't need to test
+    listed.begin();
     octreeCollideables.length = 0;
-    CCOctreeListVisibles( leafs, octreeCollideables );
-    CCASSERT( octreeCollideables.length < MAX_VISIBLE_COLLIDEABLES );
+    CCOctreeListVisibles( insideLeafs, octreeCollideables, listed );
+    const int numberOfAccepted = octreeCollideables.length;
+    CCOctreeListVisibles( intersectingLeafs, octreeCollideables, listed );
 
     // Finally find all the collideables that collide with the frustum
     visibleCollideables.length = 0;
-    collideablesInFrustum( frustum, octreeCollideables, visibleCollideables );
-    CCASSERT( visibleCollideables.length < MAX_VISIBLE_COLLIDEABLES );
+    visibleCollideables.reserve( octreeCollideables.length );
+    collideablesInFrustum( frustum, octreeCollideables, visibleCollideables, numberOfAccepted );
     LOG_NEWMAX( "Max collideables per scan", maxCollideablesPerScan, visibleCollideables.length );
 }
 
 
-// Used by CollisionTools
-void CCOctreeListCollideables(CCCollideable **collideables, int *numberOfCollideables, const CCOctree **leafs, const int numberOfLeafs)
+void CCOctreeListCollideables(CCCollideable **collideables, int *numberOfCollideables, const int maxCollideables,
+                              const CCOctree **leafs, const int numberOfLeafs, CCOctreeListedSet &listed)
 {
+    listed.begin();
 	for( int leafIndex=0; leafIndex<numberOfLeafs; ++leafIndex )
 	{
 		const CCOctree *leaf = leafs[leafIndex];
@@ -500,18 +795,13 @@ void CCOctreeListCollideables(CCCollideable **collideables, int *numberOfCollide
 			{
 				if( CCHasFlag( collideable->collideableType, collision_none ) == false )
 				{
-					bool found = false;
-					for( int collideablesIndex=0; collideablesIndex<*numberOfCollideables; ++collideablesIndex )
-					{
-						if( collideables[collideablesIndex] == collideable )
-						{
-							found = true;
-							break;
-						}
-					}
-
-					if( found == false )
+					if( listed.add( collideable ) )
 					{
+                        CCASSERT( *numberOfCollideables < maxCollideables );
+                        if( *numberOfCollideables == maxCollideables )
+                        {
+                            return;
+                        }
 						collideables[(*numberOfCollideables)++] = collideable;
 					}
 				}
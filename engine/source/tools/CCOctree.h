@@ -16,6 +16,7 @@
 
 
 #define MAX_TREE_OBJECTS 64
+#define MAX_OCTREE_COMPACTS_PER_FRAME 32
 
 #ifdef DEBUGON
 extern int maxOctreesPerObject;
@@ -45,10 +46,16 @@ struct CCOctree
 	float hSize;
 	CCVector3 min, max;
 
+    // Waiting for CCOctreeCompactTrees to see if our leafs can merge back into us
+    bool compactQueued;
+
+    // Leafs come eight at a time from a pool, so they're default constructed then setup
+	CCOctree();
 	CCOctree(CCOctree *inParent, const CCVector3 position, const float size);
+    void setup(CCOctree *inParent, const CCVector3 position, const float size);
 };
 
-// Delete the octree and all it's leafs
+// Return the octree's leafs to the pool
 extern void CCOctreeDeleteLeafs(CCOctree *tree);
 
 // Add an object into the octree and create leafs if necessary
@@ -58,12 +65,18 @@ extern void CCOctreeAddObject(CCOctree *tree, CCCollideable *collideable);
 extern void CCOctreeRemoveObject(CCOctree *tree, CCCollideable *collideable);
 extern void CCOctreeRemoveObject(CCCollideable *collideable);
 
-// Remove and add octree
+// Only moves the object between the trees its bounds have left or entered
 extern void CCOctreeRefreshObject(CCCollideable *collideable);
 
 // Remove unused leafs
 extern void CCOctreePruneTree(CCOctree *tree);
 
+// Merge sparse leafs back into their parents, checking at most maxTrees queued trees per call
+extern void CCOctreeCompactTrees(const int maxTrees);
+
+// Number of leaf blocks handed out by the pool, and how many it has allocated
+extern void CCOctreeGetPoolStats(int *blocksInUse, int *blocksAllocated);
+
 // See if the range is in the tree
 extern bool CCOctreeIsInLeaf(const CCOctree *leaf, const CCVector3 &targetMin, const CCVector3 &targetMax);
 
@@ -73,13 +86,34 @@ extern bool CCOctreeHasObjects(CCOctree *tree);
 // Traverse the tree and find the leafs nodes, from the bottom up so we don't end up with all the leafs
 extern void CCOctreeListLeafs(const CCOctree *tree, const CCVector3 &targetMin, const CCVector3 &targetMax, const CCOctree **leafsList, int *numberOfLeafs);
 
-// List all the collideables in the tree
-extern void CCOctreeListCollideables(CCCollideable **collideables, int *numberOfCollideables, const CCOctree **leafs, const int numberOfLeafs);
-extern void CCOctreeListVisibles(CCPtrList<CCOctree> &leafs, CCPtrList<CCCollideable> &collideables);
+// List all the collideables in the leafs, up to maxCollideables, starts a new query in the listed set
+extern void CCOctreeListCollideables(CCCollideable **collideables, int *numberOfCollideables, const int maxCollideables,
+                                     const CCOctree **leafs, const int numberOfLeafs, CCOctreeListedSet &listed);
+
+// Adds the collideables not yet listed by the set's current query
+extern void CCOctreeListVisibles(const CCPtrList<CCOctree> &leafs, CCPtrList<CCCollideable> &collideables, CCOctreeListedSet &listed);
 
 // Render the octrees
 extern void CCOctreeRender(CCOctree *tree);
 
+// Work done by the last CCOctreeScanVisibleCollideables
+struct CCOctreeScanStats
+{
+    CCOctreeScanStats()
+    {
+        nodesVisited = 0;
+        nodesAccepted = 0;
+        leafsInside = 0;
+        leafsIntersecting = 0;
+    }
+
+    int nodesVisited;
+    int nodesAccepted;          // Nodes fully inside the frustum
+    int leafsInside;
+    int leafsIntersecting;
+};
+extern const CCOctreeScanStats& CCOctreeGetScanStats();
+
 // Render the objects in the trees
 extern CCCollideable* CCOctreeGetVisibleCollideables(const int i);
 extern void CCOctreeScanVisibleCollideables(const float frustum[6][4],
@@ -0,0 +1,137 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCRadixSort.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCRadixSort.h"
+
+
+CCRadixSort::CCRadixSort()
+{
+    scratchKeys = NULL;
+    scratchValues = NULL;
+    allocated = 0;
+    numberOfPasses = 0;
+}
+
+
+CCRadixSort::~CCRadixSort()
+{
+    FREE_POINTER( scratchKeys );
+    FREE_POINTER( scratchValues );
+}
+
+
+void CCRadixSort::sort(CCSortKey *keys, int *values, const int count)
+{
+    numberOfPasses = 0;
+    if( count < 2 )
+    {
+        return;
+    }
+
+    reserve( count );
+
+    // Count every byte in one read of the keys
+    static const int numberOfBytes = sizeof( CCSortKey );
+    int counts[numberOfBytes][256];
+    memset( counts, 0, sizeof( counts ) );
+    for( int i=0; i<count; ++i )
+    {
+        CCSortKey key = keys[i];
+        for( int byte=0; byte<numberOfBytes; ++byte )
+        {
+            counts[byte][key & 0xff]++;
+            key >>= 8;
+        }
+    }
+
+    CCSortKey *sourceKeys = keys, *destinationKeys = scratchKeys;
+    int *sourceValues = values, *destinationValues = scratchValues;
+    for( int byte=0; byte<numberOfBytes; ++byte )
+    {
+        // Every key has the same value here, so this pass wouldn't move anything
+        int *byteCounts = counts[byte];
+        const int shift = byte * 8;
+        if( byteCounts[( keys[0] >> shift ) & 0xff] == count )
+        {
+            continue;
+        }
+
+        int offset = 0;
+        for( int i=0; i<256; ++i )
+        {
+            const int bucketCount = byteCounts[i];
+            byteCounts[i] = offset;
+            offset += bucketCount;
+        }
+
+        for( int i=0; i<count; ++i )
+        {
+            const CCSortKey key = sourceKeys[i];
+            const int destination = byteCounts[( key >> shift ) & 0xff]++;
+            destinationKeys[destination] = key;
+            destinationValues[destination] = sourceValues[i];
+        }
+
+        CCSortKey *keysSorted = destinationKeys;
+        destinationKeys = sourceKeys;
+        sourceKeys = keysSorted;
+
+        int *valuesSorted = destinationValues;
+        destinationValues = sourceValues;
+        sourceValues = valuesSorted;
+        numberOfPasses++;
+    }
+
+    if( sourceKeys != keys )
+    {
+        memcpy( keys, sourceKeys, sizeof( CCSortKey ) * count );
+        memcpy( values, sourceValues, sizeof( int ) * count );
+    }
+}
+
+
+bool CCRadixSort::InsertionSort(int *values, const CCSortKey *keys, const int count, const int maxMoves)
+{
+    int moves = 0;
+    for( int i=1; i<count; ++i )
+    {
+        const int value = values[i];
+        const CCSortKey key = keys[value];
+
+        int j = i;
+        while( j > 0 && keys[values[j-1]] > key )
+        {
+            values[j] = values[j-1];
+            j--;
+            moves++;
+        }
+        values[j] = value;
+
+        if( moves > maxMoves )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void CCRadixSort::reserve(const int count)
+{
+    if( count > allocated )
+    {
+        allocated = MAX( count, allocated * 2 );
+        FREE_POINTER( scratchKeys );
+        FREE_POINTER( scratchValues );
+        scratchKeys = (CCSortKey*)malloc( sizeof( CCSortKey ) * allocated );
+        scratchValues = (int*)malloc( sizeof( int ) * allocated );
+        CCASSERT( scratchKeys != NULL && scratchValues != NULL );
+    }
+}
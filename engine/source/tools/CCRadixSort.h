@@ -0,0 +1,58 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCRadixSort.h
+ * Description : Sorts values by 64 bit keys, least significant byte first.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCRADIXSORT_H__
+#define __CCRADIXSORT_H__
+
+
+typedef unsigned long long CCSortKey;
+
+// Non-negative floats order the same way as their bits, so they pack into keys without losing precision
+static inline uint CCSortKeyFromFloat(const float value)
+{
+    union { float f; uint u; } bits;
+    bits.f = value > 0.0f ? value : 0.0f;
+    return bits.u;
+}
+
+
+// Keeps its scratch buffers between sorts, so sorting every frame doesn't allocate
+class CCRadixSort
+{
+public:
+    CCRadixSort();
+    ~CCRadixSort();
+
+    // Stable, smallest key first, keys and values are reordered together
+    void sort(CCSortKey *keys, int *values, const int count);
+
+    // Sorts values, which index keys, when they're expected to already be close to in order
+    // Returns false after maxMoves, leaving values reordered but not sorted
+    static bool InsertionSort(int *values, const CCSortKey *keys, const int count, const int maxMoves);
+
+    int getNumberOfPasses() const { return numberOfPasses; }
+
+protected:
+    void reserve(const int count);
+
+protected:
+    CCSortKey *scratchKeys;
+    int *scratchValues;
+    int allocated;
+
+    // Passes made by the last sort, bytes shared by every key are skipped
+    int numberOfPasses;
+};
+
+
+#endif // __CCRADIXSORT_H__
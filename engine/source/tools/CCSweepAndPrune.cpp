@@ -0,0 +1,376 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCSweepAndPrune.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCObjects.h"
+#include "CCSweepAndPrune.h"
+
+
+// Touching ranges overlap, as with CCBasicBoxCollisionCheck, so mins sort before maxes of the same value
+static inline bool EndpointLess(const float value, const bool isMax, const float otherValue, const bool otherIsMax)
+{
+    return value < otherValue || ( value == otherValue && isMax == false && otherIsMax );
+}
+
+
+CCSweepAndPrune::CCSweepAndPrune()
+{
+    entries = NULL;
+    numberOfEntries = 0;
+    allocatedEntries = 0;
+
+    endpointsX = NULL;
+    endpointsZ = NULL;
+    active = NULL;
+
+    pairs = NULL;
+    numberOfPairs = 0;
+    allocatedPairs = 0;
+
+    candidates = NULL;
+    allocatedCandidates = 0;
+
+    numberOfSwaps = 0;
+}
+
+
+CCSweepAndPrune::~CCSweepAndPrune()
+{
+    for( int i=0; i<numberOfEntries; ++i )
+    {
+        entries[i].collideable->broadphaseIndex = -1;
+    }
+
+    if( entries != NULL )
+    {
+        delete[] entries;
+        entries = NULL;
+    }
+    FREE_POINTER( endpointsX );
+    FREE_POINTER( endpointsZ );
+    FREE_POINTER( active );
+    FREE_POINTER( pairs );
+    FREE_POINTER( candidates );
+}
+
+
+void CCSweepAndPrune::add(CCCollideable *collideable)
+{
+    CCASSERT( collideable->broadphaseIndex == -1 );
+
+    if( numberOfEntries == allocatedEntries )
+    {
+        allocatedEntries = allocatedEntries > 0 ? allocatedEntries * 2 : 256;
+
+        // Entries hold vectors, which can't be moved with realloc
+        Entry *grown = new Entry[allocatedEntries];
+        for( int i=0; i<numberOfEntries; ++i )
+        {
+            grown[i] = entries[i];
+        }
+        delete[] entries;
+        entries = grown;
+
+        endpointsX = (Endpoint*)realloc( endpointsX, sizeof( Endpoint ) * allocatedEntries * 2 );
+        endpointsZ = (Endpoint*)realloc( endpointsZ, sizeof( Endpoint ) * allocatedEntries * 2 );
+        active = (int*)realloc( active, sizeof( int ) * allocatedEntries );
+        CCASSERT( endpointsX != NULL && endpointsZ != NULL && active != NULL );
+    }
+
+    const int index = numberOfEntries++;
+    collideable->broadphaseIndex = index;
+
+    // Stays empty until the next update, so the collideable falls back to the octree until then
+    Entry &entry = entries[index];
+    entry.collideable = collideable;
+    entry.min = MAXFLOAT;
+    entry.max = MAXFLOAT;
+    entry.moveable = false;
+    entry.firstCandidate = 0;
+    entry.numberOfCandidates = 0;
+
+    // Empty entries sort to the end
+    for( int i=0; i<2; ++i )
+    {
+        Endpoint &endpointX = endpointsX[index*2+i];
+        endpointX.value = MAXFLOAT;
+        endpointX.entry = index;
+        endpointX.isMax = i == 1;
+        endpointsZ[index*2+i] = endpointX;
+    }
+}
+
+
+void CCSweepAndPrune::remove(CCCollideable *collideable)
+{
+    const int index = collideable->broadphaseIndex;
+    if( index == -1 )
+    {
+        return;
+    }
+
+    // Make sure nobody is handed a deleted candidate before the next update
+    for( int i=0; i<numberOfPairs*2; ++i )
+    {
+        if( candidates[i] == collideable )
+        {
+            candidates[i] = NULL;
+        }
+    }
+
+    // The last entry takes our place
+    const int last = numberOfEntries-1;
+    removeEndpoints( endpointsX, index, last );
+    removeEndpoints( endpointsZ, index, last );
+    if( index != last )
+    {
+        entries[index] = entries[last];
+        entries[index].collideable->broadphaseIndex = index;
+    }
+
+    numberOfEntries--;
+    collideable->broadphaseIndex = -1;
+}
+
+
+void CCSweepAndPrune::update(const float delta)
+{
+    for( int i=0; i<numberOfEntries; ++i )
+    {
+        Entry &entry = entries[i];
+        CCCollideable *collideable = entry.collideable;
+        if( collideable->isActive() && collideable->isCollideable() && CCHasFlag( collideable->collideableType, collision_box ) )
+        {
+            CCUpdateCollisions( collideable, false );
+            const float margin = collideable->getBroadphaseMargin( delta );
+            entry.min = collideable->aabbMin;
+            entry.min.sub( margin );
+            entry.max = collideable->aabbMax;
+            entry.max.add( margin );
+            entry.moveable = collideable->isMoveable();
+        }
+        else
+        {
+            entry.min = MAXFLOAT;
+            entry.max = MAXFLOAT;
+            entry.moveable = false;
+        }
+    }
+
+    numberOfSwaps = 0;
+    setEndpointValues( endpointsX, 0 );
+    insertionSort( endpointsX );
+    setEndpointValues( endpointsZ, 2 );
+    insertionSort( endpointsZ );
+
+    // Sweep along whichever axis the world is spread out on most, ignoring the empty entries at the end
+    numberOfPairs = 0;
+    if( numberOfEntries > 0 )
+    {
+        const int numberOfEndpoints = numberOfEntries*2;
+        float extentX = 0.0f, extentZ = 0.0f;
+        for( int i=numberOfEndpoints-1; i>=0; --i )
+        {
+            if( endpointsX[i].value != MAXFLOAT )
+            {
+                extentX = endpointsX[i].value - endpointsX[0].value;
+                extentZ = endpointsZ[i].value - endpointsZ[0].value;
+                break;
+            }
+        }
+
+        if( extentX >= extentZ )
+        {
+            sweep( endpointsX, 0 );
+        }
+        else
+        {
+            sweep( endpointsZ, 2 );
+        }
+    }
+
+    buildCandidates();
+}
+
+
+bool CCSweepAndPrune::getCandidates(const CCCollideable *collideable, const CCVector3 &sweptMin, const CCVector3 &sweptMax,
+                                    CCCollideable * const *&candidates, int &numberOfCandidates) const
+{
+    const int index = collideable->broadphaseIndex;
+    if( index == -1 )
+    {
+        return false;
+    }
+
+    const Entry &entry = entries[index];
+    if( sweptMin.x < entry.min.x || sweptMin.y < entry.min.y || sweptMin.z < entry.min.z ||
+        sweptMax.x > entry.max.x || sweptMax.y > entry.max.y || sweptMax.z > entry.max.z )
+    {
+        return false;
+    }
+
+    candidates = this->candidates + entry.firstCandidate;
+    numberOfCandidates = entry.numberOfCandidates;
+    return true;
+}
+
+
+void CCSweepAndPrune::setEndpointValues(Endpoint *endpoints, const int axis)
+{
+    const int numberOfEndpoints = numberOfEntries*2;
+    for( int i=0; i<numberOfEndpoints; ++i )
+    {
+        Endpoint &endpoint = endpoints[i];
+        const Entry &entry = entries[endpoint.entry];
+        endpoint.value = endpoint.isMax ? (&entry.max.x)[axis] : (&entry.min.x)[axis];
+    }
+}
+
+
+void CCSweepAndPrune::insertionSort(Endpoint *endpoints)
+{
+    // Objects only move a little each frame, so this is close to linear
+    const int numberOfEndpoints = numberOfEntries*2;
+    for( int i=1; i<numberOfEndpoints; ++i )
+    {
+        const Endpoint endpoint = endpoints[i];
+        int j = i-1;
+        while( j >= 0 && EndpointLess( endpoint.value, endpoint.isMax, endpoints[j].value, endpoints[j].isMax ) )
+        {
+            endpoints[j+1] = endpoints[j];
+            j--;
+            numberOfSwaps++;
+        }
+        endpoints[j+1] = endpoint;
+    }
+}
+
+
+void CCSweepAndPrune::removeEndpoints(Endpoint *endpoints, const int entry, const int movedEntry)
+{
+    const int numberOfEndpoints = numberOfEntries*2;
+    int length = 0;
+    for( int i=0; i<numberOfEndpoints; ++i )
+    {
+        Endpoint &endpoint = endpoints[i];
+        if( endpoint.entry != entry )
+        {
+            if( endpoint.entry == movedEntry )
+            {
+                endpoint.entry = entry;
+            }
+            endpoints[length++] = endpoint;
+        }
+    }
+}
+
+
+void CCSweepAndPrune::sweep(const Endpoint *endpoints, const int axis)
+{
+    // The other horizontal axis, y is always checked
+    const int otherAxis = axis == 0 ? 2 : 0;
+
+    int numberOfActive = 0;
+    const int numberOfEndpoints = numberOfEntries*2;
+    for( int i=0; i<numberOfEndpoints; ++i )
+    {
+        const Endpoint &endpoint = endpoints[i];
+        if( endpoint.value == MAXFLOAT )
+        {
+            break;
+        }
+
+        if( endpoint.isMax )
+        {
+            for( int j=0; j<numberOfActive; ++j )
+            {
+                if( active[j] == endpoint.entry )
+                {
+                    active[j] = active[--numberOfActive];
+                    break;
+                }
+            }
+        }
+        else
+        {
+            const Entry &entry = entries[endpoint.entry];
+            const float entryMin = (&entry.min.x)[otherAxis];
+            const float entryMax = (&entry.max.x)[otherAxis];
+            for( int j=0; j<numberOfActive; ++j )
+            {
+                const Entry &other = entries[active[j]];
+
+                // Static objects don't need to know about each other
+                if( entry.moveable || other.moveable )
+                {
+                    if( entryMax >= (&other.min.x)[otherAxis] && entryMin <= (&other.max.x)[otherAxis] &&
+                        entry.max.y >= other.min.y && entry.min.y <= other.max.y )
+                    {
+                        addPair( endpoint.entry, active[j] );
+                    }
+                }
+            }
+            active[numberOfActive++] = endpoint.entry;
+        }
+    }
+}
+
+
+void CCSweepAndPrune::addPair(const int a, const int b)
+{
+    if( numberOfPairs == allocatedPairs )
+    {
+        allocatedPairs = allocatedPairs > 0 ? allocatedPairs * 2 : 1024;
+        pairs = (int*)realloc( pairs, sizeof( int ) * allocatedPairs * 2 );
+        CCASSERT( pairs != NULL );
+    }
+
+    pairs[numberOfPairs*2] = a;
+    pairs[numberOfPairs*2+1] = b;
+    numberOfPairs++;
+}
+
+
+void CCSweepAndPrune::buildCandidates()
+{
+    for( int i=0; i<numberOfEntries; ++i )
+    {
+        entries[i].numberOfCandidates = 0;
+    }
+
+    for( int i=0; i<numberOfPairs*2; ++i )
+    {
+        entries[pairs[i]].numberOfCandidates++;
+    }
+
+    int firstCandidate = 0;
+    for( int i=0; i<numberOfEntries; ++i )
+    {
+        Entry &entry = entries[i];
+        entry.firstCandidate = firstCandidate;
+        firstCandidate += entry.numberOfCandidates;
+        entry.numberOfCandidates = 0;
+    }
+
+    if( firstCandidate > allocatedCandidates )
+    {
+        allocatedCandidates = MAX( firstCandidate, allocatedCandidates * 2 );
+        FREE_POINTER( candidates );
+        candidates = (CCCollideable**)malloc( sizeof( CCCollideable* ) * allocatedCandidates );
+        CCASSERT( candidates != NULL );
+    }
+
+    for( int i=0; i<numberOfPairs; ++i )
+    {
+        Entry &a = entries[pairs[i*2]];
+        Entry &b = entries[pairs[i*2+1]];
+        candidates[a.firstCandidate + a.numberOfCandidates++] = b.collideable;
+        candidates[b.firstCandidate + b.numberOfCandidates++] = a.collideable;
+    }
+}
@@ -0,0 +1,88 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCSweepAndPrune.h
+ * Description : Persistent sweep and prune broadphase producing candidate pairs for moveables.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCSWEEPANDPRUNE_H__
+#define __CCSWEEPANDPRUNE_H__
+
+
+class CCSweepAndPrune
+{
+public:
+    CCSweepAndPrune();
+    ~CCSweepAndPrune();
+
+    void add(CCCollideable *collideable);
+    void remove(CCCollideable *collideable);
+
+    // Fattens everyone's bounds by how far they could move this frame, insertion sorts the
+    // endpoints, which are nearly sorted from last frame, and lists the candidate pairs
+    void update(const float delta);
+
+    // Lists the candidates found for the collideable this frame, returns false if the
+    // swept range leaves its fattened bounds, in which case the octree should be queried instead
+    bool getCandidates(const CCCollideable *collideable, const CCVector3 &sweptMin, const CCVector3 &sweptMax,
+                       CCCollideable * const *&candidates, int &numberOfCandidates) const;
+
+    int getNumberOfEntries() const { return numberOfEntries; }
+    int getNumberOfPairs() const { return numberOfPairs; }
+    int getNumberOfSwaps() const { return numberOfSwaps; }
+
+protected:
+    struct Entry
+    {
+        CCCollideable *collideable;
+        CCVector3 min, max;
+        bool moveable;
+
+        int firstCandidate;
+        int numberOfCandidates;
+    };
+
+    struct Endpoint
+    {
+        float value;
+        int entry;
+        bool isMax;
+    };
+
+    void setEndpointValues(Endpoint *endpoints, const int axis);
+    void insertionSort(Endpoint *endpoints);
+    void removeEndpoints(Endpoint *endpoints, const int entry, const int movedEntry);
+
+    void sweep(const Endpoint *endpoints, const int axis);
+    void addPair(const int a, const int b);
+    void buildCandidates();
+
+protected:
+    Entry *entries;
+    int numberOfEntries, allocatedEntries;
+
+    // Two endpoints for each entry, kept sorted along x and z
+    Endpoint *endpointsX, *endpointsZ;
+
+    // Entries overlapping along the sweep axis
+    int *active;
+
+    // Pairs stored as entry indices side by side
+    int *pairs;
+    int numberOfPairs, allocatedPairs;
+
+    // Each entry's candidates sit together, indexed by Entry::firstCandidate
+    CCCollideable **candidates;
+    int allocatedCandidates;
+
+    int numberOfSwaps;
+};
+
+
+#endif // __CCSWEEPANDPRUNE_H__
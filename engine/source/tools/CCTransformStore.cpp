@@ -0,0 +1,414 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTransformStore.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTransformStore.h"
+
+
+// The arrays hold vectors and matrices, which can't be moved with realloc or memcpy,
+// so they're all new[] arrays copied an entry at a time
+template <typename T>
+static void Resize(T *&array, const int count, const int allocated)
+{
+    T *resized = new T[allocated];
+    for( int i=0; i<count; ++i )
+    {
+        resized[i] = array[i];
+    }
+    delete[] array;
+    array = resized;
+}
+
+
+// Reorders an array so entry i comes from order[i]
+template <typename T>
+static void Permute(T *&array, const int *order, const int count, const int allocated)
+{
+    T *sorted = new T[allocated];
+    for( int i=0; i<count; ++i )
+    {
+        sorted[i] = array[order[i]];
+    }
+    delete[] array;
+    array = sorted;
+}
+
+
+template <typename T>
+static void DeleteArray(T *&array)
+{
+    delete[] array;
+    array = NULL;
+}
+
+
+
+CCTransformStore::CCTransformStore()
+{
+    positions = NULL;
+    rotations = NULL;
+    scales = NULL;
+    locals = NULL;
+    worlds = NULL;
+    parents = NULL;
+    numberOfChildren = NULL;
+    flags = NULL;
+    owners = NULL;
+    order = NULL;
+
+    numberOfTransforms = 0;
+    allocatedTransforms = 0;
+
+    unordered = false;
+    numberOfUpdated = 0;
+}
+
+
+CCTransformStore::~CCTransformStore()
+{
+    // Hand our renderables back to building their own matrices
+    for( int i=0; i<numberOfTransforms; ++i )
+    {
+        CCRenderable *owner = owners[i];
+        if( owner != NULL )
+        {
+            owner->transformIndex = -1;
+            owner->dirtyModelMatrix();
+        }
+    }
+
+    DeleteArray( positions );
+    DeleteArray( rotations );
+    DeleteArray( scales );
+    DeleteArray( locals );
+    DeleteArray( worlds );
+    DeleteArray( parents );
+    DeleteArray( numberOfChildren );
+    DeleteArray( flags );
+    DeleteArray( owners );
+    DeleteArray( order );
+}
+
+
+int CCTransformStore::add(CCRenderable *owner, const int parent)
+{
+    CCASSERT( parent < numberOfTransforms );
+
+    if( numberOfTransforms == allocatedTransforms )
+    {
+        reserve( allocatedTransforms > 0 ? allocatedTransforms * 2 : 256 );
+    }
+
+    const int index = numberOfTransforms++;
+    positions[index] = CCVector3();
+    rotations[index] = CCQuaternion();
+    scales[index] = CCVector3( 1.0f );
+    CCMatrixLoadIdentity( locals[index] );
+    CCMatrixLoadIdentity( worlds[index] );
+    parents[index] = parent;
+    numberOfChildren[index] = 0;
+    flags[index] = transform_dirtyLocal;
+    owners[index] = owner;
+
+    if( parent != -1 )
+    {
+        numberOfChildren[parent]++;
+    }
+
+    if( owner != NULL )
+    {
+        owner->transformIndex = index;
+    }
+
+    return index;
+}
+
+
+void CCTransformStore::remove(const int index)
+{
+    CCASSERT( index >= 0 && index < numberOfTransforms );
+
+    if( numberOfChildren[index] > 0 )
+    {
+        for( int i=0; i<numberOfTransforms; ++i )
+        {
+            if( parents[i] == index )
+            {
+                parents[i] = -1;
+                flags[i] |= transform_dirtyWorld;
+            }
+        }
+    }
+
+    if( parents[index] != -1 )
+    {
+        numberOfChildren[parents[index]]--;
+    }
+
+    if( owners[index] != NULL )
+    {
+        owners[index]->transformIndex = -1;
+    }
+
+    // The last transform takes our place, while ordered it can't have any children
+    const int last = numberOfTransforms-1;
+    if( index != last )
+    {
+        if( numberOfChildren[last] > 0 )
+        {
+            for( int i=0; i<numberOfTransforms; ++i )
+            {
+                if( parents[i] == last )
+                {
+                    parents[i] = index;
+                }
+            }
+            unordered = true;
+        }
+
+        positions[index] = positions[last];
+        rotations[index] = rotations[last];
+        scales[index] = scales[last];
+        locals[index] = locals[last];
+        worlds[index] = worlds[last];
+        parents[index] = parents[last];
+        numberOfChildren[index] = numberOfChildren[last];
+        flags[index] = flags[last];
+        owners[index] = owners[last];
+
+        if( owners[index] != NULL )
+        {
+            owners[index]->transformIndex = index;
+        }
+
+        if( parents[index] > index )
+        {
+            unordered = true;
+        }
+    }
+
+    numberOfTransforms--;
+}
+
+
+void CCTransformStore::setParent(const int index, const int parent)
+{
+    CCASSERT( index >= 0 && index < numberOfTransforms && parent < numberOfTransforms && parent != index );
+
+    if( parents[index] != -1 )
+    {
+        numberOfChildren[parents[index]]--;
+    }
+
+    parents[index] = parent;
+    flags[index] |= transform_dirtyWorld;
+
+    if( parent != -1 )
+    {
+        numberOfChildren[parent]++;
+        if( parent > index )
+        {
+            unordered = true;
+        }
+    }
+}
+
+
+void CCTransformStore::setTransform(const int index, const CCVector3 &position, const CCVector3 &rotation, const CCVector3 *scale)
+{
+    CCQuaternion quaternion;
+    CCQuaternionFromEuler( quaternion, rotation );
+    setTransform( index, position, quaternion, scale );
+}
+
+
+void CCTransformStore::setTransform(const int index, const CCVector3 &position, const CCQuaternion &rotation, const CCVector3 *scale)
+{
+    positions[index] = position;
+    rotations[index] = rotation;
+    scales[index] = scale != NULL ? *scale : CCVector3( 1.0f );
+    flags[index] |= transform_dirtyLocal;
+}
+
+
+void CCTransformStore::update()
+{
+    if( unordered )
+    {
+        reorder();
+    }
+
+    // Parents come first, so their changed flag is already up to date when we reach their children
+    numberOfUpdated = 0;
+    for( int i=0; i<numberOfTransforms; ++i )
+    {
+        const unsigned char transformFlags = flags[i];
+        const int parent = parents[i];
+
+        if( transformFlags & transform_dirtyLocal )
+        {
+            CCMatrixCompose( locals[i], positions[i], rotations[i], &scales[i] );
+        }
+
+        if( ( transformFlags & ( transform_dirtyLocal | transform_dirtyWorld ) ) ||
+            ( parent != -1 && ( flags[parent] & transform_changed ) ) )
+        {
+            if( parent != -1 )
+            {
+                CCMatrixMultiply( worlds[i], locals[i], worlds[parent] );
+            }
+            else
+            {
+                worlds[i] = locals[i];
+            }
+
+            flags[i] = transform_changed;
+            numberOfUpdated++;
+        }
+        else
+        {
+            flags[i] = 0;
+        }
+    }
+}
+
+
+const CCMatrix& CCTransformStore::refreshLocalMatrix(const int index)
+{
+    if( flags[index] & transform_dirtyLocal )
+    {
+        CCMatrixCompose( locals[index], positions[index], rotations[index], &scales[index] );
+        flags[index] = ( flags[index] & ~transform_dirtyLocal ) | transform_dirtyWorld;
+    }
+    return locals[index];
+}
+
+
+const CCMatrix& CCTransformStore::refreshWorldMatrix(const int index)
+{
+    rebuildWorldMatrix( index );
+    return worlds[index];
+}
+
+
+bool CCTransformStore::rebuildWorldMatrix(const int index)
+{
+    refreshLocalMatrix( index );
+
+    const int parent = parents[index];
+    const bool parentRebuilt = parent != -1 && rebuildWorldMatrix( parent );
+    if( parentRebuilt || ( flags[index] & transform_dirtyWorld ) )
+    {
+        if( parent != -1 )
+        {
+            CCMatrixMultiply( worlds[index], locals[index], worlds[parent] );
+        }
+        else
+        {
+            worlds[index] = locals[index];
+        }
+        return true;
+    }
+    return false;
+}
+
+
+void CCTransformStore::reserve(const int size)
+{
+    CCASSERT( size >= numberOfTransforms );
+    allocatedTransforms = size;
+    Resize( positions, numberOfTransforms, allocatedTransforms );
+    Resize( rotations, numberOfTransforms, allocatedTransforms );
+    Resize( scales, numberOfTransforms, allocatedTransforms );
+    Resize( locals, numberOfTransforms, allocatedTransforms );
+    Resize( worlds, numberOfTransforms, allocatedTransforms );
+    Resize( parents, numberOfTransforms, allocatedTransforms );
+    Resize( numberOfChildren, numberOfTransforms, allocatedTransforms );
+    Resize( flags, numberOfTransforms, allocatedTransforms );
+    Resize( owners, numberOfTransforms, allocatedTransforms );
+    Resize( order, numberOfTransforms, allocatedTransforms );
+}
+
+
+void CCTransformStore::reorder()
+{
+    const int count = numberOfTransforms;
+
+    // List each transform's children together
+    int *firstChild = (int*)malloc( sizeof( int ) * ( count+1 ) );
+    int *children = (int*)malloc( sizeof( int ) * count );
+    int *remap = (int*)malloc( sizeof( int ) * count );
+    CCASSERT( firstChild != NULL && children != NULL && remap != NULL );
+
+    firstChild[0] = 0;
+    for( int i=0; i<count; ++i )
+    {
+        firstChild[i+1] = firstChild[i] + numberOfChildren[i];
+        remap[i] = firstChild[i];
+    }
+    for( int i=0; i<count; ++i )
+    {
+        if( parents[i] != -1 )
+        {
+            children[remap[parents[i]]++] = i;
+        }
+    }
+
+    // Roots keep their relative order, then a breadth first walk appends everyone beneath them
+    int length = 0;
+    for( int i=0; i<count; ++i )
+    {
+        if( parents[i] == -1 )
+        {
+            order[length++] = i;
+        }
+    }
+    for( int head=0; head<length; ++head )
+    {
+        const int transform = order[head];
+        for( int i=firstChild[transform]; i<firstChild[transform+1]; ++i )
+        {
+            order[length++] = children[i];
+        }
+    }
+    CCASSERT( length == count );
+
+    for( int i=0; i<count; ++i )
+    {
+        remap[order[i]] = i;
+    }
+
+    Permute( positions, order, count, allocatedTransforms );
+    Permute( rotations, order, count, allocatedTransforms );
+    Permute( scales, order, count, allocatedTransforms );
+    Permute( locals, order, count, allocatedTransforms );
+    Permute( worlds, order, count, allocatedTransforms );
+    Permute( parents, order, count, allocatedTransforms );
+    Permute( numberOfChildren, order, count, allocatedTransforms );
+    Permute( flags, order, count, allocatedTransforms );
+    Permute( owners, order, count, allocatedTransforms );
+
+    for( int i=0; i<count; ++i )
+    {
+        if( parents[i] != -1 )
+        {
+            parents[i] = remap[parents[i]];
+        }
+        if( owners[i] != NULL )
+        {
+            owners[i]->transformIndex = i;
+        }
+    }
+
+    FREE_POINTER( firstChild );
+    FREE_POINTER( children );
+    FREE_POINTER( remap );
+
+    unordered = false;
+}
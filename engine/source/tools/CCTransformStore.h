@@ -0,0 +1,93 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTransformStore.h
+ * Description : Contiguous transforms ordered parent before child, refreshed in one pass a frame.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCTRANSFORMSTORE_H__
+#define __CCTRANSFORMSTORE_H__
+
+
+class CCRenderable;
+
+class CCTransformStore
+{
+public:
+    enum Flags
+    {
+        transform_dirtyLocal    = 0x01,     // Position, rotation or scale changed
+        transform_dirtyWorld    = 0x02,     // Parent changed
+        transform_changed       = 0x04,     // World matrix was rebuilt by the last update
+    };
+
+    CCTransformStore();
+    ~CCTransformStore();
+
+    // Appends a transform, the parent must already be in the store, returns its index
+    // Bound renderables have their transformIndex kept up to date as transforms are moved around
+    int add(CCRenderable *owner, const int parent=-1);
+
+    // Children of the removed transform become roots
+    void remove(const int index);
+
+    void setParent(const int index, const int parent);
+    void setTransform(const int index, const CCVector3 &position, const CCVector3 &rotation, const CCVector3 *scale);
+    void setTransform(const int index, const CCVector3 &position, const CCQuaternion &rotation, const CCVector3 *scale);
+
+    // Restores parent before child ordering if needed, then rebuilds the dirty model matrices and the
+    // world matrices beneath them in a single pass
+    void update();
+
+    // Rebuilds a single model matrix, for renderables changed after this frame's update
+    const CCMatrix& refreshLocalMatrix(const int index);
+
+    // Rebuilds a single world matrix from its parents, for renderables changed after this frame's update
+    // The transforms are left dirty, so the next update still rebuilds everyone beneath them
+    const CCMatrix& refreshWorldMatrix(const int index);
+
+    const CCMatrix& getLocalMatrix(const int index) const { return locals[index]; }
+    const CCMatrix& getWorldMatrix(const int index) const { return worlds[index]; }
+    int getParent(const int index) const { return parents[index]; }
+    bool hasChanged(const int index) const { return ( flags[index] & transform_changed ) != 0; }
+
+    int getNumberOfTransforms() const { return numberOfTransforms; }
+    int getNumberOfUpdated() const { return numberOfUpdated; }
+
+protected:
+    void reserve(const int size);
+    void reorder();
+
+    // Returns true if the world matrix was out of date
+    bool rebuildWorldMatrix(const int index);
+
+protected:
+    CCVector3 *positions;
+    CCQuaternion *rotations;
+    CCVector3 *scales;
+    CCMatrix *locals;
+    CCMatrix *worlds;
+    int *parents;
+    int *numberOfChildren;
+    unsigned char *flags;
+    CCRenderable **owners;
+
+    // Scratch used when restoring the ordering
+    int *order;
+
+    int numberOfTransforms, allocatedTransforms;
+
+    // Set when a transform is placed before its parent
+    bool unordered;
+
+    int numberOfUpdated;
+};
+
+
+#endif // __CCTRANSFORMSTORE_H__
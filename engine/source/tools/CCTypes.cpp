@@ -42,6 +42,22 @@ CCData::~CCData()
 }
 
 
+void CCData::swap(CCData &other)
+{
+    const uint otherLength = other.length;
+    char *otherBuffer = other.buffer;
+    const uint otherBufferSize = other.bufferSize;
+
+    other.length = length;
+    other.buffer = buffer;
+    other.bufferSize = bufferSize;
+
+    length = otherLength;
+    buffer = otherBuffer;
+    bufferSize = otherBufferSize;
+}
+
+
 void CCData::setSize(const uint inLength)
 {
     if( inLength > 0 )
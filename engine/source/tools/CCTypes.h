@@ -90,6 +90,9 @@ struct CCData
     void ensureLength(const uint minLength, const bool keepData=false);
     void set(const char *data, const uint inLength);
 	void append(const char *data, const uint inLength);
+
+    // Exchanges buffers, so large data can change hands without being copied
+    void swap(CCData &other);
     
     CCData& operator=(const CCData &other);
 
@@ -471,7 +471,7 @@ bool CCURLManager::useCacheFile(CCURLRequest *urlRequest, bool ignoreTimeout)
             {
                 // In seconds
                 time_t timeNow = time( NULL );
-#if defined( Q_OS_WIN ) || defined( ANDROID ) || defined( Q_OS_LINUX ) || defined( WP8 ) || defined( WIN8 )
+#if defined( Q_OS_WIN ) || defined( ANDROID ) || defined( Q_OS_LINUX ) || defined( WP8 ) || defined( WIN8 ) || defined( HEADLESS )
                 time_t timeSince = timeNow - fileInfo.st_mtime;
 #else
                 time_t timeSince = timeNow - fileInfo.st_mtimespec.tv_sec;
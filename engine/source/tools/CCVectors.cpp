@@ -130,6 +130,130 @@ void CCVector3::clampDistance(const CCVector3 &target, const float offset)
 }
 
 
+void CCQuaternion::normalise()
+{
+    const float magnitude = sqrtf( dot( *this ) );
+    if( magnitude > 0.0f )
+    {
+        const float oneOverMagnitude = 1.0f / magnitude;
+        x *= oneOverMagnitude;
+        y *= oneOverMagnitude;
+        z *= oneOverMagnitude;
+        w *= oneOverMagnitude;
+    }
+    else
+    {
+        set( 0.0f, 0.0f, 0.0f, 1.0f );
+    }
+}
+
+
+void CCQuaternionMultiply(CCQuaternion &result, const CCQuaternion &a, const CCQuaternion &b)
+{
+    const float x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+    const float y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+    const float z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+    const float w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+    result.set( x, y, z, w );
+}
+
+
+void CCQuaternionFromEuler(CCQuaternion &result, const CCVector3 &degrees)
+{
+    // Rotations around x, then y, then z, multiplied out
+    const float halfX = CC_DEGREES_TO_RADIANS( degrees.x ) * 0.5f;
+    const float halfY = CC_DEGREES_TO_RADIANS( degrees.y ) * 0.5f;
+    const float halfZ = CC_DEGREES_TO_RADIANS( degrees.z ) * 0.5f;
+    const float sinX = sinf( halfX ), cosX = cosf( halfX );
+    const float sinY = sinf( halfY ), cosY = cosf( halfY );
+    const float sinZ = sinf( halfZ ), cosZ = cosf( halfZ );
+
+    result.x = sinX * cosY * cosZ + cosX * sinY * sinZ;
+    result.y = cosX * sinY * cosZ - sinX * cosY * sinZ;
+    result.z = cosX * cosY * sinZ + sinX * sinY * cosZ;
+    result.w = cosX * cosY * cosZ - sinX * sinY * sinZ;
+}
+
+
+void CCQuaternionToEuler(CCVector3 &degrees, const CCQuaternion &quaternion)
+{
+    const float x = quaternion.x, y = quaternion.y, z = quaternion.z, w = quaternion.w;
+
+    // The rotation matrix entries we need to pull the angles apart
+    const float m02 = 2.0f * ( x * z + y * w );
+    const float m00 = 1.0f - 2.0f * ( y * y + z * z );
+    const float m01 = 2.0f * ( x * y - z * w );
+    const float m12 = 2.0f * ( y * z - x * w );
+    const float m22 = 1.0f - 2.0f * ( x * x + y * y );
+
+    if( fabsf( m02 ) < 0.99999f )
+    {
+        degrees.x = atan2f( -m12, m22 );
+        degrees.y = asinf( m02 );
+        degrees.z = atan2f( -m01, m00 );
+    }
+    else
+    {
+        // Looking straight along y, x and z turn around the same axis so give it all to x
+        const float m21 = 2.0f * ( y * z + x * w );
+        const float m11 = 1.0f - 2.0f * ( x * x + z * z );
+        degrees.x = atan2f( m21, m11 );
+        degrees.y = m02 > 0.0f ? CC_HPI : -CC_HPI;
+        degrees.z = 0.0f;
+    }
+
+    degrees.x = CC_RADIANS_TO_DEGREES( degrees.x );
+    degrees.y = CC_RADIANS_TO_DEGREES( degrees.y );
+    degrees.z = CC_RADIANS_TO_DEGREES( degrees.z );
+    CCClampRotation( degrees.x );
+    CCClampRotation( degrees.y );
+    CCClampRotation( degrees.z );
+}
+
+
+void CCQuaternionSlerp(CCQuaternion &result, const CCQuaternion &from, const CCQuaternion &to, const float amount)
+{
+    // q and -q are the same rotation, take whichever is closer
+    float cosAngle = from.dot( to );
+    float toSign = 1.0f;
+    if( cosAngle < 0.0f )
+    {
+        cosAngle = -cosAngle;
+        toSign = -1.0f;
+    }
+
+    // Nearly the same rotation, where sinf( angle ) gets too small to divide by
+    if( cosAngle > 0.9995f )
+    {
+        CCQuaternionNlerp( result, from, to, amount );
+        return;
+    }
+
+    const float angle = acosf( cosAngle );
+    const float oneOverSin = 1.0f / sinf( angle );
+    const float fromWeight = sinf( ( 1.0f - amount ) * angle ) * oneOverSin;
+    const float toWeight = sinf( amount * angle ) * oneOverSin * toSign;
+
+    result.x = from.x * fromWeight + to.x * toWeight;
+    result.y = from.y * fromWeight + to.y * toWeight;
+    result.z = from.z * fromWeight + to.z * toWeight;
+    result.w = from.w * fromWeight + to.w * toWeight;
+}
+
+
+void CCQuaternionNlerp(CCQuaternion &result, const CCQuaternion &from, const CCQuaternion &to, const float amount)
+{
+    const float toWeight = from.dot( to ) < 0.0f ? -amount : amount;
+    const float fromWeight = 1.0f - amount;
+
+    result.x = from.x * fromWeight + to.x * toWeight;
+    result.y = from.y * fromWeight + to.y * toWeight;
+    result.z = from.z * fromWeight + to.z * toWeight;
+    result.w = from.w * fromWeight + to.w * toWeight;
+    result.normalise();
+}
+
+
 bool CCColour::toTarget(const CCColour &target, const float amount)
 {
     bool interpolating = CCToTarget( red, target.red, amount );
@@ -365,6 +365,75 @@ static inline CCVector3 CalculateSurfaceNormal(const CCVector3 &v1, const CCVect
 extern void CCVector3Transform(const CCVector3 *translation, const float m[16], CCVector3 *out);
 
 
+// A rotation as a unit quaternion, w being the real part
+struct CCQuaternion
+{
+    CCQuaternion()
+    {
+        x = y = z = 0.0f;
+        w = 1.0f;
+    }
+
+    CCQuaternion(const float inX, const float inY, const float inZ, const float inW)
+    {
+        x = inX;
+        y = inY;
+        z = inZ;
+        w = inW;
+    }
+
+    inline void set(const float inX, const float inY, const float inZ, const float inW)
+    {
+        x = inX;
+        y = inY;
+        z = inZ;
+        w = inW;
+    }
+
+    inline bool operator==(const CCQuaternion &other) const
+    {
+        return x == other.x && y == other.y && z == other.z && w == other.w;
+    }
+
+    inline bool operator!=(const CCQuaternion &other) const
+    {
+        return !( *this == other );
+    }
+
+    inline float dot(const CCQuaternion &other) const
+    {
+        return x * other.x + y * other.y + z * other.z + w * other.w;
+    }
+
+    void normalise();
+
+    float x, y, z, w;
+};
+
+static inline void CCQuaternionFillPtr(CCQuaternion **quaternion, const CCQuaternion &value)
+{
+	if( *quaternion == NULL )
+	{
+		*quaternion = (CCQuaternion*)malloc( sizeof( CCQuaternion ) );
+	}
+
+	**quaternion = value;
+}
+
+// Rotating by b then a, result may be either source
+extern void CCQuaternionMultiply(CCQuaternion &result, const CCQuaternion &a, const CCQuaternion &b);
+
+// Euler angles in degrees, applied in the same order as CCRenderable's rotation
+extern void CCQuaternionFromEuler(CCQuaternion &result, const CCVector3 &degrees);
+extern void CCQuaternionToEuler(CCVector3 &degrees, const CCQuaternion &quaternion);
+
+// Constant angular speed along the shortest arc
+extern void CCQuaternionSlerp(CCQuaternion &result, const CCQuaternion &from, const CCQuaternion &to, const float amount);
+
+// Cheaper than slerp, following the same arc at an uneven speed
+extern void CCQuaternionNlerp(CCQuaternion &result, const CCQuaternion &from, const CCQuaternion &to, const float amount);
+
+
 struct CCColour
 {
 	float	red;
@@ -0,0 +1,22 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCApp.h
+ * Description : Headless builds run the benchmark engine.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCAPP_H__
+#define __CCAPP_H__
+
+
+#include "CCBenchmark.h"
+typedef CCBenchmarkEngine CCAppEngine;
+
+
+#endif // __CCAPP_H__
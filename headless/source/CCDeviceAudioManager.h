@@ -0,0 +1,32 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCDeviceAudioManager.h
+ * Description : Silent audio for headless builds.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCDEVICEAUDIOMANAGER_H__
+#define __CCDEVICEAUDIOMANAGER_H__
+
+
+class CCDeviceAudioManager
+{
+public:
+    static void Reset() {}
+    static void Prepare(const char *id, const char *url) {}
+    static void Play(const char *id, const char *url, const bool restart, const bool loop) {}
+    static void Stop(const char *id) {}
+    static void Pause(const char *id) {}
+    static void Resume(const char *id) {}
+    static void SetTime(const char *id, const float time) {}
+    static void SetVolume(const char *id, const float volume) {}
+};
+
+
+#endif // __CCDEVICEAUDIOMANAGER_H__
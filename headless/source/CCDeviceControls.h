@@ -0,0 +1,21 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCDeviceControls.h
+ * Description : Headless builds have no touch input, see CCEngine::setupEngineThread.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCDEVICECONTROLS_H__
+#define __CCDEVICECONTROLS_H__
+
+
+typedef CCControls CCDeviceControls;
+
+
+#endif // __CCDEVICECONTROLS_H__
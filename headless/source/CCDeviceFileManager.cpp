@@ -0,0 +1,82 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCDeviceFileManager.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCDeviceFileManager.h"
+
+
+CCText CCDeviceFileManager::dataPath = "./";
+
+
+CCDeviceFileManager::CCDeviceFileManager(const CCResourceType resourceType)
+{
+    this->resourceType = resourceType;
+    file = NULL;
+    fileSize = 0;
+}
+
+
+CCDeviceFileManager::~CCDeviceFileManager()
+{
+    close();
+}
+
+
+bool CCDeviceFileManager::open(const char *filePath)
+{
+    close();
+
+    file = fopen( filePath, "rb" );
+    if( file == NULL )
+    {
+        return false;
+    }
+
+    fseek( file, 0, SEEK_END );
+    fileSize = (uint)ftell( file );
+    fseek( file, 0, SEEK_SET );
+    return true;
+}
+
+
+void CCDeviceFileManager::close()
+{
+    if( file != NULL )
+    {
+        fclose( file );
+        file = NULL;
+    }
+}
+
+
+uint CCDeviceFileManager::read(void *dest, const uint size)
+{
+    CCASSERT( file != NULL );
+    return (uint)fread( dest, 1, size, file );
+}
+
+
+void CCDeviceFileManager::seek(const uint size)
+{
+    CCASSERT( file != NULL );
+    fseek( file, size, SEEK_CUR );
+}
+
+
+bool CCDeviceFileManager::endOfFile()
+{
+    CCASSERT( file != NULL );
+    return feof( file ) != 0;
+}
+
+
+uint CCDeviceFileManager::size()
+{
+    return fileSize;
+}
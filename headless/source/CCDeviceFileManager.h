@@ -0,0 +1,48 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCDeviceFileManager.h
+ * Description : Reads files with stdio, relative to the working directory.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCDEVICEFILEMANAGER_H__
+#define __CCDEVICEFILEMANAGER_H__
+
+
+#include "CCFileManager.h"
+
+
+// Packaged files are read from packaged/ under dataPath, everything else from dataPath itself
+class CCDeviceFileManager : public CCFileManager
+{
+public:
+    CCDeviceFileManager(const CCResourceType resourceType);
+    virtual ~CCDeviceFileManager();
+
+    virtual bool open(const char *filePath);
+    virtual void close();
+
+    virtual uint read(void *dest, const uint size);
+
+    virtual void seek(const uint size);
+    virtual bool endOfFile();
+    virtual uint size();
+
+public:
+    // Ends with a /, defaults to the working directory
+    static CCText dataPath;
+
+protected:
+    CCResourceType resourceType;
+    FILE *file;
+    uint fileSize;
+};
+
+
+#endif // __CCDEVICEFILEMANAGER_H__
@@ -0,0 +1,22 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCDeviceRenderer.h
+ * Description : Headless builds draw through the recording renderer.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCDEVICERENDERER_H__
+#define __CCDEVICERENDERER_H__
+
+
+#include "CCHeadlessRenderer.h"
+typedef CCHeadlessRenderer CCDeviceRenderer;
+
+
+#endif // __CCDEVICERENDERER_H__
@@ -0,0 +1,35 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCDeviceURLManager.h
+ * Description : Headless builds have no network, requests fail straight away.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCDEVICEURLMANAGER_H__
+#define __CCDEVICEURLMANAGER_H__
+
+
+#include "CCURLManager.h"
+
+
+class CCDeviceURLManager
+{
+public:
+    // Fails the request, CCURLManager then falls back to any cached copy
+    void processRequest(CCURLRequest *inRequest)
+    {
+        inRequest->state = CCURLRequest::failed;
+    }
+
+    void clear() {}
+    bool isReadyToRequest() { return true; }
+};
+
+
+#endif // __CCDEVICEURLMANAGER_H__
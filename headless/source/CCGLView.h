@@ -0,0 +1,23 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCGLView.h
+ * Description : No window is created when headless.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCGLVIEW_H__
+#define __CCGLVIEW_H__
+
+
+class CCGLView
+{
+};
+
+
+#endif // __CCGLVIEW_H__
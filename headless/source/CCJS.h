@@ -0,0 +1,30 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCJS.h
+ * Description : Headless builds have no JavaScript engine to fetch assets through.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCJS_H__
+#define __CCJS_H__
+
+
+class CCJSEngine
+{
+public:
+    // There's nowhere to download from, so the callback is dropped
+    static void GetAsset(const char *file, const char *url, CCLambdaCallback *callback)
+    {
+        DEBUGLOG( "CCJSEngine::GetAsset() %s isn't available headless\n", file );
+        delete callback;
+    }
+};
+
+
+#endif // __CCJS_H__
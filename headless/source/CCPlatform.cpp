@@ -0,0 +1,53 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCPlatform.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+
+
+static pthread_once_t ThreadLocksOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t NativeThreadMutex;
+static pthread_mutex_t JobsThreadMutex;
+
+
+// The locks are taken again by the thread holding them
+static void CreateThreadLocks()
+{
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init( &attributes );
+    pthread_mutexattr_settype( &attributes, PTHREAD_MUTEX_RECURSIVE );
+    pthread_mutex_init( &NativeThreadMutex, &attributes );
+    pthread_mutex_init( &JobsThreadMutex, &attributes );
+    pthread_mutexattr_destroy( &attributes );
+}
+
+
+void CCNativeThreadLock()
+{
+    pthread_once( &ThreadLocksOnce, &CreateThreadLocks );
+    pthread_mutex_lock( &NativeThreadMutex );
+}
+
+
+void CCNativeThreadUnlock()
+{
+    pthread_mutex_unlock( &NativeThreadMutex );
+}
+
+
+void CCJobsThreadLock()
+{
+    pthread_once( &ThreadLocksOnce, &CreateThreadLocks );
+    pthread_mutex_lock( &JobsThreadMutex );
+}
+
+
+void CCJobsThreadUnlock()
+{
+    pthread_mutex_unlock( &JobsThreadMutex );
+}
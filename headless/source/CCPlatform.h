@@ -0,0 +1,48 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCPlatform.h
+ * Description : Platform includes for headless Linux builds.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCPLATFORM_H__
+#define __CCPLATFORM_H__
+
+
+// No window or GPU, rendering goes through CCHeadlessRenderer
+#ifndef HEADLESS
+#define HEADLESS
+#endif
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <time.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <pthread.h>
+
+typedef unsigned int uint;
+
+#define MIN(a,b) ( (a) < (b) ? (a) : (b) )
+#define MAX(a,b) ( (a) > (b) ? (a) : (b) )
+
+extern void CCNativeThreadLock();
+extern void CCNativeThreadUnlock();
+extern void CCJobsThreadLock();
+extern void CCJobsThreadUnlock();
+
+
+#endif // __CCPLATFORM_H__
@@ -0,0 +1,37 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTexture2D.cpp
+ *-----------------------------------------------------------
+ */
+
+#include "CCDefines.h"
+#include "CCTexture2D.h"
+#include "CCFileManager.h"
+
+
+bool CCTexture2D::DoesTextureExist(const char *path, const CCResourceType resourceType)
+{
+    return CCFileManager::DoesFileExist( path, resourceType );
+}
+
+
+bool CCTexture2D::load(const char *path, const CCResourceType resourceType)
+{
+    if( DoesTextureExist( path, resourceType ) == false )
+    {
+        return false;
+    }
+
+    imageWidth = imageHeight = 1;
+    allocatedWidth = allocatedHeight = 1;
+    allocatedBytes = 4;
+    return true;
+}
+
+
+void CCTexture2D::createGLTexture(const CCTextureLoadOptions options)
+{
+}
@@ -0,0 +1,33 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCTexture2D.h
+ * Description : Headless builds don't decode images, textures only check their file exists.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCTEXTURE2D_H__
+#define __CCTEXTURE2D_H__
+
+
+#include "CCTextureBase.h"
+
+
+class CCTexture2D : public CCTextureBase
+{
+public:
+    static bool DoesTextureExist(const char *path, const CCResourceType resourceType);
+
+protected:
+    // Succeeds for files that exist, as a 1x1 texture
+    virtual bool load(const char *path, const CCResourceType resourceType);
+    virtual void createGLTexture(const CCTextureLoadOptions options);
+};
+
+
+#endif // __CCTEXTURE2D_H__
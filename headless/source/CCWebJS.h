@@ -0,0 +1,23 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCWebJS.h
+ * Description : No JavaScript bridge when headless.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCWEBJS_H__
+#define __CCWEBJS_H__
+
+
+class CCWebJS
+{
+};
+
+
+#endif // __CCWEBJS_H__
@@ -0,0 +1,25 @@
+/*-----------------------------------------------------------
+ * http://softwareispoetry.com
+ *-----------------------------------------------------------
+ * This software is distributed under the Apache 2.0 license.
+ *-----------------------------------------------------------
+ * File Name   : CCWebView.h
+ * Description : No web views when headless.
+ *
+ * Created     : 17/10/26
+ * Author(s)   : agent
+ *-----------------------------------------------------------
+ */
+
+#ifndef __CCWEBVIEW_H__
+#define __CCWEBVIEW_H__
+
+
+class CCWebView
+{
+public:
+    static void ClearCache() {}
+};
+
+
+#endif // __CCWEBVIEW_H__